@@ -99,12 +99,13 @@ void BundleAdjustment::cam_tracker_params_changed(const CamaraTrackerParameter &
  * @brief BundleAdjustment::optimizeCamStructProj
  * @param _model
  */
-void BundleAdjustment::optimizeCamStructProj(v4r::Object::Ptr &_model, boost::shared_ptr< std::vector<Sensor::CameraLocation> > &_cam_trajectory, boost::shared_ptr< std::vector<std::pair<int, pcl::PointCloud<pcl::PointXYZRGB>::Ptr> > > &_log_clouds, boost::shared_ptr< Sensor::AlignedPointXYZRGBVector > &_oc_cloud)
+void BundleAdjustment::optimizeCamStructProj(v4r::Object::Ptr &_model, boost::shared_ptr< std::vector<Sensor::CameraLocation> > &_cam_trajectory, boost::shared_ptr< std::vector<std::pair<int, pcl::PointCloud<pcl::PointXYZRGB>::Ptr> > > &_log_clouds, boost::shared_ptr< Sensor::AlignedPointXYZRGBVector > &_oc_cloud, VoxelCentroidMap::Ptr &_prev_map)
 {
   model = _model;
   cam_trajectory = _cam_trajectory;
   log_clouds = _log_clouds;
   oc_cloud = _oc_cloud;
+  prev_map = _prev_map;
 
   cmd = PROJ_BA_CAM_STRUCT;
   start();
@@ -188,7 +189,7 @@ void BundleAdjustment::run()
  */
 void BundleAdjustment::optimizeCamStructProj()
 {
-  if (model.get()==0 || cam_trajectory.get()==0 || oc_cloud.get()==0)
+  if (model.get()==0 || cam_trajectory.get()==0 || oc_cloud.get()==0 || prev_map.get()==0)
     return;
 
   unsigned z=0;
@@ -236,33 +237,19 @@ void BundleAdjustment::optimizeCamStructProj()
  */
 void BundleAdjustment::renewPrevCloud(const std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f> > &poses, const std::vector<std::pair<int, pcl::PointCloud<pcl::PointXYZRGB>::Ptr> > &clouds)
 {
-  if (clouds.size()>0)
+  if (clouds.size()>0 && prev_map.get()!=0)
   {
     Eigen::Matrix4f inv_pose;
 
-    pcl::PointCloud<pcl::PointXYZRGB>::Ptr tmp_cloud(new pcl::PointCloud<pcl::PointXYZRGB>());
-    pcl::PointCloud<pcl::PointXYZRGB>::Ptr tmp_cloud2(new pcl::PointCloud<pcl::PointXYZRGB>());
-    std::vector<int> indices;
-
-    pcl::octree::OctreePointCloudVoxelCentroid<pcl::PointXYZRGB,pcl::octree::OctreeVoxelCentroidContainerXYZRGB<pcl::PointXYZRGB> >::Ptr octree;
-    octree.reset(new pcl::octree::OctreePointCloudVoxelCentroid<pcl::PointXYZRGB,pcl::octree::OctreeVoxelCentroidContainerXYZRGB<pcl::PointXYZRGB> >(cam_tracker_params.prev_voxegrid_size));
-    pcl::PassThrough<pcl::PointXYZRGB> pass;
-
+    // move the keyframes of the preview map to the optimized poses
     for (unsigned i=0; i<clouds.size(); i++)
     {
       v4r::invPose(poses[clouds[i].first], inv_pose);
-      pcl::removeNaNFromPointCloud(*clouds[i].second,*tmp_cloud,indices);
-      pass.setInputCloud (tmp_cloud);
-      pass.setFilterFieldName ("z");
-      pass.setFilterLimits (0.0, cam_tracker_params.prev_z_cutoff);
-      pass.filter (*tmp_cloud2);
-      pcl::transformPointCloud(*tmp_cloud2, *tmp_cloud, inv_pose);
-      octree->setInputCloud(tmp_cloud);
-      octree->addPointsFromInputCloud();
+      if (!prev_map->setKeyframePose(clouds[i].first, inv_pose))
+        prev_map->addKeyframe(clouds[i].first, *clouds[i].second, inv_pose);
     }
 
-    oc_cloud->clear();
-    octree->getVoxelCentroids(*oc_cloud);
+    prev_map->getCentroids(*oc_cloud);
   }
 }
 
@@ -71,7 +71,8 @@ public:
 
   void optimizeCamStructProj(v4r::Object::Ptr &_model, boost::shared_ptr< std::vector<Sensor::CameraLocation> > &_cam_trajectory,
                              boost::shared_ptr< std::vector<std::pair<int, pcl::PointCloud<pcl::PointXYZRGB>::Ptr> > > &_log_clouds,
-                             boost::shared_ptr< Sensor::AlignedPointXYZRGBVector > &_oc_cloud);
+                             boost::shared_ptr< Sensor::AlignedPointXYZRGBVector > &_oc_cloud,
+                             VoxelCentroidMap::Ptr &_prev_map);
   bool restoreCameras();
 
 
@@ -99,6 +100,7 @@ private:
   boost::shared_ptr< std::vector<Sensor::CameraLocation> > cam_trajectory;
   boost::shared_ptr< std::vector<std::pair<int, pcl::PointCloud<pcl::PointXYZRGB>::Ptr> > > log_clouds;
   boost::shared_ptr< Sensor::AlignedPointXYZRGBVector > oc_cloud;
+  VoxelCentroidMap::Ptr prev_map;
 
   std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f> > stored_cameras;
   std::vector< std::vector<double> > stored_camera_parameter;
@@ -275,7 +275,7 @@ void StoreTrackingModel::saveTrackingModel()
   std::string model_name = folder + "/models/" + objectname + "/tracking_model.ao";
 
   v4r::io::createDirForFileIfNotExist(model_name);
-  v4r::io::write(model_name, model);
+  v4r::io::writeBinary(model_name, model);
 
   std::cout << "Tracking model saved!" << std::endl;
 
@@ -0,0 +1,354 @@
+/**
+ * $Id$
+ * 
+ * Software License Agreement (GNU General Public License)
+ *
+ *  Copyright (C) 2015:
+ *
+ *    Johann Prankl, prankl@acin.tuwien.ac.at
+ *    Aitor Aldoma, aldoma@acin.tuwien.ac.at
+ *
+ *      Automation and Control Institute
+ *      Vienna University of Technology
+ *      Gusshausstraße 25-29
+ *      1170 Vienn, Austria
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author Johann Prankl, Aitor Aldoma
+ *
+ */
+
+#include "VoxelCentroidMap.h"
+#include <cmath>
+#include <limits>
+
+
+/**
+ * @brief VoxelCentroidMap::VoxelCentroidMap
+ * @param _voxel_size
+ * @param _z_cutoff points of a keyframe with a larger depth are not inserted
+ */
+VoxelCentroidMap::VoxelCentroidMap(double _voxel_size, float _z_cutoff)
+ : voxel_size(0.), inv_voxel_size(0.), z_cutoff(_z_cutoff)
+{
+  setParameter(_voxel_size, _z_cutoff);
+}
+
+/**
+ * @brief VoxelCentroidMap::~VoxelCentroidMap
+ */
+VoxelCentroidMap::~VoxelCentroidMap()
+{
+}
+
+/******************************** public *******************************/
+
+/**
+ * @brief VoxelCentroidMap::setParameter
+ * A change of the voxel size rebuilds the grid from the stored keyframes
+ * @param _voxel_size
+ * @param _z_cutoff
+ */
+void VoxelCentroidMap::setParameter(double _voxel_size, float _z_cutoff)
+{
+  boost::mutex::scoped_lock lock(mtx);
+
+  z_cutoff = _z_cutoff;
+
+  if (voxel_size == _voxel_size)
+    return;
+
+  voxel_size = _voxel_size;
+  inv_voxel_size = 1./voxel_size;
+
+  if (voxels.size()==0)
+    return;
+
+  for (unsigned i=0; i<centroids.size(); i++)
+  {
+    if (!std::isnan(centroids[i].x))
+    {
+      centroids[i].x = centroids[i].y = centroids[i].z = std::numeric_limits<float>::quiet_NaN();
+      markDirty(i);
+    }
+  }
+
+  voxels.clear();
+  free_slots.clear();
+  for (int i=centroids.size()-1; i>=0; i--)
+    free_slots.push_back(i);
+
+  for (std::map<int, boost::shared_ptr<Keyframe> >::iterator it=keyframes.begin(); it!=keyframes.end(); it++)
+    insert(*it->second, 1);
+}
+
+/**
+ * @brief VoxelCentroidMap::clear
+ */
+void VoxelCentroidMap::clear()
+{
+  boost::mutex::scoped_lock lock(mtx);
+
+  voxels.clear();
+  keyframes.clear();
+  centroids.clear();
+  free_slots.clear();
+  dirty_slots.clear();
+  is_dirty.clear();
+}
+
+/**
+ * @brief VoxelCentroidMap::addKeyframe
+ * Inserts the valid points (z in [0, z_cutoff]) of a keyframe. An existing keyframe with the same id is replaced.
+ * @param id keyframe id (e.g. camera index)
+ * @param cloud keyframe cloud in camera coordinates
+ * @param pose camera to global transformation
+ */
+void VoxelCentroidMap::addKeyframe(int id, const pcl::PointCloud<pcl::PointXYZRGB> &cloud, const Eigen::Matrix4f &pose)
+{
+  boost::mutex::scoped_lock lock(mtx);
+
+  std::map<int, boost::shared_ptr<Keyframe> >::iterator it = keyframes.find(id);
+  if (it!=keyframes.end())
+  {
+    insert(*it->second, -1);
+    keyframes.erase(it);
+  }
+
+  boost::shared_ptr<Keyframe> kf(new Keyframe());
+  kf->pose = pose;
+  kf->cloud.points.reserve(cloud.points.size());
+
+  for (unsigned i=0; i<cloud.points.size(); i++)
+  {
+    const pcl::PointXYZRGB &pt = cloud.points[i];
+    if (!std::isnan(pt.x) && !std::isnan(pt.y) && !std::isnan(pt.z) && pt.z>=0. && pt.z<=z_cutoff)
+      kf->cloud.points.push_back(pt);
+  }
+  kf->cloud.width = kf->cloud.points.size();
+  kf->cloud.height = 1;
+  kf->cloud.is_dense = true;
+
+  insert(*kf, 1);
+  keyframes[id] = kf;
+}
+
+/**
+ * @brief VoxelCentroidMap::removeKeyframe
+ * @param id
+ */
+void VoxelCentroidMap::removeKeyframe(int id)
+{
+  boost::mutex::scoped_lock lock(mtx);
+
+  std::map<int, boost::shared_ptr<Keyframe> >::iterator it = keyframes.find(id);
+  if (it==keyframes.end())
+    return;
+
+  insert(*it->second, -1);
+  keyframes.erase(it);
+}
+
+/**
+ * @brief VoxelCentroidMap::setKeyframePose
+ * Moves the points of a keyframe to a new pose (nothing is done if the pose did not change)
+ * @param id
+ * @param pose camera to global transformation
+ * @return false if the keyframe does not exist
+ */
+bool VoxelCentroidMap::setKeyframePose(int id, const Eigen::Matrix4f &pose)
+{
+  boost::mutex::scoped_lock lock(mtx);
+
+  std::map<int, boost::shared_ptr<Keyframe> >::iterator it = keyframes.find(id);
+  if (it==keyframes.end())
+    return false;
+
+  Keyframe &kf = *it->second;
+
+  if ((kf.pose-pose).cwiseAbs().maxCoeff() < 1e-6)
+    return true;
+
+  insert(kf, -1);
+  kf.pose = pose;
+  insert(kf, 1);
+
+  return true;
+}
+
+/**
+ * @brief VoxelCentroidMap::getCentroids
+ * @param _centroids slot array (empty slots are NaN)
+ */
+void VoxelCentroidMap::getCentroids(AlignedPointXYZRGBVector &_centroids)
+{
+  boost::mutex::scoped_lock lock(mtx);
+
+  _centroids = centroids;
+
+  for (unsigned i=0; i<dirty_slots.size(); i++)
+    is_dirty[dirty_slots[i]] = 0;
+  dirty_slots.clear();
+}
+
+/**
+ * @brief VoxelCentroidMap::getDelta
+ * Returns the slots changed since the last call of getDelta or getCentroids
+ * @param delta
+ */
+void VoxelCentroidMap::getDelta(Delta &delta)
+{
+  boost::mutex::scoped_lock lock(mtx);
+
+  delta.size = centroids.size();
+  delta.indices.resize(dirty_slots.size());
+  delta.points.resize(dirty_slots.size());
+
+  for (unsigned i=0; i<dirty_slots.size(); i++)
+  {
+    delta.indices[i] = dirty_slots[i];
+    delta.points[i] = centroids[dirty_slots[i]];
+    is_dirty[dirty_slots[i]] = 0;
+  }
+
+  dirty_slots.clear();
+}
+
+/**
+ * @brief VoxelCentroidMap::applyDelta
+ * @param delta
+ * @param _centroids slot array which is updated
+ */
+void VoxelCentroidMap::applyDelta(const Delta &delta, AlignedPointXYZRGBVector &_centroids)
+{
+  pcl::PointXYZRGB nan_pt;
+  nan_pt.x = nan_pt.y = nan_pt.z = std::numeric_limits<float>::quiet_NaN();
+
+  _centroids.resize(delta.size, nan_pt);
+
+  for (unsigned i=0; i<delta.indices.size(); i++)
+    _centroids[delta.indices[i]] = delta.points[i];
+}
+
+
+/******************************** private *******************************/
+
+/**
+ * @brief VoxelCentroidMap::insert
+ * @param kf
+ * @param sign 1 adds, -1 removes the points of the keyframe
+ */
+void VoxelCentroidMap::insert(const Keyframe &kf, int sign)
+{
+  const Eigen::Matrix3f R = kf.pose.topLeftCorner<3,3>();
+  const Eigen::Vector3f t = kf.pose.block<3,1>(0,3);
+
+  for (unsigned i=0; i<kf.cloud.points.size(); i++)
+  {
+    const pcl::PointXYZRGB &pt = kf.cloud.points[i];
+    Eigen::Vector3f pt_global = R*pt.getVector3fMap() + t;
+
+    if (sign>0) addPoint(pt_global, pt);
+    else removePoint(pt_global, pt);
+  }
+}
+
+/**
+ * @brief VoxelCentroidMap::addPoint
+ */
+void VoxelCentroidMap::addPoint(const Eigen::Vector3f &pt, const pcl::PointXYZRGB &col)
+{
+  Voxel &v = voxels[getKey(pt)];
+
+  if (v.slot<0)
+  {
+    if (free_slots.size()>0)
+    {
+      v.slot = free_slots.back();
+      free_slots.pop_back();
+    }
+    else
+    {
+      v.slot = centroids.size();
+      centroids.push_back(pcl::PointXYZRGB());
+      is_dirty.push_back(0);
+    }
+  }
+
+  v.pt += pt.cast<double>();
+  v.r += col.r;
+  v.g += col.g;
+  v.b += col.b;
+  v.cnt++;
+
+  setCentroid(v);
+}
+
+/**
+ * @brief VoxelCentroidMap::removePoint
+ */
+void VoxelCentroidMap::removePoint(const Eigen::Vector3f &pt, const pcl::PointXYZRGB &col)
+{
+  boost::unordered_map<unsigned long long, Voxel>::iterator it = voxels.find(getKey(pt));
+
+  if (it==voxels.end())
+    return;
+
+  Voxel &v = it->second;
+
+  if (v.cnt<=1)
+  {
+    pcl::PointXYZRGB &c = centroids[v.slot];
+    c.x = c.y = c.z = std::numeric_limits<float>::quiet_NaN();
+    markDirty(v.slot);
+    free_slots.push_back(v.slot);
+    voxels.erase(it);
+    return;
+  }
+
+  v.pt -= pt.cast<double>();
+  v.r -= col.r;
+  v.g -= col.g;
+  v.b -= col.b;
+  v.cnt--;
+
+  setCentroid(v);
+}
+
+/**
+ * @brief VoxelCentroidMap::setCentroid
+ */
+void VoxelCentroidMap::setCentroid(const Voxel &v)
+{
+  pcl::PointXYZRGB &c = centroids[v.slot];
+  c.getVector3fMap() = (v.pt / (double)v.cnt).cast<float>();
+  c.r = v.r / v.cnt;
+  c.g = v.g / v.cnt;
+  c.b = v.b / v.cnt;
+  markDirty(v.slot);
+}
+
+/**
+ * @brief VoxelCentroidMap::markDirty
+ */
+void VoxelCentroidMap::markDirty(int slot)
+{
+  if (!is_dirty[slot])
+  {
+    is_dirty[slot] = 1;
+    dirty_slots.push_back(slot);
+  }
+}
+
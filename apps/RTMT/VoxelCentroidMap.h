@@ -0,0 +1,149 @@
+/**
+ * $Id$
+ * 
+ * Software License Agreement (GNU General Public License)
+ *
+ *  Copyright (C) 2015:
+ *
+ *    Johann Prankl, prankl@acin.tuwien.ac.at
+ *    Aitor Aldoma, aldoma@acin.tuwien.ac.at
+ *
+ *      Automation and Control Institute
+ *      Vienna University of Technology
+ *      Gusshausstraße 25-29
+ *      1170 Vienn, Austria
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author Johann Prankl, Aitor Aldoma
+ *
+ */
+#ifndef _RTMT_VOXEL_CENTROID_MAP_H_
+#define _RTMT_VOXEL_CENTROID_MAP_H_
+
+#include <vector>
+#include <map>
+#include <boost/shared_ptr.hpp>
+#include <boost/unordered_map.hpp>
+#include <boost/thread/mutex.hpp>
+#include <Eigen/Dense>
+#include <Eigen/StdVector>
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+
+
+/**
+ * VoxelCentroidMap
+ * Incremental voxel grid (centroid and mean color per voxel) of the keyframes used for the preview.
+ * Keyframes can be added, removed and re-posed (e.g. after bundle adjustment) without rebuilding the
+ * grid from scratch. The centroids are stored in a slot array (empty slots are NaN) so that only the
+ * slots changed since the last call need to be sent to the viewer (see getDelta).
+ */
+class VoxelCentroidMap
+{
+public:
+  typedef std::vector<pcl::PointXYZRGB, Eigen::aligned_allocator<pcl::PointXYZRGB> > AlignedPointXYZRGBVector;
+
+  /**
+   * Delta
+   * changed slots of the centroid array
+   */
+  class Delta
+  {
+  public:
+    unsigned size;                      // size of the slot array
+    std::vector<int> indices;           // changed slots
+    AlignedPointXYZRGBVector points;    // new centroids of the changed slots (NaN if the voxel has been removed)
+    Delta() : size(0) {}
+  };
+
+private:
+  class Voxel
+  {
+  public:
+    Eigen::Vector3d pt;
+    unsigned r, g, b;
+    unsigned cnt;
+    int slot;
+    Voxel() : pt(0.,0.,0.), r(0), g(0), b(0), cnt(0), slot(-1) {}
+  };
+
+  class Keyframe
+  {
+  public:
+    Eigen::Matrix4f pose;               // camera to global
+    pcl::PointCloud<pcl::PointXYZRGB> cloud;  // valid points in camera coordinates
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  };
+
+  double voxel_size;
+  double inv_voxel_size;
+  float z_cutoff;
+
+  boost::unordered_map<unsigned long long, Voxel> voxels;
+  std::map<int, boost::shared_ptr<Keyframe> > keyframes;
+
+  AlignedPointXYZRGBVector centroids;   // slot array
+  std::vector<int> free_slots;
+  std::vector<int> dirty_slots;
+  std::vector<unsigned char> is_dirty;
+
+  boost::mutex mtx;
+
+  inline unsigned long long getKey(const Eigen::Vector3f &pt) const;
+  void insert(const Keyframe &kf, int sign);
+  void addPoint(const Eigen::Vector3f &pt, const pcl::PointXYZRGB &col);
+  void removePoint(const Eigen::Vector3f &pt, const pcl::PointXYZRGB &col);
+  void setCentroid(const Voxel &v);
+  void markDirty(int slot);
+
+public:
+  VoxelCentroidMap(double _voxel_size=0.005, float _z_cutoff=1.);
+  ~VoxelCentroidMap();
+
+  void setParameter(double _voxel_size, float _z_cutoff);
+  void clear();
+
+  void addKeyframe(int id, const pcl::PointCloud<pcl::PointXYZRGB> &cloud, const Eigen::Matrix4f &pose);
+  void removeKeyframe(int id);
+  bool setKeyframePose(int id, const Eigen::Matrix4f &pose);
+
+  void getCentroids(AlignedPointXYZRGBVector &_centroids);
+  void getDelta(Delta &delta);
+  static void applyDelta(const Delta &delta, AlignedPointXYZRGBVector &_centroids);
+
+  inline unsigned numKeyframes() const { return keyframes.size(); }
+  inline unsigned numVoxels() const { return voxels.size(); }
+
+  typedef boost::shared_ptr< ::VoxelCentroidMap> Ptr;
+  typedef boost::shared_ptr< ::VoxelCentroidMap const> ConstPtr;
+};
+
+
+/*************************** INLINE METHODES **************************/
+
+/**
+ * @brief VoxelCentroidMap::getKey
+ * 21 bit per axis (voxel coordinates are offset by 2^20)
+ */
+inline unsigned long long VoxelCentroidMap::getKey(const Eigen::Vector3f &pt) const
+{
+  const unsigned long long mask = (1ull<<21)-1;
+  unsigned long long x = (unsigned long long)((long long)std::floor(pt[0]*inv_voxel_size) + (1ll<<20)) & mask;
+  unsigned long long y = (unsigned long long)((long long)std::floor(pt[1]*inv_voxel_size) + (1ll<<20)) & mask;
+  unsigned long long z = (unsigned long long)((long long)std::floor(pt[2]*inv_voxel_size) + (1ll<<20)) & mask;
+  return (x<<42) | (y<<21) | z;
+}
+
+#endif // _RTMT_VOXEL_CENTROID_MAP_H_
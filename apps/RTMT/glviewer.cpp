@@ -121,6 +121,13 @@ void GLViewer::update_model_cloud(const boost::shared_ptr< Sensor::AlignedPointX
   //cout<<"[GLViewer::update_model_cloud] "<<oc_cloud.size()<<endl;
 }
 
+void GLViewer::update_model_cloud_delta(const boost::shared_ptr< VoxelCentroidMap::Delta > &_delta)
+{
+  oc_mutex.lock();
+  VoxelCentroidMap::applyDelta(*_delta, oc_cloud);
+  oc_mutex.unlock();
+}
+
 void GLViewer::update_cam_trajectory(const boost::shared_ptr< std::vector<Sensor::CameraLocation> > &_cam_trajectory)
 {
   cam_mutex.lock();
@@ -113,6 +113,7 @@ MainWindow::MainWindow(QWidget *parent) :
   qRegisterMetaType< cv::Mat_<cv::Vec3b> >("cv::Mat_<cv::Vec3b>");
   qRegisterMetaType< boost::shared_ptr< std::vector<Sensor::CameraLocation> > >("boost::shared_ptr< std::vector<Sensor::CameraLocation> >");
   qRegisterMetaType< boost::shared_ptr< Sensor::AlignedPointXYZRGBVector > >("boost::shared_ptr< Sensor::AlignedPointXYZRGBVector >");
+  qRegisterMetaType< boost::shared_ptr< VoxelCentroidMap::Delta > >("boost::shared_ptr< VoxelCentroidMap::Delta >");
   qRegisterMetaType< std::string >("std::string");
   qRegisterMetaType< std::vector<Eigen::Vector3f> >("std::vector<Eigen::Vector3f>");
   qRegisterMetaType< Eigen::Matrix4f >("Eigen::Matrix4f");
@@ -122,6 +123,8 @@ MainWindow::MainWindow(QWidget *parent) :
           m_glviewer, SLOT(new_image(const pcl::PointCloud<pcl::PointXYZRGB>::Ptr, const cv::Mat_<cv::Vec3b>)));
   connect(m_sensor, SIGNAL(update_model_cloud(const boost::shared_ptr< Sensor::AlignedPointXYZRGBVector >)),
           m_glviewer, SLOT(update_model_cloud(const boost::shared_ptr< Sensor::AlignedPointXYZRGBVector >)));
+  connect(m_sensor, SIGNAL(update_model_cloud_delta(const boost::shared_ptr< VoxelCentroidMap::Delta >)),
+          m_glviewer, SLOT(update_model_cloud_delta(const boost::shared_ptr< VoxelCentroidMap::Delta >)));
   connect(m_segmentation, SIGNAL(update_model_cloud(const boost::shared_ptr< Sensor::AlignedPointXYZRGBVector >)),
           m_glviewer, SLOT(update_model_cloud(const boost::shared_ptr< Sensor::AlignedPointXYZRGBVector >)));
   connect(m_sensor, SIGNAL(update_cam_trajectory(const boost::shared_ptr< std::vector<Sensor::CameraLocation> > )),
@@ -402,7 +405,7 @@ void MainWindow::on_OptimizePoses_clicked()
 
   //m_ui->statusLabel->setText("Status: Optimizing camera locations ...");
   //m_sensor->optimizeCameras(num_cameras);
-  m_ba->optimizeCamStructProj(m_sensor->getModel(),m_sensor->getTrajectory(),m_sensor->getClouds(),m_sensor->getAlignedCloud());
+  m_ba->optimizeCamStructProj(m_sensor->getModel(),m_sensor->getTrajectory(),m_sensor->getClouds(),m_sensor->getAlignedCloud(),m_sensor->getPreviewMap());
 }
 
 void MainWindow::finishedOptimizeCameras(int num_cameras)
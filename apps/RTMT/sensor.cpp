@@ -101,7 +101,7 @@ Sensor::Sensor() :
 
   cos_min_delta_angle = cos(20*M_PI/180.);
   sqr_min_cam_distance = 1.*1.;
-  octree.reset(new pcl::octree::OctreePointCloudVoxelCentroid<pcl::PointXYZRGB,pcl::octree::OctreeVoxelCentroidContainerXYZRGB<pcl::PointXYZRGB> >(cam_tracker_params.prev_voxegrid_size));
+  prev_map.reset(new VoxelCentroidMap(cam_tracker_params.prev_voxegrid_size, cam_tracker_params.prev_z_cutoff));
   oc_cloud.reset(new AlignedPointXYZRGBVector () );
 
   v4r::ClusterNormalsToPlanes::Parameter p_param;
@@ -263,7 +263,7 @@ void Sensor::cam_params_changed(const RGBDCameraParameter &_cam_params)
 
   cos_min_delta_angle = cos(20*M_PI/180.);
   sqr_min_cam_distance = 1.*1.;
-  octree.reset(new pcl::octree::OctreePointCloudVoxelCentroid<pcl::PointXYZRGB,pcl::octree::OctreeVoxelCentroidContainerXYZRGB<pcl::PointXYZRGB> >(cam_tracker_params.prev_voxegrid_size));
+  prev_map.reset(new VoxelCentroidMap(cam_tracker_params.prev_voxegrid_size, cam_tracker_params.prev_z_cutoff));
   oc_cloud.reset(new AlignedPointXYZRGBVector () );
   pose = Eigen::Matrix4f::Identity();
   conf = 0.;
@@ -304,7 +304,7 @@ void Sensor::cam_tracker_params_changed(const CamaraTrackerParameter &_cam_track
 
   cos_min_delta_angle = cos(cam_tracker_params.min_delta_angle*M_PI/180.);
   sqr_min_cam_distance = cam_tracker_params.min_delta_distance*cam_tracker_params.min_delta_distance;
-  octree->setResolution(cam_tracker_params.prev_voxegrid_size);
+  prev_map->setParameter(cam_tracker_params.prev_voxegrid_size, cam_tracker_params.prev_z_cutoff);
 }
 
 /**
@@ -332,7 +332,7 @@ void Sensor::reset()
   log_clouds.reset(new std::vector<std::pair<int, pcl::PointCloud<pcl::PointXYZRGB>::Ptr> >());
   cameras.clear();
 
-  octree.reset(new pcl::octree::OctreePointCloudVoxelCentroid<pcl::PointXYZRGB,pcl::octree::OctreeVoxelCentroidContainerXYZRGB<pcl::PointXYZRGB> >(cam_tracker_params.prev_voxegrid_size));
+  prev_map.reset(new VoxelCentroidMap(cam_tracker_params.prev_voxegrid_size, cam_tracker_params.prev_z_cutoff));
   oc_cloud.reset(new AlignedPointXYZRGBVector () );
 
   camtracker->reset();
@@ -385,8 +385,13 @@ void Sensor::storePointCloudModel(const std::string &_folder)
   cloud.height = 1;
   cloud.is_dense = true;
 
+  // skip empty slots of the preview map
+  unsigned z=0;
   for (unsigned i=0; i<oc.size(); i++)
-    cloud.points[i] = oc[i];
+    if (!isnan(oc[i].x)) cloud.points[z++] = oc[i];
+
+  cloud.resize(z);
+  cloud.width = z;
 
   if (cloud.points.size()>0)
     pcl::io::savePCDFileBinary(_folder+"/model.pcd", *tmp_cloud);
@@ -501,7 +506,14 @@ void Sensor::run()
           type = selectFrames(*cloud, cam_id, pose, *cam_trajectory);
 
           if (type >= 0) emit update_cam_trajectory(cam_trajectory);
-          if (type == 2 && cam_tracker_params.create_prev_cloud) emit update_model_cloud(oc_cloud);
+          if (type == 2 && cam_tracker_params.create_prev_cloud)
+          {
+            // only the changed voxels are sent to the viewer
+            boost::shared_ptr<VoxelCentroidMap::Delta> delta(new VoxelCentroidMap::Delta());
+            prev_map->getDelta(*delta);
+            VoxelCentroidMap::applyDelta(*delta, *oc_cloud);
+            emit update_model_cloud_delta(delta);
+          }
           if (m_activate_roi) emit update_boundingbox(edges, pose*bbox_base_transform);
         }
       }
@@ -558,20 +570,9 @@ int Sensor::selectFrames(const pcl::PointCloud<pcl::PointXYZRGB> &cloud, int cam
       log_clouds->push_back(make_pair(cam_id, pcl::PointCloud<pcl::PointXYZRGB>::Ptr(new pcl::PointCloud<pcl::PointXYZRGB>())));
       pcl::copyPointCloud(cloud,*log_clouds->back().second);
 
-      //create preview modelclouds[i].first
+      //create preview model (only the new keyframe is inserted)
       if (cam_tracker_params.create_prev_cloud)
-      {
-        pcl::removeNaNFromPointCloud(cloud,*tmp_cloud,indices);
-        pass.setInputCloud (tmp_cloud);
-        pass.setFilterFieldName ("z");
-        pass.setFilterLimits (0.0, cam_tracker_params.prev_z_cutoff);
-        pass.filter (*tmp_cloud2);
-        pcl::transformPointCloud(*tmp_cloud2, *tmp_cloud, inv_pose);
-        octree->setInputCloud(tmp_cloud);
-        octree->addPointsFromInputCloud();
-        oc_cloud->clear();
-        octree->getVoxelCentroids(*oc_cloud);
-      }
+        prev_map->addKeyframe(cam_id, cloud, inv_pose);
 
       emit printStatus(std::string("Status: Selected ")+v4r::toString(log_clouds->size(),0)+std::string(" keyframes"));
     }
@@ -592,23 +593,16 @@ void Sensor::renewPrevCloud(const std::vector<Eigen::Matrix4f, Eigen::aligned_al
   if (clouds.size()>0)
   {
     Eigen::Matrix4f inv_pose;
-    octree.reset(new pcl::octree::OctreePointCloudVoxelCentroid<pcl::PointXYZRGB,pcl::octree::OctreeVoxelCentroidContainerXYZRGB<pcl::PointXYZRGB> >(cam_tracker_params.prev_voxegrid_size));
 
+    // keyframes which are already in the map are only re-posed
     for (unsigned i=0; i<clouds.size(); i++)
     {
       v4r::invPose(poses[clouds[i].first], inv_pose);
-      pcl::removeNaNFromPointCloud(*clouds[i].second,*tmp_cloud,indices);
-      pass.setInputCloud (tmp_cloud);
-      pass.setFilterFieldName ("z");
-      pass.setFilterLimits (0.0, cam_tracker_params.prev_z_cutoff);
-      pass.filter (*tmp_cloud2);
-      pcl::transformPointCloud(*tmp_cloud2, *tmp_cloud, inv_pose);
-      octree->setInputCloud(tmp_cloud);
-      octree->addPointsFromInputCloud();
+      if (!prev_map->setKeyframePose(clouds[i].first, inv_pose))
+        prev_map->addKeyframe(clouds[i].first, *clouds[i].second, inv_pose);
     }
 
-    oc_cloud->clear();
-    octree->getVoxelCentroids(*oc_cloud);
+    prev_map->getCentroids(*oc_cloud);
   }
 }
 
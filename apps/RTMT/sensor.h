@@ -56,6 +56,7 @@
 #include <v4r/common/convertCloud.h>
 #include <v4r/keypoints/ClusterNormalsToPlanes.h>
 #include "OctreeVoxelCentroidContainerXYZRGB.hpp"
+#include "VoxelCentroidMap.h"
 
 
 
@@ -98,6 +99,7 @@ public:
   boost::shared_ptr< std::vector<CameraLocation> > &getTrajectory() {return cam_trajectory;}
   boost::shared_ptr< std::vector<std::pair<int, pcl::PointCloud<pcl::PointXYZRGB>::Ptr> > > &getClouds() { return log_clouds; }
   boost::shared_ptr< AlignedPointXYZRGBVector > &getAlignedCloud() {return oc_cloud;}
+  VoxelCentroidMap::Ptr &getPreviewMap() {return prev_map;}
 
 
 
@@ -113,6 +115,7 @@ signals:
   void new_image(const pcl::PointCloud<pcl::PointXYZRGB>::Ptr &_cloud, const cv::Mat_<cv::Vec3b> &image);
   void new_pose(const Eigen::Matrix4f &_pose);
   void update_model_cloud(const boost::shared_ptr< Sensor::AlignedPointXYZRGBVector > &_oc_cloud);
+  void update_model_cloud_delta(const boost::shared_ptr< VoxelCentroidMap::Delta > &_delta);
   void update_cam_trajectory(const boost::shared_ptr< std::vector<Sensor::CameraLocation> > &_cam_trajectory);
   void update_visualization();
   void printStatus(const std::string &_txt);
@@ -170,8 +173,7 @@ private:
   pcl::PointCloud<pcl::PointXYZRGB>::Ptr tmp_cloud, tmp_cloud2;
   boost::shared_ptr< AlignedPointXYZRGBVector > oc_cloud;
 
-  pcl::PassThrough<pcl::PointXYZRGB> pass;
-  pcl::octree::OctreePointCloudVoxelCentroid<pcl::PointXYZRGB,pcl::octree::OctreeVoxelCentroidContainerXYZRGB<pcl::PointXYZRGB> >::Ptr octree;
+  VoxelCentroidMap::Ptr prev_map;
 
   // camera tracker
   QMutex shm_mutex;
@@ -0,0 +1,119 @@
+/**
+ * $Id$
+ * 
+ * Software License Agreement (GNU General Public License)
+ *
+ *  Copyright (C) 2015:
+ *
+ *    Johann Prankl, prankl@acin.tuwien.ac.at
+ *    Aitor Aldoma, aldoma@acin.tuwien.ac.at
+ *
+ *      Automation and Control Institute
+ *      Vienna University of Technology
+ *      Gusshausstraße 25-29
+ *      1170 Vienn, Austria
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author Johann Prankl, Aitor Aldoma
+ *
+ */
+
+#ifndef KP_CLUSTERING_RNN_FAST_HH
+#define KP_CLUSTERING_RNN_FAST_HH
+
+#include <vector>
+#include <string>
+#include <stdexcept>
+#include <float.h>
+#include <Eigen/Dense>
+#include <v4r/common/impl/DataMatrix2D.hpp>
+#include "Clustering.h"
+
+
+
+
+namespace v4r
+{
+
+/**
+ * ClusteringRNNFast
+ * Reciprocal nearest neighbour (RNN) agglomerative clustering like ClusteringRNN, but
+ * - cluster means, variances and sizes are stored in contiguous arrays (no heap allocated cluster per sample)
+ * - clusters are removed from the candidate set in O(1)
+ * - the samples are split with a binary space partitioning tree (principal direction splits) into
+ *   cells of at most max_partition_size samples. The nearest neighbour search of the RNN chain
+ *   is restricted to a cell (approximate NN), the cells are clustered in parallel.
+ * - the resulting clusters are re-partitioned and agglomerated again (refine_iterations) to
+ *   merge clusters which have been separated by a cell border
+ * max_partition_size=0 disables the partitioning. Due to the O(1) removal the candidates are visited
+ * in a different order than by ClusteringRNN, i.e. the clusters can differ nevertheless (e.g. for ties)
+ */
+class V4R_EXPORTS ClusteringRNNFast : public Clustering
+{
+public:
+  class Parameter
+  {
+  public:
+    float dist_thr;
+    int max_partition_size;     // max. number of samples of a partition (0 .. no partitioning)
+    int refine_iterations;      // number of re-partition/ re-agglomeration steps of the resulting clusters
+
+    Parameter(float _dist_thr=0.4, int _max_partition_size=2048, int _refine_iterations=1)
+     : dist_thr(_dist_thr), max_partition_size(_max_partition_size), refine_iterations(_refine_iterations) {}
+  };
+
+private:
+  typedef Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> MatrixXfRM;
+
+  MatrixXfRM means;                 // cluster mean (one row per cluster, initialized with the samples)
+  std::vector<float> sqr_sigmas;
+  std::vector<int> sizes;
+  std::vector<int> list_first, list_last, list_next;   // linked lists of the sample indices of a cluster
+  std::vector<int> roots;               // resulting clusters
+
+  void initDataStructure(const DataMatrix2Df &samples);
+  void partition(const std::vector<int> &ids, std::vector< std::vector<int> > &parts);
+  void clusterPartition(std::vector<int> &remaining, std::vector<int> &result);
+  int getNearestNeighbour(int idx, const std::vector<int> &remaining, float &sim);
+  void agglomerate(int src, int dst);
+  void clusterPartitions(const std::vector<int> &ids, std::vector<int> &result);
+
+ 
+public:
+  Parameter param;
+  bool dbg;
+
+  ClusteringRNNFast(const Parameter &_param = Parameter(), bool _dbg=true);
+  ~ClusteringRNNFast();
+
+  virtual void cluster(const DataMatrix2Df &samples); 
+  virtual void getClusters(std::vector<std::vector<int> > &_clusters);
+  virtual void getCenters(DataMatrix2Df &_centers);
+
+  inline unsigned getNumClusters() const { return roots.size(); }
+};
+
+
+
+
+
+/************************** INLINE METHODES ******************************/
+
+
+
+}
+
+#endif
+
@@ -29,6 +29,8 @@
 
 #include <iostream>
 #include <stdexcept>
+#include <vector>
+#include <algorithm>
 #ifdef _OPENMP
 #include <omp.h>
 #endif
@@ -56,8 +58,10 @@ public:
       float kappa;              // gradient
       float d;                  // constant
       float kernel_radius[8];   // Kernel radius for each 0.5 meter intervall (0-4m)
-      Parameter(double _radius=0.02, int _kernel=5, bool _adaptive=false, float _kappa=0.005125, float _d = 0.0)
-       : radius(_radius), kernel(_kernel), adaptive(_adaptive), kappa(_kappa), d(_d) {}
+      bool integral_image;      // use integral images (O(1) covariance per pixel), the euclidean inlier radius is not tested
+      Parameter(double _radius=0.02, int _kernel=5, bool _adaptive=false, float _kappa=0.005125, float _d = 0.0,
+        bool _integral_image=false)
+       : radius(_radius), kernel(_kernel), adaptive(_adaptive), kappa(_kappa), d(_d), integral_image(_integral_image) {}
   };
 
 private:
@@ -68,6 +72,10 @@ private:
 
   float sqr_radius;
 
+  // summed area tables ((height+1) x (width+1)) of the point count, x, y, z and their products
+  enum { SAT_N=0, SAT_X, SAT_Y, SAT_Z, SAT_XX, SAT_XY, SAT_XZ, SAT_YY, SAT_YZ, SAT_ZZ, SAT_SIZE };
+  std::vector<double> sat[SAT_SIZE];
+
   void computeCovarianceMatrix (const v4r::DataMatrix2D<Eigen::Vector3f> &cloud,
         const std::vector<int> &indices, const Eigen::Vector3f &mean, Eigen::Matrix3f &cov);
   void estimateNormals(const v4r::DataMatrix2D<Eigen::Vector3f> &cloud,
@@ -79,10 +87,18 @@ private:
   void estimateNormals(const v4r::DataMatrix2D<Eigen::Vector3f> &cloud,
         const std::vector<int> &normals_indices, std::vector<Eigen::Vector3f> &normals);
 
+  void computeIntegralImages(const v4r::DataMatrix2D<Eigen::Vector3f> &cloud);
+  void computeNormalIntegral(const Eigen::Vector3f &pt, int u, int v, Eigen::Vector3f &n);
+  void estimateNormalsIntegral(const v4r::DataMatrix2D<Eigen::Vector3f> &cloud,
+        v4r::DataMatrix2D<Eigen::Vector3f> &normals);
+  void estimateNormalsIntegral(const v4r::DataMatrix2D<Eigen::Vector3f> &cloud,
+        const std::vector<int> &normals_indices, std::vector<Eigen::Vector3f> &normals);
+
 
   inline int getIdx(short x, short y);
   inline short X(int idx);
   inline short Y(int idx);
+  inline double sumWindow(const std::vector<double> &table, int x0, int y0, int x1, int y1) const;
 
 
 
@@ -122,6 +138,15 @@ inline short ZAdaptiveNormals::Y(int idx)
   return idx/width;
 }
 
+/**
+ * sum of the window [x0,x1]x[y0,y1] (inclusive) from a summed area table
+ */
+inline double ZAdaptiveNormals::sumWindow(const std::vector<double> &table, int x0, int y0, int x1, int y1) const
+{
+  const int w1 = width+1;
+  return table[(y1+1)*w1 + x1+1] - table[y0*w1 + x1+1] - table[(y1+1)*w1 + x0] + table[y0*w1 + x0];
+}
+
 
 }
 
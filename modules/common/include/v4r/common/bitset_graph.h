@@ -0,0 +1,155 @@
+/**
+ * $Id$
+ *
+ * Copyright (c) 2015, Johann Prankl
+ * @author Johann Prankl (prankl@acin.tuwien.ac.at)
+ */
+
+#ifndef KP_BITSET_GRAPH_HH
+#define KP_BITSET_GRAPH_HH
+
+#include <vector>
+#include <limits>
+#include <stdint.h>
+#include <pcl/common/time.h>
+#include <v4r/core/macros.h>
+#include <boost/shared_ptr.hpp>
+
+namespace v4r
+{
+
+/**
+ * BitsetGraph
+ * Undirected graph stored as bit-packed adjacency matrix (one row of 64 bit words per vertex).
+ * Rows can be filled concurrently with setBit (each thread owns its rows) and mirrored
+ * afterwards with symmetrize.
+ */
+class V4R_EXPORTS BitsetGraph
+{
+public:
+  typedef uint64_t Word;
+
+private:
+  int num_vertices_;
+  int num_words_;
+  std::vector<Word> adjacency_;
+
+public:
+  BitsetGraph(int num_vertices=0) { resize(num_vertices); }
+  ~BitsetGraph() {}
+
+  /** resize the graph and remove all edges **/
+  void resize(int num_vertices);
+
+  inline int size() const { return num_vertices_; }
+  inline int numWords() const { return num_words_; }
+
+  inline Word *row(int i) { return &adjacency_[(size_t)i*num_words_]; }
+  inline const Word *row(int i) const { return &adjacency_[(size_t)i*num_words_]; }
+
+  /** set the bit j of row i (directed, use symmetrize or addEdge for an undirected edge) **/
+  inline void setBit(int i, int j) { row(i)[j>>6] |= (Word(1)<<(j&63)); }
+  inline void addEdge(int i, int j) { setBit(i,j); setBit(j,i); }
+  inline bool isConnected(int i, int j) const { return (row(i)[j>>6]>>(j&63)) & Word(1); }
+
+  int degree(int i) const;
+  size_t numEdges() const;
+
+  /** mirror the upper triangle to the lower one **/
+  void symmetrize();
+
+  /** label the connected components (vertices with mask[i]==false are labelled -1) **/
+  int connectedComponents(std::vector<int> &labels, const std::vector<bool> &mask=std::vector<bool>()) const;
+
+  /** vertices of the biconnected components (edge partition, numbered in the order of boost::biconnected_components,
+   * vertices sorted increasingly, articulation points are part of several components, isolated vertices of none) **/
+  int biconnectedComponents(std::vector< std::vector<int> > &components) const;
+
+  /** induced subgraph of the (ordered) vertices **/
+  void getSubgraph(const std::vector<int> &vertices, BitsetGraph &sub) const;
+
+  static inline int popcount(Word w);
+  static inline int lowestBit(Word w);
+
+  typedef boost::shared_ptr< ::v4r::BitsetGraph> Ptr;
+  typedef boost::shared_ptr< ::v4r::BitsetGraph const> ConstPtr;
+};
+
+
+/**
+ * BitsetMaximalCliques
+ * Maximal clique enumeration (Bron-Kerbosch with Tomita pivoting) on a BitsetGraph. Candidate
+ * and done sets are bitsets, i.e. set intersections and pivot selection are word operations.
+ * Branches which can not reach min_clique_size are pruned. The search stops if it takes more
+ * than max_time_allowed milli seconds.
+ */
+class V4R_EXPORTS BitsetMaximalCliques
+{
+private:
+  typedef BitsetGraph::Word Word;
+
+  size_t min_clique_size_;
+  double max_time_allowed_;
+  bool max_time_reached_;
+  pcl::StopWatch time_elapsed_;
+
+  const BitsetGraph *graph_;
+  int num_words_;
+  std::vector<Word> cand_stack_;     // candidates (P) of each recursion level
+  std::vector<Word> done_stack_;     // already processed vertices (X) of each recursion level
+  std::vector<Word> branch_stack_;   // vertices to branch on (P \ N(pivot)) of each recursion level
+  std::vector<int> clique_so_far_;
+  std::vector< std::vector<int> > *cliques_;
+
+  void extend(int depth);
+
+public:
+  BitsetMaximalCliques(size_t min_clique_size=3, double max_time_allowed=std::numeric_limits<double>::infinity())
+    : min_clique_size_(min_clique_size), max_time_allowed_(max_time_allowed), max_time_reached_(false),
+      graph_(0), num_words_(0), cliques_(0) {}
+  ~BitsetMaximalCliques() {}
+
+  inline void setMinCliqueSize(size_t s) { min_clique_size_ = s; }
+  inline void setMaxTimeAllowed(double t) { max_time_allowed_ = t; }
+  inline bool getMaxTimeReached() const { return max_time_reached_; }
+
+  /** find all maximal cliques with at least min_clique_size vertices (in the order they are found) **/
+  void find(const BitsetGraph &graph, std::vector< std::vector<int> > &cliques);
+
+  typedef boost::shared_ptr< ::v4r::BitsetMaximalCliques> Ptr;
+  typedef boost::shared_ptr< ::v4r::BitsetMaximalCliques const> ConstPtr;
+};
+
+
+/*************************** INLINE METHODES **************************/
+
+inline int BitsetGraph::popcount(Word w)
+{
+#ifdef __GNUC__
+  return __builtin_popcountll(w);
+#else
+  w = w - ((w >> 1) & 0x5555555555555555ULL);
+  w = (w & 0x3333333333333333ULL) + ((w >> 2) & 0x3333333333333333ULL);
+  w = (w + (w >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+  return (int)((w * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+/**
+ * index of the lowest set bit (w must not be 0)
+ */
+inline int BitsetGraph::lowestBit(Word w)
+{
+#ifdef __GNUC__
+  return __builtin_ctzll(w);
+#else
+  int i=0;
+  while (!(w & Word(1))) { w >>= 1; i++; }
+  return i;
+#endif
+}
+
+}
+
+#endif
+
@@ -44,12 +44,17 @@
 
 #include "correspondence_grouping.h"
 #include <pcl/recognition/boost.h>
+#include <boost/unordered_map.hpp>
+#include <boost/weak_ptr.hpp>
+#include <list>
+#include <stdint.h>
 
 namespace v4r
 {
   namespace recognition
   {
     /** \brief HoughSpace3D is a 3D voting space. Cast votes can be interpolated in order to better deal with approximations introduced by bin quantization. A weight can also be associated with each vote. 
+      * Only bins which received a vote are stored (hashed by their linear bin index), i.e. the memory does not depend on the extent of the space.
       * \author Federico Tombari (original), Tommaso Cavallari (PCL port)
       * \ingroup recognition
       */
@@ -77,9 +82,9 @@ namespace v4r
           * \param[in] single_vote_coord coordinates of the vote being cast (in absolute coordinates)
           * \param[in] weight weight associated with the vote.
           * \param[in] voter_id the numeric id of the voter. Useful to trace back the voting correspondence, if the vote is returned by findMaxima as part of a maximum of the Hough Space.
-          * \return the index of the bin in which the vote has been cast.
+          * \return the index of the bin in which the vote has been cast (-1 if out of bounds).
           */
-        int
+        int64_t
         vote (const Eigen::Vector3d &single_vote_coord, double weight, int voter_id);
 
         /** \brief Vote for a given position in the 3D space. The weight is interpolated between the bin pointed by single_vote_coord and its neighbors.
@@ -87,28 +92,57 @@ namespace v4r
           * \param[in] single_vote_coord coordinates of the vote being cast.
           * \param[in] weight weight associated with the vote.
           * \param[in] voter_id the numeric id of the voter. Useful to trace back the voting correspondence, if the vote is returned by findMaxima as a part of a maximum of the Hough Space.
-          * \return the index of the bin in which the vote has been cast.
+          * \return the index of the bin in which the vote has been cast (-1 if out of bounds).
           */
-        int
+        int64_t
         voteInt (const Eigen::Vector3d &single_vote_coord, double weight, int voter_id);
 
+        /** \brief Cast a batch of votes in parallel. Each thread votes into its own buffer, the buffers are merged
+          * in thread order at the end (i.e. the voter ids of a bin stay sorted).
+          *
+          * \param[in] vote_coords coordinates of the votes, the voter id of a vote is its index.
+          * \param[in] weights weight of each vote (empty: 1.0).
+          * \param[in] interpolate interpolate the weights between neighboring bins (see voteInt).
+          */
+        void
+        vote (const std::vector<Eigen::Vector3d> &vote_coords, const std::vector<double> &weights, bool interpolate);
+
         /** \brief Find the bins with most votes.
           * 
           * \param[in] min_threshold the minimum number of votes to be included in a bin in order to have its value returned. 
           * If set to a value between -1 and 0 the Hough space maximum_vote is found and the returned values are all the votes greater than -min_threshold * maximum_vote.
-          * \param[out] maxima_values the list of Hough Space bin values greater than min_threshold.
+          * \param[out] maxima_values the list of Hough Space bin values greater than min_threshold (ordered by bin index).
           * \param[out] maxima_voter_ids for each value returned, a list of the voter ids who cast a vote in that position. 
           * \return The min_threshold used, either set by the user or found by this method.
           */
         double
         findMaxima (double min_threshold, std::vector<double> & maxima_values, std::vector<std::vector<int> > &maxima_voter_ids);
 
+        /** \brief Reserve hash buckets for n_matches*percentage non-empty bins. */
         void reserveVoterIdsVector(int n_matches, float percentage=0.1f);
 
+        /** \brief Reserve size_per_bin voter ids for each newly created bin. */
         void reserveVoterIdsVectorFixedSize(int size_per_bin);
 
+        /** \brief Number of bins which received a vote. */
+        inline size_t
+        getNumberOfNonEmptyBins () const
+        {
+          return (bins_.size ());
+        }
+
         protected:
 
+        /** \brief A non-empty bin of the Hough Space. */
+        struct Bin
+        {
+          double value;
+          std::vector<int> voter_ids;
+          Bin() : value(0.) {}
+        };
+
+        typedef boost::unordered_map<int64_t, Bin> BinMap;
+
         /** \brief Minimum coordinate in the Hough Space. */
         Eigen::Vector3d min_coord_;
 
@@ -118,21 +152,37 @@ namespace v4r
         /** \brief Number of bins for each dimension. */
         Eigen::Vector3i bin_count_;
 
-        /** \brief Used to access hough_space_ as if it was a matrix. */
-        int partial_bin_products_[4];
-
-        /** \brief Total number of bins in the Hough Space. */
-        int total_bins_count_;
-
-        /** \brief The Hough Space. */
-        std::vector<double> hough_space_;
-        //boost::unordered_map<int, double> hough_space_;
-
-        /** \brief List of voters for each bin. */
-        boost::unordered_map<int, std::vector<int> > voter_ids_;
-
-        std::vector<std::vector<int> > voter_ids_vector_;
-        std::vector< int > voter_ids_vector_size_;
+        /** \brief Used to compute the linear bin index as if the space was a matrix. */
+        int64_t partial_bin_products_[4];
+
+        /** \brief Voter ids reserved for a new bin. */
+        int voter_ids_per_bin_;
+
+        /** \brief The non-empty bins of the Hough Space. */
+        BinMap bins_;
+
+        /** \brief Add a vote to bins (which is either bins_ or a thread local buffer). */
+        int64_t
+        castVote (BinMap &bins, const Eigen::Vector3d &single_vote_coord, double weight, int voter_id, bool interpolate) const;
+
+        /** \brief Add a weighted vote to a single bin. */
+        inline void
+        addToBin (BinMap &bins, int64_t index, double weight, int voter_id) const
+        {
+          Bin &bin = bins[index];
+          if (bin.voter_ids.empty ())
+            bin.voter_ids.reserve (voter_ids_per_bin_);
+          bin.value += weight;
+          bin.voter_ids.push_back (voter_id);
+        }
+
+        /** \brief Value of a bin (0 for empty bins). */
+        inline double
+        getValue (int64_t index) const
+        {
+          BinMap::const_iterator it = bins_.find (index);
+          return (it == bins_.end () ? 0. : it->second.value);
+        }
     };
   }
 
@@ -173,6 +223,8 @@ namespace v4r
         , scene_rf_ ()
         , needs_training_ (true)
         , model_votes_ ()
+        , model_cache_ ()
+        , max_cached_models_ (10)
         , hough_threshold_ (-1)
         , hough_bin_size_ (1.0)
         , use_interpolation_ (true)
@@ -191,14 +243,27 @@ namespace v4r
       setInputCloud (const PointCloudConstPtr &cloud)
       {
         pcl::PCLBase<PointModelT>::setInputCloud (cloud);
-        needs_training_ = true;
         hough_space_initialized_ = false;
-        input_rf_.reset();
+
+        typename ModelCache::iterator it = findCachedModel (cloud);
+        if (it != model_cache_.end ())
+        {
+          model_cache_.splice (model_cache_.begin (), model_cache_, it);
+          input_rf_ = it->rf;
+          model_votes_ = it->votes;
+          needs_training_ = false;
+        }
+        else
+        {
+          input_rf_.reset();
+          needs_training_ = true;
+        }
       }
 
       /** \brief Provide a pointer to the input dataset's reference frames. 
         * Each point in the reference frame cloud should be the reference frame of
-        * the correspondent point in the input dataset.
+        * the correspondent point in the input dataset. The reference frames replace
+        * the cached ones of the current input cloud on the next training.
         * 
         * \param[in] input_rf the pointer to the input cloud's reference frames.
         */
@@ -342,6 +407,7 @@ namespace v4r
       /** \brief Sets whether the vote casting procedure uses the correspondence's distance as a score.
         * 
         * \param[in] use_distance_weight the algorithm should use the weighted distance when calculating the Hough voting score.
+        * The weights only apply to interpolated votes (see setUseInterpolation).
         */
       inline void
       setUseDistanceWeight (bool use_distance_weight)
@@ -371,6 +437,7 @@ namespace v4r
       {
         local_rf_normals_search_radius_ = local_rf_normals_search_radius;
         needs_training_ = true;
+        model_cache_.clear ();
         hough_space_initialized_ = false;
       }
 
@@ -398,6 +465,7 @@ namespace v4r
       {
         local_rf_search_radius_ = local_rf_search_radius;
         needs_training_ = true;
+        model_cache_.clear ();
         hough_space_initialized_ = false;
       }
 
@@ -414,8 +482,41 @@ namespace v4r
         return (local_rf_search_radius_);
       }
 
+      /** \brief Sets the maximum number of trained models whose reference frames and votes are cached.
+        * If exceeded, the least recently used model is removed (0... unbounded).
+        *
+        * \param[in] max_cached_models maximum number of cached models.
+        */
+      inline void
+      setMaxCachedModels (size_t max_cached_models)
+      {
+        max_cached_models_ = max_cached_models;
+        while (max_cached_models_ && model_cache_.size () > max_cached_models_)
+          model_cache_.pop_back ();
+      }
+
+      /** \brief Gets the maximum number of trained models whose reference frames and votes are cached. */
+      inline size_t
+      getMaxCachedModels () const
+      {
+        return (max_cached_models_);
+      }
+
+      /** \brief Removes the reference frames and votes of all trained models. Needs to be called if a model
+        * cloud is modified in place, as models are identified by their cloud pointer.
+        */
+      inline void
+      clearModelCache ()
+      {
+        model_cache_.clear ();
+        needs_training_ = true;
+        hough_space_initialized_ = false;
+      }
+
       /** \brief Call this function after setting the input, the input_rf and the hough_bin_size parameters to perform an off line training of the algorithm. This might be useful if one wants to perform once and for all a pre-computation of votes that only concern the models, increasing the on-line efficiency of the grouping algorithm. 
         * The algorithm is automatically trained on the first invocation of the recognize method or the cluster method if this training function has not been manually invoked.
+        * The reference frames and votes of the last trained models are cached (see setMaxCachedModels), i.e. setting the same model cloud again does not require another training.
+        * The cache does not keep the model clouds alive, a destroyed cloud is removed from it.
         * 
         * \return true if the training had been successful or false if errors have occurred.
         */
@@ -458,6 +559,40 @@ namespace v4r
       /** \brief The result of the training. The vector between each model point and the centroid of the model adjusted by its local reference frame.*/
       std::vector<Eigen::Vector3f> model_votes_;
 
+      /** \brief Reference frames and votes of a trained model. */
+      struct TrainedModel
+      {
+        boost::weak_ptr<const PointCloud> cloud;
+        ModelRfCloudConstPtr rf;
+        std::vector<Eigen::Vector3f> votes;
+      };
+
+      typedef std::list<TrainedModel> ModelCache;
+
+      /** \brief The trained models, most recently used first. */
+      ModelCache model_cache_;
+
+      /** \brief Maximum number of cached models (0... unbounded). */
+      size_t max_cached_models_;
+
+      /** \brief Finds the cached model of a cloud, removes the models whose cloud has been destroyed. */
+      typename ModelCache::iterator
+      findCachedModel (const PointCloudConstPtr &cloud)
+      {
+        typename ModelCache::iterator it = model_cache_.begin ();
+        while (it != model_cache_.end ())
+        {
+          PointCloudConstPtr cached_cloud = it->cloud.lock ();
+          if (!cached_cloud)
+            it = model_cache_.erase (it);
+          else if (cached_cloud == cloud)
+            return (it);
+          else
+            ++it;
+        }
+        return (model_cache_.end ());
+      }
+
       /** \brief The minimum number of votes in the Hough space needed to infer the presence of a model instance into the scene cloud. */
       double hough_threshold_;
 
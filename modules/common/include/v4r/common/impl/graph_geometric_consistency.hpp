@@ -41,6 +41,7 @@
 #define FAAT_PCL_RECOGNITION_GRAPH_GEOMETRIC_CONSISTENCY_IMPL_H_
 
 #include "v4r/common/graph_geometric_consistency.h"
+#include <v4r/common/bitset_graph.h>
 #include <pcl/registration/correspondence_types.h>
 #include <pcl/registration/correspondence_rejection_sample_consensus.h>
 #include <pcl/common/io.h>
@@ -48,7 +49,6 @@
 #include <boost/unordered_map.hpp>
 #include <boost/graph/connected_components.hpp>
 #include <boost/graph/copy.hpp>
-#include <boost/graph/biconnected_components.hpp>
 #include <boost/graph/prim_minimum_spanning_tree.hpp>
 #include <exception>
 
@@ -169,209 +169,6 @@ class FAATPCL_CliquesException: public std::exception
     }
 } myex;
 
-template<typename Graph>
-class V4R_EXPORTS Tomita
-{
-    typedef std::set<typename boost::graph_traits<Graph>::vertex_descriptor> SetType;
-    typedef std::vector<typename boost::graph_traits<Graph>::vertex_descriptor> VectorType;
-    std::vector<VectorType *> cliques_found_;
-    size_t min_clique_size_;
-    typedef boost::unordered_map<typename boost::graph_traits<Graph>::vertex_descriptor, size_t> MapType;
-    MapType used_ntimes_in_cliques_;
-    std::vector<SetType> nnbrs;
-    float max_time_allowed_;
-    pcl::StopWatch time_elapsed_;
-    bool max_time_reached_;
-
-    void
-    addClique (VectorType & clique)
-    {
-        if (clique.size () >= min_clique_size_)
-        {
-            VectorType * vt = new VectorType (clique);
-            cliques_found_.push_back (vt);
-            for (size_t i = 0; i < clique.size (); i++)
-            {
-                used_ntimes_in_cliques_[clique[i]]++;
-            }
-
-        }
-    }
-
-    void
-    printSet (SetType & s)
-    {
-        typename SetType::iterator vertexIt, vertexEnd;
-        SetType tmp;
-
-        vertexIt = s.begin ();
-        vertexEnd = s.end ();
-
-        for (; vertexIt != vertexEnd; ++vertexIt)
-        {
-            std::cout << *vertexIt + 1 << " ";
-        }
-
-        std::cout << std::endl;
-    }
-    //_extend(nnbrs,cand,done,clique_so_far,cliques);
-    void
-    extend (SetType & cand, SetType & done, VectorType & clique_so_far)
-    {
-        SetType small_cand, pivot_nbrs;
-        int maxconn = -1;
-        size_t num_cand = cand.size ();
-
-        //iterate over done and compute maximum intersection between candidates and the adjacents of done (nnbrs)
-        typename SetType::iterator vertexIt, vertexEnd;
-        SetType tmp;
-
-        vertexIt = done.begin ();
-        vertexEnd = done.end ();
-
-        for (; vertexIt != vertexEnd; ++vertexIt)
-        {
-            std::set_intersection (cand.begin (), cand.end (), nnbrs[*vertexIt].begin (), nnbrs[*vertexIt].end (), std::inserter (tmp, tmp.begin ()));
-
-            if (static_cast<int> (tmp.size ()) > maxconn)
-            {
-                maxconn = static_cast<int> (tmp.size ());
-                pivot_nbrs = tmp;
-                if (maxconn == (int)num_cand)
-                {
-                    //All possible cliques already found
-                    return;
-                }
-            }
-
-            tmp.clear ();
-        }
-
-        //same for candidates
-        vertexIt = cand.begin ();
-        vertexEnd = cand.end ();
-
-        for (; vertexIt != vertexEnd; ++vertexIt)
-        {
-            std::set_intersection (cand.begin (), cand.end (), nnbrs[*vertexIt].begin (), nnbrs[*vertexIt].end (), std::inserter (tmp, tmp.begin ()));
-
-            if (static_cast<int> (tmp.size ()) > maxconn)
-            {
-                maxconn = static_cast<int> (tmp.size ());
-                pivot_nbrs = tmp;
-            }
-            tmp.clear ();
-        }
-
-        std::set_difference (cand.begin (), cand.end (), pivot_nbrs.begin (), pivot_nbrs.end (), std::inserter (small_cand, small_cand.begin ()));
-        vertexIt = small_cand.begin ();
-        vertexEnd = small_cand.end ();
-
-        for (; vertexIt != vertexEnd; ++vertexIt)
-        {
-            cand.erase (*vertexIt);
-            clique_so_far.push_back (*vertexIt);
-            SetType new_cand, new_done;
-            std::set_intersection (cand.begin (), cand.end (), nnbrs[*vertexIt].begin (), nnbrs[*vertexIt].end (),
-                    std::inserter (new_cand, new_cand.begin ()));
-
-            std::set_intersection (done.begin (), done.end (), nnbrs[*vertexIt].begin (), nnbrs[*vertexIt].end (),
-                    std::inserter (new_done, new_done.begin ()));
-
-            if (new_done.size () == 0 && new_cand.size () == 0)
-                addClique (clique_so_far);
-            else if (new_done.size () == 0 && (new_cand.size () == 1))
-            {
-                if ((clique_so_far.size () + 1) >= min_clique_size_)
-                {
-                    VectorType tt = clique_so_far;
-                    tt.push_back (*(new_cand.begin ()));
-                    addClique (tt);
-                }
-            }
-            else
-            {
-                float t_elapsed = static_cast<float>(time_elapsed_.getTime());
-                if(t_elapsed > max_time_allowed_)
-                {
-                    max_time_reached_ = true;
-                    return;
-                }
-
-                extend (new_cand, new_done, clique_so_far);
-            }
-
-            clique_so_far.erase (clique_so_far.begin () + (clique_so_far.size () - 1));
-            done.insert (*vertexIt);
-        }
-    }
-
-public:
-
-    Tomita (size_t mins = 3)
-    {
-        min_clique_size_ = mins;
-        max_time_allowed_ = std::numeric_limits<float>::infinity();
-        max_time_reached_ = false;
-    }
-
-    bool
-    getMaxTimeReached()
-    {
-        return max_time_reached_;
-    }
-
-    void
-    setMaxTimeAllowed(float t)
-    {
-        max_time_allowed_ = t;
-    }
-
-    void
-    find_cliques (Graph & G, size_t num_v)
-    {
-        SetType cand, done;
-        VectorType clique_so_far;
-        nnbrs.clear ();
-        used_ntimes_in_cliques_.clear ();
-        cliques_found_.clear ();
-        time_elapsed_.reset();
-        max_time_reached_ = false;
-
-        typename boost::graph_traits<Graph>::vertex_iterator vertexIt, vertexEnd;
-        boost::tie (vertexIt, vertexEnd) = vertices (G);
-        nnbrs.resize (num_v);
-
-        size_t i = 0;
-        for (; vertexIt != vertexEnd; ++vertexIt, ++i)
-        {
-            typename boost::graph_traits<Graph>::adjacency_iterator vi, vi_end;
-            size_t k = 0;
-            for (boost::tie (vi, vi_end) = boost::adjacent_vertices (*vertexIt, G); vi != vi_end; ++vi, ++k)
-            {
-                nnbrs[i].insert (*vi);
-                cand.insert (*vi);
-            }
-
-            used_ntimes_in_cliques_[*vertexIt] = 0;
-        }
-
-        extend (cand, done, clique_so_far);
-    }
-
-    size_t
-    getNumCliquesFound ()
-    {
-        return cliques_found_.size ();
-    }
-
-    void
-    getCliques (std::vector<VectorType *> & cliques)
-    {
-        cliques = cliques_found_;
-    }
-};
-
 
 bool
 less_clique_vectors (const std::vector<size_t> * a, const std::vector<size_t> * b)
@@ -468,84 +265,117 @@ v4r::GraphGeometricConsistencyGrouping<PointModelT, PointSceneT>::clusterCorresp
     PointCloudPtr temp_scene_cloud_ptr (new PointCloud ());
     pcl::copyPointCloud<PointSceneT, PointModelT> (*scene_, *temp_scene_cloud_ptr);
 
-    GraphGGCG correspondence_graph (model_scene_corrs_->size ());
-    float min_dist_for_cluster = param_.gc_size_ * param_.dist_for_cluster_factor_;
+    const int n_corrs = static_cast<int> (model_scene_corrs_->size ());
+    if (n_corrs == 0)
+        return;
 
-    for (size_t k = 0; k < model_scene_corrs_->size (); ++k)
-    {
-        int scene_index_k = model_scene_corrs_->at (k).index_match;
-        int model_index_k = model_scene_corrs_->at (k).index_query;
-        const Eigen::Vector3f& scene_point_k = scene_->at (scene_index_k).getVector3fMap ();
-        const Eigen::Vector3f& model_point_k = input_->at (model_index_k).getVector3fMap ();
-        const Eigen::Vector3f& scene_normal_k = scene_normals_->at (scene_index_k).getNormalVector3fMap ();
-        const Eigen::Vector3f& model_normal_k = input_normals_->at (model_index_k).getNormalVector3fMap ();
-
-        for (size_t j = (k + 1); j < model_scene_corrs_->size (); ++j)
-        {
-            int scene_index_j = model_scene_corrs_->at (j).index_match;
-            int model_index_j = model_scene_corrs_->at (j).index_query;
+    const float min_dist_for_cluster = param_.gc_size_ * param_.dist_for_cluster_factor_;
+    const float sqr_min_dist_for_cluster = min_dist_for_cluster * min_dist_for_cluster;
+    const float gc_size = static_cast<float> (param_.gc_size_);
+    const float thres_dot_distance = static_cast<float> (param_.thres_dot_distance_);
 
-            //same scene or model point constraint
-            if(scene_index_j == scene_index_k || model_index_j == model_index_k)
-                continue;
+    //points and normals of the correspondences stored column-wise (scene point, model point, scene normal, model normal)
+    //such that the pair tests run over contiguous arrays
+    Eigen::Matrix<float, Eigen::Dynamic, 12> corr_data (n_corrs, 12);
+    std::vector<int> scene_indices (n_corrs), model_indices (n_corrs);
 
-            const Eigen::Vector3f& scene_point_j = scene_->at (scene_index_j).getVector3fMap ();
-            const Eigen::Vector3f& model_point_j = input_->at (model_index_j).getVector3fMap ();
+    for (int k = 0; k < n_corrs; ++k)
+    {
+        scene_indices[k] = model_scene_corrs_->at (k).index_match;
+        model_indices[k] = model_scene_corrs_->at (k).index_query;
+        corr_data.block<1, 3> (k, 0) = scene_->at (scene_indices[k]).getVector3fMap ().transpose ();
+        corr_data.block<1, 3> (k, 3) = input_->at (model_indices[k]).getVector3fMap ().transpose ();
+        corr_data.block<1, 3> (k, 6) = scene_normals_->at (scene_indices[k]).getNormalVector3fMap ().transpose ();
+        corr_data.block<1, 3> (k, 9) = input_normals_->at (model_indices[k]).getNormalVector3fMap ().transpose ();
+    }
 
-            const Eigen::Vector3f& scene_normal_j = scene_normals_->at (scene_index_j).getNormalVector3fMap ();
-            const Eigen::Vector3f& model_normal_j = input_normals_->at (model_index_j).getNormalVector3fMap ();
+    const float *sx = corr_data.col (0).data (), *sy = corr_data.col (1).data (), *sz = corr_data.col (2).data ();
+    const float *mx = corr_data.col (3).data (), *my = corr_data.col (4).data (), *mz = corr_data.col (5).data ();
+    const float *snx = corr_data.col (6).data (), *sny = corr_data.col (7).data (), *snz = corr_data.col (8).data ();
+    const float *mnx = corr_data.col (9).data (), *mny = corr_data.col (10).data (), *mnz = corr_data.col (11).data ();
+    const int *scene_idx = &scene_indices[0], *model_idx = &model_indices[0];
 
-            Eigen::Vector3f dist_trg = model_point_k - model_point_j;
-            Eigen::Vector3f dist_ref = scene_point_k - scene_point_j;
+    //bit-packed consistency graph, each thread fills the upper triangle of its rows
+    BitsetGraph correspondence_graph (n_corrs);
 
-            //minimum distance constraint
-            if ((dist_trg.norm () < min_dist_for_cluster) || (dist_ref.norm () < min_dist_for_cluster))
-                continue;
+#pragma omp parallel
+    {
+        std::vector<unsigned char> consistent (n_corrs);
 
-            double distance = fabs (dist_trg.norm () - dist_ref.norm());
-            double dot_distance = 0;
-            if (pcl_isnan(scene_normal_k.dot (scene_normal_j)) || pcl_isnan(model_normal_k.dot (model_normal_j)))
-                dot_distance = 0.f;
-            else
+#pragma omp for schedule(dynamic, 16)
+        for (int k = 0; k < n_corrs; ++k)
+        {
+            //branch free pair tests to let the compiler vectorize the loop
+            //(a NaN normal results in a NaN dot_distance, i.e. the dot product constraint is not applied)
+            for (int j = k + 1; j < n_corrs; ++j)
             {
-                float dot_model = model_normal_k.dot (model_normal_j);
-                dot_distance = std::abs (scene_normal_k.dot (scene_normal_j) - dot_model);
+                float dtx = mx[k] - mx[j], dty = my[k] - my[j], dtz = mz[k] - mz[j];
+                float drx = sx[k] - sx[j], dry = sy[k] - sy[j], drz = sz[k] - sz[j];
+                float sqr_dist_trg = dtx * dtx + dty * dty + dtz * dtz;
+                float sqr_dist_ref = drx * drx + dry * dry + drz * drz;
+                float distance = std::abs (std::sqrt (sqr_dist_trg) - std::sqrt (sqr_dist_ref));
+                float dot_model = mnx[k] * mnx[j] + mny[k] * mny[j] + mnz[k] * mnz[j];
+                float dot_scene = snx[k] * snx[j] + sny[k] * sny[j] + snz[k] * snz[j];
+                float dot_distance = std::abs (dot_scene - dot_model);
+
+                consistent[j] = static_cast<unsigned char> (
+                            (scene_idx[j] != scene_idx[k]) & (model_idx[j] != model_idx[k]) &       //same scene or model point constraint
+                            !(sqr_dist_trg < sqr_min_dist_for_cluster) & !(sqr_dist_ref < sqr_min_dist_for_cluster) &   //minimum distance constraint
+                            !(dot_model < -0.1f) &                                                   //Model normals should be consistently oriented! otherwise reject!
+                            (distance < gc_size) & !(dot_distance > thres_dot_distance));            //gc constraint and dot_product constraint!
             }
 
-            //Model normals should be consistently oriented! otherwise reject!
-            float dot_distance_model = model_normal_k.dot (model_normal_j);
-            if(dot_distance_model < -0.1f)
-                continue;
-
-            //gc constraint and dot_product constraint!
-            if ((distance < param_.gc_size_) && (dot_distance <= param_.thres_dot_distance_))
-                boost::add_edge (k, j, correspondence_graph);
+            for (int j = k + 1; j < n_corrs; ++j)
+            {
+                if (consistent[j])
+                    correspondence_graph.setBit (k, j);
+            }
         }
     }
 
+    correspondence_graph.symmetrize ();
 
-    typename boost::property_map < GraphGGCG, edge_component_t>::type components = get(edge_component, correspondence_graph);
-    size_t n_cc = biconnected_components(correspondence_graph, components);
+    //biconnected components (the induced subgraph of the vertices of a component holds exactly its edges)
+    std::vector< std::vector<int> > cc_vertices;
+    int n_cc = correspondence_graph.biconnectedComponents (cc_vertices);
 
     if(n_cc < 1)
         return;
 
-    std::vector<size_t> model_instances_kept_indices;
-
-    std::vector< std::set<size_t> > unique_vertices_per_cc (n_cc);
-    std::vector<size_t> cc_sizes (n_cc, 0);
+    //extract the graphs of the biconnected components and search the cliques of the components concurrently
+    std::vector<BitsetGraph> cc_graphs (n_cc);
+    std::vector<size_t> cc_num_edges (n_cc, 0);
+    std::vector<float> cc_arboricity (n_cc, 0.f);
+    std::vector<unsigned char> cliques_computation_possible_ (n_cc, param_.use_graph_);
+    std::vector< std::vector< std::vector<int> > > cc_cliques (n_cc);
 
-    typename boost::graph_traits<GraphGGCG>::edge_iterator edgeIt, edgeEnd;
-    boost::tie (edgeIt, edgeEnd) = edges (correspondence_graph);
-    for (; edgeIt != edgeEnd; ++edgeIt)
+#pragma omp parallel for schedule(dynamic)
+    for (int c = 0; c < n_cc; c++)
     {
-        int c = components[*edgeIt];
-        unique_vertices_per_cc[c].insert(boost::source(*edgeIt, correspondence_graph));
-        unique_vertices_per_cc[c].insert(boost::target(*edgeIt, correspondence_graph));
+        //ignore if not enough vertices...
+        size_t num_v_in_cc = cc_vertices[c].size ();
+        if (num_v_in_cc < param_.gc_threshold_ || num_v_in_cc < 2)
+            continue;
+
+        correspondence_graph.getSubgraph (cc_vertices[c], cc_graphs[c]);
+        cc_num_edges[c] = cc_graphs[c].numEdges ();
+        cc_arboricity[c] = cc_num_edges[c] / static_cast<float>(num_v_in_cc - 1);
+
+        if (cliques_computation_possible_[c] && cc_arboricity[c] < 25)
+        {
+            BitsetMaximalCliques clique_search (param_.gc_threshold_, param_.max_time_allowed_cliques_comptutation_);
+            clique_search.find (cc_graphs[c], cc_cliques[c]);
+
+            if(clique_search.getMaxTimeReached())
+            {
+                PCL_WARN("Max time reached during clique computation %f!!\n", param_.max_time_allowed_cliques_comptutation_);
+                cliques_computation_possible_[c] = false;
+                cc_cliques[c].clear ();
+            }
+        }
     }
 
-    for(size_t i=0; i < unique_vertices_per_cc.size(); i++)
-        cc_sizes[i] = unique_vertices_per_cc[i].size();
+    std::vector<size_t> model_instances_kept_indices;
 
     pcl::registration::CorrespondenceRejectorSampleConsensus<PointModelT> corr_rejector;
     corr_rejector.setMaximumIterations (10000);
@@ -556,72 +386,42 @@ v4r::GraphGeometricConsistencyGrouping<PointModelT, PointSceneT>::clusterCorresp
 
     //Go through the connected components and decide whether to use CliqueGC or usualGC or ignore (cc_sizes[i] < gc_threshold_)
     //Decision based on the number of vertices in the connected component and graph arbocity...
-
-    //std::cout << "Number of connected components over threshold..." << over_gc << std::endl;
-    //    std::cout << "Number of connected components..." << n_cc << std::endl;
+    std::vector<int> local_index (n_corrs, -1);
     size_t analyzed_ccs = 0;
-    std::vector<bool> cliques_computation_possible_;
-    cliques_computation_possible_.resize(n_cc, param_.use_graph_);
-    for (size_t c = 0; c < n_cc; c++)
+    for (int c = 0; c < n_cc; c++)
     {
         //ignore if not enough vertices...
-        size_t num_v_in_cc = cc_sizes[c];
-        if (num_v_in_cc < param_.gc_threshold_)
+        size_t num_v_in_cc = cc_vertices[c].size ();
+        if (num_v_in_cc < param_.gc_threshold_ || num_v_in_cc < 2)
             continue;
 
         analyzed_ccs++;
 
-        GraphGGCG connected_graph(correspondence_graph);
-
-        //iterate over edges and remove those not belonging to this biconnected component
-        boost::tie (edgeIt, edgeEnd) = edges (connected_graph);
-        for (; edgeIt != edgeEnd; ++edgeIt)
-        {
-            if (components[*edgeIt] != c)
-                boost::remove_edge(*edgeIt, connected_graph);
-        }
+        const std::vector<int> &vertices = cc_vertices[c];
+        const BitsetGraph &connected_graph = cc_graphs[c];
+        float arboricity = cc_arboricity[c];
 
-        //std::cout << "Num edges connnected component:" << boost::num_edges(connected_graph) << std::endl;
-        //visualizeGraph(connected_graph, "connected component");
+        for (size_t i = 0; i < vertices.size (); i++)
+            local_index[vertices[i]] = static_cast<int> (i);
 
-        float arboricity = num_edges (connected_graph) / static_cast<float>(num_v_in_cc - 1);
-        //std::cout << "arboricity:" << arboricity << " num_v:" << num_v_in_cc << " edges:" << num_edges (connected_graph) << std::endl;
-        //std::vector<std::pair<int, int> > edges_used;
         std::set<size_t> correspondences_used;
 
         std::vector< std::vector<size_t> > correspondence_to_instance;
         if(param_.prune_by_CC_)
             correspondence_to_instance.resize(model_scene_corrs_->size());
 
-        if (cliques_computation_possible_[c] && arboricity < 25 /*&& (num_v_in_cc < 400) && (num_edges (connected_graph) < 8000) && arboricity < 10*/)
+        if (cliques_computation_possible_[c] && arboricity < 25)
         {
-            //std::cout << "Using cliques" << std::endl;
-            //std::cout << "N edges: " << num_edges (connected_graph) << " vertices:" << num_v_in_cc << " arboricity:" << arboricity <<  std::endl;
-
-            std::vector<std::vector<size_t> *> cliques;
+            //map the cliques of the component back to correspondence indices
+            std::vector<std::vector<size_t> *> cliques (cc_cliques[c].size ());
+            for (size_t k = 0; k < cliques.size (); k++)
             {
-                //pcl::ScopeTime t ("tomita cliques...");
-                Tomita<GraphGGCG> tom (param_.gc_threshold_);
-                tom.setMaxTimeAllowed(param_.max_time_allowed_cliques_comptutation_);
-                tom.find_cliques (connected_graph, model_scene_corrs_->size ());
-                if(tom.getMaxTimeReached())
-                {
-                    PCL_WARN("Max time reached during clique computation %f!!\n", param_.max_time_allowed_cliques_comptutation_);
-                    cliques_computation_possible_[c] = false;
-                    c--;
-                    analyzed_ccs--;
-
-                    //free memory for cliques
-                    tom.getCliques (cliques);
-                    for (size_t p = 0; p < cliques.size (); p++)
-                        delete cliques[p];
-
-                    continue;
-                }
-                //std::cout << "Number of cliques found by tomita..." << tom.getNumCliquesFound () << std::endl;
-                tom.getCliques (cliques);
+                const std::vector<int> &clique = cc_cliques[c][k];
+                cliques[k] = new std::vector<size_t> (clique.size ());
+                for (size_t jj = 0; jj < clique.size (); jj++)
+                    cliques[k]->at (jj) = vertices[clique[jj]];
             }
-
+            cc_cliques[c].clear ();
             std::vector< ExtendedClique > extended_cliques;
             std::vector<std::pair<float, std::vector<size_t> * > > cliques_with_average_weight;
             for(size_t k = 0; k < cliques.size(); k++)
@@ -830,41 +630,30 @@ v4r::GraphGeometricConsistencyGrouping<PointModelT, PointSceneT>::clusterCorresp
         {
             //use iterative gc for simple cases with lots of correspondences...
             PCL_WARN("Problem is too hard to solve it using cliques...\n");
-            std::cout << "N edges: " << num_edges (connected_graph) << " vertices:" << num_v_in_cc << " arboricity:" << arboricity <<  std::endl;
+            std::cout << "N edges: " << cc_num_edges[c] << " vertices:" << num_v_in_cc << " arboricity:" << arboricity <<  std::endl;
 
             std::vector<size_t> consensus_set;
             consensus_set.resize(model_scene_corrs_->size ());
             std::vector<bool> taken_corresps (model_scene_corrs_->size (), false);
 
-            GraphGGCG connected_graph(correspondence_graph);
-            //iterate over edges and remove those not belonging to this biconnected component
-            boost::tie (edgeIt, edgeEnd) = edges (connected_graph);
-            for (; edgeIt != edgeEnd; ++edgeIt)
+            for (size_t i = 0; i < vertices.size (); i++)
             {
-                if (components[*edgeIt] != c)
-                {
-                    boost::remove_edge(*edgeIt, connected_graph);
-                }
-            }
-
-            typename boost::graph_traits<GraphGGCG>::vertex_iterator vertexIt, vertexEnd;
-            boost::tie (vertexIt, vertexEnd) = vertices (connected_graph);
-            for (; vertexIt != vertexEnd; ++vertexIt)
-            {
-                if ( boost::out_degree(*vertexIt, connected_graph) < (param_.gc_threshold_ - 1))
-                    taken_corresps[*vertexIt] = true;
+                if ( static_cast<size_t> (connected_graph.degree (i)) < (param_.gc_threshold_ - 1))
+                    taken_corresps[vertices[i]] = true;
             }
 
-            for (size_t i = 0; i < model_scene_corrs_->size (); ++i)
+            for (size_t ii = 0; ii < vertices.size (); ++ii)
             {
+                size_t i = vertices[ii];
                 if (taken_corresps[i])
                     continue;
 
                 int consensus_size = 0;
                 consensus_set[consensus_size++] = i;
 
-                for (size_t j = 0; j < model_scene_corrs_->size (); ++j)
+                for (size_t jj = 0; jj < vertices.size (); ++jj)
                 {
+                    size_t j = vertices[jj];
                     if (j != i && !taken_corresps[j])
                     {
                         //Let's check if j fits into the current consensus set
@@ -873,7 +662,7 @@ v4r::GraphGeometricConsistencyGrouping<PointModelT, PointSceneT>::clusterCorresp
                         for (int k = 0; k < consensus_size; ++k)
                         {
                             //check if edge (j, consensus_set[k] exists in the graph, if it does not, is_a_good_candidate = false!...
-                            if (!(boost::edge (j, consensus_set[k], connected_graph).second))
+                            if (!connected_graph.isConnected (jj, local_index[consensus_set[k]]))
                             {
                                 is_a_good_candidate = false;
                                 break;
@@ -884,7 +673,6 @@ v4r::GraphGeometricConsistencyGrouping<PointModelT, PointSceneT>::clusterCorresp
                             consensus_set[consensus_size++] = j;
                     }
                 }
-
                 if (consensus_size >= param_.gc_threshold_)
                 {
                     pcl::Correspondences temp_corrs, filtered_corrs;
@@ -979,42 +767,26 @@ v4r::GraphGeometricConsistencyGrouping<PointModelT, PointSceneT>::clusterCorresp
         if( param_.prune_by_CC_ )
         {
             //pcl::ScopeTime t("final post-processing...");
-            GraphGGCG connected_graph_used_edges(connected_graph);
-            typename boost::graph_traits<GraphGGCG>::vertex_iterator vertexIt, vertexEnd;
-            std::vector<typename boost::graph_traits<GraphGGCG>::vertex_descriptor> to_be_removed;
-            boost::tie (vertexIt, vertexEnd) = vertices (connected_graph_used_edges);
-            for (; vertexIt != vertexEnd; ++vertexIt)
-            {
-                std::set<size_t>::const_iterator it;
-                it = correspondences_used.find(*vertexIt);
-                if (it == correspondences_used.end())
-                    to_be_removed.push_back (*vertexIt);
-            }
+            //connected components of the component graph restricted to the used correspondences
+            std::vector<bool> used (vertices.size (), false);
+            for (size_t i = 0; i < vertices.size (); i++)
+                used[i] = (correspondences_used.find (vertices[i]) != correspondences_used.end ());
 
-            for (size_t i = 0; i < to_be_removed.size (); i++)
-                clear_vertex (to_be_removed[i], connected_graph_used_edges);
+            std::vector<int> components;
+            int n_cc_used = connected_graph.connectedComponents (components, used);
 
-            boost::vector_property_map<size_t> components (boost::num_vertices (connected_graph_used_edges));
-            size_t n_cc = boost::connected_components (connected_graph_used_edges, &components[0]);
-
-            std::vector<size_t> cc_sizes  (n_cc, 0);
-            for (size_t i = 0; i < model_scene_corrs_->size (); i++)
-                cc_sizes[components[i]]++;
-
-            size_t ncc_overthres = 0;
-            for (size_t i = 0; i < n_cc; i++)
+            std::vector<size_t> cc_sizes (n_cc_used, 0);
+            for (size_t i = 0; i < vertices.size (); i++)
             {
-                if(cc_sizes[i] >= param_.gc_threshold_)
-                    ncc_overthres++;
+                if (components[i] >= 0)
+                    cc_sizes[components[i]]++;
             }
 
-            //std::cout << "Number of connected components over threshold: " << ncc_overthres << std::endl;
-
             //somehow now i need to do a Nonmax supression of the model_instances that are in the same CC
             //gather instances that were generated with correspondences found in a specific CC
             //correspondence_to_instance maps correspondences (vertices) to instance, we can use that i guess
 
-            for (size_t internal_c = 0; internal_c < n_cc; internal_c++)
+            for (int internal_c = 0; internal_c < n_cc_used; internal_c++)
             {
                 //ignore if not enough vertices...
                 size_t num_v_in_cc_tmp = cc_sizes[internal_c];
@@ -1022,18 +794,12 @@ v4r::GraphGeometricConsistencyGrouping<PointModelT, PointSceneT>::clusterCorresp
                     continue;
 
                 std::set<size_t> instances_for_this_cc;
+                for (size_t i = 0; i < vertices.size (); i++)
                 {
-                    boost::tie (vertexIt, vertexEnd) = vertices (connected_graph_used_edges);
-
-                    for (; vertexIt != vertexEnd; ++vertexIt)
+                    if (components[i] == internal_c)
                     {
-                        if (components[*vertexIt] == internal_c)
-                        {
-                            for(size_t k=0; k < correspondence_to_instance[*vertexIt].size(); k++)
-                            {
-                                instances_for_this_cc.insert(correspondence_to_instance[*vertexIt][k]);
-                            }
-                        }
+                        const std::vector<size_t> &instances = correspondence_to_instance[vertices[i]];
+                        instances_for_this_cc.insert (instances.begin (), instances.end ());
                     }
                 }
 
@@ -147,6 +147,18 @@ v4r::Hough3DGrouping<PointModelT, PointSceneT, PointModelRfT, PointSceneRfT>::tr
     model_votes_[i].z () = z_ax.dot (centroid - input_->at (i).getVector3fMap ());*/
   }
 
+  typename ModelCache::iterator it = findCachedModel (input_);
+  if (it != model_cache_.end ())
+    model_cache_.erase (it);
+
+  model_cache_.push_front (TrainedModel ());
+  model_cache_.front ().cloud = input_;
+  model_cache_.front ().rf = input_rf_;
+  model_cache_.front ().votes = model_votes_;
+
+  while (max_cached_models_ && model_cache_.size () > max_cached_models_)
+    model_cache_.pop_back ();
+
   needs_training_ = false;
   return (true);
 }
@@ -198,16 +210,15 @@ v4r::Hough3DGrouping<PointModelT, PointSceneT, PointModelRfT, PointSceneRfT>::ho
   }
 
   std::vector<Eigen::Vector3d> scene_votes (n_matches);
+  std::vector<double> weights;
   Eigen::Vector3d d_min, d_max, bin_size;
 
   d_min.setConstant (std::numeric_limits<double>::max ());
   d_max.setConstant (-std::numeric_limits<double>::max ());
   bin_size.setConstant (hough_bin_size_);
 
-  float max_distance = -std::numeric_limits<float>::max ();
-
-  // Calculating 3D Hough space dimensions and vote position for each match
-  pcl::StopWatch t;
+  // Calculating the vote position for each match
+  #pragma omp parallel for if(n_matches>256)
   for (int i=0; i< n_matches; ++i)
   {
     int scene_index = model_scene_corrs_->at (i).index_match;
@@ -220,72 +231,39 @@ v4r::Hough3DGrouping<PointModelT, PointSceneT, PointModelRfT, PointSceneRfT>::ho
     Eigen::Map<const Eigen::Vector3f> scene_point_rf_y(scene_point_rf.y_axis);
     Eigen::Map<const Eigen::Vector3f> scene_point_rf_z(scene_point_rf.z_axis);
 
-    /*Eigen::Vector3f scene_point_rf_x (scene_point_rf.x_axis[0], scene_point_rf.x_axis[1], scene_point_rf.x_axis[2]);
-    Eigen::Vector3f scene_point_rf_y (scene_point_rf.y_axis[0], scene_point_rf.y_axis[1], scene_point_rf.y_axis[2]);
-    Eigen::Vector3f scene_point_rf_z (scene_point_rf.z_axis[0], scene_point_rf.z_axis[1], scene_point_rf.z_axis[2]);*/
-
-    //const Eigen::Vector3f& model_point = input_->at (model_index).getVector3fMap ();
-
     const Eigen::Vector3f& model_point_vote = model_votes_[model_index];
 
-    //todo: maybe this can be optimized
-    scene_votes[i].x () = scene_point_rf_x[0] * model_point_vote[0] + scene_point_rf_y[0] * model_point_vote[1] + scene_point_rf_z[0] * model_point_vote[2] + scene_point.x ();
-    scene_votes[i].y () = scene_point_rf_x[1] * model_point_vote[0] + scene_point_rf_y[1] * model_point_vote[1] + scene_point_rf_z[1] * model_point_vote[2] + scene_point.y ();
-    scene_votes[i].z () = scene_point_rf_x[2] * model_point_vote[0] + scene_point_rf_y[2] * model_point_vote[1] + scene_point_rf_z[2] * model_point_vote[2] + scene_point.z ();
-
-    if (scene_votes[i].x () < d_min.x ()) 
-      d_min.x () = scene_votes[i].x (); 
-    if (scene_votes[i].x () > d_max.x ()) 
-      d_max.x () = scene_votes[i].x (); 
+    scene_votes[i] = (scene_point_rf_x * model_point_vote[0] + scene_point_rf_y * model_point_vote[1] + scene_point_rf_z * model_point_vote[2] + scene_point).cast<double> ();
+  }
 
-    if (scene_votes[i].y () < d_min.y ()) 
-      d_min.y () = scene_votes[i].y (); 
-    if (scene_votes[i].y () > d_max.y ()) 
-      d_max.y () = scene_votes[i].y (); 
+  // 3D Hough space dimensions
+  for (int i=0; i< n_matches; ++i)
+  {
+    d_min = d_min.cwiseMin (scene_votes[i]);
+    d_max = d_max.cwiseMax (scene_votes[i]);
+  }
 
-    if (scene_votes[i].z () < d_min.z ()) 
-      d_min.z () = scene_votes[i].z (); 
-    if (scene_votes[i].z () > d_max.z ()) 
-      d_max.z () = scene_votes[i].z ();
+  // Calculate max distance for weighted votes (as in the original implementation, only interpolated votes are weighted)
+  if (use_distance_weight_ && use_interpolation_)
+  {
+    float max_distance = -std::numeric_limits<float>::max ();
+    for (int i=0; i< n_matches; ++i)
+      max_distance = std::max (max_distance, model_scene_corrs_->at (i).distance);
 
-    // Calculate max distance for interpolated votes
-    if (use_interpolation_ && max_distance < model_scene_corrs_->at (i).distance)
+    if (max_distance != 0)
     {
-      max_distance = model_scene_corrs_->at (i).distance;
+      weights.resize (n_matches);
+      for (int i=0; i< n_matches; ++i)
+        weights[i] = 1.0 - (model_scene_corrs_->at (i).distance / max_distance);
     }
   }
 
-  std::cout << d_min << std::endl;
-  std::cout << d_max << std::endl;
-
-  std::cout << "vote position" << t.getTime() << std::endl;
-
+  // Hough Voting (sparse space, only bins with votes are allocated)
   hough_space_.reset (new v4r::recognition::HoughSpace3D (d_min, bin_size, d_max));
-  hough_space_->reserveVoterIdsVectorFixedSize(10);
-
-  {
-      pcl::ScopeTime t("hough voting intern");
-      // Hough Voting
+  hough_space_->reserveVoterIdsVector (n_matches, 1.f);
+  hough_space_->vote (scene_votes, weights, use_interpolation_);
 
-      for (int i = 0; i < n_matches; ++i)
-      {
-        double weight = 1.0;
-        if (use_distance_weight_ && max_distance != 0)
-        {
-          weight = 1.0 - (model_scene_corrs_->at (i).distance / max_distance);
-        }
-        if (use_interpolation_)
-        {
-          hough_space_->voteInt (scene_votes[i], weight, i);
-        }
-        else
-        {
-          hough_space_->vote (scene_votes[i], weight, i);
-        }
-      }
-
-      hough_space_initialized_ = true;
-  }
+  hough_space_initialized_ = true;
 
   return (true);
 }
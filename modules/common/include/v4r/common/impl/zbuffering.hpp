@@ -42,14 +42,14 @@ namespace v4r
 ///////////////////////////////////////////////////////////////////////////////////////////
 template<typename ModelT, typename SceneT>
 ZBuffering<ModelT, SceneT>::ZBuffering (int resx, int resy, float f) :
-  f_ (f), width_ (resx), height_ (resy), depth_ (NULL)
+  f_ (f), width_ (resx), height_ (resy)
 {
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////
 template<typename ModelT, typename SceneT>
 ZBuffering<ModelT, SceneT>::ZBuffering () :
-  f_ (), width_ (), height_ (), depth_ (NULL)
+  f_ (), width_ (), height_ ()
 {
 }
 
@@ -57,15 +57,13 @@ ZBuffering<ModelT, SceneT>::ZBuffering () :
 template<typename ModelT, typename SceneT>
 ZBuffering<ModelT, SceneT>::~ZBuffering ()
 {
-  if (depth_ != NULL)
-    delete[] depth_;
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////
 template<typename ModelT, typename SceneT>
 void
 ZBuffering<ModelT, SceneT>::filter (const typename pcl::PointCloud<ModelT> & model,
-                                                         typename pcl::PointCloud<ModelT> & filtered, float thres)
+                                                         typename pcl::PointCloud<ModelT> & filtered, float thres) const
 {
   std::vector<int> indices_to_keep;
   filter(model, indices_to_keep, thres);
@@ -77,7 +75,7 @@ template<typename ModelT, typename SceneT>
 void
 ZBuffering<ModelT, SceneT>::filter (const typename pcl::PointCloud<ModelT> & model,
                                                          std::vector<int> & indices_to_keep,
-                                                         float thres)
+                                                         float thres) const
 {
 
   float cx, cy;
@@ -145,9 +143,8 @@ ZBuffering<ModelT, SceneT>::computeDepthMap (const typename pcl::PointCloud<Scen
     f_ = (cx) / maxC;
   }
 
-  depth_ = new float[width_ * height_];
-  for (int i = 0; i < (width_ * height_); i++)
-    depth_[i] = std::numeric_limits<float>::quiet_NaN ();
+  // the buffer is only allocated on the first call (or if the resolution changes)
+  depth_.assign (width_ * height_, std::numeric_limits<float>::quiet_NaN ());
 
   for (size_t i = 0; i < scene.points.size (); i++)
   {
@@ -161,7 +158,7 @@ ZBuffering<ModelT, SceneT>::computeDepthMap (const typename pcl::PointCloud<Scen
       continue;
 
     if ((z < depth_[u * height_ + v]) || (!pcl_isfinite(depth_[u * height_ + v])))
-      depth_[u * width_ + v] = z;
+      depth_[u * height_ + v] = z;
   }
 
   if (smooth)
@@ -169,10 +166,9 @@ ZBuffering<ModelT, SceneT>::computeDepthMap (const typename pcl::PointCloud<Scen
     //Dilate and smooth the depth map
     int ws = wsize;
     int ws2 = int (std::floor (static_cast<float> (ws) / 2.f));
-    float * depth_smooth = new float[width_ * height_];
-    for (size_t i = 0; i < (width_ * height_); i++)
-        depth_smooth[i] = std::numeric_limits<float>::quiet_NaN ();
+    depth_smooth_.assign (width_ * height_, std::numeric_limits<float>::quiet_NaN ());
 
+#pragma omp parallel for
     for (int u = ws2; u < (width_ - ws2); u++)
     {
       for (int v = ws2; v < (height_ - ws2); v++)
@@ -180,20 +176,20 @@ ZBuffering<ModelT, SceneT>::computeDepthMap (const typename pcl::PointCloud<Scen
         float min = std::numeric_limits<float>::max ();
         for (int j = (u - ws2); j <= (u + ws2); j++)
         {
+          const float *col = &depth_[j * height_];
           for (int i = (v - ws2); i <= (v + ws2); i++)
           {
-            if (pcl_isfinite(depth_[j * width_ + i]) && (depth_[j * width_ + i] < min))
-                min = depth_[j * width_ + i];
+            if (pcl_isfinite(col[i]) && (col[i] < min))
+                min = col[i];
           }
         }
 
         if (min < (std::numeric_limits<float>::max () - 0.1))
-            depth_smooth[u * width_ + v] = min;
+            depth_smooth_[u * height_ + v] = min;
       }
     }
 
-    memcpy (depth_, depth_smooth, sizeof(float) * width_ * height_);
-    delete[] depth_smooth;
+    depth_.swap (depth_smooth_);
   }
 }
 
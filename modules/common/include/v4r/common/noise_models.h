@@ -48,7 +48,7 @@ public:
     public:
         bool use_depth_edges_; /// @brief if true, uses PCL's organized edge detection algorithm to compute distance of each pixel to these discontinuites.
         float focal_length_; /// @brief Focal length of the camera
-        int edge_radius_;   /// @brief radius in pixel. Only pixels within this radius with respect to an edge point will compute the distance to the edge. Remaining points will have infinite distance to edge
+        int edge_radius_;   /// @brief radius in pixel. Only pixels within this (Euclidean) radius with respect to an edge point will get the distance to the edge. Remaining points will have infinite distance to edge
         Parameter(
                 bool use_depth_edges = true,
                 float focal_length = 525.f,
@@ -65,7 +65,9 @@ private:
     typedef typename pcl::PointCloud<pcl::Normal>::Ptr PointNormalTPtr;
     PointTPtr input_; /// @brief input cloud
     PointNormalTPtr normals_; /// @brief input normal
-    std::vector<std::vector<float> > pt_properties_; /// @brief for each pixel save lateral [idx=0] and axial sigma [idx=1] as well as Euclidean distance to depth discontinuity [idx=2]
+    std::vector<float> sigma_lateral_; /// @brief lateral noise of each pixel
+    std::vector<float> sigma_axial_; /// @brief axial noise of each pixel
+    std::vector<float> dist_to_edge_px_; /// @brief Euclidean distance in pixel of each pixel to the closest depth discontinuity
     pcl::PointIndices discontinuity_edges_; /// @brief indices of the point cloud which represent edges
 
 public:
@@ -108,6 +110,36 @@ public:
     void
     compute();
 
+    /**
+     * @brief getSigmaLateral
+     * @return lateral noise of each pixel
+     */
+    const std::vector<float> &
+    getSigmaLateral() const
+    {
+        return sigma_lateral_;
+    }
+
+    /**
+     * @brief getSigmaAxial
+     * @return axial noise of each pixel
+     */
+    const std::vector<float> &
+    getSigmaAxial() const
+    {
+        return sigma_axial_;
+    }
+
+    /**
+     * @brief getDistanceToEdge
+     * @return distance in pixel of each pixel to the closest depth discontinuity
+     */
+    const std::vector<float> &
+    getDistanceToEdge() const
+    {
+        return dist_to_edge_px_;
+    }
+
     /**
      * @brief getPointProperties
      * @return returns for each pixel lateral [idx=0] and axial [idx=1] as well as distance in pixel to closest depth discontinuity [idx=2]
@@ -115,7 +147,14 @@ public:
     std::vector<std::vector<float> >
     getPointProperties() const
     {
-        return pt_properties_;
+        std::vector<std::vector<float> > pt_properties (sigma_lateral_.size(), std::vector<float>(3));
+        for (size_t i = 0; i < pt_properties.size(); i++)
+        {
+            pt_properties[i][0] = sigma_lateral_[i];
+            pt_properties[i][1] = sigma_axial_[i];
+            pt_properties[i][2] = dist_to_edge_px_[i];
+        }
+        return pt_properties;
     }
 };
 }
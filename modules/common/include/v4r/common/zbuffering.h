@@ -41,6 +41,10 @@
 #include <pcl/common/transforms.h>
 #include <pcl/common/io.h>
 
+#include <algorithm>
+#include <limits>
+#include <vector>
+
 #include <v4r/core/macros.h>
 
 
@@ -56,7 +60,8 @@ namespace v4r
       private:
         float f_;
         int width_, height_;
-        float * depth_;
+        std::vector<float> depth_;          /// @brief depth map (indexed by u * height_ + v), kept allocated between calls
+        std::vector<float> depth_smooth_;   /// @brief scratch buffer for smoothing the depth map
 
       public:
 
@@ -66,11 +71,212 @@ namespace v4r
 
         void computeDepthMap (const typename pcl::PointCloud<SceneT> & scene, bool compute_focal = false, bool smooth = false, int wsize = 3);
 
-        void filter (const typename pcl::PointCloud<ModelT> & model, typename pcl::PointCloud<ModelT> & filtered, float thres = 0.01);
+        void filter (const typename pcl::PointCloud<ModelT> & model, typename pcl::PointCloud<ModelT> & filtered, float thres = 0.01) const;
 
-        void filter (const typename pcl::PointCloud<ModelT> & model, std::vector<int> & indices, float thres = 0.01);
+        void filter (const typename pcl::PointCloud<ModelT> & model, std::vector<int> & indices, float thres = 0.01) const;
       };
 
+    /**
+     * @brief Depth buffer of an organized point cloud (one camera view) used to reason about occlusions of many point clouds,
+     * e.g. all hypotheses of a frame. The buffer is built once per view, the test methods are const and can be called
+     * in parallel for different clouds. They use the same camera model as the free functions below (principal point at the
+     * image center) and do not allocate if the output (and scratch) buffers are reused.
+     */
+    class V4R_EXPORTS DepthBuffer
+    {
+    public:
+        /**
+         * @brief per-thread scratch memory for filter()
+         */
+        class Scratch
+        {
+        public:
+            std::vector<float> depth_;
+            std::vector<int> closest_idx_;
+            std::vector<int> touched_;
+        };
+
+    private:
+        int width_, height_;
+        float f_, cx_, cy_;
+        std::vector<float> depth_; /// @brief z value of each pixel (NaN if the point is not finite)
+
+    public:
+        DepthBuffer () : width_ (0), height_ (0), f_ (525.f), cx_ (0.f), cy_ (0.f)
+        { }
+
+        /**
+         * @brief builds the depth buffer from an organized cloud
+         * @param organized_cloud organized cloud of the view
+         * @param f focal length used for back-projection of points
+         */
+        template<typename SceneT>
+        void
+        setInputCloud (const pcl::PointCloud<SceneT> & organized_cloud, float f = 525.f)
+        {
+            width_ = organized_cloud.width;
+            height_ = organized_cloud.height;
+            f_ = f;
+            cx_ = static_cast<float> (width_) / 2.f - 0.5f;
+            cy_ = static_cast<float> (height_) / 2.f - 0.5f;
+            depth_.resize (organized_cloud.points.size ());
+
+            #pragma omp parallel for
+            for (int i = 0; i < static_cast<int> (depth_.size ()); i++)
+                depth_[i] = pcl::isFinite (organized_cloud.points[i]) ? organized_cloud.points[i].z : std::numeric_limits<float>::quiet_NaN ();
+        }
+
+        /**
+         * @brief same as computeOccludedPoints(organized_cloud, to_be_filtered, ...) with the cloud of this buffer
+         * @param to_be_filtered cloud to be tested (in camera coordinates of the view)
+         * @param is_occluded occlusion mask with size equal to to_be_filtered
+         * @param threshold points further away from the reference point than this threshold are occluded
+         * @param is_occluded_out_fov flag for points projected outside the image
+         */
+        template<typename PointT>
+        void
+        computeOccludedPoints (const pcl::PointCloud<PointT> & to_be_filtered,
+                               std::vector<bool> & is_occluded,
+                               float threshold = 0.01f,
+                               bool is_occluded_out_fov = true) const
+        {
+            is_occluded.resize (to_be_filtered.points.size ());
+
+            for (size_t i = 0; i < to_be_filtered.points.size (); i++)
+            {
+                if ( !pcl::isFinite(to_be_filtered.points[i]) )
+                {
+                    is_occluded[i] = false;
+                    continue;
+                }
+
+                is_occluded[i] = isOccluded (to_be_filtered.points[i].getVector3fMap (), threshold, is_occluded_out_fov);
+            }
+        }
+
+        /**
+         * @brief same as above but transforms the points on the fly into the camera coordinates of the view
+         * @param transform transformation from the coordinate system of to_be_filtered to the view
+         */
+        template<typename PointT>
+        void
+        computeOccludedPoints (const pcl::PointCloud<PointT> & to_be_filtered,
+                               const Eigen::Matrix4f & transform,
+                               std::vector<bool> & is_occluded,
+                               float threshold = 0.01f,
+                               bool is_occluded_out_fov = true) const
+        {
+            is_occluded.resize (to_be_filtered.points.size ());
+            const Eigen::Matrix3f R = transform.block<3,3>(0,0);
+            const Eigen::Vector3f t = transform.block<3,1>(0,3);
+
+            for (size_t i = 0; i < to_be_filtered.points.size (); i++)
+            {
+                if ( !pcl::isFinite(to_be_filtered.points[i]) )
+                {
+                    is_occluded[i] = false;
+                    continue;
+                }
+
+                const Eigen::Vector3f p = R * to_be_filtered.points[i].getVector3fMap () + t;
+                is_occluded[i] = isOccluded (p, threshold, is_occluded_out_fov);
+            }
+        }
+
+        /**
+         * @brief same as filter(organized_cloud, to_be_filtered, f, threshold, indices_to_keep), i.e. only the closest
+         * visible point per pixel is kept (in pixel order)
+         * @param to_be_filtered cloud to be filtered (in camera coordinates of the view)
+         * @param threshold all points further away from the reference point than this threshold will be filtered
+         * @param indices_to_keep indices of the points which are passed
+         * @param scratch scratch memory (one per thread)
+         */
+        template<typename PointT>
+        void
+        filter (const pcl::PointCloud<PointT> & to_be_filtered,
+                float threshold,
+                std::vector<int> & indices_to_keep,
+                Scratch & scratch) const
+        {
+            if (scratch.depth_.size () != depth_.size ())
+            {
+                scratch.depth_.assign (depth_.size (), std::numeric_limits<float>::quiet_NaN ());
+                scratch.closest_idx_.assign (depth_.size (), -1);
+            }
+            scratch.touched_.clear ();
+
+            for (size_t i = 0; i < to_be_filtered.points.size (); i++)
+            {
+                const float x = to_be_filtered.points[i].x;
+                const float y = to_be_filtered.points[i].y;
+                const float z = to_be_filtered.points[i].z;
+                const int u = static_cast<int> (f_ * x / z + cx_);
+                const int v = static_cast<int> (f_ * y / z + cy_);
+
+                //Not out of bounds
+                if ( u >= width_ || v >= height_ || u < 0 || v < 0 )
+                    continue;
+
+                //Check for invalid depth
+                const int px = v * width_ + u;
+                const float z_oc = depth_[px];
+                if ( !pcl_isfinite(z_oc) )
+                    continue;
+
+                //Check if point depth (distance to camera) is greater than the (u,v)
+                if ( (z - z_oc) > threshold )
+                    continue;
+
+                if ( scratch.closest_idx_[px] == -1 )
+                {
+                    scratch.touched_.push_back (px);
+                    scratch.closest_idx_[px] = static_cast<int> (i);
+                    scratch.depth_[px] = z;
+                }
+                else if ( z < scratch.depth_[px] )
+                {
+                    scratch.closest_idx_[px] = static_cast<int> (i);
+                    scratch.depth_[px] = z;
+                }
+            }
+
+            std::sort (scratch.touched_.begin (), scratch.touched_.end ());
+            indices_to_keep.resize (scratch.touched_.size ());
+
+            // reset only the touched pixels so the scratch buffer can be reused without clearing it completely
+            for (size_t k = 0; k < scratch.touched_.size (); k++)
+            {
+                const int px = scratch.touched_[k];
+                indices_to_keep[k] = scratch.closest_idx_[px];
+                scratch.closest_idx_[px] = -1;
+                scratch.depth_[px] = std::numeric_limits<float>::quiet_NaN ();
+            }
+        }
+
+        bool empty () const { return depth_.empty (); }
+
+    private:
+        inline bool
+        isOccluded (const Eigen::Vector3f & p, float threshold, bool is_occluded_out_fov) const
+        {
+            const int u = static_cast<int> (f_ * p[0] / p[2] + cx_);
+            const int v = static_cast<int> (f_ * p[1] / p[2] + cy_);
+
+            // points out of the field of view
+            if ( u >= width_ || v >= height_ || u < 0 || v < 0 )
+                return is_occluded_out_fov;
+
+            const float z_oc = depth_[v * width_ + u];
+
+            // invalid depth
+            if ( !pcl_isfinite(z_oc) )
+                return true;
+
+            //Check if point depth (distance to camera) is greater than the (u,v)
+            return (p[2] - z_oc) > threshold;
+        }
+    };
+
       template<typename SceneT, typename ModelT>
       std::vector<bool>
       computeOccludedPoints (const pcl::PointCloud<SceneT> & organized_cloud,
@@ -0,0 +1,373 @@
+/**
+ * $Id$
+ * 
+ * Software License Agreement (GNU General Public License)
+ *
+ *  Copyright (C) 2015:
+ *
+ *    Johann Prankl, prankl@acin.tuwien.ac.at
+ *    Aitor Aldoma, aldoma@acin.tuwien.ac.at
+ *
+ *      Automation and Control Institute
+ *      Vienna University of Technology
+ *      Gusshausstraße 25-29
+ *      1170 Vienn, Austria
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author Johann Prankl, Aitor Aldoma
+ *
+ */
+
+#include <v4r/common/ClusteringRNNFast.h>
+#include <cfloat>
+#include <climits>
+#include <cstdio>
+
+namespace v4r
+{
+
+using namespace std;
+
+
+ClusteringRNNFast::ClusteringRNNFast(const Parameter &_param, bool _dbg)
+ : param(_param), dbg(_dbg)
+{
+}
+
+ClusteringRNNFast::~ClusteringRNNFast()
+{
+}
+
+
+
+
+/************************************** PRIVATE ************************************/
+
+/**
+ * initDataStructure
+ */
+void ClusteringRNNFast::initDataStructure(const DataMatrix2Df &samples)
+{
+  means = Eigen::Map<const MatrixXfRM>(&samples.data[0], samples.rows, samples.cols);
+  sqr_sigmas.assign(samples.rows, 0.);
+  sizes.assign(samples.rows, 1);
+  list_next.assign(samples.rows, -1);
+  list_first.resize(samples.rows);
+  list_last.resize(samples.rows);
+
+  for (int i=0; i<samples.rows; i++)
+  {
+    list_first[i] = i;
+    list_last[i] = i;
+  }
+}
+
+/**
+ * partition
+ * split the clusters with a binary space partitioning tree until the cells contain at most max_partition_size clusters
+ * (the cell is split at the plane between two extreme points, which approximates the principal direction)
+ */
+void ClusteringRNNFast::partition(const std::vector<int> &ids, std::vector< std::vector<int> > &parts)
+{
+  parts.clear();
+
+  if (ids.size()==0)
+    return;
+
+  std::vector< std::vector<int> > stack(1, ids);
+  std::vector<int> part0, part1;
+  Eigen::VectorXf mean;
+  float dist, max_dist;
+  int a, b;
+
+  while (stack.size()>0)
+  {
+    std::vector<int> cell;
+    cell.swap(stack.back());
+    stack.pop_back();
+
+    if (param.max_partition_size<=0 || (int)cell.size()<=param.max_partition_size)
+    {
+      parts.push_back(std::vector<int>());
+      parts.back().swap(cell);
+      continue;
+    }
+
+    // get extreme points
+    mean = Eigen::VectorXf::Zero(means.cols());
+    for (unsigned i=0; i<cell.size(); i++)
+      mean += means.row(cell[i]).transpose();
+    mean /= float(cell.size());
+
+    a = cell[0], max_dist = -1.;
+    for (unsigned i=0; i<cell.size(); i++)
+    {
+      dist = (means.row(cell[i]).transpose()-mean).squaredNorm();
+      if (dist>max_dist) { max_dist = dist; a = cell[i]; }
+    }
+
+    b = cell[0], max_dist = -1.;
+    for (unsigned i=0; i<cell.size(); i++)
+    {
+      dist = (means.row(cell[i])-means.row(a)).squaredNorm();
+      if (dist>max_dist) { max_dist = dist; b = cell[i]; }
+    }
+
+    // split
+    part0.clear();
+    part1.clear();
+
+    for (unsigned i=0; i<cell.size(); i++)
+    {
+      if ( (means.row(cell[i])-means.row(a)).squaredNorm() < (means.row(cell[i])-means.row(b)).squaredNorm() )
+        part0.push_back(cell[i]);
+      else part1.push_back(cell[i]);
+    }
+
+    // degenerated (e.g. identical samples)
+    if (part0.size()==0 || part1.size()==0)
+    {
+      part0.assign(cell.begin(), cell.begin()+cell.size()/2);
+      part1.assign(cell.begin()+cell.size()/2, cell.end());
+    }
+
+    stack.push_back(part0);
+    stack.push_back(part1);
+  }
+}
+
+/**
+ * find nearest neighbour of a cluster
+ */
+int ClusteringRNNFast::getNearestNeighbour(int idx, const std::vector<int> &remaining, float &sim)
+{
+  sim = -FLT_MAX;
+  int nn = INT_MAX;
+  float tmp;
+  const float sqr_sigma = sqr_sigmas[idx];
+
+  for (unsigned i=0; i<remaining.size(); i++)
+  {
+    const int &r = remaining[i];
+    tmp = -( sqr_sigma + sqr_sigmas[r] + (means.row(idx)-means.row(r)).squaredNorm() );
+    if (tmp > sim)
+    {
+      sim = tmp;
+      nn = i;
+    }
+  }
+
+  return nn;
+}
+
+/**
+ * Agglomerate
+ */
+void ClusteringRNNFast::agglomerate(int src, int dst)
+{
+  float sum = 1. / ( sizes[src] + sizes[dst] );
+
+  sqr_sigmas[dst] = sum * (
+              sizes[src]*sqr_sigmas[src] +
+              sizes[dst]*sqr_sigmas[dst] +
+              sum*sizes[src]*sizes[dst]*(means.row(src)-means.row(dst)).squaredNorm() );
+
+  //compute new mean model of two clusters
+  means.row(dst) = (means.row(dst)*float(sizes[dst]) + means.row(src)*float(sizes[src])) * sum;
+
+  //add occurrences from src
+  list_next[list_last[dst]] = list_first[src];
+  list_last[dst] = list_last[src];
+  sizes[dst] += sizes[src];
+}
+
+/**
+ * clusterPartition
+ * RNN clustering of the clusters in remaining (no approximation within the partition)
+ */
+void ClusteringRNNFast::clusterPartition(std::vector<int> &remaining, std::vector<int> &result)
+{
+  int nn, last;
+  float sim;
+  std::vector<float> lastsim;
+  std::vector<int> chain;
+
+  result.clear();
+
+  if (remaining.size()==0)
+    return;
+
+  last=0;
+  lastsim.push_back(-FLT_MAX);
+
+  chain.push_back(remaining.back());
+  remaining.pop_back();
+  float sqrThr = -param.dist_thr*param.dist_thr;
+
+  while (remaining.size()!=0){
+    nn = getNearestNeighbour(chain[last], remaining, sim);
+
+    if(sim > lastsim[last]){
+      //no RNN -> add to chain
+      last++;
+      chain.push_back(remaining[nn]);
+      remaining[nn] = remaining.back();
+      remaining.pop_back();
+      lastsim.push_back(sim);
+    } else {
+      //RNN found
+      if (lastsim[last] > sqrThr){
+        agglomerate(chain[last-1], chain[last]);
+        remaining.push_back(chain[last]);
+        chain.pop_back();
+        chain.pop_back();
+        lastsim.pop_back();
+        lastsim.pop_back();
+        last-=2;
+      }else{
+        //cluster found
+        result.insert(result.end(), chain.begin(), chain.end());
+        chain.clear();
+        lastsim.clear();
+        last=-1;
+      }
+    }
+
+    if (last<0){
+      //init new chain
+      last++;
+      lastsim.push_back(-FLT_MAX);
+
+      chain.push_back(remaining.back());
+      remaining.pop_back();
+    }
+  }
+
+  result.insert(result.end(), chain.begin(), chain.end());
+}
+
+/**
+ * clusterPartitions
+ * partition the clusters and agglomerate the partitions in parallel
+ */
+void ClusteringRNNFast::clusterPartitions(const std::vector<int> &ids, std::vector<int> &result)
+{
+  std::vector< std::vector<int> > parts, part_results;
+
+  partition(ids, parts);
+  part_results.resize(parts.size());
+
+  int cnt=0;
+
+  #pragma omp parallel for schedule(dynamic)
+  for (int i=0; i<(int)parts.size(); i++)
+  {
+    clusterPartition(parts[i], part_results[i]);
+
+    if (dbg)
+    {
+      #pragma omp critical
+      {
+        cnt++;
+        printf("\r[ClusteringRNNFast] partition %d/%d",cnt,(int)parts.size());
+        fflush(stdout);
+      }
+    }
+  }
+
+  result.clear();
+  for (unsigned i=0; i<part_results.size(); i++)
+    result.insert(result.end(), part_results[i].begin(), part_results[i].end());
+
+  if (dbg) printf(" -> %d/%d clusters\n",(int)result.size(),(int)ids.size());
+}
+
+
+
+
+
+/************************************** PUBLIC ************************************/
+
+
+/**
+ * create clusters
+ */
+void ClusteringRNNFast::cluster(const DataMatrix2Df &samples)
+{
+  roots.clear();
+
+  if (samples.rows==0)
+    return;
+
+  initDataStructure(samples);
+
+  std::vector<int> ids(samples.rows), tmp;
+  for (int i=0; i<samples.rows; i++)
+    ids[i] = i;
+
+  clusterPartitions(ids, roots);
+
+  if (param.max_partition_size<=0 || samples.rows<=param.max_partition_size)
+    return;
+
+  // merge clusters separated by cell borders
+  for (int i=0; i<param.refine_iterations; i++)
+  {
+    tmp.swap(roots);
+    clusterPartitions(tmp, roots);
+
+    if (roots.size()==tmp.size())
+      break;
+  }
+}
+
+/**
+ * getClusters
+ */
+void ClusteringRNNFast::getClusters(std::vector<std::vector<int> > &_clusters)
+{
+  _clusters.resize(roots.size());
+
+  for (unsigned i=0; i<roots.size(); i++)
+  {
+    std::vector<int> &cl = _clusters[i];
+    cl.clear();
+    cl.reserve(sizes[roots[i]]);
+
+    for (int idx=list_first[roots[i]]; idx!=-1; idx=list_next[idx])
+      cl.push_back(idx);
+  }
+}
+
+/**
+ * getCenters
+ */
+void ClusteringRNNFast::getCenters(DataMatrix2Df &_centers)
+{
+  _centers.clear();
+
+  if (roots.size()==0)
+    return;
+
+  int cols = means.cols();
+  _centers.reserve(roots.size(), cols);
+
+  for (unsigned i=0; i<roots.size(); i++)
+    _centers.push_back(&means(roots[i],0), cols);
+}
+
+
+}
+
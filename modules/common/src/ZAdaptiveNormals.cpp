@@ -236,6 +236,140 @@ void ZAdaptiveNormals::estimateNormals(const v4r::DataMatrix2D<Eigen::Vector3f>
 }
 
 
+/**
+ * computeIntegralImages
+ * summed area tables of the valid points (row prefix sums followed by column accumulation,
+ * both passes run over contiguous rows)
+ */
+void ZAdaptiveNormals::computeIntegralImages(const v4r::DataMatrix2D<Eigen::Vector3f> &cloud)
+{
+  const int w1 = width+1;
+
+  #pragma omp parallel for
+  for (int t=0; t<SAT_SIZE; t++)
+  {
+    std::vector<double> &table = sat[t];
+    table.assign(w1*(height+1), 0.);
+
+    for (int v=0; v<height; v++)
+    {
+      const Eigen::Vector3f *pts = &cloud.data[v*width];
+      double *row = &table[(v+1)*w1+1];
+      const double *prev = &table[v*w1+1];
+      double sum = 0.;
+
+      for (int u=0; u<width; u++)
+      {
+        const Eigen::Vector3f &pt = pts[u];
+        if (!isnan(pt[0]) && !isnan(pt[1]) && !isnan(pt[2]))
+        {
+          switch (t)
+          {
+          case SAT_N:  sum += 1.; break;
+          case SAT_X:  sum += pt[0]; break;
+          case SAT_Y:  sum += pt[1]; break;
+          case SAT_Z:  sum += pt[2]; break;
+          case SAT_XX: sum += pt[0]*pt[0]; break;
+          case SAT_XY: sum += pt[0]*pt[1]; break;
+          case SAT_XZ: sum += pt[0]*pt[2]; break;
+          case SAT_YY: sum += pt[1]*pt[1]; break;
+          case SAT_YZ: sum += pt[1]*pt[2]; break;
+          case SAT_ZZ: sum += pt[2]*pt[2]; break;
+          }
+        }
+        row[u] = prev[u] + sum;
+      }
+    }
+  }
+}
+
+/**
+ * computeNormalIntegral
+ * covariance of the (depth dependent) kernel window from the summed area tables
+ */
+void ZAdaptiveNormals::computeNormalIntegral(const Eigen::Vector3f &pt, int u, int v, Eigen::Vector3f &n)
+{
+  int kernel = param.kernel;
+  if (param.adaptive)
+  {
+    int dist = (int) (pt[2]*2); // *2 => every 0.5 meter another kernel radius
+    kernel = (int)param.kernel_radius[ std::max(0, std::min(dist,7)) ];
+  }
+
+  const int x0 = std::max(u-kernel, 0), x1 = std::min(u+kernel, width-1);
+  const int y0 = std::max(v-kernel, 0), y1 = std::min(v+kernel, height-1);
+
+  const double cnt = sumWindow(sat[SAT_N], x0, y0, x1, y1);
+  if (cnt < 4)
+  {
+    n[0] = NaN;
+    return;
+  }
+
+  const double inv = 1./cnt;
+  const Eigen::Vector3d mean(sumWindow(sat[SAT_X], x0, y0, x1, y1)*inv,
+                             sumWindow(sat[SAT_Y], x0, y0, x1, y1)*inv,
+                             sumWindow(sat[SAT_Z], x0, y0, x1, y1)*inv);
+
+  Eigen::Matrix3d cov;
+  cov(0,0) = sumWindow(sat[SAT_XX], x0, y0, x1, y1)*inv - mean[0]*mean[0];
+  cov(0,1) = sumWindow(sat[SAT_XY], x0, y0, x1, y1)*inv - mean[0]*mean[1];
+  cov(0,2) = sumWindow(sat[SAT_XZ], x0, y0, x1, y1)*inv - mean[0]*mean[2];
+  cov(1,1) = sumWindow(sat[SAT_YY], x0, y0, x1, y1)*inv - mean[1]*mean[1];
+  cov(1,2) = sumWindow(sat[SAT_YZ], x0, y0, x1, y1)*inv - mean[1]*mean[2];
+  cov(2,2) = sumWindow(sat[SAT_ZZ], x0, y0, x1, y1)*inv - mean[2]*mean[2];
+  cov(1,0) = cov(0,1);
+  cov(2,0) = cov(0,2);
+  cov(2,1) = cov(1,2);
+
+  // closed form eigenvector of the smallest eigenvalue
+  double eigen_value;
+  Eigen::Vector3d eigen_vector;
+  v4r::eigen33 (cov, eigen_value, eigen_vector);
+
+  n = eigen_vector.cast<float>();
+
+  if (n.dot(pt) > 0)
+    n *= -1;
+}
+
+/**
+ * estimateNormalsIntegral
+ */
+void ZAdaptiveNormals::estimateNormalsIntegral(const v4r::DataMatrix2D<Eigen::Vector3f> &cloud, v4r::DataMatrix2D<Eigen::Vector3f> &normals)
+{
+  computeIntegralImages(cloud);
+
+  #pragma omp parallel for
+  for (int v=0; v<height; v++) {
+    const Eigen::Vector3f *pts = &cloud.data[v*width];
+    Eigen::Vector3f *ns = &normals.data[v*width];
+    for (int u=0; u<width; u++) {
+      const Eigen::Vector3f &pt = pts[u];
+      if(!isnan(pt[0]) && !isnan(pt[1]) && !isnan(pt[2]))
+        computeNormalIntegral(pt, u, v, ns[u]);
+      else ns[u][0] = NaN;
+    }
+  }
+}
+
+/**
+ * estimateNormalsIntegral
+ */
+void ZAdaptiveNormals::estimateNormalsIntegral(const v4r::DataMatrix2D<Eigen::Vector3f> &cloud, const std::vector<int> &normals_indices, std::vector<Eigen::Vector3f> &normals)
+{
+  computeIntegralImages(cloud);
+
+  #pragma omp parallel for
+  for (int i=0; i<(int)normals_indices.size(); i++) {
+    int idx = normals_indices[i];
+    const Eigen::Vector3f &pt = cloud.data[idx];
+    if(!isnan(pt[0]) && !isnan(pt[1]) && !isnan(pt[2]))
+      computeNormalIntegral(pt, idx%width, idx/width, normals[i]);
+    else normals[i][0] = NaN;
+  }
+}
+
 
 /************************** PUBLIC *************************/
 
@@ -249,7 +383,9 @@ void ZAdaptiveNormals::compute(const v4r::DataMatrix2D<Eigen::Vector3f> &cloud,
 
   normals.resize(height, width);
 
-  estimateNormals(cloud, normals);
+  if (param.integral_image)
+    estimateNormalsIntegral(cloud, normals);
+  else estimateNormals(cloud, normals);
 }
 
 /**
@@ -262,7 +398,9 @@ void ZAdaptiveNormals::compute(const v4r::DataMatrix2D<Eigen::Vector3f> &cloud,
 
   normals.resize(indices.size());
 
-  estimateNormals(cloud, indices, normals);
+  if (param.integral_image)
+    estimateNormalsIntegral(cloud, indices, normals);
+  else estimateNormals(cloud, indices, normals);
 }
 
 
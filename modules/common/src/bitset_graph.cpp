@@ -0,0 +1,408 @@
+/**
+ * $Id$
+ *
+ * Copyright (c) 2015, Johann Prankl
+ * @author Johann Prankl (prankl@acin.tuwien.ac.at)
+ */
+
+#include <v4r/common/bitset_graph.h>
+#include <algorithm>
+
+namespace v4r
+{
+
+using namespace std;
+
+
+/************************** BitsetGraph *************************/
+
+/**
+ * @brief BitsetGraph::resize
+ * @param num_vertices
+ */
+void BitsetGraph::resize(int num_vertices)
+{
+  num_vertices_ = num_vertices;
+  num_words_ = (num_vertices+63)>>6;
+  adjacency_.assign((size_t)num_vertices_*num_words_, Word(0));
+}
+
+/**
+ * @brief BitsetGraph::degree
+ * @param i vertex
+ * @return number of neighbours
+ */
+int BitsetGraph::degree(int i) const
+{
+  const Word *r = row(i);
+  int deg = 0;
+  for (int w=0; w<num_words_; w++)
+    deg += popcount(r[w]);
+  return deg;
+}
+
+/**
+ * @brief BitsetGraph::numEdges
+ * @return number of undirected edges (the graph needs to be symmetric)
+ */
+size_t BitsetGraph::numEdges() const
+{
+  size_t cnt = 0;
+  for (int i=0; i<num_vertices_; i++)
+    cnt += degree(i);
+  return cnt/2;
+}
+
+/**
+ * @brief BitsetGraph::symmetrize
+ * Mirrors the edges (i,j) with j>i, i.e. rows which have been filled with the upper triangle
+ * only result in an undirected graph.
+ */
+void BitsetGraph::symmetrize()
+{
+  for (int i=0; i<num_vertices_; i++)
+  {
+    const Word *r = row(i);
+
+    for (int w=(i>>6); w<num_words_; w++)
+    {
+      Word bits = r[w];
+      if (w==(i>>6))
+        bits &= ~((Word(2)<<(i&63))-1);
+
+      while (bits)
+      {
+        setBit((w<<6)+lowestBit(bits), i);
+        bits &= bits-1;
+      }
+    }
+  }
+}
+
+/**
+ * @brief BitsetGraph::connectedComponents
+ * Breadth first search, the neighbours of a vertex are expanded word by word
+ * @param labels component index of each vertex (-1 if masked out)
+ * @param mask vertices to consider (empty: all)
+ * @return number of components
+ */
+int BitsetGraph::connectedComponents(std::vector<int> &labels, const std::vector<bool> &mask) const
+{
+  labels.assign(num_vertices_, -1);
+
+  std::vector<Word> unvisited(num_words_, Word(0));
+  for (int i=0; i<num_vertices_; i++)
+    if (mask.empty() || mask[i])
+      unvisited[i>>6] |= (Word(1)<<(i&63));
+
+  std::vector<int> queue;
+  queue.reserve(num_vertices_);
+  int n_cc = 0;
+
+  for (int i=0; i<num_vertices_; i++)
+  {
+    if (!((unvisited[i>>6]>>(i&63)) & Word(1)))
+      continue;
+
+    unvisited[i>>6] &= ~(Word(1)<<(i&63));
+    labels[i] = n_cc;
+    queue.clear();
+    queue.push_back(i);
+
+    for (unsigned q=0; q<queue.size(); q++)
+    {
+      const Word *r = row(queue[q]);
+
+      for (int w=0; w<num_words_; w++)
+      {
+        Word bits = r[w] & unvisited[w];
+        if (!bits)
+          continue;
+
+        unvisited[w] &= ~bits;
+
+        while (bits)
+        {
+          int j = (w<<6) + lowestBit(bits);
+          labels[j] = n_cc;
+          queue.push_back(j);
+          bits &= bits-1;
+        }
+      }
+    }
+
+    n_cc++;
+  }
+
+  return n_cc;
+}
+
+/**
+ * @brief BitsetGraph::biconnectedComponents
+ * Iterative Hopcroft-Tarjan depth first search (neighbours in increasing order) with an edge stack.
+ * An edge between two vertices of a component belongs to that component, i.e. the induced subgraph
+ * of the vertices of a component (getSubgraph) contains exactly the edges of the component.
+ * @param components vertices of each component
+ * @return number of components
+ */
+int BitsetGraph::biconnectedComponents(std::vector< std::vector<int> > &components) const
+{
+  components.clear();
+
+  std::vector<int> disc(num_vertices_, -1), low(num_vertices_, 0), parent(num_vertices_, -1), next(num_vertices_, 0);
+  std::vector<int> mark(num_vertices_, -1);
+  std::vector< std::pair<int,int> > edge_stack;
+  std::vector<int> dfs_stack;
+  int time = 0;
+
+  for (int r=0; r<num_vertices_; r++)
+  {
+    if (disc[r]!=-1)
+      continue;
+
+    disc[r] = low[r] = time++;
+    dfs_stack.push_back(r);
+
+    while (!dfs_stack.empty())
+    {
+      const int v = dfs_stack.back();
+      const Word *rv = row(v);
+      int w = -1;
+
+      // next unexplored neighbour of v
+      while (next[v]<num_vertices_)
+      {
+        const int wi = next[v]>>6;
+        Word bits = rv[wi] & ~((Word(1)<<(next[v]&63))-1);
+
+        if (bits)
+        {
+          w = (wi<<6) + lowestBit(bits);
+          next[v] = w+1;
+          break;
+        }
+
+        next[v] = (wi+1)<<6;
+      }
+
+      if (w!=-1)
+      {
+        if (disc[w]==-1)
+        {
+          edge_stack.push_back(std::make_pair(v,w));
+          parent[w] = v;
+          disc[w] = low[w] = time++;
+          dfs_stack.push_back(w);
+        }
+        else if (w!=parent[v] && disc[w]<disc[v])
+        {
+          edge_stack.push_back(std::make_pair(v,w));
+          low[v] = std::min(low[v], disc[w]);
+        }
+        continue;
+      }
+
+      // v is finished
+      dfs_stack.pop_back();
+      const int p = parent[v];
+      if (p==-1)
+        continue;
+
+      low[p] = std::min(low[p], low[v]);
+
+      if (low[v]>=disc[p])
+      {
+        const int c = components.size();
+        components.push_back(std::vector<int>());
+        std::vector<int> &comp = components.back();
+
+        std::pair<int,int> e;
+        do
+        {
+          e = edge_stack.back();
+          edge_stack.pop_back();
+
+          if (mark[e.first]!=c) { mark[e.first] = c; comp.push_back(e.first); }
+          if (mark[e.second]!=c) { mark[e.second] = c; comp.push_back(e.second); }
+        }
+        while (e.first!=p || e.second!=v);
+
+        std::sort(comp.begin(), comp.end());
+      }
+    }
+  }
+
+  return components.size();
+}
+
+/**
+ * @brief BitsetGraph::getSubgraph
+ * @param vertices vertices of the subgraph (vertex i of sub is vertices[i])
+ * @param sub induced subgraph
+ */
+void BitsetGraph::getSubgraph(const std::vector<int> &vertices, BitsetGraph &sub) const
+{
+  const int size = vertices.size();
+  sub.resize(size);
+
+  #pragma omp parallel for if(size>256)
+  for (int i=0; i<size; i++)
+  {
+    const Word *r = row(vertices[i]);
+
+    for (int j=0; j<size; j++)
+      if ((r[vertices[j]>>6]>>(vertices[j]&63)) & Word(1))
+        sub.setBit(i,j);
+  }
+}
+
+
+/************************** BitsetMaximalCliques *************************/
+
+/**
+ * @brief BitsetMaximalCliques::extend
+ * One recursion level of Bron-Kerbosch with pivoting. The candidate/done sets of a level are
+ * stored at cand_stack_/done_stack_[depth*num_words], the next level is written behind them.
+ * @param depth size of clique_so_far_
+ */
+void BitsetMaximalCliques::extend(int depth)
+{
+  const int nw = num_words_;
+  Word *cand = &cand_stack_[(size_t)depth*nw];
+  Word *done = &done_stack_[(size_t)depth*nw];
+  Word *branch = &branch_stack_[(size_t)depth*nw];
+
+  int num_cand = 0;
+  for (int w=0; w<nw; w++)
+    num_cand += BitsetGraph::popcount(cand[w]);
+
+  if (num_cand==0)
+  {
+    for (int w=0; w<nw; w++)
+      if (done[w]) return;
+
+    if (clique_so_far_.size() >= min_clique_size_)
+      cliques_->push_back(clique_so_far_);
+    return;
+  }
+
+  if (clique_so_far_.size()+num_cand < min_clique_size_)
+    return;
+
+  if (time_elapsed_.getTime() > max_time_allowed_)
+  {
+    max_time_reached_ = true;
+    return;
+  }
+
+  // pivot: vertex of done or cand with the most neighbours in cand
+  int pivot = -1, max_conn = -1;
+
+  for (int pass=0; pass<2 && max_conn<num_cand; pass++)
+  {
+    const Word *set = (pass==0 ? done : cand);
+
+    for (int w=0; w<nw && max_conn<num_cand; w++)
+    {
+      Word bits = set[w];
+
+      while (bits)
+      {
+        int u = (w<<6) + BitsetGraph::lowestBit(bits);
+        bits &= bits-1;
+
+        const Word *nbrs = graph_->row(u);
+        int conn = 0;
+        for (int k=0; k<nw; k++)
+          conn += BitsetGraph::popcount(cand[k] & nbrs[k]);
+
+        if (conn > max_conn)
+        {
+          max_conn = conn;
+          pivot = u;
+          if (max_conn==num_cand) break;
+        }
+      }
+    }
+  }
+
+  // all cliques already found from a done vertex
+  if (max_conn==num_cand && !((cand[pivot>>6]>>(pivot&63)) & Word(1)))
+    return;
+
+  const Word *pivot_nbrs = graph_->row(pivot);
+  for (int w=0; w<nw; w++)
+    branch[w] = cand[w] & ~pivot_nbrs[w];
+
+  Word *next_cand = cand + nw;
+  Word *next_done = done + nw;
+
+  for (int w=0; w<nw; w++)
+  {
+    Word bits = branch[w];
+
+    while (bits)
+    {
+      const Word bit = bits & (~bits+1);
+      const int v = (w<<6) + BitsetGraph::lowestBit(bits);
+      bits &= bits-1;
+
+      const Word *nbrs = graph_->row(v);
+      for (int k=0; k<nw; k++)
+      {
+        next_cand[k] = cand[k] & nbrs[k];
+        next_done[k] = done[k] & nbrs[k];
+      }
+
+      clique_so_far_.push_back(v);
+      extend(depth+1);
+      clique_so_far_.pop_back();
+
+      if (max_time_reached_)
+        return;
+
+      cand[w] &= ~bit;
+      done[w] |= bit;
+      num_cand--;
+
+      if (clique_so_far_.size()+num_cand < min_clique_size_)
+        return;
+    }
+  }
+}
+
+/**
+ * @brief BitsetMaximalCliques::find
+ * @param graph undirected graph
+ * @param cliques maximal cliques (vertex indices in increasing order of insertion)
+ */
+void BitsetMaximalCliques::find(const BitsetGraph &graph, std::vector< std::vector<int> > &cliques)
+{
+  cliques.clear();
+  clique_so_far_.clear();
+  max_time_reached_ = false;
+  time_elapsed_.reset();
+
+  graph_ = &graph;
+  cliques_ = &cliques;
+  num_words_ = graph.numWords();
+
+  const int size = graph.size();
+  if (size==0)
+    return;
+
+  // a clique has at most size vertices -> size+1 recursion levels
+  cand_stack_.assign((size_t)(size+1)*num_words_, Word(0));
+  done_stack_.assign((size_t)(size+1)*num_words_, Word(0));
+  branch_stack_.resize((size_t)(size+1)*num_words_);
+
+  for (int i=0; i<size; i++)
+    if (graph.degree(i) > 0)
+      cand_stack_[i>>6] |= (Word(1)<<(i&63));
+
+  extend(0);
+}
+
+
+} //-- THE END --
+
@@ -41,6 +41,13 @@
 #include "pcl/impl/instantiate.hpp"
 #include <v4r/common/hough_3d.h>
 #include <v4r/common/impl/hough_3d.hpp>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 PCL_INSTANTIATE_PRODUCT(Hough3DGrouping, ((pcl::PointXYZ)(pcl::PointXYZI)(pcl::PointXYZRGB)(pcl::PointXYZRGBA))
                                          ((pcl::PointXYZ)(pcl::PointXYZI)(pcl::PointXYZRGB)(pcl::PointXYZRGBA))
@@ -49,57 +56,34 @@ PCL_INSTANTIATE_PRODUCT(Hough3DGrouping, ((pcl::PointXYZ)(pcl::PointXYZI)(pcl::P
 /////////////////////////////////////////////////////////////////////////////
 
 v4r::recognition::HoughSpace3D::HoughSpace3D (const Eigen::Vector3d &min_coord, const Eigen::Vector3d &bin_size, const Eigen::Vector3d &max_coord)
+  : voter_ids_per_bin_ (0)
 {
   min_coord_ = min_coord;
   bin_size_ = bin_size;
 
+  // +1: a vote at max_coord falls into the last bin
   for (int i = 0; i < 3; ++i)
   {
-    bin_count_[i] = static_cast<int> (ceil ((max_coord[i] - min_coord_[i]) / bin_size_[i]));
-  }
-
-  for (int i = 0; i < 3; ++i)
-  {
-    std::cout << bin_count_[i] << " ";
+    bin_count_[i] = static_cast<int> (floor ((max_coord[i] - min_coord_[i]) / bin_size_[i])) + 1;
   }
-  std::cout << std::endl;
 
   partial_bin_products_[0] = 1;
   for (int i=1; i<=3; ++i)
     partial_bin_products_[i] = bin_count_[i-1]*partial_bin_products_[i-1];
-
-  total_bins_count_ = partial_bin_products_[3];
-
-  hough_space_.clear ();
-  hough_space_.resize (total_bins_count_, 0.0);
-
-  voter_ids_vector_.clear();
-  voter_ids_vector_.resize(total_bins_count_);
-
-  voter_ids_vector_size_.clear();
-  voter_ids_vector_size_.resize(total_bins_count_, 0);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 void
 v4r::recognition::HoughSpace3D::reset ()
 {
-  hough_space_.clear ();
-  hough_space_.resize (total_bins_count_, 0.0);
-
-  voter_ids_.clear ();
-  voter_ids_vector_.clear();
-  voter_ids_vector_.resize(total_bins_count_);
-
-  voter_ids_vector_size_.clear();
-  voter_ids_vector_size_.resize(total_bins_count_, 0);
+  bins_.clear ();
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 void
 v4r::recognition::HoughSpace3D::reserveVoterIdsVector(int n_matches, float percentage)
 {
-
+  bins_.reserve (static_cast<size_t> (n_matches * percentage));
 }
 
 
@@ -107,44 +91,94 @@ v4r::recognition::HoughSpace3D::reserveVoterIdsVector(int n_matches, float perce
 void
 v4r::recognition::HoughSpace3D::reserveVoterIdsVectorFixedSize(int size_per_bin)
 {
-    for(size_t i=0; i < voter_ids_vector_.size(); i++)
-    {
-        voter_ids_vector_[i].resize(size_per_bin);
-        //voter_ids_vector_[i].reserve(size_per_bin);
-    }
+  voter_ids_per_bin_ = size_per_bin;
 }
 
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-int
+int64_t
 v4r::recognition::HoughSpace3D::vote (const Eigen::Vector3d &single_vote_coord, double weight, int voter_id)
 {
-  int index = 0;
+  return (castVote (bins_, single_vote_coord, weight, voter_id, false));
+}
 
-  for (int i=0; i<3; ++i)
-  {
-    int currentBin = static_cast<int> (floor ((single_vote_coord[i] - min_coord_[i])/bin_size_[i]));
-    if (currentBin < 0 || currentBin >= bin_count_[i])
-    {
-      //PCL_ERROR("Current Vote goes out of bounds in the Hough Table!\nDimension: %d, Value inserted: %f, Min value: %f, Max value: %f\n", i, 
-      //  single_vote_coord[i], min_coord_[i], min_coord_[i] + bin_size_[i]*bin_count_[i]);
-      return -1;
-    }
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+int64_t
+v4r::recognition::HoughSpace3D::voteInt (const Eigen::Vector3d &single_vote_coord, double weight, int voter_id)
+{
+  return (castVote (bins_, single_vote_coord, weight, voter_id, true));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+v4r::recognition::HoughSpace3D::vote (const std::vector<Eigen::Vector3d> &vote_coords, const std::vector<double> &weights, bool interpolate)
+{
+  if (!weights.empty () && weights.size () != vote_coords.size ())
+    throw std::runtime_error("[HoughSpace3D::vote] Number of weights does not match the number of votes!");
+
+  const int n_votes = static_cast<int> (vote_coords.size ());
+
+  int num_threads = 1;
+#ifdef _OPENMP
+  num_threads = omp_get_max_threads ();
+#endif
+  num_threads = std::max (1, std::min (num_threads, n_votes / 256));
 
-    index += partial_bin_products_[i] * currentBin;
+  if (num_threads == 1)
+  {
+    for (int i = 0; i < n_votes; ++i)
+      castVote (bins_, vote_coords[i], weights.empty () ? 1.0 : weights[i], i, interpolate);
+    return;
   }
 
-  hough_space_[index] += weight;
-  voter_ids_[index].push_back (voter_id);
+  // each thread votes for a contiguous range into its own buffer
+  std::vector<BinMap> thread_bins (num_threads);
+
+  #pragma omp parallel for num_threads(num_threads)
+  for (int t = 0; t < num_threads; ++t)
+  {
+    const int start = static_cast<int> (static_cast<int64_t> (t) * n_votes / num_threads);
+    const int end = static_cast<int> (static_cast<int64_t> (t+1) * n_votes / num_threads);
+
+    for (int i = start; i < end; ++i)
+      castVote (thread_bins[t], vote_coords[i], weights.empty () ? 1.0 : weights[i], i, interpolate);
+  }
 
-  return (index);
+  // merge in thread order, i.e. the voter ids of each bin stay sorted
+  for (int t = 0; t < num_threads; ++t)
+  {
+    for (BinMap::const_iterator it = thread_bins[t].begin (); it != thread_bins[t].end (); ++it)
+    {
+      Bin &bin = bins_[it->first];
+      bin.value += it->second.value;
+      bin.voter_ids.insert (bin.voter_ids.end (), it->second.voter_ids.begin (), it->second.voter_ids.end ());
+    }
+    BinMap ().swap (thread_bins[t]);
+  }
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-int
-v4r::recognition::HoughSpace3D::voteInt (const Eigen::Vector3d &single_vote_coord, double weight, int voter_id)
+int64_t
+v4r::recognition::HoughSpace3D::castVote (BinMap &bins, const Eigen::Vector3d &single_vote_coord, double weight, int voter_id, bool interpolate) const
 {
-  int central_bin_index = 0;
+  if (!interpolate)
+  {
+    int64_t index = 0;
+
+    for (int i=0; i<3; ++i)
+    {
+      int currentBin = static_cast<int> (floor ((single_vote_coord[i] - min_coord_[i])/bin_size_[i]));
+      if (currentBin < 0 || currentBin >= bin_count_[i])
+        return -1;
+
+      index += partial_bin_products_[i] * currentBin;
+    }
+
+    addToBin (bins, index, weight, voter_id);
+    return (index);
+  }
+
+  int64_t central_bin_index = 0;
 
   const int n_neigh = 27; // total number of neighbours = 3^nDim = 27
 
@@ -152,21 +186,13 @@ v4r::recognition::HoughSpace3D::voteInt (const Eigen::Vector3d &single_vote_coor
   Eigen::Vector3f bin_centroid;
   Eigen::Vector3f central_bin_weight;
   Eigen::Vector3i interp_bin;
-  std::vector<float> interp_weight (n_neigh);
-
-  for (int n = 0; n < n_neigh; ++n)
-    interp_weight[n] = 1.0;
 
   for (int d = 0; d < 3; ++d)
   {
     // Compute coordinates of central bin
     central_bin_coord[d] = static_cast<int> (floor ((single_vote_coord[d] - min_coord_[d]) / bin_size_[d]));
     if (central_bin_coord[d] < 0 || central_bin_coord[d] >= bin_count_[d])
-    {
-      //PCL_ERROR("Current Vote goes out of bounds in the Hough Table!\nDimension: %d, Value inserted: %f, Min value: %f, Max value: %f\n", d,
-      //  single_vote_coord[d], min_coord_[d], min_coord_[d] + bin_size_[d]*bin_count_[d]);
       return -1;
-    }
 
     central_bin_index += partial_bin_products_[d] * central_bin_coord[d];
 
@@ -192,10 +218,10 @@ v4r::recognition::HoughSpace3D::voteInt (const Eigen::Vector3d &single_vote_coor
   }
 
   // For each neighbor of the central point
-  //int counterRealVotes = 0;
   for (int n = 0; n < n_neigh; ++n)
   {
-    int final_bin_index = 0;
+    int64_t final_bin_index = 0;
+    float interp_weight = 1.f;
     int exp = 1;
     int curr_neigh_index = 0;
     bool invalid = false;
@@ -208,11 +234,11 @@ v4r::recognition::HoughSpace3D::voteInt (const Eigen::Vector3d &single_vote_coor
         // Each coordinate of the neighbor has to be equal either to one of the central bin or to one of the interpolated bins
         if(curr_neigh_index == interp_bin[d])
         {
-          interp_weight[n] *= 1-central_bin_weight[d];
+          interp_weight *= 1-central_bin_weight[d];
         }
         else if(curr_neigh_index == central_bin_coord[d])
         {
-          interp_weight[n] *= central_bin_weight[d];
+          interp_weight *= central_bin_weight[d];
         }
         else
         {
@@ -231,22 +257,7 @@ v4r::recognition::HoughSpace3D::voteInt (const Eigen::Vector3d &single_vote_coor
     }
 
     if (!invalid)
-    {
-      hough_space_[final_bin_index] += weight * interp_weight[n];
-
-      //voter_ids_[final_bin_index].push_back (voter_id);
-
-      //voter_ids_vector_[final_bin_index].push_back (voter_id);
-      voter_ids_vector_[final_bin_index][voter_ids_vector_size_[final_bin_index]++] = voter_id;
-
-      //lazy allocation
-      int size_vec = static_cast<int>(voter_ids_vector_[final_bin_index].size());
-      if(voter_ids_vector_size_[final_bin_index] >= size_vec)
-      {
-        voter_ids_vector_[final_bin_index].resize(size_vec + 50);
-      }
-
-    }
+      addToBin (bins, final_bin_index, weight * interp_weight, voter_id);
   }
 
   return (central_bin_index);
@@ -256,68 +267,65 @@ v4r::recognition::HoughSpace3D::voteInt (const Eigen::Vector3d &single_vote_coor
 double
 v4r::recognition::HoughSpace3D::findMaxima (double min_threshold, std::vector<double> &maxima_values, std::vector<std::vector<int> > &maxima_voter_ids)
 {
+  maxima_voter_ids.clear ();
+  maxima_values.clear ();
 
   // If min_threshold between -1 and 0 use it as a percentage of maximum vote
   if (min_threshold < 0)
   {
     double hough_maximum = std::numeric_limits<double>::min ();
-    for (int i = 0; i < total_bins_count_; ++i)
+    for (BinMap::const_iterator it = bins_.begin (); it != bins_.end (); ++it)
     {
-      if (hough_space_[i] > hough_maximum)
+      if (it->second.value > hough_maximum)
       {
-        hough_maximum = hough_space_[i];
+        hough_maximum = it->second.value;
       }
     }
 
     min_threshold = min_threshold >= -1 ? -min_threshold * hough_maximum : hough_maximum;
   }
 
-  maxima_voter_ids.clear ();
-  maxima_values.clear ();
-
-  double indexes[3];
-
-  //int zeros = 0;
-
-  for (int i=0; i < total_bins_count_; ++i)
+  // candidates above the threshold, sorted by bin index to get a deterministic order
+  std::vector<std::pair<int64_t, const Bin*> > candidates;
+  candidates.reserve (bins_.size ());
+  for (BinMap::const_iterator it = bins_.begin (); it != bins_.end (); ++it)
   {
-    //if (hough_space_[i] == 0)
-    //{
-    //  ++zeros;
-    //}
-    if (hough_space_[i] < min_threshold)
-      continue;
+    if (it->second.value >= min_threshold)
+      candidates.push_back (std::make_pair (it->first, &it->second));
+  }
+  std::sort (candidates.begin (), candidates.end ());
 
-    // Check with neighbors
-    bool is_maximum = true;
-    int moduled_index = i;
+  // check the candidates against their neighbors in parallel (read only access to bins_)
+  const int n_candidates = static_cast<int> (candidates.size ());
+  std::vector<unsigned char> is_maximum (n_candidates, 1);
 
-    for (int k = 2; k >= 0; --k){
+  #pragma omp parallel for if(n_candidates>256)
+  for (int j = 0; j < n_candidates; ++j)
+  {
+    const int64_t i = candidates[j].first;
+    const double value = candidates[j].second->value;
+    int64_t moduled_index = i;
 
+    for (int k = 2; k >= 0; --k)
+    {
       moduled_index = moduled_index % partial_bin_products_[k+1];
-      indexes[k] = moduled_index / partial_bin_products_[k];
+      const int64_t index_k = moduled_index / partial_bin_products_[k];
 
-      if (indexes[k] > 0 && hough_space_[i] < hough_space_[i-partial_bin_products_[k]])
-      {
-        is_maximum = false;
-        break;
-      }
-      if (indexes[k] < bin_count_[k]-1 && hough_space_[i] < hough_space_[i+partial_bin_products_[k]])
+      if ((index_k > 0 && value < getValue (i-partial_bin_products_[k])) ||
+          (index_k < bin_count_[k]-1 && value < getValue (i+partial_bin_products_[k])))
       {
-        is_maximum = false;
+        is_maximum[j] = 0;
         break;
       }
     }
+  }
 
-    if (is_maximum)
+  for (int j = 0; j < n_candidates; ++j)
+  {
+    if (is_maximum[j])
     {
-
-      //If using voter_ids_vector_size_, then resize voter_ids_vector_ accordingly
-      voter_ids_vector_[i].resize(voter_ids_vector_size_[i]);
-
-      maxima_values.push_back (hough_space_[i]);
-      //maxima_voter_ids.push_back ( voter_ids_[i] );
-      maxima_voter_ids.push_back ( voter_ids_vector_[i] );
+      maxima_values.push_back (candidates[j].second->value);
+      maxima_voter_ids.push_back (candidates[j].second->voter_ids);
     }
   }
 
@@ -20,7 +20,9 @@ template<typename PointT>
 void
 NguyenNoiseModel<PointT>::compute ()
 {
-    pt_properties_.resize(input_->points.size());
+    sigma_lateral_.resize(input_->points.size());
+    sigma_axial_.resize(input_->points.size());
+    dist_to_edge_px_.resize(input_->points.size());
     discontinuity_edges_.indices.clear();
 
     //compute depth discontinuity edges
@@ -43,80 +45,59 @@ NguyenNoiseModel<PointT>::compute ()
             discontinuity_edges_.indices.push_back(edge_indices[j].indices[i]);
     }
 
-//    pcl::visualization::PCLVisualizer vis;
-//    vis.addPointCloud(input_);
-
-    for(size_t i=0; i < input_->points.size(); i++)
-    {
-        float sigma_lateral = 0.f;
-        float sigma_axial = 0.f;
-        const PointT &pt = input_->points[i];
-        const pcl::Normal &n = normals_->points[i];
-        const Eigen::Vector3f & np = n.getNormalVector3fMap();
-
-        pt_properties_[i].resize(3, std::numeric_limits<float>::max());
-
-        if( !pcl::isFinite(pt) || !pcl::isFinite(n) )
-            continue;
-
-        //origin to pint
-        //Eigen::Vector3f o2p = input_->points[i].getVector3fMap() * -1.f;
-        Eigen::Vector3f o2p = Eigen::Vector3f::UnitZ() * -1.f;
-
-        o2p.normalize();
-        float angle = pcl::rad2deg(acos(o2p.dot(np)));
-
-        sigma_lateral = (0.8 + 0.034 * angle / (90.f - angle)) * pt.z / param_.focal_length_;
-        sigma_axial = 0.0012 + 0.0019 * ( pt.z - 0.4 ) * ( pt.z - 0.4 ) + 0.0001 * angle * angle / ( sqrt(pt.z) * (90 - angle) * (90 - angle));
-
-//        std::cout << "angle: " << angle << ", sigma_lateral: " << sigma_lateral << ", sigma axial: " << sigma_axial << std::endl;
-//        vis.removeAllShapes();
-//        vis.addSphere(input_->points[i], 0.03f, 1,0,0);
-//        vis.spin();
-        pt_properties_[i][0] = sigma_lateral;
-        pt_properties_[i][1] = sigma_axial;
-   }
+    const int width = input_->width;
+    const int height = input_->height;
 
     //compute distance (in pixels) to edge for each pixel
+    //edge pixels are the zeros of the mask, the (exact Euclidean) distance transform is linear in the number of pixels
+    cv::Mat_<float> dist_to_edge;
     if (param_.use_depth_edges_)
     {
-        std::vector<float> dist_to_edge_3d(input_->points.size(), std::numeric_limits<float>::infinity());
-        std::vector<float> dist_to_edge_px(input_->points.size(), std::numeric_limits<float>::infinity());
+        cv::Mat_<unsigned char> edge_mask (height, width, (unsigned char)255);
+        for (size_t i = 0; i < discontinuity_edges_.indices.size (); i++)
+        {
+            const int idx = discontinuity_edges_.indices[i];
+            edge_mask (idx / width, idx % width) = 0;
+        }
+
+        if (discontinuity_edges_.indices.empty())
+            dist_to_edge = cv::Mat_<float>(height, width, std::numeric_limits<float>::infinity());
+        else
+            cv::distanceTransform (edge_mask, dist_to_edge, CV_DIST_L2, CV_DIST_MASK_PRECISE);
+    }
 
-        for (const auto &idx_start : discontinuity_edges_.indices) {
-            dist_to_edge_3d[idx_start] = 0.f;
-            dist_to_edge_px[idx_start] = 0.f;
+    const float max_dist = static_cast<float>(param_.edge_radius_);
 
-            int row_start = idx_start / input_->width;
-            int col_start = idx_start % input_->width;
+    #pragma omp parallel for
+    for (int row = 0; row < height; row++)
+    {
+        for (int col = 0; col < width; col++)
+        {
+            const int i = row * width + col;
+            sigma_lateral_[i] = sigma_axial_[i] = dist_to_edge_px_[i] = std::numeric_limits<float>::max();
 
-            for (int row_k = (row_start - param_.edge_radius_); row_k <= (row_start + param_.edge_radius_); row_k++)
+            if (param_.use_depth_edges_)
             {
-                for (int col_k = (col_start - param_.edge_radius_); col_k <= (col_start + param_.edge_radius_); col_k++)
-                {
-                    if( col_k<0 || row_k < 0 || col_k >= input_->width || row_k >= input_->height || row_k == row_start || col_k == col_start)
-                        continue;
+                const float d = dist_to_edge (row, col);
+                dist_to_edge_px_[i] = d <= max_dist ? d : std::numeric_limits<float>::infinity();
+            }
 
-                    int idx_k = row_k * input_->width + col_k;
+            const PointT &pt = input_->points[i];
+            const pcl::Normal &n = normals_->points[i];
 
-                    float dist_3d = dist_to_edge_3d[idx_start] + (input_->points[idx_start].getVector3fMap () - input_->points[idx_k].getVector3fMap ()).norm ();
-                    float dist_px = dist_to_edge_px[idx_start] + sqrt( (col_k-col_start)*(col_k-col_start) + (row_k-row_start)*(row_k-row_start));
+            if( !pcl::isFinite(pt) || !pcl::isFinite(n) )
+                continue;
 
-                    if( dist_px < dist_to_edge_px[idx_k] )
-                        dist_to_edge_px[idx_k] = dist_px;
+            //origin to pint
+            //Eigen::Vector3f o2p = input_->points[i].getVector3fMap() * -1.f;
+            const Eigen::Vector3f o2p = Eigen::Vector3f::UnitZ() * -1.f;
+            const Eigen::Vector3f & np = n.getNormalVector3fMap();
 
-                    if( dist_3d < dist_to_edge_3d[idx_k] )
-                        dist_to_edge_3d[idx_k] = dist_3d;
-                }
-            }
-        }
+            float angle = pcl::rad2deg(acos(o2p.dot(np)));
 
-//        std::ofstream f ("/tmp/test.txt");
-        for (int i = 0; i < input_->points.size (); i++) {
-            pt_properties_[i][2] = dist_to_edge_px[i];
-//            f << dist_to_edge_px[i] << std::endl;
+            sigma_lateral_[i] = (0.8 + 0.034 * angle / (90.f - angle)) * pt.z / param_.focal_length_;
+            sigma_axial_[i] = 0.0012 + 0.0019 * ( pt.z - 0.4 ) * ( pt.z - 0.4 ) + 0.0001 * angle * angle / ( sqrt(pt.z) * (90 - angle) * (90 - angle));
         }
-//        f.close();
     }
 }
 
@@ -50,9 +50,13 @@ public:
   public:
     int win_size;
     ImGradientDescriptor::Parameter ghParam;
+    bool sample_gradients;  // sample rotated patches from image gradients computed once per pyramid level
+                            // instead of warping and differentiating a patch per keypoint (faster, but the
+                            // descriptors differ slightly, i.e. do not mix it with models created without)
     Parameter(int _win_size=34, 
-      const ImGradientDescriptor::Parameter &_ghParam=ImGradientDescriptor::Parameter())
-    : win_size(_win_size), ghParam(_ghParam) {}
+      const ImGradientDescriptor::Parameter &_ghParam=ImGradientDescriptor::Parameter(),
+      bool _sample_gradients=false)
+    : win_size(_win_size), ghParam(_ghParam), sample_gradients(_sample_gradients) {}
   };
 
 private:
@@ -60,6 +64,12 @@ private:
 
   int h_win;
 
+  std::vector< cv::Mat_<unsigned char> > im_pyr;
+  std::vector< cv::Mat_<short> > dx_pyr, dy_pyr;   // image gradients per pyramid level
+
+  void computeGradientPyramid(const cv::Mat_<unsigned char> &image, const std::vector<cv::KeyPoint> &keys);
+  void sampleGradients(const cv::KeyPoint &key, cv::Mat_<float> &dx, cv::Mat_<float> &dy);
+
 public:
  
 
@@ -71,26 +71,37 @@ private:
   cv::Mat_<unsigned char> im_smooth;
   cv::Mat_<short> im_dx, im_dy;
   cv::Mat_<float> lt_gauss;
+  std::vector<int> lt_cell_u, lt_cell_v;   // histogram offset of the patch columns / rows
+  std::vector<float> mag;                  // weighted gradient magnitudes of a patch row
 
   void ComputeGradients(const cv::Mat_<unsigned char> &im);
-  void ComputeDescriptor(std::vector<float> &desc, const cv::Mat_<float> &weight);
-  void ComputeDescriptorInterpolate(std::vector<float> &desc, const cv::Mat_<float> &weight);
-  void ComputeLTGauss(const cv::Mat_<unsigned char> &im);
-  void ComputeLTGaussCirc(const cv::Mat_<unsigned char> &im);
-  void ComputeLTGaussLin(const cv::Mat_<unsigned char> &im);
-  void Normalize(std::vector<float> &desc);
-  void Cut(std::vector<float> &desc);
+  template<typename T>
+  void ComputeDescriptor(const cv::Mat_<T> &dx, const cv::Mat_<T> &dy, const cv::Mat_<float> &weight, float *desc);
+  void ComputeDescriptorInterpolate(float *desc, const cv::Mat_<float> &weight);
+  void ComputeLTCells(int rows, int cols);
+  void ComputeLTGauss(int rows, int cols);
+  void ComputeLTGaussCirc(int rows, int cols);
+  void ComputeLTGaussLin(int rows, int cols);
+  void Normalize(float *desc);
+  void Cut(float *desc);
+  void PostProcess(float *desc);
 
   inline int sign(const float &v);
+  template<typename T>
+  inline int getBin(const T &dx, const T &dy);
 
 
 public:
+  static const int DESC_SIZE = 128;        // 4x4 cells x 8 orientations
 
   ImGradientDescriptor(const Parameter &p=Parameter());
   ~ImGradientDescriptor();
 
   void compute(const cv::Mat_<unsigned char> &im, std::vector<float> &desc);
   void compute(const cv::Mat_<unsigned char> &im,const cv::Mat_<float> &weight, std::vector<float> &desc);
+  void compute(const cv::Mat_<unsigned char> &im, float *desc);
+  void compute(const cv::Mat_<unsigned char> &im,const cv::Mat_<float> &weight, float *desc);
+  void compute(const cv::Mat_<float> &dx, const cv::Mat_<float> &dy, float *desc);
 
   typedef SmartPtr< ::v4r::ImGradientDescriptor> Ptr;
   typedef SmartPtr< ::v4r::ImGradientDescriptor const> ConstPtr;
@@ -106,6 +117,22 @@ inline int ImGradientDescriptor::sign(const float &v)
   return +1;
 }
 
+/**
+ * orientation bin (0..7) of a gradient
+ */
+template<typename T>
+inline int ImGradientDescriptor::getBin(const T &dx, const T &dy)
+{
+  if (dx>0 && dy>0){
+    return (dx>dy ? 0 : 1);
+  }else if (dx<0 && dy>0){
+    return ((-dx)<dy ? 2 : 3);
+  }else if (dx<0 && dy<0){
+    return (dx<dy ? 4 : 5);
+  }
+  return (dx<(-dy) ? 6 : 7);
+}
+
 
 } //--END--
 
@@ -28,53 +28,75 @@
 #include <v4r/core/macros.h>
 #include <v4r/features/global_estimator.h>
 
-#include <pcl/features/esf.h>
+#include <Eigen/Dense>
 #include <glog/logging.h>
 
 namespace v4r
 {
+    /**
+     * @brief Ensemble of Shape Functions (ESF) descriptor (Wohlkinger and Vincze, 2011) with 640 bins
+     * (D2 in/out/mixed, D2 ratio, A3 in/out/mixed, D3 in/out/mixed, 64 bins each). Voxelization, sampling and
+     * normalization differ from pcl::ESFEstimation, i.e. the signatures are not comparable to pcl::ESFSignature640
+     * and models trained with it have to be retrained (see getFeatureDescriptorName).
+     * The random point triples are split into a fixed number of chunks with an own random number stream each,
+     * which are sampled in parallel and reduced at the end, i.e. the signature does not depend on the number of threads.
+     * Point, occupancy grid and sample buffers are kept, i.e. clusters of the same frame (set by setIndices)
+     * are described without copying the cloud or reallocating memory.
+     */
     template<typename PointT>
       class V4R_EXPORTS ESFEstimation : public GlobalEstimator<PointT>
       {
+      public:
+          class Parameter
+          {
+          public:
+              size_t num_samples_;  /// @brief number of sampled point triples
+              int num_threads_;     /// @brief number of threads (0 ... number of available cores)
+              unsigned seed_;       /// @brief seed of the random number streams
+              Parameter( size_t num_samples = 20000, int num_threads = 0, unsigned seed = 0)
+                  : num_samples_ (num_samples), num_threads_ (num_threads), seed_ (seed)
+              {}
+          };
+
       private:
           using GlobalEstimator<PointT>::indices_;
           using GlobalEstimator<PointT>::input_cloud_;
 
-          typedef typename pcl::PointCloud<PointT>::Ptr PointInTPtr;
-          PointInTPtr processed_;
-
-      public:
-          std::vector<float>
-          estimate ()
-          {
-            std::vector<float> signature;
+          Parameter param_;
 
-            CHECK(input_cloud_ && !input_cloud_->points.empty());
+          std::vector<Eigen::Vector3f> points_;   /// @brief finite points of the object in voxel grid coordinates
+          std::vector<unsigned char> grid_;       /// @brief (dilated) occupancy grid of the object
 
-            if(!indices_.empty()) {
-                processed_.reset(new pcl::PointCloud<PointT>);
-                pcl::copyPointCloud(*input_cloud_, indices_, *processed_);
-            }
-            else
-                processed_ = input_cloud_;
+          // shape function values and on-surface ratio of their lines for each sample
+          std::vector<float> d2_, d2_ratio_;      // three point pairs per triple
+          std::vector<float> d3_, d3_ratio_;
+          std::vector<float> a3_, a3_ratio_;
 
+          void voxelize ();
+          void sample (int num_threads);
+          void computeHistograms (std::vector<float> &signature, int num_threads) const;
 
-            typedef typename pcl::ESFEstimation<PointT, pcl::ESFSignature640> ESFEstimation;
-            pcl::PointCloud<pcl::ESFSignature640> ESF_signature;
-            ESFEstimation esf;
-            esf.setInputCloud (processed_);
-            esf.compute (ESF_signature);
+          /** @brief fraction of the occupied voxels between two points (end points excluded) */
+          inline float lineRatio (const Eigen::Vector3f &a, const Eigen::Vector3f &b) const;
 
-            const pcl::ESFSignature640 &pt = ESF_signature.points[0];
-            const size_t feat_dim = (size_t) ((double)(sizeof(pt.histogram)) / sizeof(pt.histogram[0]));
-            signature.resize(feat_dim);
+      public:
+          ESFEstimation (const Parameter &p = Parameter()) : param_(p)
+          {}
 
-            for(size_t i=0; i<feat_dim; i++)
-                signature[i] = pt.histogram[i];
+          std::vector<float>
+          estimate ();
 
-            indices_.clear();
+          /** @brief name of the training data directory, differs from the one of PCL's ESF ("esf") */
+          std::string
+          getFeatureDescriptorName () const
+          {
+              return "esf_v4r";
+          }
 
-            return signature;
+          boost::shared_ptr<GlobalEstimator<PointT> >
+          makeCopy () const
+          {
+              return boost::shared_ptr<GlobalEstimator<PointT> > (new ESFEstimation<PointT> (param_));
           }
       };
 }
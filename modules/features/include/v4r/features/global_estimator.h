@@ -74,6 +74,17 @@ namespace v4r
             input_cloud_ = in;
         }
 
+        /**
+         * @brief copy of the estimator with the same configuration and an own state,
+         * i.e. the copy and the original can be used concurrently
+         * @return empty pointer if the estimator can not be copied
+         */
+        virtual boost::shared_ptr<GlobalEstimator<PointT> >
+        makeCopy () const
+        {
+            return boost::shared_ptr<GlobalEstimator<PointT> > ();
+        }
+
     };
 }
 
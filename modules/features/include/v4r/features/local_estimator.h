@@ -66,6 +66,16 @@ public:
     {
         *keypoint_indices = *keypoint_indices_;
     }
+
+    /**
+     * @brief copy of the extractor with the same configuration and an own state (e.g. for another thread)
+     * @return empty pointer if the extractor can not be copied
+     */
+    virtual boost::shared_ptr<KeypointExtractor<PointInT> >
+    makeCopy () const
+    {
+        return boost::shared_ptr<KeypointExtractor<PointInT> > ();
+    }
 };
 
 template<typename PointInT>
@@ -195,6 +205,12 @@ public:
         sampling_density_ = f;
     }
 
+    boost::shared_ptr<KeypointExtractor<PointInT> >
+    makeCopy () const
+    {
+        return boost::shared_ptr<KeypointExtractor<PointInT> > (new UniformSamplingExtractor<PointInT> (*this));
+    }
+
     void
     compute (PointInTPtr & keypoints)
     {
@@ -280,6 +296,23 @@ protected:
     boost::shared_ptr<std::vector<std::vector<int> > > neighborhood_indices_;
     boost::shared_ptr<std::vector<std::vector<float> > > neighborhood_dist_;
 
+    /**
+     * @brief sets copies of the keypoint extractors to the estimator e (see makeCopy)
+     * @return false if an extractor can not be copied
+     */
+    bool
+    copyKeypointExtractorsTo (LocalEstimator<PointInT, FeatureT> & e) const
+    {
+        e.keypoint_extractor_.resize (keypoint_extractor_.size ());
+        for (size_t i = 0; i < keypoint_extractor_.size (); i++)
+        {
+            e.keypoint_extractor_[i] = keypoint_extractor_[i]->makeCopy ();
+            if (!e.keypoint_extractor_[i])
+                return false;
+        }
+        return true;
+    }
+
     void
     computeKeypoints (const PointInTPtr & cloud, PointInTPtr & keypoints, const pcl::PointCloud<pcl::Normal>::Ptr & normals)
     {
@@ -417,6 +450,17 @@ public:
 
     virtual
     std::string getFeatureDescriptorName() const = 0;
+
+    /**
+     * @brief copy of the estimator with the same configuration (including copies of the keypoint extractors)
+     * and an own state, i.e. the copy and the original can be used concurrently
+     * @return empty pointer if the estimator can not be copied (e.g. it holds a GPU context)
+     */
+    virtual boost::shared_ptr<LocalEstimator<PointInT, FeatureT> >
+    makeCopy () const
+    {
+        return boost::shared_ptr<LocalEstimator<PointInT, FeatureT> > ();
+    }
 };
 }
 
@@ -162,6 +162,16 @@ namespace v4r
           return true;
         }
 
+        boost::shared_ptr<LocalEstimator<PointInT, FeatureT> >
+        makeCopy () const
+        {
+          // the SIFT detector is shared, its detection and extraction are const
+          boost::shared_ptr<OpenCVSIFTLocalEstimation<PointInT, FeatureT> > e (new OpenCVSIFTLocalEstimation<PointInT, FeatureT> (*this));
+          if (!this->copyKeypointExtractorsTo (*e))
+            return boost::shared_ptr<LocalEstimator<PointInT, FeatureT> > ();
+          return e;
+        }
+
       private:
 
       };
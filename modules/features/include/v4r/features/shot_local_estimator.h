@@ -123,6 +123,15 @@ namespace v4r
         {
           return true;
         }
+
+        boost::shared_ptr<LocalEstimator<PointInT, FeatureT> >
+        makeCopy () const
+        {
+          boost::shared_ptr<SHOTLocalEstimation<PointInT, FeatureT> > e (new SHOTLocalEstimation<PointInT, FeatureT> (*this));
+          if (!this->copyKeypointExtractorsTo (*e))
+            return boost::shared_ptr<LocalEstimator<PointInT, FeatureT> > ();
+          return e;
+        }
       };
 }
 
@@ -215,6 +215,15 @@ namespace v4r
         {
           return true;
         }
+
+        boost::shared_ptr<LocalEstimator<PointInT, FeatureT> >
+        makeCopy () const
+        {
+          boost::shared_ptr<SHOTLocalEstimationOMP<PointInT, FeatureT> > e (new SHOTLocalEstimationOMP<PointInT, FeatureT> (*this));
+          if (!this->copyKeypointExtractorsTo (*e))
+            return boost::shared_ptr<LocalEstimator<PointInT, FeatureT> > ();
+          return e;
+        }
       };
 }
 
@@ -32,6 +32,7 @@
 
 
 #include <v4r/features/ComputeImGradientDescriptors.h>
+#include <algorithm>
 
 #ifdef _OPENMP
 #include <omp.h>
@@ -57,6 +58,117 @@ ComputeImGradientDescriptors::~ComputeImGradientDescriptors()
 }
 
 
+/**
+ * @brief ComputeImGradientDescriptors::computeGradientPyramid
+ * Computes the image gradients (same smoothing and sobel kernel as ImGradientDescriptor) once per
+ * pyramid level. The number of levels depends on the largest keypoint.
+ */
+void ComputeImGradientDescriptors::computeGradientPyramid(const cv::Mat_<unsigned char> &image, const std::vector<cv::KeyPoint> &keys)
+{
+  float max_step = 1.;
+
+  for (unsigned i=0; i<keys.size(); i++)
+    max_step = std::max(max_step, keys[i].size/(float)(param.win_size-2));
+
+  int levels = 1;
+  while ( (1<<levels) <= max_step && (image.cols>>levels) >= param.win_size && (image.rows>>levels) >= param.win_size )
+    levels++;
+
+  im_pyr.resize(levels);
+  dx_pyr.resize(levels);
+  dy_pyr.resize(levels);
+
+  cv::Mat_<unsigned char> im_smooth;
+
+  for (int i=0; i<levels; i++)
+  {
+    if (i==0) im_pyr[i] = image;
+    else cv::pyrDown(im_pyr[i-1], im_pyr[i]);
+
+    if (param.ghParam.smooth)
+      cv::blur(im_pyr[i], im_smooth, cv::Size(3,3));
+    else im_smooth = im_pyr[i];
+
+    cv::Sobel(im_smooth, dx_pyr[i], CV_16S, 1, 0, 3, 1, 0, cv::BORDER_DEFAULT );
+    cv::Sobel(im_smooth, dy_pyr[i], CV_16S, 0, 1, 3, 1, 0, cv::BORDER_DEFAULT );
+  }
+}
+
+/**
+ * @brief ComputeImGradientDescriptors::sampleGradients
+ * Samples the gradient patch of a keypoint (bilinear) from the pyramid level which best fits the
+ * keypoint size and rotates/scales the gradients to the patch frame, i.e. the result corresponds to
+ * the gradients of the affine warped patch.
+ * @param key
+ * @param dx gradient patch (win_size x win_size, the 1px border is not sampled)
+ * @param dy
+ */
+void ComputeImGradientDescriptors::sampleGradients(const cv::KeyPoint &key, cv::Mat_<float> &dx, cv::Mat_<float> &dy)
+{
+  const float step = key.size/(float)(param.win_size-2);    // image pixels per patch pixel
+
+  int level = 0;
+  while (level+1<(int)dx_pyr.size() && (1<<(level+1)) <= step)
+    level++;
+
+  const cv::Mat_<short> &gdx = dx_pyr[level];
+  const cv::Mat_<short> &gdy = dy_pyr[level];
+
+  const float inv_l = 1./(float)(1<<level);
+  const float step_l = step*inv_l;                          // level pixels per patch pixel
+  const float dir = key.angle*(float)(CV_PI/180);
+  const float cos_dir = std::cos(dir);
+  const float sin_dir = std::sin(dir);
+  const float a = step_l*cos_dir;
+  const float b = step_l*sin_dir;
+  const float x0 = (key.pt.x+.5)*inv_l - .5;
+  const float y0 = (key.pt.y+.5)*inv_l - .5;
+
+  dx.create(param.win_size, param.win_size);
+  dy.create(param.win_size, param.win_size);
+  dx.setTo(0);
+  dy.setTo(0);
+
+  for (int y=1; y<param.win_size-1; y++)
+  {
+    const float py = y-h_win;
+    float *ptr_dx = &dx(y,0);
+    float *ptr_dy = &dy(y,0);
+
+    for (int x=1; x<param.win_size-1; x++)
+    {
+      const float px = x-h_win;
+      const float lx = x0 + a*px + b*py;
+      const float ly = y0 - b*px + a*py;
+      const int ix = (int)std::floor(lx);
+      const int iy = (int)std::floor(ly);
+
+      if (ix<0 || iy<0 || ix+1>=gdx.cols || iy+1>=gdx.rows)
+        continue;
+
+      const float fx = lx-ix;
+      const float fy = ly-iy;
+      const float w00 = (1.-fx)*(1.-fy);
+      const float w01 = fx*(1.-fy);
+      const float w10 = (1.-fx)*fy;
+      const float w11 = fx*fy;
+
+      const short *d0 = &gdx(iy,ix);
+      const short *d1 = &gdx(iy+1,ix);
+      const float gx = w00*d0[0] + w01*d0[1] + w10*d1[0] + w11*d1[1];
+
+      d0 = &gdy(iy,ix);
+      d1 = &gdy(iy+1,ix);
+      const float gy = w00*d0[0] + w01*d0[1] + w10*d1[0] + w11*d1[1];
+
+      ptr_dx[x] = step_l*(cos_dir*gx - sin_dir*gy);
+      ptr_dy[x] = step_l*(sin_dir*gx + cos_dir*gy);
+    }
+  }
+}
+
+
+
 /***************************************************************************************/
 
 /**
@@ -64,64 +176,74 @@ ComputeImGradientDescriptors::~ComputeImGradientDescriptors()
  */
 void ComputeImGradientDescriptors::compute(const cv::Mat_<unsigned char> &image, const std::vector<cv::Point2f> &pts, cv::Mat &descriptors)
 {
-  ImGradientDescriptor gradDesc(param.ghParam);
-
-  std::vector<float> desc(128), desc0(128,-1);
-
-  descriptors = cv::Mat_<float>(pts.size(), 128);
+  descriptors = cv::Mat_<float>(pts.size(), ImGradientDescriptor::DESC_SIZE);
 
-  #pragma omp parallel for private(desc, gradDesc)
-  for (unsigned i=0; i<pts.size(); i++)
+  #pragma omp parallel
   {
-    const cv::Point2f &pt = pts[i];
-    if (pt.x-h_win>=0 && pt.y-h_win>=0 && (pt.x+h_win<image.cols && pt.y+h_win<image.rows))
+    ImGradientDescriptor gradDesc(param.ghParam);
+
+    #pragma omp for
+    for (int i=0; i<(int)pts.size(); i++)
     {
-      gradDesc.compute(cv::Mat(image, cv::Rect(pt.x-h_win,pt.y-h_win, param.win_size,param.win_size)), desc);
-      memcpy(&descriptors.at<float>(i,0), &desc[0], 128*sizeof(float));
+      const cv::Point2f &pt = pts[i];
+      float *desc = descriptors.ptr<float>(i);
+
+      if (pt.x-h_win>=0 && pt.y-h_win>=0 && (pt.x+h_win<image.cols && pt.y+h_win<image.rows))
+        gradDesc.compute(cv::Mat(image, cv::Rect(pt.x-h_win,pt.y-h_win, param.win_size,param.win_size)), desc);
+      else std::fill(desc, desc+ImGradientDescriptor::DESC_SIZE, -1.f);
     }
-    else  memcpy(&descriptors.at<float>(i,0), &desc0[0], 128*sizeof(float));
   }
- 
 }
 
 /**
  * compute descriptors
+ * Each thread has its own descriptor and patch buffers and the descriptors are written directly
+ * to the rows of the descriptor matrix.
  */
 void ComputeImGradientDescriptors::compute(const cv::Mat_<unsigned char> &image, const std::vector<cv::KeyPoint> &keys, cv::Mat &descriptors)
 {
-  ImGradientDescriptor gradDesc(param.ghParam);
+  descriptors = cv::Mat_<float>(keys.size(), ImGradientDescriptor::DESC_SIZE);
 
-  cv::Mat_<float> M(2,3);
-  cv::Mat_<unsigned char> im_desc(param.win_size,param.win_size);
-  cv::Size dsize(param.win_size,param.win_size);
-  std::vector<float> desc(128), desc0(128,-1);
-  
-  descriptors = cv::Mat_<float>(keys.size(), 128);
+  if (param.sample_gradients)
+    computeGradientPyramid(image, keys);
 
-  #pragma omp parallel for private(desc, gradDesc, im_desc, M)
-  for (unsigned i=0; i<keys.size(); i++)
+  #pragma omp parallel
   {
-    const cv::KeyPoint &key = keys[i];
+    ImGradientDescriptor gradDesc(param.ghParam);
+    cv::Mat_<float> M(2,3);
+    cv::Mat_<unsigned char> im_desc(param.win_size,param.win_size);
+    cv::Mat_<float> patch_dx, patch_dy;
+    cv::Size dsize(param.win_size,param.win_size);
 
-    float dir = key.angle*(float)(CV_PI/180);
-    float scale = (param.win_size-2)/key.size;
-    float sin_dir = scale*std::sin(dir);
-    float cos_dir = scale*std::cos(dir);
+    #pragma omp for
+    for (int i=0; i<(int)keys.size(); i++)
+    {
+      const cv::KeyPoint &key = keys[i];
 
-    M = cv::Mat_<float>(2,3);
-    M(0,0)= cos_dir;
-    M(0,1)= -sin_dir;
-    M(0,2)= h_win - cos_dir*key.pt.x + sin_dir*key.pt.y;
-    M(1,0)= sin_dir;
-    M(1,1)= cos_dir;
-    M(1,2)= h_win - sin_dir*key.pt.x - cos_dir*key.pt.y; 
-    
-    cv::warpAffine(image, im_desc, M, dsize, cv::INTER_LINEAR, cv::BORDER_CONSTANT, 0);
+      if (param.sample_gradients)
+      {
+        sampleGradients(key, patch_dx, patch_dy);
+        gradDesc.compute(patch_dx, patch_dy, descriptors.ptr<float>(i));
+        continue;
+      }
 
-    gradDesc.compute(im_desc, desc);
-    memcpy(&descriptors.at<float>(i,0), &desc[0], 128*sizeof(float));
+      float dir = key.angle*(float)(CV_PI/180);
+      float scale = (param.win_size-2)/key.size;
+      float sin_dir = scale*std::sin(dir);
+      float cos_dir = scale*std::cos(dir);
+
+      M(0,0)= cos_dir;
+      M(0,1)= -sin_dir;
+      M(0,2)= h_win - cos_dir*key.pt.x + sin_dir*key.pt.y;
+      M(1,0)= sin_dir;
+      M(1,1)= cos_dir;
+      M(1,2)= h_win - sin_dir*key.pt.x - cos_dir*key.pt.y; 
+
+      cv::warpAffine(image, im_desc, M, dsize, cv::INTER_LINEAR, cv::BORDER_CONSTANT, 0);
+
+      gradDesc.compute(im_desc, descriptors.ptr<float>(i));
+    }
   }
- 
 }
 
 /**
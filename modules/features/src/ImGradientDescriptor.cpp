@@ -31,6 +31,7 @@
  */
 
 #include <v4r/features/ImGradientDescriptor.h>
+#include <algorithm>
 
 //#define IMGD_INTERPOLATED
 
@@ -41,6 +42,8 @@ namespace v4r
 
 using namespace std;
 
+const int ImGradientDescriptor::DESC_SIZE;
+
 
 /************************************************************************************
  * Constructor/Destructor
@@ -68,60 +71,67 @@ void ImGradientDescriptor::ComputeGradients(const cv::Mat_<unsigned char> &im)
   cv::Sobel(im_smooth, im_dy, CV_16S, 0, 1, 3, 1, 0, cv::BORDER_DEFAULT );
 }
 
+/**
+ * ComputeLTCells
+ * histogram offsets of the patch rows and columns (the 1px border is not used)
+ */
+void ImGradientDescriptor::ComputeLTCells(int rows, int cols)
+{
+  if ((int)lt_cell_v.size()==rows-2 && (int)lt_cell_u.size()==cols-2)
+    return;
+
+  int dv = (rows-2)/4;
+  int du = (cols-2)/4;
+
+  lt_cell_v.resize(rows-2);
+  lt_cell_u.resize(cols-2);
+
+  for (int v=0; v<rows-2; v++)
+    lt_cell_v[v] = std::min(v/dv,3)*4*8;
+  for (int u=0; u<cols-2; u++)
+    lt_cell_u[u] = std::min(u/du,3)*8;
+}
+
 /**
  * ComputeDescriptor
+ * The weighted magnitudes of a row are computed in one (vectorizable) pass,
+ * the binning uses the precomputed cell offsets
  */
-void ImGradientDescriptor::ComputeDescriptor(std::vector<float> &desc, const cv::Mat_<float> &weight)
+template<typename T>
+void ImGradientDescriptor::ComputeDescriptor(const cv::Mat_<T> &dx, const cv::Mat_<T> &dy, const cv::Mat_<float> &weight, float *desc)
 {
-  int h;
-  short *ptr_dx, *ptr_dy;
+  ComputeLTCells(dx.rows, dx.cols);
 
-  desc.clear();
-  desc.resize(128,0);
+  std::fill(desc, desc+DESC_SIZE, 0.f);
 
-  int dv = (im_dx.rows-2)/4;
-  int du = (im_dx.cols-2)/4;
+  const int cols = dx.cols-2;
+  mag.resize(cols);
+  float *ptr_mag = &mag[0];
 
-  for (int v=1; v<im_dx.rows-1; v++)
+  for (int v=1; v<dx.rows-1; v++)
   {
-    ptr_dx = &im_dx(v,1);
-    ptr_dy = &im_dy(v,1);
+    const T *ptr_dx = &dx(v,1);
+    const T *ptr_dy = &dy(v,1);
+    const float *ptr_w = &weight(v,1);
 
-    for (int u=1; u<im_dx.cols-1; u++, ptr_dx++, ptr_dy++)
-    {
-      if (*ptr_dx>0 && *ptr_dy>0){
-        if (*ptr_dx>*ptr_dy) h=0;
-        else h=1;
-      }else if (*ptr_dx<0 && *ptr_dy>0){
-        if ((-*ptr_dx)<*ptr_dy) h=2;
-        else h=3;
-      }else if (*ptr_dx<0 && *ptr_dy<0){
-        if ((*ptr_dx)<*ptr_dy) h=4;
-        else h=5;
-      }else{
-        if ((*ptr_dx)<(-*ptr_dy)) h=6;
-        else h=7;
-      }
+    for (int u=0; u<cols; u++)
+      ptr_mag[u] = float(std::abs(ptr_dx[u])+std::abs(ptr_dy[u])) * ptr_w[u];
 
-      //desc[(((v-1)/dv*4 + (u-1)/du))*8 + h] += float(sqrt(*ptr_dx * *ptr_dx + *ptr_dy * *ptr_dy)) * weight(v,u);
-      desc[(((v-1)/dv*4 + (u-1)/du))*8 + h] += float(fabs(*ptr_dx)+fabs(*ptr_dy)) * weight(v,u);
-      //desc[(v-1)/dv*4*8 + (u-1)/du*8 + h] += float(fabs(*ptr_dx)+fabs(*ptr_dy)) * weight(v,u);
+    float *ptr_desc = desc + lt_cell_v[v-1];
 
-      //cout<<sqrt(*ptr_dx * *ptr_dx + *ptr_dy * *ptr_dy)<<" ";
-    }
-  } 
+    for (int u=0; u<cols; u++)
+      ptr_desc[lt_cell_u[u] + getBin(ptr_dx[u], ptr_dy[u])] += ptr_mag[u];
+  }
 }
 
 /**
  * ComputeDescriptorInterpolate
  */
-void ImGradientDescriptor::ComputeDescriptorInterpolate(std::vector<float> &desc, const cv::Mat_<float> &weight)
+void ImGradientDescriptor::ComputeDescriptorInterpolate(float *desc, const cv::Mat_<float> &weight)
 {
   int h;
-  //short *ptr_dx, *ptr_dy;
 
-  desc.clear();
-  desc.resize(128,0);
+  std::fill(desc, desc+DESC_SIZE, 0.f);
 
   int dv = (im_dx.rows-2)/4;
   int du = (im_dx.cols-2)/4;
@@ -139,22 +149,10 @@ void ImGradientDescriptor::ComputeDescriptorInterpolate(std::vector<float> &desc
         {
           int ug = u*du+x+1;
           int vg = v*dv+y+1;
-          const float &dx = im_dx(vg,ug);
-          const float &dy = im_dy(vg,ug);
-
-          if (dx>0 && dy>0){
-            if (dx>dy) h=0;
-            else h=1;
-          }else if (dx<0 && dy>0){
-            if ((-dx)<dy) h=2;
-            else h=3;
-          }else if (dx<0 && dy<0){
-            if (dx<dy) h=4;
-            else h=5;
-          }else{
-            if (dx<-dy) h=6;
-            else h=7;
-          }
+          const float dx = im_dx(vg,ug);
+          const float dy = im_dy(vg,ug);
+
+          h = getBin(dx, dy);
           
           wx = 0.5 + .5 * (1. - (float(x)-du_2) / du_2);
           wy = 0.5 + .5 * (1. - (float(y)-dv_2) / dv_2);
@@ -186,27 +184,27 @@ void ImGradientDescriptor::ComputeDescriptorInterpolate(std::vector<float> &desc
 /**
  * ComputeLTGauss
  */
-void ImGradientDescriptor::ComputeLTGauss(const cv::Mat_<unsigned char> &im)
+void ImGradientDescriptor::ComputeLTGauss(int rows, int cols)
 {
-  if (lt_gauss.rows!=im.rows || lt_gauss.cols!=im.cols)
+  if (lt_gauss.rows!=rows || lt_gauss.cols!=cols)
   {
     if (param.gauss_lin)
-      ComputeLTGaussLin(im);
-    else ComputeLTGaussCirc(im);
+      ComputeLTGaussLin(rows, cols);
+    else ComputeLTGaussCirc(rows, cols);
   }
 }
 
 /**
  * ComputeLTGaussCirc
  */
-void ImGradientDescriptor::ComputeLTGaussCirc(const cv::Mat_<unsigned char> &im)
+void ImGradientDescriptor::ComputeLTGaussCirc(int rows, int cols)
 {  
-  if (im.rows!=im.cols || (im.rows-2)%4 != 0)
+  if (rows!=cols || (rows-2)%4 != 0)
     throw std::runtime_error("[ImGradientDescriptor::ComputeLTGaussCirc] Invalid patch size!");
 
-  lt_gauss=cv::Mat_<float>(im.rows,im.cols);
+  lt_gauss=cv::Mat_<float>(rows,cols);
 
-  float h_size = im.rows/2;
+  float h_size = rows/2;
   float invSqrSigma;
 
   invSqrSigma = param.sigma*(float)(h_size-1);
@@ -219,26 +217,19 @@ void ImGradientDescriptor::ComputeLTGaussCirc(const cv::Mat_<unsigned char> &im)
       lt_gauss(v+h_size,u+h_size) = exp(invSqrSigma*(u*u+v*v));
     }
   }
-
-  /*cv::Mat_<unsigned char> tmp(im.rows,im.cols);
-  for (int v=0; v<im.rows; v++)
-    for (int u=0; u<im.cols; u++)
-      tmp(v,u) = lt_gauss(v,u)*255;
-  cv::imshow("image",tmp);
-  cv::waitKey(0);*/
 }
 
 /**
  * ComputeLTGaussLin
  */
-void ImGradientDescriptor::ComputeLTGaussLin(const cv::Mat_<unsigned char> &im)
+void ImGradientDescriptor::ComputeLTGaussLin(int rows, int cols)
 {  
-  if ((im.cols-2)%4 != 0 || (im.rows-2)%4 != 0)
+  if ((cols-2)%4 != 0 || (rows-2)%4 != 0)
     throw std::runtime_error("[ImGradientDescriptor::ComputeLTGaussLin] Invalid patch size!");
 
-  lt_gauss.resize(im.rows,im.cols);
+  lt_gauss = cv::Mat_<float>(rows,cols);
 
-  float h_size = im.rows/2;
+  float h_size = rows/2;
   float invSqrSigma;
 
   invSqrSigma = param.sigma*(float)(h_size-1);
@@ -246,7 +237,7 @@ void ImGradientDescriptor::ComputeLTGaussLin(const cv::Mat_<unsigned char> &im)
   
   for (int v=-h_size; v<h_size; v++)
   {
-    for (int u=0; u<im.cols; u++)
+    for (int u=0; u<cols; u++)
     {
       lt_gauss(v+h_size,u) = exp(invSqrSigma*(u*u));
     }
@@ -257,35 +248,44 @@ void ImGradientDescriptor::ComputeLTGaussLin(const cv::Mat_<unsigned char> &im)
 /**
  * Normalize
  */
-void ImGradientDescriptor::Normalize(std::vector<float> &desc)
+void ImGradientDescriptor::Normalize(float *desc)
 {
-  float norm=0;
-
-  float *ptr = &desc[0];
-  for (unsigned i=0; i<desc.size(); i++, ptr++)
-    norm += (*ptr * *ptr);
+  Eigen::Map< Eigen::Matrix<float,DESC_SIZE,1> > eig_desc(desc);
+  float norm = eig_desc.squaredNorm();
 
   if (norm > numeric_limits<float>::epsilon( ))
-  {
-    norm = 1./sqrt(norm);
+    eig_desc *= 1./sqrt(norm);
+}
 
-    for (unsigned i=0; i<desc.size(); i++)
-      desc[i] *= norm;
-  }
+/**
+ * Cut
+ */
+void ImGradientDescriptor::Cut(float *desc)
+{
+  Eigen::Map< Eigen::Matrix<float,DESC_SIZE,1> > eig_desc(desc);
+  eig_desc.array() = eig_desc.array().min(param.thrCutDesc);
 }
 
 /**
- * Normalize
+ * PostProcess
+ * normalization and root descriptor
  */
-void ImGradientDescriptor::Cut(std::vector<float> &desc)
+void ImGradientDescriptor::PostProcess(float *desc)
 {
-  float *ptr = &desc[0];
-  float *ptr_end = &desc.back();
-  ptr_end++;
+  if (param.normalize)
+  {
+    Normalize(desc);   // to 1
+    Cut(desc);         // cut 0.2
+    Normalize(desc);   // renormalize to 1
+  }
 
-  for (; ptr!=ptr_end; ptr++)
-    if (*ptr > param.thrCutDesc)
-      *ptr = param.thrCutDesc;
+  if (param.computeRootGD)
+  {
+    Eigen::Map< Eigen::Matrix<float,DESC_SIZE,1> > eig_desc(desc);
+    float norm = eig_desc.lpNorm<1>();
+    eig_desc.array() /= norm;
+    eig_desc.array() = eig_desc.array().sqrt();
+  }
 }
 
 
@@ -296,63 +296,77 @@ void ImGradientDescriptor::Cut(std::vector<float> &desc)
  * compute gradient descriptor of center point (sift like)
  * we use a 3x3 sobel kernel
  * @param im image patch to compute the descriptor (min. 18x18 = 16x16 + 1px boarder)
+ * @param desc pointer to DESC_SIZE floats
  */
-void ImGradientDescriptor::compute(const cv::Mat_<unsigned char> &im, std::vector<float> &desc)
+void ImGradientDescriptor::compute(const cv::Mat_<unsigned char> &im, float *desc)
 {
-  ComputeLTGauss(im);
+  ComputeLTGauss(im.rows, im.cols);
 
   ComputeGradients(im);
 
   #ifdef IMGD_INTERPOLATED
   ComputeDescriptorInterpolate(desc, lt_gauss);
   #else
-  ComputeDescriptor(desc, lt_gauss);
+  ComputeDescriptor(im_dx, im_dy, lt_gauss, desc);
   #endif
 
-  if (param.normalize)
-  {
-    Normalize(desc);   // to 1
-    Cut(desc);         // cut 0.2
-    Normalize(desc);   // renormalize to 1
-  }
-
-  if (param.computeRootGD)
-  {
-    Eigen::Map<Eigen::VectorXf> eig_desc(&desc[0], desc.size());
-    float norm = eig_desc.lpNorm<1>();
-    eig_desc.array() /= norm;
-    eig_desc.array() = eig_desc.array().sqrt();
-  }
+  PostProcess(desc);
 }
 
 /**
  * compute gradient descriptor of center point (sift like)
  * we use a 3x3 sobel kernel
  * @param im image patch to compute the descriptor (min. 18x18 = 16x16 + 1px boarder)
+ * @param desc pointer to DESC_SIZE floats
  */
-void ImGradientDescriptor::compute(const cv::Mat_<unsigned char> &im, const cv::Mat_<float> &weight, std::vector<float> &desc)
+void ImGradientDescriptor::compute(const cv::Mat_<unsigned char> &im, const cv::Mat_<float> &weight, float *desc)
 {
   ComputeGradients(im);
 
   #ifdef IMGD_INTERPOLATED
   ComputeDescriptorInterpolate(desc, weight);
   #else
-  ComputeDescriptor(desc, weight);
+  ComputeDescriptor(im_dx, im_dy, weight, desc);
   #endif
 
-  if (param.normalize)
-  {
-    Normalize(desc);   // to 1
-    Cut(desc);         // cut 0.2
-    Normalize(desc);   // renormalize to 1
-  }
+  PostProcess(desc);
+}
 
-  if (param.computeRootGD)
-  {
-    Eigen::Map<Eigen::VectorXf> eig_desc(&desc[0], desc.size());
-    float norm = eig_desc.lpNorm<1>();
-    eig_desc.array() /= norm;
-    eig_desc.array() = eig_desc.array().sqrt();
-  }
+/**
+ * compute gradient descriptor from a gradient patch (e.g. sampled from the gradients of the whole image)
+ * @param dx gradient patch in x-direction (the 1px boarder is not used)
+ * @param dy gradient patch in y-direction
+ * @param desc pointer to DESC_SIZE floats
+ */
+void ImGradientDescriptor::compute(const cv::Mat_<float> &dx, const cv::Mat_<float> &dy, float *desc)
+{
+  ComputeLTGauss(dx.rows, dx.cols);
+
+  ComputeDescriptor(dx, dy, lt_gauss, desc);
+
+  PostProcess(desc);
+}
+
+/**
+ * compute gradient descriptor of center point (sift like)
+ * we use a 3x3 sobel kernel
+ * @param im image patch to compute the descriptor (min. 18x18 = 16x16 + 1px boarder)
+ */
+void ImGradientDescriptor::compute(const cv::Mat_<unsigned char> &im, std::vector<float> &desc)
+{
+  desc.resize(DESC_SIZE);
+  compute(im, &desc[0]);
 }
+
+/**
+ * compute gradient descriptor of center point (sift like)
+ * we use a 3x3 sobel kernel
+ * @param im image patch to compute the descriptor (min. 18x18 = 16x16 + 1px boarder)
+ */
+void ImGradientDescriptor::compute(const cv::Mat_<unsigned char> &im, const cv::Mat_<float> &weight, std::vector<float> &desc)
+{
+  desc.resize(DESC_SIZE);
+  compute(im, weight, &desc[0]);
+}
+
 }
@@ -1,3 +1,266 @@
+/******************************************************************************
+ * Copyright (c) 2012 Aitor Aldoma, Thomas Faeulhammer
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ ******************************************************************************/
+
 #include <v4r/features/esf_estimator.h>
 
-template class V4R_EXPORTS v4r::ESFEstimation<pcl::PointXYZ>;
+#include <pcl/point_types.h>
+#include <boost/random.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace v4r
+{
+
+namespace
+{
+const int GRID_SIZE = 64;
+const int GRID_SIZE_H = GRID_SIZE / 2;
+const int NUM_BINS = 64;
+const int NUM_CHUNKS = 64;   // fixed number of random number streams, independent of the number of threads
+
+inline int
+bin (float val, float max_val)
+{
+    return std::min<int> (NUM_BINS - 1, static_cast<int> (val / max_val * NUM_BINS));
+}
+}
+
+template<typename PointT>
+inline float
+ESFEstimation<PointT>::lineRatio (const Eigen::Vector3f &a, const Eigen::Vector3f &b) const
+{
+    const Eigen::Vector3f d = b - a;
+    const int steps = static_cast<int> (std::ceil (d.cwiseAbs ().maxCoeff ()));
+
+    if (steps < 2)
+        return 1.f;
+
+    const Eigen::Vector3f step = d / steps;
+    Eigen::Vector3f p = a + step;
+    int occupied = 0;
+
+    for (int s = 1; s < steps; s++, p += step)
+    {
+        const int x = static_cast<int> (p[0] + 0.5f);
+        const int y = static_cast<int> (p[1] + 0.5f);
+        const int z = static_cast<int> (p[2] + 0.5f);
+        occupied += grid_[ (x * GRID_SIZE + y) * GRID_SIZE + z ];
+    }
+
+    return occupied / static_cast<float> (steps - 1);
+}
+
+template<typename PointT>
+void
+ESFEstimation<PointT>::voxelize ()
+{
+    Eigen::Vector3f centroid = Eigen::Vector3f::Zero ();
+    for (size_t i = 0; i < points_.size (); i++)
+        centroid += points_[i];
+    centroid /= static_cast<float> (points_.size ());
+
+    float max_dist2 = 0.f;
+    for (size_t i = 0; i < points_.size (); i++)
+        max_dist2 = std::max (max_dist2, (points_[i] - centroid).squaredNorm ());
+
+    // the object is scaled into the grid such that the dilated voxels stay inside
+    const float scale = max_dist2 > 0.f ? (GRID_SIZE_H - 2) / std::sqrt (max_dist2) : 1.f;
+    const Eigen::Vector3f offset = Eigen::Vector3f::Constant (GRID_SIZE_H);
+
+    grid_.assign (GRID_SIZE * GRID_SIZE * GRID_SIZE, 0);
+
+    for (size_t i = 0; i < points_.size (); i++)
+    {
+        points_[i] = (points_[i] - centroid) * scale + offset;
+
+        const int x = static_cast<int> (points_[i][0] + 0.5f);
+        const int y = static_cast<int> (points_[i][1] + 0.5f);
+        const int z = static_cast<int> (points_[i][2] + 0.5f);
+        const int idx = (x * GRID_SIZE + y) * GRID_SIZE + z;
+
+        grid_[idx] = 1;
+        grid_[idx - 1] = grid_[idx + 1] = 1;
+        grid_[idx - GRID_SIZE] = grid_[idx + GRID_SIZE] = 1;
+        grid_[idx - GRID_SIZE * GRID_SIZE] = grid_[idx + GRID_SIZE * GRID_SIZE] = 1;
+    }
+}
+
+template<typename PointT>
+void
+ESFEstimation<PointT>::sample (int num_threads)
+{
+    const int num_samples = static_cast<int> (param_.num_samples_);
+    const int num_pts = static_cast<int> (points_.size ());
+
+    d2_.resize (3 * num_samples);
+    d2_ratio_.resize (3 * num_samples);
+    d3_.resize (num_samples);
+    d3_ratio_.resize (num_samples);
+    a3_.resize (num_samples);
+    a3_ratio_.resize (num_samples);
+
+#pragma omp parallel for schedule(dynamic) num_threads(num_threads)
+    for (int c = 0; c < NUM_CHUNKS; c++)
+    {
+        boost::mt19937 rng (param_.seed_ * NUM_CHUNKS + c);
+        boost::uniform_int<int> dist (0, num_pts - 1);
+        boost::variate_generator<boost::mt19937 &, boost::uniform_int<int> > rand_idx (rng, dist);
+
+        const int t_end = static_cast<int> ((long) (c + 1) * num_samples / NUM_CHUNKS);
+        for (int t = static_cast<int> ((long) c * num_samples / NUM_CHUNKS); t < t_end; t++)
+        {
+            int idx1, idx2, idx3;
+            do
+            {
+                idx1 = rand_idx ();
+                idx2 = rand_idx ();
+                idx3 = rand_idx ();
+            }
+            while (idx1 == idx2 || idx1 == idx3 || idx2 == idx3);
+
+            const Eigen::Vector3f &p1 = points_[idx1];
+            const Eigen::Vector3f &p2 = points_[idx2];
+            const Eigen::Vector3f &p3 = points_[idx3];
+            const Eigen::Vector3f v21 = p2 - p1;
+            const Eigen::Vector3f v31 = p3 - p1;
+
+            // D2: distance of the three point pairs
+            const float r12 = lineRatio (p1, p2);
+            const float r13 = lineRatio (p1, p3);
+            const float r23 = lineRatio (p2, p3);
+            d2_[3 * t] = v21.norm ();
+            d2_[3 * t + 1] = v31.norm ();
+            d2_[3 * t + 2] = (p3 - p2).norm ();
+            d2_ratio_[3 * t] = r12;
+            d2_ratio_[3 * t + 1] = r13;
+            d2_ratio_[3 * t + 2] = r23;
+
+            // D3: square root of the triangle area
+            d3_[t] = std::sqrt (0.5f * v21.cross (v31).norm ());
+            d3_ratio_[t] = (r12 + r13 + r23) / 3.f;
+
+            // A3: angle at p1, classified by its opposite line
+            const float norms = d2_[3 * t] * d2_[3 * t + 1];
+            const float cos_a = norms > 0.f ? v21.dot (v31) / norms : 1.f;
+            a3_[t] = std::acos (std::max (-1.f, std::min (1.f, cos_a)));
+            a3_ratio_[t] = r23;
+        }
+    }
+}
+
+template<typename PointT>
+void
+ESFEstimation<PointT>::computeHistograms (std::vector<float> &signature, int num_threads) const
+{
+    const int num_samples = static_cast<int> (param_.num_samples_);
+    const float max_d2 = std::max (*std::max_element (d2_.begin (), d2_.end ()), std::numeric_limits<float>::epsilon ());
+    const float max_d3 = std::max (*std::max_element (d3_.begin (), d3_.end ()), std::numeric_limits<float>::epsilon ());
+    const float max_a3 = static_cast<float> (M_PI);
+
+    // offsets of the histograms in the signature, each one has an in/out/mixed part
+    const int D2 = 0, D2_RATIO = 3 * NUM_BINS, A3 = 4 * NUM_BINS, D3 = 7 * NUM_BINS;
+
+    signature.assign (10 * NUM_BINS, 0.f);
+
+#pragma omp parallel num_threads(num_threads)
+    {
+        std::vector<float> hist (signature.size (), 0.f);
+
+        // 0 ... in, 1 ... out, 2 ... mixed
+#pragma omp for
+        for (int t = 0; t < num_samples; t++)
+        {
+            for (int k = 3 * t; k < 3 * t + 3; k++)
+            {
+                const float r = d2_ratio_[k];
+                const int cls = r >= 1.f ? 0 : (r <= 0.f ? 1 : 2);
+                hist[D2 + cls * NUM_BINS + bin (d2_[k], max_d2)]++;
+
+                if (cls == 2)
+                    hist[D2_RATIO + bin (r, 1.f)]++;
+            }
+
+            const float r_d3 = d3_ratio_[t];
+            hist[D3 + (r_d3 >= 1.f ? 0 : (r_d3 <= 0.f ? 1 : 2)) * NUM_BINS + bin (d3_[t], max_d3)]++;
+
+            const float r_a3 = a3_ratio_[t];
+            hist[A3 + (r_a3 >= 1.f ? 0 : (r_a3 <= 0.f ? 1 : 2)) * NUM_BINS + bin (a3_[t], max_a3)]++;
+        }
+
+#pragma omp critical
+        for (size_t i = 0; i < signature.size (); i++)
+            signature[i] += hist[i];
+    }
+}
+
+template<typename PointT>
+std::vector<float>
+ESFEstimation<PointT>::estimate ()
+{
+    CHECK(input_cloud_ && !input_cloud_->points.empty());
+
+    // gather the finite points of the object (without copying the cluster into a new cloud)
+    const size_t num_pts = indices_.empty () ? input_cloud_->points.size () : indices_.size ();
+    points_.clear ();
+    points_.reserve (num_pts);
+
+    for (size_t i = 0; i < num_pts; i++)
+    {
+        const PointT &pt = input_cloud_->points[ indices_.empty () ? i : indices_[i] ];
+        if (pcl_isfinite (pt.x) && pcl_isfinite (pt.y) && pcl_isfinite (pt.z))
+            points_.push_back (pt.getVector3fMap ());
+    }
+
+    indices_.clear ();
+
+    std::vector<float> signature (10 * NUM_BINS, 0.f);
+
+    if (points_.size () < 3 || param_.num_samples_ == 0)
+    {
+        LOG(WARNING) << "Not enough points (" << points_.size () << ") for computing the ESF descriptor.";
+        return signature;
+    }
+
+    int num_threads = param_.num_threads_;
+#ifdef _OPENMP
+    if (num_threads <= 0)
+        num_threads = omp_get_max_threads ();
+#endif
+    num_threads = std::max (1, num_threads);
+
+    voxelize ();
+    sample (num_threads);
+    computeHistograms (signature, num_threads);
+
+    return signature;
+}
+
+template class V4R_EXPORTS ESFEstimation<pcl::PointXYZ>;
+template class V4R_EXPORTS ESFEstimation<pcl::PointXYZRGB>;
+
+}
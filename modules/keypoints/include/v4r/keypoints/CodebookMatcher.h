@@ -43,7 +43,7 @@
 #include <Eigen/Dense>
 #include <stdexcept>
 #include <v4r/common/impl/SmartPtr.hpp>
-#include <v4r/common/ClusteringRNN.h>
+#include <v4r/common/ClusteringRNNFast.h>
 #include <v4r/core/macros.h>
 #include <v4r/keypoints/impl/triple.hpp>
 
@@ -59,14 +59,18 @@ public:
     float thr_desc_rnn;
     float nnr;
     float max_dist;
-    Parameter(float _thr_desc_rnn=0.55, float _nnr=0.92, float _max_dist=.7)
-    : thr_desc_rnn(_thr_desc_rnn), nnr(_nnr), max_dist(_max_dist) {}
+    int max_rnn_partition_size;   // approximate rnn clustering in partitions of max. size (0 .. no partitioning)
+    bool brute_force;             // exact L2 search (batched, multi-threaded) instead of the approximate FLANN search
+    Parameter(float _thr_desc_rnn=0.55, float _nnr=0.92, float _max_dist=.7, int _max_rnn_partition_size=2048,
+      bool _brute_force=false)
+    : thr_desc_rnn(_thr_desc_rnn), nnr(_nnr), max_dist(_max_dist), max_rnn_partition_size(_max_rnn_partition_size),
+      brute_force(_brute_force) {}
   };
 
 private:
   Parameter param;
 
-  ClusteringRNN rnn;
+  ClusteringRNNFast rnn;
 
   int max_view_index;
   DataMatrix2Df descs;
@@ -76,7 +80,20 @@ private:
   std::vector< std::vector< std::pair<int,int> > > cb_entries;
   std::vector< std::pair<int, int> > view_rank;
 
+  // flat (CSR) copy of cb_entries for the voting: entries of center i are [cb_offsets[i], cb_offsets[i+1])
+  std::vector<int> cb_offsets;
+  std::vector< std::pair<int,int> > cb_occs;
+  std::vector<int> view_cnt;
+
   cv::Ptr<cv::DescriptorMatcher> matcher;
+  cv::Mat_<float> bf_centers;         // codebook for the brute force search
+  std::vector<float> bf_sqr_norms;
+
+  void clusterDescriptors();
+  void createMatcher();
+  void knnMatch(const cv::Mat &descriptors, std::vector< std::vector< cv::DMatch > > &cb_matches);
+  void knnMatchBruteForce(const cv::Mat &descriptors, std::vector< std::vector< cv::DMatch > > &cb_matches);
+  void getViewRank(std::vector< std::pair<int, int> > &_view_rank);
 
 public:
   cv::Mat dbg;
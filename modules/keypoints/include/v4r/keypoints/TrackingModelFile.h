@@ -0,0 +1,124 @@
+/**
+ * $Id$
+ * 
+ * Software License Agreement (GNU General Public License)
+ *
+ *  Copyright (C) 2015:
+ *
+ *    Johann Prankl, prankl@acin.tuwien.ac.at
+ *    Aitor Aldoma, aldoma@acin.tuwien.ac.at
+ *
+ *      Automation and Control Institute
+ *      Vienna University of Technology
+ *      Gusshausstraße 25-29
+ *      1170 Vienn, Austria
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author Johann Prankl, Aitor Aldoma
+ *
+ */
+
+#ifndef KP_TRACKING_MODEL_FILE_HH
+#define KP_TRACKING_MODEL_FILE_HH
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <boost/thread/mutex.hpp>
+#include <v4r/core/macros.h>
+#include <v4r/common/impl/SmartPtr.hpp>
+#include <v4r/keypoints/ArticulatedObject.h>
+
+namespace v4r
+{
+
+/**
+ * TrackingModelFile
+ * Versioned, mmap-able container for tracking models (ArticulatedObject).
+ *
+ * Layout (native byte order, blocks aligned to 16 bytes):
+ *   FileHeader | core | view data 0 .. n-1 | view index
+ * The core is the boost serialized object without the heavy per view data, i.e. the camera poses,
+ * global points, codebook and for each view idx, camera_id, center and the global point indices.
+ * The view data (image, descriptors, keypoints, viewrays, camera points, projections, part indices)
+ * is stored in raw arrays and is loaded on demand (loadView). The image and the descriptors of a
+ * loaded view point to the (private) file mapping, i.e. the TrackingModelFile must be kept alive as
+ * long as the views are used.
+ */
+class V4R_EXPORTS TrackingModelFile
+{
+public:
+  static const char MAGIC[8];
+  static const uint32_t VERSION;
+
+private:
+  struct FileHeader
+  {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t core_offset;
+    uint64_t core_size;
+    uint64_t index_offset;
+    uint64_t num_views;
+  };
+
+  struct ViewIndexEntry
+  {
+    uint64_t offset;
+    uint64_t size;
+  };
+
+  unsigned char *data;
+  size_t data_size;
+
+  ArticulatedObject::Ptr model;
+  std::vector<ViewIndexEntry> index;
+  std::vector<int> loaded;
+
+  boost::mutex mtx_load;
+
+  void parseView(const ViewIndexEntry &entry, ObjectView &view);
+
+public:
+  TrackingModelFile();
+  ~TrackingModelFile();
+
+  /** map the file and load the core (codebook, global points, cameras, light weight views) **/
+  bool open(const std::string &file);
+  void close();
+
+  inline bool isOpen() const { return data!=0; }
+  inline const ArticulatedObject::Ptr &getModel() const { return model; }
+  inline unsigned getNumViews() const { return index.size(); }
+  inline bool isViewLoaded(unsigned idx) const { return loaded[idx]!=0; }
+
+  /** page in the data of a view (in place, views already used by e.g. a tracker are completed) **/
+  void loadView(unsigned idx);
+  void loadAllViews();
+  /** replace a view by its light weight version (holders of the old view pointer keep the data) **/
+  void releaseView(unsigned idx);
+
+  static bool write(const std::string &file, const ArticulatedObject &model);
+  static bool isTrackingModelFile(const std::string &file);
+
+  typedef SmartPtr< ::v4r::TrackingModelFile> Ptr;
+  typedef SmartPtr< ::v4r::TrackingModelFile const> ConstPtr;
+};
+
+} //--END--
+
+#endif
+
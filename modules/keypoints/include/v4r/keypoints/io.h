@@ -40,6 +40,7 @@
 #include <v4r/core/macros.h>
 #include <v4r/keypoints/ArticulatedObject.h>
 #include <v4r/keypoints/impl/ArticulatedObject_serialization.hpp>
+#include <v4r/keypoints/TrackingModelFile.h>
 
 namespace v4r
 {
@@ -47,6 +48,10 @@ namespace io
 {
   V4R_EXPORTS bool write(const std::string &file, const ArticulatedObject::Ptr &model);
   V4R_EXPORTS bool read(const std::string &file, ArticulatedObject::Ptr &model);
+
+  /** write/ read the TrackingModelFile format (read detects the format automatically) **/
+  V4R_EXPORTS bool writeBinary(const std::string &file, const ArticulatedObject::Ptr &model);
+  V4R_EXPORTS bool readBinary(const std::string &file, ArticulatedObject::Ptr &model);
 }
 }
 
@@ -32,6 +32,7 @@
 
 #include <v4r/keypoints/CodebookMatcher.h>
 #include <v4r/common/impl/ScopeTime.hpp>
+#include <algorithm>
 
 
 namespace v4r
@@ -97,17 +98,16 @@ void CodebookMatcher::addView(const cv::Mat &descriptors, int view_idx)
 }
 
 /**
- * @brief CodebookMatcher::createCodebook
+ * @brief CodebookMatcher::clusterDescriptors
+ * rnn clustering of the descriptors and conversion to the codebook
  */
-void CodebookMatcher::createCodebook()
+void CodebookMatcher::clusterDescriptors()
 {
-  v4r::ScopeTime t("CodebookMatcher::createCodebook");
-
-  // rnn clustering
   v4r::DataMatrix2Df centers;
   std::vector<std::vector<int> > clusters;
 
   rnn.param.dist_thr = param.thr_desc_rnn;
+  rnn.param.max_partition_size = param.max_rnn_partition_size;
   rnn.cluster(descs);
   rnn.getClusters(clusters);
   rnn.getCenters(centers);
@@ -118,23 +118,171 @@ void CodebookMatcher::createCodebook()
 
   for (unsigned i=0; i<clusters.size(); i++)
   {
+    cb_entries[i].reserve(clusters[i].size());
+
     for (unsigned j=0; j<clusters[i].size(); j++)
       cb_entries[i].push_back(vk_indices[clusters[i][j]]);
 
     cv::Mat_<float>(1,centers.cols,&centers(i,0)).copyTo(cb_centers.row(i));
   }
 
-  cout<<"codbeook.size()="<<clusters.size()<<"/"<<descs.rows<<endl;
+  cout<<"codbeook.size()="<<clusters.size()<<"/"<<descs.rows<<" (views: "<<max_view_index+1<<")"<<endl;
+}
+
+/**
+ * @brief CodebookMatcher::createMatcher
+ * Creates the flat entry table for the voting and the matcher (FLANN or the data for the
+ * brute force search)
+ */
+void CodebookMatcher::createMatcher()
+{
+  if (cb_centers.type()!=CV_32F)
+    throw std::runtime_error("[CodebookMatcher::createMatcher] Invalid codebook type (CV_32F required)!");
+
+  cb_offsets.resize(cb_entries.size()+1);
+  cb_offsets[0] = 0;
+
+  for (unsigned i=0; i<cb_entries.size(); i++)
+    cb_offsets[i+1] = cb_offsets[i] + cb_entries[i].size();
+
+  cb_occs.resize(cb_offsets.back());
 
-  // create flann for matching
-  { v4r::ScopeTime t("create FLANN");
-  matcher = new cv::FlannBasedMatcher();
-  matcher->add(std::vector<cv::Mat>(1,cb_centers));
-  matcher->train();
+  for (unsigned i=0; i<cb_entries.size(); i++)
+    std::copy(cb_entries[i].begin(), cb_entries[i].end(), cb_occs.begin()+cb_offsets[i]);
+
+  if (param.brute_force)
+  {
+    matcher.release();
+    cb_centers.copyTo(bf_centers);
+    bf_sqr_norms.resize(bf_centers.rows);
+
+    for (int i=0; i<bf_centers.rows; i++)
+      bf_sqr_norms[i] = bf_centers.row(i).dot(bf_centers.row(i));
   }
+  else
+  {
+    v4r::ScopeTime t("create FLANN");
+    bf_centers.release();
+    bf_sqr_norms.clear();
+    matcher = new cv::FlannBasedMatcher();
+    matcher->add(std::vector<cv::Mat>(1,cb_centers));
+    matcher->train();
+  }
+}
+
+/**
+ * @brief CodebookMatcher::knnMatchBruteForce
+ * Exact 2-nn search. The squared distances of a block of queries to all centers are computed
+ * with one matrix product (|q|^2 + |c|^2 - 2 q.c), blocks are processed in parallel.
+ * The distances are L2 as for cv::FlannBasedMatcher.
+ * @param descriptors
+ * @param cb_matches
+ */
+void CodebookMatcher::knnMatchBruteForce(const cv::Mat &descriptors, std::vector< std::vector< cv::DMatch > > &cb_matches)
+{
+  if (descriptors.type()!=CV_32F || descriptors.cols!=bf_centers.cols)
+    throw std::runtime_error("[CodebookMatcher::knnMatchBruteForce] Invalid descriptors!");
+
+  const int block_size = 256;
+  const int num_blocks = (descriptors.rows+block_size-1)/block_size;
+
+  cb_matches.clear();
+  cb_matches.resize(descriptors.rows);
+
+  #pragma omp parallel
+  {
+    cv::Mat_<float> dots;
+
+    #pragma omp for schedule(dynamic)
+    for (int b=0; b<num_blocks; b++)
+    {
+      const int start = b*block_size;
+      const int end = std::min(start+block_size, descriptors.rows);
+      const cv::Mat queries = descriptors.rowRange(start, end);
+
+      cv::gemm(queries, bf_centers, -2., cv::Mat(), 0., dots, cv::GEMM_2_T);
+
+      for (int i=0; i<dots.rows; i++)
+      {
+        const float q_norm = queries.row(i).dot(queries.row(i));
+        const float *d = &dots(i,0);
+        int idx0=-1, idx1=-1;
+        float dist0 = FLT_MAX, dist1 = FLT_MAX;
+
+        for (int j=0; j<dots.cols; j++)
+        {
+          const float dist = d[j] + bf_sqr_norms[j];
+
+          if (dist < dist1)
+          {
+            if (dist < dist0)
+            {
+              dist1 = dist0; idx1 = idx0;
+              dist0 = dist; idx0 = j;
+            }
+            else
+            {
+              dist1 = dist; idx1 = j;
+            }
+          }
+        }
+
+        std::vector< cv::DMatch > &ms = cb_matches[start+i];
+        if (idx0>=0) ms.push_back(cv::DMatch(start+i, idx0, 0, sqrt(std::max(dist0+q_norm,0.f))));
+        if (idx1>=0) ms.push_back(cv::DMatch(start+i, idx1, 0, sqrt(std::max(dist1+q_norm,0.f))));
+      }
+    }
+  }
+}
+
+/**
+ * @brief CodebookMatcher::knnMatch
+ * 2-nn search in the codebook
+ */
+void CodebookMatcher::knnMatch(const cv::Mat &descriptors, std::vector< std::vector< cv::DMatch > > &cb_matches)
+{
+  if (param.brute_force)
+  {
+    if (bf_centers.empty())
+      throw std::runtime_error("[CodebookMatcher::knnMatch] No codebook available!");
+    knnMatchBruteForce(descriptors, cb_matches);
+  }
+  else
+  {
+    if (matcher.empty())
+      throw std::runtime_error("[CodebookMatcher::knnMatch] No codebook available!");
+    matcher->knnMatch( descriptors, cb_matches, 2 );
+  }
+}
+
+/**
+ * @brief CodebookMatcher::getViewRank
+ * converts the view votes to the view rank
+ */
+void CodebookMatcher::getViewRank(std::vector< std::pair<int, int> > &_view_rank)
+{
+  _view_rank.resize(view_cnt.size());
+
+  for (unsigned i=0; i<_view_rank.size(); i++)
+    _view_rank[i] = std::make_pair((int)i,view_cnt[i]);
+
+  //sort
+  std::sort(_view_rank.begin(),_view_rank.end(),cmpViewRandDec);
+}
+
+/**
+ * @brief CodebookMatcher::createCodebook
+ */
+void CodebookMatcher::createCodebook()
+{
+  v4r::ScopeTime t("CodebookMatcher::createCodebook");
+
+  clusterDescriptors();
+
+  createMatcher();
 
   // once the codebook is created clear the temp containers
-  rnn = ClusteringRNN();
+  rnn = ClusteringRNNFast();
   descs = DataMatrix2Df();
   vk_indices = std::vector< std::pair<int,int> >();
   cb_centers.release();
@@ -150,42 +298,16 @@ void CodebookMatcher::createCodebook(cv::Mat &_cb_centers, std::vector< std::vec
 {
   v4r::ScopeTime t("CodebookMatcher::createCodebook");
 
-  // rnn clustering
-  v4r::DataMatrix2Df centers;
-  std::vector<std::vector<int> > clusters;
-
-  rnn.param.dist_thr = param.thr_desc_rnn;
-  rnn.cluster(descs);
-  rnn.getClusters(clusters);
-  rnn.getCenters(centers);
+  clusterDescriptors();
 
-  cb_entries.clear();
-  cb_entries.resize(clusters.size());
-  cb_centers = cv::Mat_<float>(clusters.size(), centers.cols);
-
-  for (unsigned i=0; i<clusters.size(); i++)
-  {
-    for (unsigned j=0; j<clusters[i].size(); j++)
-      cb_entries[i].push_back(vk_indices[clusters[i][j]]);
-
-    cv::Mat_<float>(1,centers.cols,&centers(i,0)).copyTo(cb_centers.row(i));
-  }
-
-  cout<<"codbeook.size()="<<clusters.size()<<"/"<<descs.rows<<endl;
-
-  // create flann for matching
-  { v4r::ScopeTime t("create FLANN");
-  matcher = new cv::FlannBasedMatcher();
-  matcher->add(std::vector<cv::Mat>(1,cb_centers));
-  matcher->train();
-  }
+  createMatcher();
 
   // return codebook
   cb_centers.copyTo(_cb_centers);
   _cb_entries = cb_entries;
 
   // once the codebook is created clear the temp containers
-  rnn = ClusteringRNN();
+  rnn = ClusteringRNNFast();
   descs = DataMatrix2Df();
   vk_indices = std::vector< std::pair<int,int> >();
   cb_centers.release();
@@ -210,14 +332,7 @@ void CodebookMatcher::setCodebook(const cv::Mat &_cb_centers, const std::vector<
 
   max_view_index++;
 
-  // create flann for matching
-  { v4r::ScopeTime t("create FLANN");
-  matcher = new cv::FlannBasedMatcher();
-  matcher->add(std::vector<cv::Mat>(1,cb_centers));
-  matcher->train();
-  }
-
-
+  createMatcher();
 }
 
 /**
@@ -229,12 +344,9 @@ void CodebookMatcher::queryViewRank(const cv::Mat &descriptors, std::vector< std
 {
   std::vector< std::vector< cv::DMatch > > cb_matches;
 
-  matcher->knnMatch( descriptors, cb_matches, 2 );
-
-  view_rank.resize(max_view_index+1);
+  knnMatch( descriptors, cb_matches );
 
-  for (unsigned i=0; i<view_rank.size(); i++)
-    view_rank[i] = std::make_pair((int)i,0.);
+  view_cnt.assign(max_view_index+1, 0);
 
   for (unsigned i=0; i<cb_matches.size(); i++)
   {
@@ -244,16 +356,15 @@ void CodebookMatcher::queryViewRank(const cv::Mat &descriptors, std::vector< std
 
       if (ma0.distance/cb_matches[i][1].distance < param.nnr)
       {
-        const std::vector< std::pair<int,int> > &occs = cb_entries[ma0.trainIdx];
+        const int end = cb_offsets[ma0.trainIdx+1];
 
-        for (unsigned j=0; j<occs.size(); j++)
-          view_rank[occs[j].first].second++;
+        for (int j=cb_offsets[ma0.trainIdx]; j<end; j++)
+          view_cnt[cb_occs[j].first]++;
       }
     }
   }
 
-  //sort
-  std::sort(view_rank.begin(),view_rank.end(),cmpViewRandDec);
+  getViewRank(view_rank);
 }
 
 /**
@@ -265,14 +376,11 @@ void CodebookMatcher::queryMatches(const cv::Mat &descriptors, std::vector< std:
 {
   std::vector< std::vector< cv::DMatch > > cb_matches;
 
-  matcher->knnMatch( descriptors, cb_matches, 2 );
+  knnMatch( descriptors, cb_matches );
 
   matches.clear();
   matches.resize(descriptors.rows);
-  view_rank.resize(max_view_index+1);
-
-  for (unsigned i=0; i<view_rank.size(); i++)
-    view_rank[i] = std::make_pair((int)i,0.);
+  view_cnt.assign(max_view_index+1, 0);
 
   for (unsigned i=0; i<cb_matches.size(); i++)
   {
@@ -282,34 +390,25 @@ void CodebookMatcher::queryMatches(const cv::Mat &descriptors, std::vector< std:
       if (ma0.distance < param.max_dist && ma0.distance/cb_matches[i][1].distance < param.nnr)
       {
         std::vector< cv::DMatch > &ms = matches[ma0.queryIdx];
-        const std::vector< std::pair<int,int> > &occs = cb_entries[ma0.trainIdx];
+        const int start = cb_offsets[ma0.trainIdx];
+        const int end = cb_offsets[ma0.trainIdx+1];
+
+        ms.reserve(end-start);
 
-        for (unsigned j=0; j<occs.size(); j++)
+        for (int j=start; j<end; j++)
         {
-          ms.push_back(cv::DMatch(ma0.queryIdx,occs[j].second,occs[j].first,ma0.distance));
-          view_rank[occs[j].first].second++;
+          const std::pair<int,int> &occ = cb_occs[j];
+          ms.push_back(cv::DMatch(ma0.queryIdx,occ.second,occ.first,ma0.distance));
+          view_cnt[occ.first]++;
         }
       }
     }
   }
 
-  //sort
-  std::sort(view_rank.begin(),view_rank.end(),cmpViewRandDec);
+  getViewRank(view_rank);
 }
 
 
 
 
 }
-
-
-
-
-
-
-
-
-
-
-
-
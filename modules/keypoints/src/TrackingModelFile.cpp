@@ -0,0 +1,515 @@
+/**
+ * $Id$
+ * 
+ * Software License Agreement (GNU General Public License)
+ *
+ *  Copyright (C) 2015:
+ *
+ *    Johann Prankl, prankl@acin.tuwien.ac.at
+ *    Aitor Aldoma, aldoma@acin.tuwien.ac.at
+ *
+ *      Automation and Control Institute
+ *      Vienna University of Technology
+ *      Gusshausstraße 25-29
+ *      1170 Vienn, Austria
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author Johann Prankl, Aitor Aldoma
+ *
+ */
+
+#include <v4r/keypoints/TrackingModelFile.h>
+#include <v4r/keypoints/impl/ArticulatedObject_serialization.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/stream.hpp>
+#include <fstream>
+#include <sstream>
+#include <string.h>
+#include <algorithm>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace v4r
+{
+
+using namespace std;
+
+const char TrackingModelFile::MAGIC[8] = {'V','4','R','T','M','F','\0','\0'};
+const uint32_t TrackingModelFile::VERSION = 1;
+
+static const uint32_t BYTE_ORDER_MARK = 0x01020304;
+static const uint64_t BLOCK_ALIGN = 16;
+
+/**
+ * records of the raw view arrays
+ */
+struct KeyPointRecord
+{
+  float x, y, size, angle, response;
+  int32_t octave, class_id, pad;
+};
+
+struct ProjRecord
+{
+  int32_t cam;
+  float u, v;
+  float x, y, z;
+};
+
+inline uint64_t alignBlock(uint64_t size)
+{
+  return (size + BLOCK_ALIGN-1) & ~(BLOCK_ALIGN-1);
+}
+
+/**
+ * writeBlock
+ * [uint64 size | uint64 reserved | data | padding]
+ */
+static void writeBlock(std::ofstream &out, const void *d, uint64_t size)
+{
+  static const char zeros[BLOCK_ALIGN] = {0};
+  uint64_t head[2] = {size, 0};
+  out.write((const char*)head, sizeof(head));
+  if (size>0) out.write((const char*)d, size);
+  out.write(zeros, alignBlock(size)-size);
+}
+
+/**
+ * readBlock
+ * reads the block at offs of the view data [0, view_size) (sizes are checked without pointer arithmetic)
+ */
+static const unsigned char *readBlock(const unsigned char *view_data, uint64_t view_size, uint64_t &offs, uint64_t &size)
+{
+  if (offs > view_size || view_size-offs < 2*sizeof(uint64_t))
+    throw std::runtime_error("[TrackingModelFile] Corrupted view data!");
+
+  memcpy(&size, view_data+offs, sizeof(uint64_t));
+  offs += 2*sizeof(uint64_t);
+
+  if (size > view_size-offs)
+    throw std::runtime_error("[TrackingModelFile] Corrupted view data!");
+
+  const unsigned char *d = view_data+offs;
+  offs += std::min(alignBlock(size), view_size-offs);
+  return d;
+}
+
+/**
+ * isValidMatType
+ */
+inline bool isValidMatType(int32_t type)
+{
+  return type>=0 && type==CV_MAT_TYPE(type) && CV_MAT_DEPTH(type)<=CV_64F;
+}
+
+/**
+ * writeMatRows (handles non continuous matrices)
+ */
+static void writeMat(std::ofstream &out, const cv::Mat &m)
+{
+  if (m.empty() || m.isContinuous())
+  {
+    writeBlock(out, m.data, m.total()*m.elemSize());
+    return;
+  }
+
+  cv::Mat tmp = m.clone();
+  writeBlock(out, tmp.data, tmp.total()*tmp.elemSize());
+}
+
+
+
+
+/************************************************************************************
+ * Constructor/Destructor
+ */
+TrackingModelFile::TrackingModelFile()
+ : data(0), data_size(0)
+{
+}
+
+TrackingModelFile::~TrackingModelFile()
+{
+  close();
+}
+
+
+
+/************************************** PRIVATE ************************************/
+
+/**
+ * parseView
+ * All blocks are validated before the view is modified, i.e. a corrupted file results in an exception
+ * and leaves the view untouched.
+ */
+void TrackingModelFile::parseView(const ViewIndexEntry &entry, ObjectView &view)
+{
+  enum { DIMS=0, IMAGE, DESCS, KEYS, VIEWRAYS, CAM_POINTS, PROJ_SIZES, PROJS, PART_INDICES, NUM_BLOCKS };
+
+  if (entry.offset > data_size || entry.size > data_size-entry.offset)
+    throw std::runtime_error("[TrackingModelFile::loadView] Corrupted view index!");
+
+  const unsigned char *blocks[NUM_BLOCKS];
+  uint64_t sizes[NUM_BLOCKS];
+  uint64_t offs = 0;
+
+  for (int i=0; i<NUM_BLOCKS; i++)
+    blocks[i] = readBlock(data+entry.offset, entry.size, offs, sizes[i]);
+
+  // dims: image rows/cols, descriptor rows/cols/type
+  if (sizes[DIMS]!=8*sizeof(int32_t))
+    throw std::runtime_error("[TrackingModelFile::loadView] Corrupted view data!");
+  int32_t dims[8];
+  memcpy(dims, blocks[DIMS], sizeof(dims));
+
+  if (dims[0]<0 || dims[1]<0 || dims[2]<0 || dims[3]<0)
+    throw std::runtime_error("[TrackingModelFile::loadView] Corrupted view dimensions!");
+  if ((dims[2]>0 && dims[3]>0) && !isValidMatType(dims[4]))
+    throw std::runtime_error("[TrackingModelFile::loadView] Invalid descriptor type!");
+  if (sizes[IMAGE] != uint64_t(dims[0])*uint64_t(dims[1]))
+    throw std::runtime_error("[TrackingModelFile::loadView] Corrupted image data!");
+  if (sizes[DESCS] != (dims[2]>0 && dims[3]>0 ? uint64_t(dims[2])*uint64_t(dims[3])*CV_ELEM_SIZE(dims[4]) : 0))
+    throw std::runtime_error("[TrackingModelFile::loadView] Corrupted descriptor data!");
+
+  if (sizes[KEYS]%sizeof(KeyPointRecord)!=0 || sizes[VIEWRAYS]%sizeof(Eigen::Vector3f)!=0 ||
+      sizes[CAM_POINTS]%sizeof(Eigen::Vector3f)!=0 || sizes[PROJ_SIZES]%sizeof(uint32_t)!=0 ||
+      sizes[PROJS]%sizeof(ProjRecord)!=0 || sizes[PART_INDICES]%sizeof(int32_t)!=0)
+    throw std::runtime_error("[TrackingModelFile::loadView] Corrupted view data!");
+
+  const uint32_t *proj_sizes = (const uint32_t*)blocks[PROJ_SIZES];
+  const uint64_t num_proj_sizes = sizes[PROJ_SIZES]/sizeof(uint32_t);
+  const uint64_t num_projs = sizes[PROJS]/sizeof(ProjRecord);
+  uint64_t sum_projs = 0;
+  for (uint64_t i=0; i<num_proj_sizes; i++)
+    sum_projs += proj_sizes[i];
+  if (sum_projs!=num_projs)
+    throw std::runtime_error("[TrackingModelFile::loadView] Corrupted projections!");
+
+  // the matrices point to the private mapping (copy on write)
+  if (dims[0]>0 && dims[1]>0) view.image = cv::Mat_<unsigned char>(dims[0], dims[1], (unsigned char*)blocks[IMAGE]);
+  else view.image = cv::Mat_<unsigned char>();
+
+  if (dims[2]>0 && dims[3]>0) view.descs = cv::Mat(dims[2], dims[3], dims[4], (void*)blocks[DESCS]);
+  else view.descs = cv::Mat();
+
+  const KeyPointRecord *keys = (const KeyPointRecord*)blocks[KEYS];
+  view.keys.resize(sizes[KEYS]/sizeof(KeyPointRecord));
+  for (unsigned i=0; i<view.keys.size(); i++)
+  {
+    const KeyPointRecord &k = keys[i];
+    view.keys[i] = cv::KeyPoint(k.x, k.y, k.size, k.angle, k.response, k.octave, k.class_id);
+  }
+
+  view.viewrays.resize(sizes[VIEWRAYS]/sizeof(Eigen::Vector3f));
+  if (sizes[VIEWRAYS]>0) memcpy(&view.viewrays[0], blocks[VIEWRAYS], sizes[VIEWRAYS]);
+
+  view.cam_points.resize(sizes[CAM_POINTS]/sizeof(Eigen::Vector3f));
+  if (sizes[CAM_POINTS]>0) memcpy(&view.cam_points[0], blocks[CAM_POINTS], sizes[CAM_POINTS]);
+
+  const ProjRecord *projs = (const ProjRecord*)blocks[PROJS];
+  uint64_t z=0;
+  view.projs.resize(num_proj_sizes);
+  for (unsigned i=0; i<view.projs.size(); i++)
+  {
+    std::vector< triple<int, cv::Point2f, Eigen::Vector3f> > &ps = view.projs[i];
+    ps.resize(proj_sizes[i]);
+
+    for (unsigned j=0; j<ps.size(); j++, z++)
+    {
+      const ProjRecord &p = projs[z];
+      ps[j] = triple<int, cv::Point2f, Eigen::Vector3f>(p.cam, cv::Point2f(p.u,p.v), Eigen::Vector3f(p.x,p.y,p.z));
+    }
+  }
+
+  view.part_indices.resize(sizes[PART_INDICES]/sizeof(int32_t));
+  if (sizes[PART_INDICES]>0) memcpy(&view.part_indices[0], blocks[PART_INDICES], sizes[PART_INDICES]);
+}
+
+
+/************************************** PUBLIC ************************************/
+
+/**
+ * @brief TrackingModelFile::open
+ * @param file
+ * @return false if the file can not be opened or is not a tracking model file
+ */
+bool TrackingModelFile::open(const std::string &file)
+{
+  close();
+
+  int fd = ::open(file.c_str(), O_RDONLY);
+  if (fd<0)
+    return false;
+
+  struct stat st;
+  if (fstat(fd, &st)!=0 || st.st_size < (off_t)sizeof(FileHeader))
+  {
+    ::close(fd);
+    return false;
+  }
+
+  data_size = st.st_size;
+  void *ptr = mmap(0, data_size, PROT_READ|PROT_WRITE, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+
+  if (ptr==MAP_FAILED)
+  {
+    data_size = 0;
+    return false;
+  }
+
+  data = (unsigned char*)ptr;
+
+  const FileHeader &header = *(const FileHeader*)data;
+
+  if (memcmp(header.magic, MAGIC, sizeof(MAGIC))!=0 || header.byte_order!=BYTE_ORDER_MARK ||
+      header.core_offset > data_size || header.core_size > data_size-header.core_offset ||
+      header.index_offset > data_size || header.num_views > (data_size-header.index_offset)/sizeof(ViewIndexEntry))
+  {
+    close();
+    return false;
+  }
+
+  if (header.version > VERSION)
+  {
+    close();
+    throw std::runtime_error("[TrackingModelFile::open] Unsupported file version!");
+  }
+
+  // load core
+  try
+  {
+    boost::iostreams::stream<boost::iostreams::array_source> is((const char*)data+header.core_offset, header.core_size);
+    boost::archive::binary_iarchive ia(is);
+    ia >> model;
+  }
+  catch (const std::exception &e)
+  {
+    close();
+    throw std::runtime_error(std::string("[TrackingModelFile::open] Corrupted model: ")+e.what());
+  }
+
+  // load index
+  const ViewIndexEntry *entries = (const ViewIndexEntry*)(data+header.index_offset);
+  index.assign(entries, entries+header.num_views);
+  loaded.assign(index.size(), 0);
+
+  if (model.get()==0 || model->views.size()!=index.size())
+  {
+    close();
+    throw std::runtime_error("[TrackingModelFile::open] Number of views does not match the index!");
+  }
+
+  return true;
+}
+
+/**
+ * @brief TrackingModelFile::close
+ */
+void TrackingModelFile::close()
+{
+  if (data!=0)
+    munmap(data, data_size);
+
+  data = 0;
+  data_size = 0;
+  index.clear();
+  loaded.clear();
+  model.reset();
+}
+
+/**
+ * @brief TrackingModelFile::loadView
+ * @param idx
+ */
+void TrackingModelFile::loadView(unsigned idx)
+{
+  if (data==0 || idx>=index.size())
+    throw std::runtime_error("[TrackingModelFile::loadView] Invalid view index or file not open!");
+
+  boost::mutex::scoped_lock lock(mtx_load);
+
+  if (loaded[idx])
+    return;
+
+  parseView(index[idx], *model->views[idx]);
+  loaded[idx] = 1;
+}
+
+/**
+ * @brief TrackingModelFile::loadAllViews
+ */
+void TrackingModelFile::loadAllViews()
+{
+  for (unsigned i=0; i<index.size(); i++)
+    loadView(i);
+}
+
+/**
+ * @brief TrackingModelFile::releaseView
+ * @param idx
+ */
+void TrackingModelFile::releaseView(unsigned idx)
+{
+  if (data==0 || idx>=index.size())
+    throw std::runtime_error("[TrackingModelFile::releaseView] Invalid view index or file not open!");
+
+  boost::mutex::scoped_lock lock(mtx_load);
+
+  if (!loaded[idx])
+    return;
+
+  const ObjectView &view = *model->views[idx];
+  ObjectView::Ptr light(new ObjectView(model.get(), view.camera_id));
+  light->idx = view.idx;
+  light->center = view.center;
+  light->points = view.points;
+
+  model->views[idx] = light;
+  loaded[idx] = 0;
+}
+
+/**
+ * @brief TrackingModelFile::write
+ * @param file
+ * @param model
+ * @return
+ */
+bool TrackingModelFile::write(const std::string &file, const ArticulatedObject &model)
+{
+  std::ofstream out(file.c_str(), std::ios::out | std::ios::binary);
+
+  if (!out.is_open())
+    return false;
+
+  // core: shallow copy of the object with light weight views
+  ArticulatedObject::Ptr core(new ArticulatedObject(model));
+  core->views.resize(model.views.size());
+
+  for (unsigned i=0; i<model.views.size(); i++)
+  {
+    const ObjectView &view = *model.views[i];
+    core->views[i].reset(new ObjectView(core.get(), view.camera_id));
+    core->views[i]->idx = view.idx;
+    core->views[i]->center = view.center;
+    core->views[i]->points = view.points;
+  }
+
+  std::ostringstream oss(std::ios::out | std::ios::binary);
+  {
+    boost::archive::binary_oarchive oa(oss);
+    oa << core;
+  }
+  std::string core_data = oss.str();
+
+  FileHeader header;
+  memset(&header, 0, sizeof(FileHeader));
+  memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.version = VERSION;
+  header.byte_order = BYTE_ORDER_MARK;
+  header.num_views = model.views.size();
+
+  out.write((const char*)&header, sizeof(FileHeader));
+
+  header.core_offset = out.tellp();
+  header.core_size = core_data.size();
+  out.write(core_data.data(), core_data.size());
+
+  static const char zeros[BLOCK_ALIGN] = {0};
+  out.write(zeros, alignBlock(header.core_offset+header.core_size)-(header.core_offset+header.core_size));
+
+  // view data
+  std::vector<ViewIndexEntry> entries(model.views.size());
+  std::vector<KeyPointRecord> keys;
+  std::vector<uint32_t> proj_sizes;
+  std::vector<ProjRecord> projs;
+
+  for (unsigned i=0; i<model.views.size(); i++)
+  {
+    const ObjectView &view = *model.views[i];
+    entries[i].offset = out.tellp();
+
+    int32_t dims[8] = { view.image.rows, view.image.cols, view.descs.rows, view.descs.cols, view.descs.type(), 0, 0, 0 };
+    writeBlock(out, dims, sizeof(dims));
+    writeMat(out, view.image);
+    writeMat(out, view.descs);
+
+    keys.resize(view.keys.size());
+    for (unsigned j=0; j<view.keys.size(); j++)
+    {
+      const cv::KeyPoint &k = view.keys[j];
+      KeyPointRecord &r = keys[j];
+      r.x = k.pt.x; r.y = k.pt.y; r.size = k.size; r.angle = k.angle; r.response = k.response;
+      r.octave = k.octave; r.class_id = k.class_id; r.pad = 0;
+    }
+    writeBlock(out, (keys.size()>0?&keys[0]:0), keys.size()*sizeof(KeyPointRecord));
+    writeBlock(out, (view.viewrays.size()>0?&view.viewrays[0]:0), view.viewrays.size()*sizeof(Eigen::Vector3f));
+    writeBlock(out, (view.cam_points.size()>0?&view.cam_points[0]:0), view.cam_points.size()*sizeof(Eigen::Vector3f));
+
+    proj_sizes.resize(view.projs.size());
+    projs.clear();
+    for (unsigned j=0; j<view.projs.size(); j++)
+    {
+      proj_sizes[j] = view.projs[j].size();
+      for (unsigned k=0; k<view.projs[j].size(); k++)
+      {
+        const triple<int, cv::Point2f, Eigen::Vector3f> &p = view.projs[j][k];
+        ProjRecord r;
+        r.cam = p.first; r.u = p.second.x; r.v = p.second.y;
+        r.x = p.third[0]; r.y = p.third[1]; r.z = p.third[2];
+        projs.push_back(r);
+      }
+    }
+    writeBlock(out, (proj_sizes.size()>0?&proj_sizes[0]:0), proj_sizes.size()*sizeof(uint32_t));
+    writeBlock(out, (projs.size()>0?&projs[0]:0), projs.size()*sizeof(ProjRecord));
+    writeBlock(out, (view.part_indices.size()>0?&view.part_indices[0]:0), view.part_indices.size()*sizeof(int32_t));
+
+    entries[i].size = uint64_t(out.tellp()) - entries[i].offset;
+  }
+
+  // index and header
+  header.index_offset = out.tellp();
+  if (entries.size()>0)
+    out.write((const char*)&entries[0], entries.size()*sizeof(ViewIndexEntry));
+
+  out.seekp(0);
+  out.write((const char*)&header, sizeof(FileHeader));
+
+  return out.good();
+}
+
+/**
+ * @brief TrackingModelFile::isTrackingModelFile
+ * @param file
+ * @return true if the file starts with the magic number
+ */
+bool TrackingModelFile::isTrackingModelFile(const std::string &file)
+{
+  char magic[sizeof(MAGIC)];
+  std::ifstream in(file.c_str(), std::ios::in | std::ios::binary);
+
+  if (!in.is_open() || !in.read(magic, sizeof(MAGIC)))
+    return false;
+
+  return memcmp(magic, MAGIC, sizeof(MAGIC))==0;
+}
+
+}
+
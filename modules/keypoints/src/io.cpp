@@ -52,6 +52,9 @@ bool write(const std::string &file, const ArticulatedObject::Ptr &model)
 
 bool read(const std::string &file, ArticulatedObject::Ptr &model)
 {
+  if (TrackingModelFile::isTrackingModelFile(file))
+    return readBinary(file, model);
+
   model.reset(new ArticulatedObject());
 
   std::ifstream ifs(file.c_str());
@@ -65,6 +68,37 @@ bool read(const std::string &file, ArticulatedObject::Ptr &model)
 }
 
 
+bool writeBinary(const std::string &file, const ArticulatedObject::Ptr &model)
+{
+  if (model.get()==0)
+    return false;
+
+  return TrackingModelFile::write(file, *model);
+}
+
+
+bool readBinary(const std::string &file, ArticulatedObject::Ptr &model)
+{
+  TrackingModelFile tm;
+
+  if (!tm.open(file))
+    return false;
+
+  tm.loadAllViews();
+  model = tm.getModel();
+
+  // detach from the file mapping
+  for (unsigned i=0; i<model->views.size(); i++)
+  {
+    ObjectView &view = *model->views[i];
+    view.image = view.image.clone();
+    view.descs = view.descs.clone();
+  }
+
+  return true;
+}
+
+
 }
 } //--END--
 
@@ -30,9 +30,24 @@ namespace v4r
             num_classes_ = 0;
         }
 
+        /**
+         * @brief predicts the targets of all samples (in parallel)
+         * @param data_test samples
+         * @param target_pred predicted target of each sample
+         */
         void SVMpredictTarget(const std::vector<std::vector<double> > & data_test,
                                      std::vector<double> &target_pred);
 
+        /**
+         * @brief predicts the targets of all samples (in parallel) together with the class probabilities
+         * @param data_test samples
+         * @param target_pred predicted target of each sample
+         * @param probabilities probability of each class (in the order of svm_get_labels) for each sample
+         */
+        void SVMpredictTarget(const std::vector<std::vector<double> > & data_test,
+                                     std::vector<double> &target_pred,
+                                     std::vector<std::vector<double> > &probabilities);
+
         void testSVM(
                 const std::vector<std::vector<double> > & data_test,
                 const std::vector<double> &target_actual,
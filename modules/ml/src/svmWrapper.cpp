@@ -1,6 +1,7 @@
 #include <v4r/io/filesystem.h>
 #include <v4r/ml/svmWrapper.h>
 #include <iostream>
+#include <stdexcept>
 
 
 namespace v4r
@@ -50,22 +51,61 @@ bool svmSortOp (svmData i, svmData j) { return (i.y<j.y); }
     }
 
 
+    /**
+     * @brief converts a sample to the sparse (1-based index, -1 terminated) libsvm format, the buffer is reused
+     */
+    static void toSvmNodes(const std::vector<double> &sample, std::vector< ::svm_node> &nodes)
+    {
+        nodes.resize(sample.size()+1);
+
+        for(size_t kk=0; kk<sample.size(); kk++)
+        {
+            nodes[kk].value = sample[kk];
+            nodes[kk].index = kk+1;
+        }
+        nodes[sample.size()].index = -1;
+    }
+
     void svmWrapper::SVMpredictTarget( const std::vector<std::vector<double> > & data_test,
                                          std::vector<double> &target_pred)
     {
         target_pred.resize (data_test.size());
 
-        for(size_t i=0; i<data_test.size(); i++)
+#pragma omp parallel
         {
-            ::svm_node *svm_n_test = new ::svm_node[data_test[i].size()+1];
+            std::vector< ::svm_node> svm_n_test;
 
-            for(size_t kk=0; kk<data_test[i].size(); kk++)
+#pragma omp for schedule(dynamic)
+            for(int i=0; i<(int)data_test.size(); i++)
             {
-                svm_n_test[kk].value = data_test[i][kk];
-                svm_n_test[kk].index = kk+1;
+                toSvmNodes(data_test[i], svm_n_test);
+                target_pred[i] = ::svm_predict(svm_mod_, &svm_n_test[0]);
+            }
+        }
+    }
+
+    void svmWrapper::SVMpredictTarget( const std::vector<std::vector<double> > & data_test,
+                                         std::vector<double> &target_pred,
+                                         std::vector<std::vector<double> > &probabilities)
+    {
+        if(!::svm_check_probability_model(svm_mod_))
+            throw std::runtime_error("[svmWrapper::SVMpredictTarget] The SVM model does not provide probability estimates!");
+
+        const int nr_class = ::svm_get_nr_class(svm_mod_);
+        target_pred.resize (data_test.size());
+        probabilities.resize (data_test.size());
+
+#pragma omp parallel
+        {
+            std::vector< ::svm_node> svm_n_test;
+
+#pragma omp for schedule(dynamic)
+            for(int i=0; i<(int)data_test.size(); i++)
+            {
+                toSvmNodes(data_test[i], svm_n_test);
+                probabilities[i].resize(nr_class);
+                target_pred[i] = ::svm_predict_probability(svm_mod_, &svm_n_test[0], &probabilities[i][0]);
             }
-            svm_n_test[data_test[i].size()].index = -1;
-            target_pred[i] = ::svm_predict(svm_mod_, svm_n_test);
         }
     }
 
@@ -39,6 +39,7 @@
 #include <boost/graph/adjacency_list.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/graph/graph_traits.hpp>
+#include <list>
 
 #ifdef HAVE_SIFTGPU
     #include <SiftGPU/SiftGPU.h>
@@ -96,6 +97,11 @@ public:
         bool do_mst_refinement_;
         double ratio_cluster_obj_supported_;
         double ratio_cluster_occluded_;
+        bool streaming_; /// @brief if true, learns in a memory bounded way. Views older than num_full_res_views_ are compacted, i.e. only their (downsampled) object points are kept for transferring the object mask and their object points are integrated incrementally.
+        size_t num_full_res_views_; /// @brief number of latest views kept at full resolution in streaming mode (only these are used for SIFT based camera pose estimation)
+        double object_voxel_size_; /// @brief voxel size used for downsampling the object points kept for each view in streaming mode (0... no downsampling)
+        std::string spill_dir_; /// @brief if not empty, the full point clouds of compacted views are written to this directory (streaming mode). Otherwise they are discarded and can not be saved as training views.
+        size_t max_icp_cached_views_; /// @brief maximum number of views whose registration data (see getICPCache) is kept. The least recently used one is released and recomputed when needed again (0... unbounded)
         Parameter (double radius = 0.005f,
                    double eps_angle = 0.95f,
                    double dist_threshold_growing = 0.05f,
@@ -110,7 +116,12 @@ public:
                    int normal_method = 0,
                    bool do_mst_refinement = true,
                    double ratio_cluster_obj_supported = 0.25,
-                   double ratio_cluster_occluded = 0.75):
+                   double ratio_cluster_occluded = 0.75,
+                   bool streaming = false,
+                   size_t num_full_res_views = 3,
+                   double object_voxel_size = 0.003f,
+                   const std::string &spill_dir = "",
+                   size_t max_icp_cached_views = 10):
             radius_(radius),
             eps_angle_(eps_angle),
             dist_threshold_growing_(dist_threshold_growing),
@@ -125,7 +136,12 @@ public:
             normal_method_(normal_method),
             do_mst_refinement_(do_mst_refinement),
             ratio_cluster_obj_supported_ (ratio_cluster_obj_supported),
-            ratio_cluster_occluded_(ratio_cluster_occluded)
+            ratio_cluster_occluded_(ratio_cluster_occluded),
+            streaming_(streaming),
+            num_full_res_views_(num_full_res_views),
+            object_voxel_size_(object_voxel_size),
+            spill_dir_(spill_dir),
+            max_icp_cached_views_(max_icp_cached_views)
         {
         }
 
@@ -157,6 +173,7 @@ protected:
     std::vector< pcl::PointCloud<PointT>::Ptr > keyframes_used_;  /// @brief all keyframes containing the object with sufficient number of points
     std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f> > cameras_used_;  /// @brief camera pose belonging to the keyframes containing the object with sufficient number of points
     std::vector<std::vector<size_t> > object_indices_clouds_used_;  /// @brief indices of the object in all keyframes containing the object with sufficient number of points
+    std::vector<std::string> keyframe_files_used_;  /// @brief file of the spilled point cloud for each keyframe which has been compacted (empty if the keyframe is in memory)
 
     pcl::PointCloud<pcl::PointXYZRGBNormal>::Ptr cloud_normals_oriented_;
 
@@ -170,7 +187,8 @@ protected:
     std::vector<int> vis_viewpoint_;
     cv::Ptr<SiftGPU> sift_;
     std::vector<modelView> grph_;
-    pcl::octree::OctreePointCloudSearch<PointT> octree_;
+    boost::shared_ptr<NMBasedCloudIntegration<PointT> > nm_integration_; /// @brief incremental cloud integration of the compacted views (streaming mode)
+    std::list<size_t> icp_cached_views_; /// @brief ids of the views with registration data, most recently used first
 
     void computeAbsolutePoses(const Graph & grph,
                               std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f> > & absolute_poses);
@@ -241,19 +259,46 @@ protected:
     }
 
     /**
-     * @brief This method computes a cost function for the pairwise alignment of two point clouds.
-     * It is computed using fast ICP
-     * @param[in] cloud_src source cloud
-     * @param[in] cloud_dst target cloud
+     * @brief This method computes a cost function for the pairwise alignment of two views.
+     * It is computed using fast ICP on the cached data of the views
+     * @param[in] src source view
+     * @param[in] dst target view
      * @param[out] refined_transform refined homogenous transformation matrix aligning the two point clouds based on ICP
      * @param[in] transform homogenous transformation matrix aligning the two point clouds
      * @return registration cost ( the lower the better the alignment - weight range [0, 0.75] )
      */
-    float calcEdgeWeightAndRefineTf (const pcl::PointCloud<PointT>::ConstPtr &cloud_src,
-                                     const pcl::PointCloud<PointT>::ConstPtr &cloud_dst,
+    float calcEdgeWeightAndRefineTf (modelView &src,
+                                     modelView &dst,
                                      Eigen::Matrix4f &refined_transform,
                                      const Eigen::Matrix4f &transform = Eigen::Matrix4f::Identity());
 
+    /**
+     * @brief returns the search structure of a view's point cloud (built on first use)
+     * @param view
+     * @return octree of view.cloud_
+     */
+    const pcl::octree::OctreePointCloudSearch<PointT> & getOctree(modelView &view) const;
+
+    /**
+     * @brief returns the registration data of a view's point cloud (created on first use, filled by fast ICP).
+     * At most param_.max_icp_cached_views_ views keep their registration data, the least recently used one is released.
+     * @param view
+     * @return ICP cache of view.cloud_ (points further away than 5m removed)
+     */
+    FastICPCloudCache<PointT>::Ptr getICPCache(modelView &view);
+
+    /**
+     * @brief radius search for a batch of query points, the queries are processed in parallel
+     * @param[in] octree search structure
+     * @param[in] query_points cloud containing the query points
+     * @param[in] query_indices indices of the query points (empty: all points)
+     * @param[out] nn_indices for each query the indices of the points within param_.radius_
+     */
+    void radiusSearch(const pcl::octree::OctreePointCloudSearch<PointT> &octree,
+                      const pcl::PointCloud<PointT> &query_points,
+                      const std::vector<int> &query_indices,
+                      std::vector<std::vector<int> > &nn_indices) const;
+
     /**
      * @brief given a point cloud and a normal cloud, this function computes points belonging to a table
      *  (optional: computes smooth clusters for points not belonging to table)
@@ -288,7 +333,7 @@ protected:
      * @param[in] octree search space for transferred points
      * @param[out] obj_mask nearest neighbors points within a specified radius highlighted (true) in object mask
      */
-    void nnSearch(const pcl::PointCloud<PointT> &object_points, pcl::octree::OctreePointCloudSearch<PointT> &octree,  std::vector<bool> &obj_mask);
+    void nnSearch(const pcl::PointCloud<PointT> &object_points, const pcl::octree::OctreePointCloudSearch<PointT> &octree,  std::vector<bool> &obj_mask);
 
     /**
      * @brief Nearest Neighbor Search for points transferred into search cloud
@@ -301,6 +346,7 @@ protected:
     /**
      * @brief extracts smooth Euclidean clusters of a given point cloud
      * @param input cloud
+     * @param octree search structure of the input cloud
      * @param normals_
      * @param initial_mask
      * @param bg_mask
@@ -308,6 +354,7 @@ protected:
      */
     std::vector<bool>
     extractEuclideanClustersSmooth (const pcl::PointCloud<PointT>::ConstPtr &cloud,
+                                    const pcl::octree::OctreePointCloudSearch<PointT> &octree,
                                     const pcl::PointCloud<pcl::Normal> &normals_,
                                     const std::vector<bool> &initial_mask,
                                     const std::vector<bool> &bg_mask) const;
@@ -328,6 +375,38 @@ protected:
                            pcl::PointCloud<FeatureT>::Ptr &sift_signatures,
                            std::vector<float> &sift_keypoint_scales);
 
+    /**
+     * @brief computes the noise model of a view and adds its object points to the incremental cloud integration
+     * @param view view with full point cloud and normals
+     */
+    void addViewToIntegration(modelView &view);
+
+    /**
+     * @brief extracts the (downsampled) object points of a view and their bounding box
+     * @param view view with full point cloud and final object mask
+     */
+    void computeObjectCloud(modelView &view) const;
+
+    /**
+     * @brief releases all data of a view which is not needed anymore for transferring the object mask to new views.
+     * The object points are added to the incremental cloud integration, the full cloud is optionally written to disk.
+     * Pre-labelled views are kept as they are needed for the occlusion reasoning.
+     * @param view view to be compacted
+     */
+    void compactView(modelView &view);
+
+    /**
+     * @brief checks if a bounding box can be seen by a camera, i.e. if its projection overlaps with the image plane
+     * @param min_pt minimum point of the bounding box
+     * @param max_pt maximum point of the bounding box
+     * @param tf transform from the coordinate system of the bounding box into the camera
+     * @param width image width
+     * @param height image height
+     * @return true if the bounding box is (partially) within the view frustum
+     */
+    bool isInFrustum(const Eigen::Vector4f &min_pt, const Eigen::Vector4f &max_pt, const Eigen::Matrix4f &tf,
+                     int width = 640, int height = 480) const;
+
     void
     estimateViewTransformationBySIFT(const pcl::PointCloud<PointT> &src_cloud,
                                           const pcl::PointCloud<PointT> &dst_cloud,
@@ -340,7 +419,7 @@ protected:
 
 public:
 
-    IOL (const Parameter &p=Parameter()) : octree_(0.005f)
+    IOL (const Parameter &p=Parameter())
     {
         param_ = p;
         // Parameters for smooth clustering / plane segmentation
@@ -369,7 +448,7 @@ public:
      * @brief saves the learned model to disk
      * @param[in] directory where to save the object model
      * @param[in] name of the object model
-     * @return
+     * @return false if not all training views could be saved (keyframes released in streaming mode without a spill directory)
      */
     bool save_model (const std::string &models_dir = "/tmp/dynamic_models/",
                      const std::string &model_name = "new_dynamic_model",
@@ -395,6 +474,8 @@ public:
         big_cloud_segmented_->points.clear();
         big_cloud_segmented_refined_->points.clear();
         grph_.clear();
+        icp_cached_views_.clear();
+        nm_integration_.reset();
         gs_.clearing_graph();
         gs_.clear();
         vis_viewpoint_.clear();
@@ -26,8 +26,10 @@
 #define V4R_OBJECT_MODELLING_MODELVIEW_H__
 
 #include <pcl/common/common.h>
+#include <pcl/octree/octree_search.h>
 #include <v4r/core/macros.h>
 #include <v4r/keypoints/ClusterNormalsToPlanes.h>
+#include <v4r/registration/fast_icp_with_gc.h>
 
 namespace v4r
 {
@@ -66,6 +68,9 @@ namespace v4r
             pcl::PointCloud<pcl::PointXYZRGBA>::Ptr  supervoxel_cloud_;
             pcl::PointCloud<pcl::PointXYZRGBA>::Ptr  supervoxel_cloud_organized_;
 
+            pcl::octree::OctreePointCloudSearch<PointT>::Ptr octree_; /// @brief search structure of cloud_ (built once, shared by all steps)
+            FastICPCloudCache<PointT>::Ptr icp_cache_; /// @brief normals, edges and keypoints of cloud_ used for registering this view
+
             std::vector<SuperPlane> planes_;
 
             std::vector< size_t > scene_points_;
@@ -81,6 +86,12 @@ namespace v4r
 
             bool is_pre_labelled_;
 
+            pcl::PointCloud<PointT>::Ptr  object_cloud_; /// @brief (downsampled) object points in camera coordinates, used for transferring the object to new views (streaming mode)
+            Eigen::Vector4f object_min_pt_, object_max_pt_; /// @brief bounding box of object_cloud_
+            bool is_compacted_; /// @brief if true, cloud, normals and intermediate results of this view have been released (streaming mode)
+            int integration_id_; /// @brief id of this view in the incremental noise model based cloud integration (-1 if not added)
+            std::string spilled_cloud_file_; /// @brief file containing the full point cloud of a compacted view (empty if not spilled to disk)
+
             modelView()
             {
                 cloud_.reset(new pcl::PointCloud<PointT>());
@@ -89,7 +100,10 @@ namespace v4r
                 supervoxel_cloud_.reset(new pcl::PointCloud<pcl::PointXYZRGBA>());
                 supervoxel_cloud_organized_.reset(new pcl::PointCloud<pcl::PointXYZRGBA>());
                 sift_signatures_.reset (new pcl::PointCloud<FeatureT>());
+                object_cloud_.reset(new pcl::PointCloud<PointT>());
                 is_pre_labelled_ = false;
+                is_compacted_ = false;
+                integration_id_ = -1;
             }
         };
     }
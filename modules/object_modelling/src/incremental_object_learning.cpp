@@ -23,6 +23,7 @@
 #include <pcl/common/transforms.h>
 #include <pcl/filters/extract_indices.h>
 #include <pcl/filters/statistical_outlier_removal.h>
+#include <pcl/filters/voxel_grid.h>
 #include <pcl/io/pcd_io.h>
 #include <pcl/recognition/cg/geometric_consistency.h>
 #include <pcl/registration/correspondence_rejection_sample_consensus.h>
@@ -54,36 +55,66 @@ namespace v4r
 namespace object_modelling
 {
 
+FastICPCloudCache<IOL::PointT>::Ptr
+IOL::getICPCache(modelView &view)
+{
+    if ( !view.icp_cache_ )
+    {
+        pcl::PointCloud<PointT>::Ptr cloud_wo_nan ( new pcl::PointCloud<PointT>());
+
+        pcl::PassThrough<PointT> pass;
+        pass.setFilterLimits (0.f, 5.f);
+        pass.setFilterFieldName ("z");
+        pass.setInputCloud (view.cloud_);
+        pass.setKeepOrganized (true);
+        pass.filter (*cloud_wo_nan);
+
+        view.icp_cache_.reset( new FastICPCloudCache<PointT>(cloud_wo_nan) );
+
+        if ( param_.max_icp_cached_views_ && icp_cached_views_.size() >= param_.max_icp_cached_views_ )
+        {
+            grph_[ icp_cached_views_.back() ].icp_cache_.reset();
+            icp_cached_views_.pop_back();
+        }
+    }
+    else
+        icp_cached_views_.remove( view.id_ );
+
+    icp_cached_views_.push_front( view.id_ );
+    return view.icp_cache_;
+}
+
+const pcl::octree::OctreePointCloudSearch<IOL::PointT> &
+IOL::getOctree(modelView &view) const
+{
+    if ( !view.octree_ )
+    {
+        view.octree_.reset( new pcl::octree::OctreePointCloudSearch<PointT>(0.005f) );
+        view.octree_->setInputCloud ( view.cloud_ );
+        view.octree_->addPointsFromInputCloud ();
+    }
+
+    return *view.octree_;
+}
+
 float
-IOL::calcEdgeWeightAndRefineTf (const pcl::PointCloud<PointT>::ConstPtr &cloud_src,
-                                const pcl::PointCloud<PointT>::ConstPtr &cloud_dst,
+IOL::calcEdgeWeightAndRefineTf (modelView &src,
+                                modelView &dst,
                                 Eigen::Matrix4f &refined_transform,
                                 const Eigen::Matrix4f &transform)
 {
-    pcl::PointCloud<PointT>::Ptr cloud_src_wo_nan ( new pcl::PointCloud<PointT>());
-    pcl::PointCloud<PointT>::Ptr cloud_dst_wo_nan ( new pcl::PointCloud<PointT>());
-
-    pcl::PassThrough<PointT> pass;
-    pass.setFilterLimits (0.f, 5.f);
-    pass.setFilterFieldName ("z");
-    pass.setInputCloud (cloud_src);
-    pass.setKeepOrganized (true);
-    pass.filter (*cloud_src_wo_nan);
-
-    pcl::PassThrough<PointT> pass2;
-    pass2.setFilterLimits (0.f, 5.f);
-    pass2.setFilterFieldName ("z");
-    pass2.setInputCloud (cloud_dst);
-    pass2.setKeepOrganized (true);
-    pass2.filter (*cloud_dst_wo_nan);
+    const FastICPCloudCache<PointT>::Ptr src_cache = getICPCache(src);
+    const FastICPCloudCache<PointT>::Ptr dst_cache = getICPCache(dst);
 
     float w_after_icp_ = std::numeric_limits<float>::max ();
     const float best_overlap_ = 0.75f;
 
     FastIterativeClosestPointWithGC<PointT> icp;
     icp.setMaxCorrespondenceDistance ( 0.02f );
-    icp.setInputSource ( cloud_src_wo_nan );
-    icp.setInputTarget ( cloud_dst_wo_nan );
+    icp.setInputSource ( src_cache->cloud_ );
+    icp.setInputTarget ( dst_cache->cloud_ );
+    icp.setInputCache ( src_cache );
+    icp.setTargetCache ( dst_cache );
     icp.setUseNormals (true);
     icp.useStandardCG (true);
     icp.setNoCG(true);
@@ -209,57 +240,65 @@ IOL::estimateViewTransformationBySIFT(const pcl::PointCloud<PointT> &src_cloud,
 std::vector<bool>
 IOL::extractEuclideanClustersSmooth (
         const pcl::PointCloud<PointT>::ConstPtr &cloud,
+        const pcl::octree::OctreePointCloudSearch<PointT> &octree,
         const pcl::PointCloud<pcl::Normal> &normals,
         const std::vector<bool> &initial_mask,
         const std::vector<bool> &bg_mask) const
 {
     assert (cloud->points.size () == normals.points.size ());
 
-    pcl::octree::OctreePointCloudSearch<PointT> octree(0.005f);
-    octree.setInputCloud ( cloud );
-    octree.addPointsFromInputCloud ();
-
     // Create a bool vector of processed point indices, and initialize it to false
-    std::vector<bool> to_grow = initial_mask;
+    std::vector<int> to_grow;
     std::vector<bool> in_cluster = initial_mask;
 
-    bool stop = false;
-    while(!stop)
+    for (size_t i = 0; i < cloud->points.size (); i++)
     {
-        stop = true;
-        std::vector<bool> is_new_point (cloud->points.size (), false);  // do as long as there is no new point
-        std::vector<int> nn_indices;
-        std::vector<float> nn_distances;
+        if (initial_mask[i])
+            to_grow.push_back(i);
+    }
 
-        for (size_t i = 0; i < cloud->points.size (); i++)
+    std::vector<std::vector<int> > nn_indices;
+
+    while(!to_grow.empty())   // do as long as there is no new point
+    {
+        radiusSearch(octree, *cloud, to_grow, nn_indices);
+
+        // check smoothness constraint for all neighbors of the current front in parallel
+        #pragma omp parallel for schedule(dynamic, 64)
+        for (size_t i = 0; i < to_grow.size (); i++)
         {
-            if (!to_grow[i])
-                continue;
+            Eigen::Vector3f n1 = normals.points[ to_grow[i] ].getNormalVector3fMap();
+            n1.normalize();
 
-            if (octree.radiusSearch (cloud->points[i], param_.radius_, nn_indices, nn_distances))
+            size_t kept = 0;
+            for (size_t j = 0; j < nn_indices[i].size (); j++) // is nn_indices[0] the same point?
+            {
+                const int nn = nn_indices[i][j];
+
+                if( in_cluster[ nn ] || bg_mask[ nn ] )  // if nearest neighbor is already an object or is a point to be neglected (background)
+                    continue;
+
+                Eigen::Vector3f n2 = normals.points[ nn ].getNormalVector3fMap();
+                n2.normalize();
+                if (n1.dot(n2) >= param_.eps_angle_)
+                    nn_indices[i][kept++] = nn;
+            }
+            nn_indices[i].resize(kept);
+        }
+
+        std::vector<int> new_points;
+        for (size_t i = 0; i < to_grow.size (); i++)
+        {
+            for (const int nn : nn_indices[i])
             {
-                for (size_t j = 0; j < nn_indices.size (); j++) // is nn_indices[0] the same point?
+                if ( !in_cluster[nn] )
                 {
-                    if( !in_cluster[ nn_indices[j] ] && !bg_mask[ nn_indices[j] ])  // if nearest neighbor is not already an object and is not a point to be neglected (background)
-                    {
-                        //check smoothness constraint
-                        Eigen::Vector3f n1 = normals.points[i].getNormalVector3fMap();
-                        Eigen::Vector3f n2 = normals.points[nn_indices[j]].getNormalVector3fMap();
-                        n1.normalize();
-                        n2.normalize();
-                        float dot_p = n1.dot(n2);
-
-                        if (dot_p >= param_.eps_angle_)
-                        {
-                            stop = false;
-                            is_new_point[ nn_indices[j] ] = true;
-                            in_cluster[ nn_indices[j] ] = true;
-                        }
-                    }
+                    in_cluster[nn] = true;
+                    new_points.push_back(nn);
                 }
             }
         }
-        to_grow = is_new_point;
+        to_grow.swap(new_points);
     }
     return in_cluster;
 }
@@ -342,6 +381,31 @@ IOL::updatePointNormalsFromSuperVoxels(const pcl::PointCloud<PointT>::Ptr & clou
     }
 }
 
+void
+IOL::radiusSearch(const pcl::octree::OctreePointCloudSearch<PointT> &octree,
+                  const pcl::PointCloud<PointT> &query_points,
+                  const std::vector<int> &query_indices,
+                  std::vector<std::vector<int> > &nn_indices) const
+{
+    const size_t num_queries = query_indices.empty() ? query_points.points.size() : query_indices.size();
+    nn_indices.resize(num_queries);
+
+    #pragma omp parallel
+    {
+        std::vector<float> nn_sqr_distances;
+
+        #pragma omp for schedule(dynamic, 64)
+        for(size_t i=0; i < num_queries; i++)
+        {
+            const PointT &pt = query_points.points[ query_indices.empty() ? i : query_indices[i] ];
+            nn_indices[i].clear();
+
+            if ( pcl::isFinite(pt) )
+                octree.radiusSearch (pt, param_.radius_, nn_indices[i], nn_sqr_distances);
+        }
+    }
+}
+
 void
 IOL::nnSearch(const pcl::PointCloud<PointT> &object_points, const pcl::PointCloud<PointT>::ConstPtr &search_cloud,  std::vector<bool> &obj_mask)
 {
@@ -352,11 +416,11 @@ IOL::nnSearch(const pcl::PointCloud<PointT> &object_points, const pcl::PointClou
 }
 
 void
-IOL::nnSearch(const pcl::PointCloud<PointT> &object_points, pcl::octree::OctreePointCloudSearch<PointT> &octree,  std::vector<bool> &obj_mask)
+IOL::nnSearch(const pcl::PointCloud<PointT> &object_points, const pcl::octree::OctreePointCloudSearch<PointT> &octree,  std::vector<bool> &obj_mask)
 {
     //find neighbours from transferred object points
-    std::vector<int> pointIdxRadiusSearch;
-    std::vector<float> pointRadiusSquaredDistance;
+    std::vector<std::vector<int> > nn_indices;
+    radiusSearch(octree, object_points, std::vector<int>(), nn_indices);
 
     for(size_t i=0; i < object_points.points.size(); i++)
     {
@@ -365,11 +429,9 @@ IOL::nnSearch(const pcl::PointCloud<PointT> &object_points, pcl::octree::OctreeP
             PCL_WARN ("Warning: Point is NaN.\n");    // not sure if this causes somewhere else a problem. This condition should not be fulfilled.
             continue;
         }
-        if ( octree.radiusSearch (object_points.points[i], param_.radius_, pointIdxRadiusSearch, pointRadiusSquaredDistance) > 0)
-        {
-            for( size_t nn_id = 0; nn_id < pointIdxRadiusSearch.size(); nn_id++)
-                obj_mask[ pointIdxRadiusSearch[ nn_id ] ] = true;
-        }
+
+        for( size_t nn_id = 0; nn_id < nn_indices[i].size(); nn_id++)
+            obj_mask[ nn_indices[i][ nn_id ] ] = true;
     }
 }
 
@@ -431,11 +493,23 @@ IOL::write_model_to_disk (const std::string &models_dir, const std::string &mode
     {
         io::createDirIfNotExist(export_to + "/views");
 
+        // views are numbered consecutively, i.e. released keyframes do not leave gaps between cloud, pose and indices files
+        size_t num_saved_views = 0;
         for(size_t i=0; i < keyframes_used_.size(); i++)
         {
             std::stringstream view_file;
-            view_file << export_to << "/views/cloud_" << setfill('0') << setw(8) << i << ".pcd";
-            pcl::io::savePCDFileBinary (view_file.str (), *keyframes_used_[i]);
+            view_file << export_to << "/views/cloud_" << setfill('0') << setw(8) << num_saved_views << ".pcd";
+
+            if ( i < keyframe_files_used_.size() && !keyframe_files_used_[i].empty() )  // compacted keyframe spilled to disk
+                boost::filesystem::copy_file(keyframe_files_used_[i], view_file.str(), boost::filesystem::copy_option::overwrite_if_exists);
+            else if ( !keyframes_used_[i]->points.empty() )
+                pcl::io::savePCDFileBinary (view_file.str (), *keyframes_used_[i]);
+            else
+            {
+                std::cerr << "Point cloud of keyframe " << i << " has been released in streaming mode. Set a spill directory to be able to save it as training view." << std::endl;
+                continue;
+            }
+            num_saved_views++;
             std::cout << view_file.str() << std::endl;
 
             std::string path_pose (view_file.str());
@@ -453,6 +527,12 @@ IOL::write_model_to_disk (const std::string &models_dir, const std::string &mode
                 mask_f << idx << std::endl;
             mask_f.close();
         }
+
+        if ( num_saved_views < keyframes_used_.size() )
+        {
+            std::cerr << "Saved only " << num_saved_views << " of " << keyframes_used_.size() << " training views of model " << model_name << "." << std::endl;
+            return false;
+        }
     }
     return true;
 }
@@ -465,6 +545,7 @@ IOL::save_model (const std::string &models_dir, const std::string &model_name, b
 
     std::vector< pcl::PointCloud<pcl::Normal>::Ptr > normals_used (num_frames);
     keyframes_used_.resize(num_frames);
+    keyframe_files_used_.resize(num_frames);
     cameras_used_.resize(num_frames);
     object_indices_clouds_used_.resize(num_frames);
 
@@ -475,44 +556,60 @@ IOL::save_model (const std::string &models_dir, const std::string &model_name, b
         if ( createIndicesFromMask<size_t>(grph_[view_id].obj_mask_step_.back()).size() )
         {
             keyframes_used_[ kept_keyframes ] = grph_[view_id].cloud_;
+            keyframe_files_used_[ kept_keyframes ] = grph_[view_id].spilled_cloud_file_;
             normals_used [ kept_keyframes ] = grph_[view_id].normal_;
             cameras_used_ [ kept_keyframes ] = grph_[view_id].camera_pose_;
             object_indices_clouds_used_[ kept_keyframes ] = createIndicesFromMask<size_t>( grph_[view_id].obj_mask_step_.back() );
+
+            if ( param_.streaming_ ) // camera poses might have changed since the view has been added to the integration
+            {
+                addViewToIntegration( grph_[view_id] );
+                nm_integration_->setViewTransformation( grph_[view_id].integration_id_, grph_[view_id].camera_pose_ );
+            }
             kept_keyframes++;
         }
     }
 
     keyframes_used_.resize(kept_keyframes);
+    keyframe_files_used_.resize(kept_keyframes);
     normals_used.resize(kept_keyframes);
     cameras_used_.resize(kept_keyframes);
     object_indices_clouds_used_.resize(kept_keyframes);
-    std::vector<std::vector<std::vector<float> > > pt_properties (kept_keyframes);
 
     if ( kept_keyframes > 0)
     {
-        //compute noise weights
-        for(size_t i=0; i < kept_keyframes; i++)
+        pcl::PointCloud<PointT>::Ptr octree_cloud(new pcl::PointCloud<PointT>);
+        pcl::PointCloud<pcl::Normal>::Ptr octree_normals;
+
+        if ( param_.streaming_ )    // object points have been accumulated incrementally
         {
-            NguyenNoiseModel<PointT>::Parameter nm_param;
-            nm_param.use_depth_edges_ = true;
-            NguyenNoiseModel<PointT> nm (nm_param);
-            nm.setInputCloud(keyframes_used_[i]);
-            nm.setInputNormals(normals_used[i]);
-            nm.compute();
-            pt_properties[i] = nm.getPointProperties();
+            nm_integration_->compute(octree_cloud);
+            nm_integration_->getOutputNormals(octree_normals);
         }
+        else
+        {
+            //compute noise weights
+            std::vector<std::vector<std::vector<float> > > pt_properties (kept_keyframes);
+            for(size_t i=0; i < kept_keyframes; i++)
+            {
+                NguyenNoiseModel<PointT>::Parameter nm_param;
+                nm_param.use_depth_edges_ = true;
+                NguyenNoiseModel<PointT> nm (nm_param);
+                nm.setInputCloud(keyframes_used_[i]);
+                nm.setInputNormals(normals_used[i]);
+                nm.compute();
+                pt_properties[i] = nm.getPointProperties();
+            }
 
-        pcl::PointCloud<PointT>::Ptr octree_cloud(new pcl::PointCloud<PointT>);
-        NMBasedCloudIntegration<PointT> nmIntegration (nm_int_param_);
-        nmIntegration.setInputClouds(keyframes_used_);
-        nmIntegration.setTransformations(cameras_used_);
-        nmIntegration.setInputNormals(normals_used);
-        nmIntegration.setIndices( object_indices_clouds_used_ );
-        nmIntegration.setPointProperties( pt_properties );
-        nmIntegration.compute(octree_cloud);
-
-        pcl::PointCloud<pcl::Normal>::Ptr octree_normals;
-        nmIntegration.getOutputNormals(octree_normals);
+            NMBasedCloudIntegration<PointT> nmIntegration (nm_int_param_);
+            nmIntegration.setInputClouds(keyframes_used_);
+            nmIntegration.setTransformations(cameras_used_);
+            nmIntegration.setInputNormals(normals_used);
+            nmIntegration.setIndices( object_indices_clouds_used_ );
+            nmIntegration.setPointProperties( pt_properties );
+            nmIntegration.compute(octree_cloud);
+            nmIntegration.getOutputNormals(octree_normals);
+        }
 
         pcl::PointCloud<pcl::PointXYZRGBNormal>::Ptr filtered_with_normals_oriented (new pcl::PointCloud<pcl::PointXYZRGBNormal>());
         pcl::concatenateFields(*octree_normals, *octree_cloud, *filtered_with_normals_oriented);
@@ -524,7 +621,7 @@ IOL::save_model (const std::string &models_dir, const std::string &model_name, b
         sor.filter (*cloud_normals_oriented_);
 
         std::cout << "Saving " << kept_keyframes << " keyframes from " << num_frames << " to " << models_dir << std::endl;
-        write_model_to_disk(models_dir, model_name, save_individual_views);
+        return write_model_to_disk(models_dir, model_name, save_individual_views);
     }
     return true;
 }
@@ -673,6 +770,135 @@ IOL::computeAbsolutePoses (const Graph & grph,
   computeAbsolutePosesRecursive (grph, source_view, accum, absolute_poses, hop_list);
 }
 
+bool
+IOL::isInFrustum(const Eigen::Vector4f &min_pt, const Eigen::Vector4f &max_pt, const Eigen::Matrix4f &tf, int width, int height) const
+{
+    const float focal_length = 525.f;
+    const float cx = width / 2.f;
+    const float cy = height / 2.f;
+
+    float u_min = std::numeric_limits<float>::max(), v_min = std::numeric_limits<float>::max();
+    float u_max = -std::numeric_limits<float>::max(), v_max = -std::numeric_limits<float>::max();
+    bool in_front = false, behind = false;
+
+    for(int corner_id=0; corner_id<8; corner_id++)
+    {
+        const Eigen::Vector3f corner ( (corner_id & 1) ? max_pt(0) : min_pt(0),
+                                       (corner_id & 2) ? max_pt(1) : min_pt(1),
+                                       (corner_id & 4) ? max_pt(2) : min_pt(2) );
+        const Eigen::Vector3f corner_cam = tf.block<3,3>(0,0) * corner + tf.block<3,1>(0,3);
+
+        if ( corner_cam(2) <= 0.f )
+        {
+            behind = true;
+            continue;
+        }
+
+        in_front = true;
+        const float u = focal_length * corner_cam(0) / corner_cam(2) + cx;
+        const float v = focal_length * corner_cam(1) / corner_cam(2) + cy;
+        u_min = std::min(u_min, u);
+        u_max = std::max(u_max, u);
+        v_min = std::min(v_min, v);
+        v_max = std::max(v_max, v);
+    }
+
+    if ( !in_front )
+        return false;
+
+    if ( behind )   // box reaches behind the camera, the projection is unbounded
+        return true;
+
+    return u_max >= 0.f && v_max >= 0.f && u_min < width && v_min < height;
+}
+
+void
+IOL::computeObjectCloud(modelView &view) const
+{
+    pcl::PointCloud<PointT>::Ptr object_points (new pcl::PointCloud<PointT>());
+    pcl::copyPointCloud(*view.cloud_, view.obj_mask_step_.back(), *object_points);
+
+    if ( param_.object_voxel_size_ > 0.f && !object_points->points.empty() )
+    {
+        const float leaf_size = static_cast<float>(param_.object_voxel_size_);
+        pcl::VoxelGrid<PointT> vg;
+        vg.setInputCloud (object_points);
+        vg.setLeafSize (leaf_size, leaf_size, leaf_size);
+        view.object_cloud_.reset(new pcl::PointCloud<PointT>());
+        vg.filter (*view.object_cloud_);
+    }
+    else
+        view.object_cloud_ = object_points;
+
+    if ( !view.object_cloud_->points.empty() )
+        pcl::getMinMax3D(*view.object_cloud_, view.object_min_pt_, view.object_max_pt_);
+}
+
+void
+IOL::addViewToIntegration(modelView &view)
+{
+    const std::vector<size_t> object_indices = createIndicesFromMask<size_t>( view.obj_mask_step_.back() );
+
+    if ( object_indices.empty() || view.integration_id_ >= 0 )
+        return;
+
+    if ( !nm_integration_ )
+        nm_integration_.reset( new NMBasedCloudIntegration<PointT>(nm_int_param_) );
+
+    NguyenNoiseModel<PointT>::Parameter nm_param;
+    nm_param.use_depth_edges_ = true;
+    NguyenNoiseModel<PointT> nm (nm_param);
+    nm.setInputCloud(view.cloud_);
+    nm.setInputNormals(view.normal_);
+    nm.compute();
+
+    view.integration_id_ = nm_integration_->addView(*view.cloud_, *view.normal_, nm.getPointProperties(), object_indices, view.camera_pose_);
+}
+
+void
+IOL::compactView(modelView &view)
+{
+    if ( view.is_compacted_ || view.is_pre_labelled_ )
+        return;
+
+    addViewToIntegration(view);
+
+    if ( !param_.spill_dir_.empty() )
+    {
+        io::createDirIfNotExist(param_.spill_dir_);
+        std::stringstream spill_file;
+        spill_file << param_.spill_dir_ << "/cloud_" << setfill('0') << setw(8) << view.id_ << ".pcd";
+        pcl::io::savePCDFileBinary (spill_file.str(), *view.cloud_);
+        view.spilled_cloud_file_ = spill_file.str();
+    }
+
+    // only the final object mask is needed for saving the model
+    view.obj_mask_step_.erase(view.obj_mask_step_.begin(), view.obj_mask_step_.end() - 1);
+
+    view.cloud_.reset(new pcl::PointCloud<PointT>());
+    view.normal_.reset(new pcl::PointCloud<pcl::Normal>());
+    view.octree_.reset();
+    view.icp_cache_.reset();
+    icp_cached_views_.remove( view.id_ );
+    view.transferred_cluster_.reset(new pcl::PointCloud<PointT>());
+    view.supervoxel_cloud_.reset(new pcl::PointCloud<pcl::PointXYZRGBA>());
+    view.supervoxel_cloud_organized_.reset(new pcl::PointCloud<pcl::PointXYZRGBA>());
+    view.sift_signatures_.reset(new pcl::PointCloud<FeatureT>());
+    std::vector<size_t>().swap(view.sift_keypoint_indices_);
+    std::vector<size_t>().swap(view.scene_points_);
+
+    // plane merging only needs the plane parameters of old views
+    for(modelView::SuperPlane &sp : view.planes_)
+    {
+        std::vector<int>().swap(sp.indices);
+        std::vector<size_t>().swap(sp.visible_indices);
+        std::vector<size_t>().swap(sp.object_indices);
+        std::vector<size_t>().swap(sp.within_chop_z_indices);
+    }
+
+    view.is_compacted_ = true;
+}
+
 bool
 IOL::learn_object (const pcl::PointCloud<PointT> &cloud, const Eigen::Matrix4f &camera_pose, const std::vector<size_t> &initial_indices)
 {
@@ -695,8 +921,7 @@ IOL::learn_object (const pcl::PointCloud<PointT> &cloud, const Eigen::Matrix4f &
     computeNormals<PointT>(view.cloud_, view.normal_, param_.normal_method_);
     extractPlanePoints(view.cloud_, view.normal_, planes);
 
-    octree_.setInputCloud ( view.cloud_ );
-    octree_.addPointsFromInputCloud ();
+    const pcl::octree::OctreePointCloudSearch<PointT> &octree = getOctree(view);
 
     boost::shared_ptr<flann::Index<DistT> > flann_index;
 
@@ -770,7 +995,7 @@ IOL::learn_object (const pcl::PointCloud<PointT> &cloud, const Eigen::Matrix4f &
         {
             for (size_t view_id = 0; view_id < grph_.size(); view_id++)
             {
-                if( view.id_ == grph_[view_id].id_)
+                if( view.id_ == grph_[view_id].id_ || grph_[view_id].is_compacted_)   // compacted views do not have their full cloud anymore
                     continue;
 
                 std::vector<CamConnect> transforms;
@@ -807,7 +1032,7 @@ IOL::learn_object (const pcl::PointCloud<PointT> &cloud, const Eigen::Matrix4f &
                     try
                     {
                         Eigen::Matrix4f icp_refined_trans;
-                        transforms[ trans_id ].edge_weight = calcEdgeWeightAndRefineTf( grph_[view_id].cloud_, view.cloud_, icp_refined_trans, transforms[ trans_id ].transformation_);
+                        transforms[ trans_id ].edge_weight = calcEdgeWeightAndRefineTf( grph_[view_id], view, icp_refined_trans, transforms[ trans_id ].transformation_);
                         transforms[ trans_id ].transformation_ = icp_refined_trans,
                         std::cout << "Edge weight is " << transforms[ trans_id ].edge_weight << " for edge connecting vertex " <<
                                      transforms[ trans_id ].source_id_ << " and " << transforms[ trans_id ].target_id_ << " by " <<
@@ -852,32 +1077,64 @@ IOL::learn_object (const pcl::PointCloud<PointT> &cloud, const Eigen::Matrix4f &
             }
         }
 
+        Eigen::Vector4f scene_min_pt, scene_max_pt;
+        if ( param_.streaming_ )
+            pcl::getMinMax3D(*view.cloud_, scene_min_pt, scene_max_pt);
+
+        // the search tree of the new view is shared by the refinement of all transferred object clouds
+        pcl::search::KdTree<PointT>::Ptr icp_target_tree (new pcl::search::KdTree<PointT>);
+        icp_target_tree->setInputCloud (view.cloud_);
+
         std::vector<bool> is_occluded;
         for (size_t view_id = 0; view_id < grph_.size(); view_id++)
         {
             if( view.id_ != grph_[view_id].id_)
             {
-                pcl::PointCloud<PointT>::Ptr new_search_pts, new_search_pts_aligned;
-                new_search_pts.reset(new pcl::PointCloud<PointT>());
-                new_search_pts_aligned.reset(new pcl::PointCloud<PointT>());
-                pcl::copyPointCloud(*grph_[view_id].cloud_, grph_[view_id].obj_mask_step_.back(), *new_search_pts);
                 const Eigen::Matrix4f tf = view.camera_pose_.inverse() * grph_[view_id].camera_pose_;
-                pcl::transformPointCloud(*new_search_pts, *new_search_pts_aligned, tf);
 
-                pcl::IterativeClosestPoint<PointT, PointT> icp;
-                icp.setInputSource(new_search_pts_aligned);
-                icp.setInputTarget(view.cloud_);
-                icp.setMaxCorrespondenceDistance (0.02f);
-                pcl::PointCloud<PointT>::Ptr icp_aligned_cloud (new pcl::PointCloud<PointT>());
-                icp.align(*icp_aligned_cloud, Eigen::Matrix4f::Identity());
-                *view.transferred_cluster_ += *icp_aligned_cloud;
+                // in streaming mode, only the kept object points are transferred and only if they can be seen in the new view
+                bool do_transfer = true;
+                pcl::PointCloud<PointT>::Ptr new_search_pts;
+                if ( param_.streaming_ )
+                {
+                    new_search_pts = grph_[view_id].object_cloud_;
+                    do_transfer = !new_search_pts->points.empty() &&
+                            isInFrustum(grph_[view_id].object_min_pt_, grph_[view_id].object_max_pt_, tf, view.cloud_->width, view.cloud_->height);
+                }
+                else
+                {
+                    new_search_pts.reset(new pcl::PointCloud<PointT>());
+                    pcl::copyPointCloud(*grph_[view_id].cloud_, grph_[view_id].obj_mask_step_.back(), *new_search_pts);
+                }
+
+                if ( do_transfer )
+                {
+                    pcl::PointCloud<PointT>::Ptr new_search_pts_aligned (new pcl::PointCloud<PointT>());
+                    pcl::transformPointCloud(*new_search_pts, *new_search_pts_aligned, tf);
+
+                    pcl::IterativeClosestPoint<PointT, PointT> icp;
+                    icp.setInputSource(new_search_pts_aligned);
+                    icp.setInputTarget(view.cloud_);
+                    icp.setSearchMethodTarget(icp_target_tree, true);
+                    icp.setMaxCorrespondenceDistance (0.02f);
+                    pcl::PointCloud<PointT>::Ptr icp_aligned_cloud (new pcl::PointCloud<PointT>());
+                    icp.align(*icp_aligned_cloud, Eigen::Matrix4f::Identity());
+                    *view.transferred_cluster_ += *icp_aligned_cloud;
+                }
 
                 if (grph_[view_id].is_pre_labelled_)
                 {
-                    std::vector<bool> is_occluded_tmp = computeOccludedPoints(*grph_[view_id].cloud_,
-                                                                                                   *view.cloud_,
-                                                                                                   tf.inverse(),
-                                                                                                        525.f, 0.01f, false);
+                    std::vector<bool> is_occluded_tmp;
+
+                    // points outside the field of view of the labelled view are not occluded
+                    if ( param_.streaming_ && !isInFrustum(scene_min_pt, scene_max_pt, tf.inverse(),
+                                                           grph_[view_id].cloud_->width, grph_[view_id].cloud_->height) )
+                        is_occluded_tmp.resize(view.cloud_->points.size(), false);
+                    else
+                        is_occluded_tmp = computeOccludedPoints(*grph_[view_id].cloud_,
+                                                                *view.cloud_,
+                                                                tf.inverse(),
+                                                                525.f, 0.01f, false);
                     if( is_occluded.size() == is_occluded_tmp.size())
                     {
                         is_occluded = binary_operation(is_occluded, is_occluded_tmp, BINARY_OPERATOR::AND); // is this correct?
@@ -891,7 +1148,7 @@ IOL::learn_object (const pcl::PointCloud<PointT> &cloud, const Eigen::Matrix4f &
         }
 
         std::vector<bool> obj_mask_nn_search (view.cloud_->points.size(), false);
-        nnSearch(*view.transferred_cluster_, octree_, obj_mask_nn_search);
+        nnSearch(*view.transferred_cluster_, octree, obj_mask_nn_search);
         view.obj_mask_step_.push_back( obj_mask_nn_search);
 
         computePlaneProperties(planes, obj_mask_nn_search, is_occluded,
@@ -948,10 +1205,12 @@ IOL::learn_object (const pcl::PointCloud<PointT> &cloud, const Eigen::Matrix4f &
     view.obj_mask_step_.push_back( obj_mask_enforced_by_supervoxel_consistency );
 
     std::vector<bool> obj_mask_grown_by_smooth_surface = extractEuclideanClustersSmooth(view.cloud_,
+                                                                                           octree,
                                                                                            *view.normal_,
                                                                                            obj_mask_enforced_by_supervoxel_consistency,
                                                                                            pixel_is_neglected);
     view.obj_mask_step_.push_back(obj_mask_grown_by_smooth_surface);
+    view.octree_.reset();   // only needed while the view is segmented
 
     std::vector<bool> obj_mask_eroded = erodeIndices(obj_mask_grown_by_smooth_surface, *view.cloud_);
     remove_nan_points(*view.cloud_, obj_mask_eroded);
@@ -967,6 +1226,17 @@ IOL::learn_object (const pcl::PointCloud<PointT> &cloud, const Eigen::Matrix4f &
         view.obj_mask_step_.back() = view.obj_mask_step_[0];
         std::cout << "After postprocessing the initial frame not enough points are left. Therefore taking the original provided indices." << std::endl;
     }
+
+    if ( param_.streaming_ )
+    {
+        computeObjectCloud(view);
+
+        if ( grph_.size() > param_.num_full_res_views_ )
+        {
+            for (size_t view_id = 0; view_id < grph_.size() - param_.num_full_res_views_; view_id++)
+                compactView( grph_[view_id] );
+        }
+    }
 //    visualize();
     return true;
 }
@@ -1012,6 +1282,11 @@ IOL::printParams(std::ostream &ostr) const
          << "apply minimimum spanning tree: " << param_.do_mst_refinement_ << std::endl
          << "ratio_cluster_obj_supported_: " << param_.ratio_cluster_obj_supported_ << std::endl
          << "ratio_cluster_occluded_: " << param_.ratio_cluster_occluded_ << std::endl
+         << "streaming: " << param_.streaming_ << std::endl
+         << "num_full_res_views_: " << param_.num_full_res_views_ << std::endl
+         << "object_voxel_size_: " << param_.object_voxel_size_ << std::endl
+         << "spill_dir_: " << param_.spill_dir_ << std::endl
+         << "max_icp_cached_views_: " << param_.max_icp_cached_views_ << std::endl
          << "smooth_clustering_param_inlDist: " << p_param_.inlDist << std::endl
          << "smooth_clustering_param_inlDistSmooth: " << p_param_.inlDistSmooth << std::endl
          << "smooth_clustering_param_least_squares_refinement: " << p_param_.least_squares_refinement << std::endl
@@ -30,6 +30,9 @@ IOL::createBigCloud()
      size_t kept_keyframes=0;
      for (size_t view_id = 0; view_id < grph_.size(); view_id++)
      {
+         if ( grph_[view_id].is_compacted_ )   // point clouds of compacted views have been released (streaming mode)
+             continue;
+
          // scene reconstruction without noise model
          pcl::PointCloud<PointT>::Ptr cloud_trans (new pcl::PointCloud<PointT>());
          pcl::transformPointCloud(*grph_[view_id].cloud_, *cloud_trans, grph_[view_id].camera_pose_);
@@ -108,6 +111,9 @@ IOL::visualize_clusters()
 
     for (size_t view_id = 0; view_id < grph_.size(); view_id++)
     {
+        if ( grph_[view_id].is_compacted_ )
+            continue;
+
         std::stringstream name;
         name << "cloud_" << view_id;
         pcl::visualization::PointCloudColorHandlerRGBField<PointT> rgb_handler(grph_[view_id].cloud_);
@@ -205,6 +211,9 @@ IOL::visualize()
 
     for (size_t view_id = 0; view_id < grph_.size(); view_id++)
     {
+        if ( grph_[view_id].is_compacted_ )
+            continue;
+
         size_t subwindow_id=0;
 
         pcl::PointCloud<PointT>::Ptr cloud_trans (new pcl::PointCloud<PointT>());
@@ -270,6 +279,9 @@ IOL::writeImagesToDisk(const std::string &path, bool crop)
 
     for (size_t view_id = 0; view_id < grph_.size(); view_id++)
     {
+        if ( grph_[view_id].is_compacted_ )
+            continue;
+
         std::stringstream filename;
         filename << path << "/" << view_id << ".jpg";
         cv::imwrite( filename.str(), ConvertPCLCloud2Image(*grph_[view_id].cloud_));
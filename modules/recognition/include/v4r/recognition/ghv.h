@@ -170,6 +170,8 @@ namespace v4r
           double plane_thrAngle_;  /// @brief Threshold of normal angle in degree for plane clustering
           int knn_plane_clustering_search_;  /// @brief sets the number of points used for searching nearest neighbors in unorganized point clouds (used in plane segmentation)
           bool visualize_go_cues_; /// @brief visualizes the cues during the computation and shows cost and number of evaluations. Useful for debugging
+          bool use_projective_association_; /// @brief if true and the scene is organized, model points are associated with scene points by searching a pixel window around their projection instead of an octree radius search
+          int projective_search_window_; /// @brief maximum half-size (in pixels) of the image window searched for a projected model point (only used with projective association)
 
           Parameter (
                   double color_sigma_l = 0.6f,
@@ -209,7 +211,9 @@ namespace v4r
                   double plane_inlier_distance = 0.02f,
                   double plane_thrAngle = 30,
                   int knn_plane_clustering_search = 10,
-                  bool visualize_go_cues = false
+                  bool visualize_go_cues = false,
+                  bool use_projective_association = false,
+                  int projective_search_window = 10
                   )
               :
                 HypothesisVerification<ModelT, SceneT>::Parameter(),
@@ -250,7 +254,9 @@ namespace v4r
                 plane_inlier_distance_ ( plane_inlier_distance ),
                 plane_thrAngle_ ( plane_thrAngle ),
                 knn_plane_clustering_search_ ( knn_plane_clustering_search ),
-                visualize_go_cues_ ( visualize_go_cues )
+                visualize_go_cues_ ( visualize_go_cues ),
+                use_projective_association_ ( use_projective_association ),
+                projective_search_window_ ( projective_search_window )
           {}
       }param_;
 
@@ -619,6 +625,16 @@ namespace v4r
 
       typename boost::shared_ptr<pcl::octree::OctreePointCloudSearch<SceneT> > octree_scene_downsampled_;
 
+      std::vector<int> scene_pixel_to_downsampled_; /// @brief pixel of the organized scene -> index of the downsampled scene point (-1 if none)
+      bool projective_association_; /// @brief true if neighbors are searched in the image plane instead of the octree
+
+      /**
+       * @brief radius search in the downsampled scene by scanning the image window around the projection of p
+       * (same output as octree radiusSearch, i.e. squared distances)
+       */
+      template<typename PointT>
+      void projectiveRadiusSearch(const PointT &p, float radius, std::vector<int> &indices, std::vector<float> &sqr_distances) const;
+
       int min_contribution_;
       bool LS_short_circuit_;
       std::vector<std::vector<float> > points_one_plane_sides_;
@@ -675,6 +691,7 @@ namespace v4r
 
         max_threads_ = 1;
         scene_and_normals_set_from_outside_ = false;
+        projective_association_ = false;
       }
 
       void setMeanAndCovariance(Eigen::VectorXf & mean, Eigen::MatrixXf & cov)
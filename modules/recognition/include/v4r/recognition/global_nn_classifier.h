@@ -28,6 +28,7 @@
 #include <glog/logging.h>
 #include <flann/flann.h>
 #include <pcl/common/common.h>
+#include <pcl/PointIndices.h>
 #include <v4r/recognition/global_recognizer.h>
 #include <v4r/recognition/source.h>
 #include <v4r/common/faat_3d_rec_framework_defines.h>
@@ -97,6 +98,8 @@ protected:
     flann::Matrix<float> flann_data_;
     flann::Index<DistT> * flann_index_;
     std::vector<flann_model> flann_models_;
+    std::vector<int> flann_model_class_;     /// @brief class index (in class_names_) of each flann model
+    std::vector<std::string> class_names_;
 
     /** @brief load features from disk and create flann structure */
     void
@@ -127,11 +130,16 @@ protected:
     size_t NN_;
     std::string first_nn_category_;
 
+    /** @brief additional estimators for the threads of the offline training and the batch classification */
+    std::vector<typename boost::shared_ptr<GlobalEstimator<PointInT> > > training_estimators_;
+    int num_training_threads_;  /// @brief number of threads used for training the models (0 ... number of available cores)
+
 public:
 
     GlobalNNClassifier ()
     {
         NN_ = 1;
+        num_training_threads_ = 0;
     }
 
     ~GlobalNNClassifier ()
@@ -153,6 +161,20 @@ public:
     void
     classify ();
 
+    /**
+     * @brief classifies several clusters of a cloud at once. The signatures are computed in parallel
+     * and all clusters are matched in a single nearest neighbor search.
+     * @param cloud input cloud
+     * @param clusters indices of the objects to be classified
+     * @param categories categories of each cluster sorted by their confidence (empty if no signature could be computed for the cluster)
+     * @param confidences confidence of each category (fraction of the NN_ neighbors voting for it)
+     */
+    void
+    classify (const PointInTPtr &cloud,
+              const std::vector<pcl::PointIndices> &clusters,
+              std::vector<std::vector<std::string> > &categories,
+              std::vector<std::vector<float> > &confidences);
+
     /** \brief Sets the model data source */
     void
     setDataSource (const typename boost::shared_ptr<Source<PointInT> > & source)
@@ -165,6 +187,23 @@ public:
     {
         descr_name_ = name;
     }
+
+    /**
+     * @brief sets additional global estimators (configured like the feature estimator) for training the models and batch classification.
+     * Each thread uses one of the estimators, further threads use copies of the feature estimator (see GlobalEstimator::makeCopy).
+     * Only needed for estimators which can not be copied, threads sharing an estimator compute their signatures one after the other.
+     */
+    void
+    setTrainingFeatureEstimators (const std::vector<typename boost::shared_ptr<GlobalEstimator<PointInT> > > & feats)
+    {
+        training_estimators_ = feats;
+    }
+
+    void
+    setNumTrainingThreads (int n)
+    {
+        num_training_threads_ = n;
+    }
 };
 }
 #endif /* REC_FRAMEWORK_GLOBAL_PIPELINE_H_ */
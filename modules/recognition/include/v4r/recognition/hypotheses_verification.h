@@ -221,53 +221,63 @@ namespace v4r
         if (scene_cloud_ == 0)
           throw std::runtime_error("setSceneCloud should be called before adding the model if reasoning about occlusions...");
 
+        // the scene depth buffer is built once and shared by all hypotheses
         ZBuffering<ModelT, SceneT> zbuffer_scene (param_.zbuffer_scene_resolution_, param_.zbuffer_scene_resolution_, 1.f);
-        if (!occlusion_cloud_->isOrganized ())
+        DepthBuffer scene_depth;
+        if (occlusion_cloud_->isOrganized ())
+            scene_depth.setInputCloud (*occlusion_cloud_, param_.focal_length_);
+        else
         {
             PCL_WARN("Scene not organized... filtering using computed depth buffer\n");
             zbuffer_scene.computeDepthMap (*occlusion_cloud_, true);
         }
 
+        const bool filter_normals = occlusion_cloud_->isOrganized () && normals_set_ && requires_normals_;
+        std::vector<typename pcl::PointCloud<ModelT>::Ptr> visible_models (models.size ());
+        std::vector<pcl::PointCloud<pcl::Normal>::Ptr> visible_normal_models (filter_normals ? models.size () : 0);
         visible_indices_.resize(models.size());
 
-        for (size_t i = 0; i < models.size (); i++)
+#pragma omp parallel
         {
-
-          //self-occlusions
-          typename pcl::PointCloud<ModelT>::Ptr filtered (new pcl::PointCloud<ModelT> ());
+          // per thread scratch buffers, reused for all hypotheses of this thread
           ZBuffering<ModelT, SceneT> zbuffer_self_occlusion (param_.zbuffer_self_occlusion_resolution_, param_.zbuffer_self_occlusion_resolution_, 1.f);
-          zbuffer_self_occlusion.computeDepthMap (*models[i], true);
-
+          DepthBuffer::Scratch scratch;
           std::vector<int> self_occlusion_indices;
-          zbuffer_self_occlusion.filter (*models[i], self_occlusion_indices, param_.occlusion_thres_);
-          pcl::copyPointCloud (*models[i], self_occlusion_indices, *filtered);
-
-          typename pcl::PointCloud<ModelT>::ConstPtr const_filtered(new pcl::PointCloud<ModelT> (*filtered));
-          //typename pcl::PointCloud<ModelT>::ConstPtr const_filtered(new pcl::PointCloud<ModelT> (*models[i]));
-
-          //scene-occlusions
-
           std::vector<int> indices_cloud_occlusion;
-          if (occlusion_cloud_->isOrganized ())
-          {
-            filtered = filter<ModelT,SceneT> (*occlusion_cloud_, *const_filtered, param_.focal_length_, param_.occlusion_thres_, indices_cloud_occlusion);
-            visible_indices_[i].resize(filtered->points.size());
+          pcl::PointCloud<ModelT> self_visible;
 
-            for(size_t k=0; k < indices_cloud_occlusion.size(); k++)
-                visible_indices_[i][k] = self_occlusion_indices[indices_cloud_occlusion[k]];
-
-            if(normals_set_ && requires_normals_) {
-              pcl::PointCloud<pcl::Normal>::Ptr filtered_normals (new pcl::PointCloud<pcl::Normal> ());
-              pcl::copyPointCloud(*complete_normal_models_[i], visible_indices_[i], *filtered_normals);
-              visible_normal_models_.push_back(filtered_normals);
+#pragma omp for schedule(dynamic)
+          for (int i = 0; i < static_cast<int> (models.size ()); i++)
+          {
+            //self-occlusions
+            zbuffer_self_occlusion.computeDepthMap (*models[i], true);
+            zbuffer_self_occlusion.filter (*models[i], self_occlusion_indices, param_.occlusion_thres_);
+            pcl::copyPointCloud (*models[i], self_occlusion_indices, self_visible);
+
+            //scene-occlusions
+            visible_models[i].reset (new pcl::PointCloud<ModelT> ());
+            if (occlusion_cloud_->isOrganized ())
+            {
+              scene_depth.filter (self_visible, param_.occlusion_thres_, indices_cloud_occlusion, scratch);
+              visible_indices_[i].resize(indices_cloud_occlusion.size());
+
+              for(size_t k=0; k < indices_cloud_occlusion.size(); k++)
+                  visible_indices_[i][k] = self_occlusion_indices[indices_cloud_occlusion[k]];
+
+              pcl::copyPointCloud (*models[i], visible_indices_[i], *visible_models[i]);
+
+              if(filter_normals) {
+                visible_normal_models[i].reset (new pcl::PointCloud<pcl::Normal> ());
+                pcl::copyPointCloud(*complete_normal_models_[i], visible_indices_[i], *visible_normal_models[i]);
+              }
             }
+            else
+              zbuffer_scene.filter (self_visible, *visible_models[i], param_.occlusion_thres_);
           }
-          else
-            zbuffer_scene.filter (*const_filtered, *filtered, param_.occlusion_thres_);
-
-          visible_models_.push_back (filtered);
         }
 
+        visible_models_.insert (visible_models_.end (), visible_models.begin (), visible_models.end ());
+        visible_normal_models_.insert (visible_normal_models_.end (), visible_normal_models.begin (), visible_normal_models.end ());
         complete_models_ = models;
       }
 
@@ -290,7 +300,12 @@ namespace v4r
       scene_cloud_downsampled_.reset(new pcl::PointCloud<SceneT>());
 
       if(param_.resolution_ <= 0.f)
+      {
           scene_cloud_downsampled_.reset(new pcl::PointCloud<SceneT>(*scene_cloud));
+          scene_sampled_indices_.resize(scene_cloud->points.size());
+          for(size_t i=0; i < scene_sampled_indices_.size(); i++)
+              scene_sampled_indices_[i] = i;
+      }
       else
       {
         /*pcl::VoxelGrid<SceneT> voxel_grid;
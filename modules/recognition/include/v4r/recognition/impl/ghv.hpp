@@ -50,6 +50,8 @@
 #include <boost/random/uniform_01.hpp>
 #include <boost/graph/connected_components.hpp>
 #include <boost/graph/adjacency_matrix.hpp>
+#include <boost/unordered_map.hpp>
+#include <algorithm>
 
 namespace v4r {
 
@@ -213,6 +215,17 @@ GHV<ModelT, SceneT>::addPlanarModels(std::vector<PlaneModel<ModelT> > & models)
     model_to_planar_model_.clear();
     //iterate through the planar models and append them to complete_models_?
 
+    // the scene depth buffer is the same for all planes
+    ZBuffering<ModelT, SceneT> zbuffer_scene (param_.zbuffer_scene_resolution_, param_.zbuffer_scene_resolution_, 1.f);
+    DepthBuffer scene_depth;
+    DepthBuffer::Scratch scratch;
+    if (occlusion_cloud_->isOrganized ())
+        scene_depth.setInputCloud (*occlusion_cloud_, param_.focal_length_);
+    else if (!planar_models_.empty())
+        zbuffer_scene.computeDepthMap (*occlusion_cloud_, true);
+
+    std::vector<int> indices_cloud_occlusion;
+
     size_t size_start = visible_models_.size();
     for(size_t i=0; i < planar_models_.size(); i++)
     {
@@ -220,20 +233,15 @@ GHV<ModelT, SceneT>::addPlanarModels(std::vector<PlaneModel<ModelT> > & models)
         typename pcl::PointCloud<SceneT>::Ptr plane_cloud = planar_models_[i].projectPlaneCloud();
         complete_models_.push_back(plane_cloud);
 
-        ZBuffering<ModelT, SceneT> zbuffer_scene (param_.zbuffer_scene_resolution_, param_.zbuffer_scene_resolution_, 1.f);
-        if (!occlusion_cloud_->isOrganized ())
-            zbuffer_scene.computeDepthMap (*occlusion_cloud_, true);
-
-        //self-occlusions
-        typename pcl::PointCloud<ModelT>::Ptr filtered (new pcl::PointCloud<ModelT> (*plane_cloud));
-        typename pcl::PointCloud<ModelT>::ConstPtr const_filtered(new pcl::PointCloud<ModelT> (*filtered));
-
-        std::vector<int> indices_cloud_occlusion;
+        typename pcl::PointCloud<ModelT>::Ptr filtered (new pcl::PointCloud<ModelT> ());
 
         if (occlusion_cloud_->isOrganized ())
-            filtered = filter<ModelT,SceneT> (*occlusion_cloud_, *const_filtered, param_.focal_length_, param_.occlusion_thres_, indices_cloud_occlusion);
+        {
+            scene_depth.filter (*plane_cloud, param_.occlusion_thres_, indices_cloud_occlusion, scratch);
+            pcl::copyPointCloud (*plane_cloud, indices_cloud_occlusion, *filtered);
+        }
         else
-            zbuffer_scene.filter (*const_filtered, *filtered, param_.occlusion_thres_);
+            zbuffer_scene.filter (*plane_cloud, *filtered, param_.occlusion_thres_);
 
         visible_models_.push_back (filtered);
 
@@ -449,15 +457,24 @@ GHV<ModelT, SceneT>::initialize()
     {
         scene_normals_.reset (new pcl::PointCloud<pcl::Normal> ());
 
+        // keep the mapping to the (organized) scene in sync with the downsampled cloud
+        bool has_sampled_indices = scene_sampled_indices_.size() == scene_cloud_downsampled_->points.size ();
+        if (!has_sampled_indices)
+            scene_sampled_indices_.clear();
+
         size_t kept = 0;
         for (size_t i = 0; i < scene_cloud_downsampled_->points.size (); ++i) {
             if ( pcl::isFinite( scene_cloud_downsampled_->points[i]) )
             {
                 scene_cloud_downsampled_->points[kept] = scene_cloud_downsampled_->points[i];
+                if (has_sampled_indices)
+                    scene_sampled_indices_[kept] = scene_sampled_indices_[i];
                 kept++;
             }
         }
 
+        if (has_sampled_indices)
+            scene_sampled_indices_.resize(kept);
         scene_cloud_downsampled_->points.resize(kept);
         scene_cloud_downsampled_->width = kept;
         scene_cloud_downsampled_->height = 1;
@@ -479,11 +496,13 @@ GHV<ModelT, SceneT>::initialize()
             {
                 scene_normals_->points[kept] = scene_normals_->points[i];
                 scene_cloud_downsampled_->points[kept] = scene_cloud_downsampled_->points[i];
-                scene_sampled_indices_[kept] = scene_sampled_indices_[i];
+                if (has_sampled_indices)
+                    scene_sampled_indices_[kept] = scene_sampled_indices_[i];
                 kept++;
             }
         }
-        scene_sampled_indices_.resize(kept);
+        if (has_sampled_indices)
+            scene_sampled_indices_.resize(kept);
 
         scene_normals_->points.resize (kept);
         scene_normals_->width = kept;
@@ -517,6 +536,19 @@ GHV<ModelT, SceneT>::initialize()
     octree_scene_downsampled_->setInputCloud(scene_cloud_downsampled_);
     octree_scene_downsampled_->addPointsFromInputCloud();
 
+    // image-space association needs the pixel of every downsampled point
+    projective_association_ = false;
+    scene_pixel_to_downsampled_.clear();
+    if (param_.use_projective_association_ && scene_cloud_->isOrganized()
+            && !scene_and_normals_set_from_outside_
+            && scene_sampled_indices_.size() == scene_cloud_downsampled_->points.size())
+    {
+        scene_pixel_to_downsampled_.resize(scene_cloud_->width * scene_cloud_->height, -1);
+        for (size_t i = 0; i < scene_sampled_indices_.size(); i++)
+            scene_pixel_to_downsampled_[ scene_sampled_indices_[i] ] = i;
+        projective_association_ = true;
+    }
+
     //compute segmentation of the scene if detect_clutter_
     if (param_.detect_clutter_)
     {
@@ -792,76 +824,44 @@ GHV<ModelT, SceneT>::initialize()
             return false;
         }
 
-        //compute the bounding boxes for the models to create an occupancy grid
+        //sparse occupancy grid of the complete models. Only occupied voxels get an entry in complete_cloud_occupancy_by_RM_,
+        //so memory and the sweeps over the grid scale with the occupied volume and not with the bounding box of all hypotheses
         {
             pcl::ScopeTime tcues ("complete_cloud_occupancy_by_RM_");
-            ModelT min_pt_all, max_pt_all;
-            min_pt_all.x = min_pt_all.y = min_pt_all.z = std::numeric_limits<float>::max ();
-            max_pt_all.x = max_pt_all.y = max_pt_all.z = std::numeric_limits<float>::min ();
+            boost::unordered_map<boost::uint64_t, int> voxel_ids;
+            const float inv_res = 1.f / param_.res_occupancy_grid_;
 
             for (size_t i = 0; i < recognition_models_.size (); i++)
             {
                 if(!valid_model_[i])
                     continue;
 
-                ModelT min_pt, max_pt;
-                pcl::getMinMax3D (*complete_models_[i], min_pt, max_pt);
-
-                if (min_pt.x < min_pt_all.x)
-                    min_pt_all.x = min_pt.x;
-
-                if (min_pt.y < min_pt_all.y)
-                    min_pt_all.y = min_pt.y;
-
-                if (min_pt.z < min_pt_all.z)
-                    min_pt_all.z = min_pt.z;
-
-                if (max_pt.x > max_pt_all.x)
-                    max_pt_all.x = max_pt.x;
-
-                if (max_pt.y > max_pt_all.y)
-                    max_pt_all.y = max_pt.y;
-
-                if (max_pt.z > max_pt_all.z)
-                    max_pt_all.z = max_pt.z;
-            }
-
-            size_t size_x, size_y, size_z;
-            size_x = static_cast<size_t> (std::abs (max_pt_all.x - min_pt_all.x) / param_.res_occupancy_grid_ + 1.5f);  // rounding up and add 1
-            size_y = static_cast<size_t> (std::abs (max_pt_all.y - min_pt_all.y) / param_.res_occupancy_grid_ + 1.5f);
-            size_z = static_cast<size_t> (std::abs (max_pt_all.z - min_pt_all.z) / param_.res_occupancy_grid_ + 1.5f);
-
-            complete_cloud_occupancy_by_RM_.resize (size_x * size_y * size_z, 0);
-
-            for (size_t i = 0; i < recognition_models_.size (); i++)
-            {
-                if(!valid_model_[i])
-                    continue;
-
-                std::vector<bool> banned_vector(size_x * size_y * size_z, false);   // what's the purpose of this?
-
-                recognition_models_[i]->complete_cloud_occupancy_indices_.resize(complete_models_[i]->points.size ());
+                std::vector<int> &occ_indices = recognition_models_[i]->complete_cloud_occupancy_indices_;
+                occ_indices.resize(complete_models_[i]->points.size ());
                 size_t used = 0;
 
                 for (size_t j = 0; j < complete_models_[i]->points.size (); j++)
                 {
-                    size_t pos_x, pos_y, pos_z;
-                    pos_x = static_cast<size_t>( (complete_models_[i]->points[j].x - min_pt_all.x) / param_.res_occupancy_grid_);
-                    pos_y = static_cast<size_t>( (complete_models_[i]->points[j].y - min_pt_all.y) / param_.res_occupancy_grid_);
-                    pos_z = static_cast<size_t>( (complete_models_[i]->points[j].z - min_pt_all.z) / param_.res_occupancy_grid_);
+                    const ModelT &pt = complete_models_[i]->points[j];
 
-                    size_t idx = pos_z * size_x * size_y + pos_y * size_x + pos_x;
+                    // 21 bit per axis (+-5km at 5mm resolution)
+                    const boost::uint64_t pos_x = static_cast<boost::uint64_t>( static_cast<int>( floor(pt.x * inv_res) ) + (1<<20) ) & 0x1FFFFF;
+                    const boost::uint64_t pos_y = static_cast<boost::uint64_t>( static_cast<int>( floor(pt.y * inv_res) ) + (1<<20) ) & 0x1FFFFF;
+                    const boost::uint64_t pos_z = static_cast<boost::uint64_t>( static_cast<int>( floor(pt.z * inv_res) ) + (1<<20) ) & 0x1FFFFF;
+                    const boost::uint64_t key = (pos_z << 42) | (pos_y << 21) | pos_x;
 
-                    if ( !banned_vector[idx] )
-                    {
-                        recognition_models_[i]->complete_cloud_occupancy_indices_[used] = idx;
-                        banned_vector[idx] = true;
-                        used++;
-                    }
+                    std::pair<boost::unordered_map<boost::uint64_t, int>::iterator, bool> it =
+                            voxel_ids.insert( std::make_pair(key, static_cast<int>(voxel_ids.size())) );
+
+                    occ_indices[used++] = it.first->second;
                 }
 
-                recognition_models_[i]->complete_cloud_occupancy_indices_.resize(used);
+                // each model occupies a voxel only once
+                std::sort(occ_indices.begin(), occ_indices.begin() + used);
+                occ_indices.resize( std::unique(occ_indices.begin(), occ_indices.begin() + used) - occ_indices.begin() );
             }
+
+            complete_cloud_occupancy_by_RM_.resize (voxel_ids.size (), 0);
         }
     }
 
@@ -1307,12 +1307,19 @@ GHV<ModelT, SceneT>::fill_structures(std::vector<int> & cc_indices, std::vector<
         }
     }
 
+    // sum of the occupancy of all voxels occupied multiple times. Only the voxels of the active models of this component
+    // are occupied, and each model occupies a voxel once, so it is enough to visit the voxels of the active models
     int occupied_multiple = 0;
-    for (size_t i = 0; i < complete_cloud_occupancy_by_RM_.size (); i++)
+    for (size_t j = 0; j < recognition_models_.size (); j++)
     {
-        if (complete_cloud_occupancy_by_RM_[i] > 1)
+        if(!initial_solution[j])
+            continue;
+
+        const std::vector<int> &occ_indices = recognition_models_[j]->complete_cloud_occupancy_indices_;
+        for (size_t i = 0; i < occ_indices.size (); i++)
         {
-            occupied_multiple += complete_cloud_occupancy_by_RM_[i];
+            if (complete_cloud_occupancy_by_RM_[ occ_indices[i] ] > 1)
+                occupied_multiple++;
         }
     }
 
@@ -1358,12 +1365,10 @@ template<typename ModelT, typename SceneT>
 void
 GHV<ModelT, SceneT>::clear_structures()
 {
-    size_t kk = complete_cloud_occupancy_by_RM_.size();
     explained_by_RM_.clear();
     explained_by_RM_distance_weighted.clear();
     previous_explained_by_RM_distance_weighted.clear();
     unexplained_by_RM_neighboorhods.clear();
-    complete_cloud_occupancy_by_RM_.clear();
     explained_by_RM_model.clear();
     duplicates_by_RM_weighted_.clear();
 
@@ -1372,7 +1377,7 @@ GHV<ModelT, SceneT>::clear_structures()
     explained_by_RM_distance_weighted.resize (scene_cloud_downsampled_->points.size (), 0);
     previous_explained_by_RM_distance_weighted.resize (scene_cloud_downsampled_->points.size ());
     unexplained_by_RM_neighboorhods.resize (scene_cloud_downsampled_->points.size (), 0.f);
-    complete_cloud_occupancy_by_RM_.resize(kk, 0);
+    std::fill(complete_cloud_occupancy_by_RM_.begin(), complete_cloud_occupancy_by_RM_.end(), 0);    // sparse grid, only occupied voxels
     explained_by_RM_model.resize (scene_cloud_downsampled_->points.size (), -1);
 }
 
@@ -2608,6 +2613,53 @@ GHV<ModelT, SceneT>::specifyColor(size_t id, Eigen::MatrixXf & lookup, boost::sh
     }
 }
 
+template<typename ModelT, typename SceneT>
+template<typename PointT>
+void
+GHV<ModelT, SceneT>::projectiveRadiusSearch (const PointT &p, float radius, std::vector<int> &indices, std::vector<float> &sqr_distances) const
+{
+    indices.clear();
+    sqr_distances.clear();
+
+    const float z = p.z;
+    if ( !pcl_isfinite(z) || z <= 0.f )
+        return;
+
+    const int width = static_cast<int>(scene_cloud_->width);
+    const int height = static_cast<int>(scene_cloud_->height);
+    const float f = param_.focal_length_;
+    const float cx = (static_cast<float> (width) / 2.f - 0.5f);
+    const float cy = (static_cast<float> (height) / 2.f - 0.5f);
+    const int u = static_cast<int> (f * p.x / z + cx);
+    const int v = static_cast<int> (f * p.y / z + cy);
+
+    // half-size of the pixel window covering a sphere with the given radius around p
+    int win = param_.projective_search_window_;
+    if (z > radius)
+        win = std::min(win, static_cast<int>( std::ceil( f * radius / (z - radius) ) ));
+
+    const float sqr_radius = radius * radius;
+    const Eigen::Vector3f pt = p.getVector3fMap();
+
+    for (int y = std::max(0, v - win); y <= std::min(height - 1, v + win); y++)
+    {
+        const int *row = &scene_pixel_to_downsampled_[y * width];
+        for (int x = std::max(0, u - win); x <= std::min(width - 1, u + win); x++)
+        {
+            const int idx = row[x];
+            if (idx < 0)
+                continue;
+
+            const float sqr_d = (scene_cloud_downsampled_->points[idx].getVector3fMap() - pt).squaredNorm();
+            if (sqr_d <= sqr_radius)
+            {
+                indices.push_back(idx);
+                sqr_distances.push_back(sqr_d);
+            }
+        }
+    }
+}
+
 template<typename ModelT, typename SceneT>
 bool
 GHV<ModelT, SceneT>::addModel (size_t model_id, boost::shared_ptr<GHVRecognitionModel<ModelT> > & recog_model)
@@ -2641,10 +2693,10 @@ GHV<ModelT, SceneT>::addModel (size_t model_id, boost::shared_ptr<GHVRecognition
     std::vector<float> outliers_weight;
     std::vector<float> explained_indices_distances;
 
-    //which point first from the scene is explained by a point j_k with dist d_k from the model
-    std::map<int, boost::shared_ptr<std::vector<std::pair<int, float> > > > model_explains_scene_points;
-    std::map<int, boost::shared_ptr<std::vector<std::pair<int, float> > > > model_explains_scene_points_color_weight;
-    std::map<int, boost::shared_ptr<std::vector<std::pair<int, float> > > >::iterator it;
+    //which point from the scene is explained by a model point with (squared) distance d
+    //stored as (scene point, (d, model point)), sorted afterwards to find the closest model point per scene point
+    std::vector<std::pair<int, std::pair<float, int> > > model_explains_scene_points;
+    std::vector<float> model_point_color_weight; // best color weight of each model point
 
     outliers_weight.resize (recog_model->visible_cloud_->points.size ());
     recog_model->outlier_indices_.resize (recog_model->visible_cloud_->points.size ());
@@ -2692,9 +2744,13 @@ GHV<ModelT, SceneT>::addModel (size_t model_id, boost::shared_ptr<GHVRecognition
     recog_model->inlier_distances_.resize(recog_model->visible_cloud_->points.size ());
     for (size_t pt = 0; pt < recog_model->visible_cloud_->points.size (); pt++)
     {
-        octree_scene_downsampled_->radiusSearch (recog_model->visible_cloud_->points[pt], param_.inliers_threshold_,
-                                                 recog_model->inlier_indices_[pt], recog_model->inlier_distances_[pt],
-                                                 std::numeric_limits<int>::max ());
+        if (projective_association_)
+            projectiveRadiusSearch (recog_model->visible_cloud_->points[pt], param_.inliers_threshold_,
+                                    recog_model->inlier_indices_[pt], recog_model->inlier_distances_[pt]);
+        else
+            octree_scene_downsampled_->radiusSearch (recog_model->visible_cloud_->points[pt], param_.inliers_threshold_,
+                                                     recog_model->inlier_indices_[pt], recog_model->inlier_distances_[pt],
+                                                     std::numeric_limits<int>::max ());
     }
 
     Eigen::MatrixXf lookup;
@@ -2718,6 +2774,9 @@ GHV<ModelT, SceneT>::addModel (size_t model_id, boost::shared_ptr<GHVRecognition
     float sigma_y = 2.f * param_.color_sigma_l_ * param_.color_sigma_l_;
     Eigen::Vector3f color_m, color_s;
 
+    if(!is_planar_model && !param_.ignore_color_even_if_exists_)
+        model_point_color_weight.resize (recog_model->visible_cloud_->points.size (), 0.f);
+
     for (size_t i = 0; i < recog_model->visible_cloud_->points.size (); i++)
     {
         bool outlier = false;
@@ -2800,40 +2859,12 @@ GHV<ModelT, SceneT>::addModel (size_t model_id, boost::shared_ptr<GHVRecognition
 
             if(is_planar_model || param_.ignore_color_even_if_exists_ || weights[0] > param_.best_color_weight_) //best weight is not an outlier
             {
+                //nn_distances is squared!!
                 for (size_t k = 0; k < nn_distances.size (); k++)
-                {
-                    std::pair<int, float> pair = std::make_pair (i, nn_distances[k]); //i is a index to a model point and then distance
-                    //nn_distances is squared!!
+                    model_explains_scene_points.push_back ( std::make_pair (nn_indices[k], std::make_pair (nn_distances[k], static_cast<int>(i)) ) );
 
-                    it = model_explains_scene_points.find (nn_indices[k]);
-                    if (it == model_explains_scene_points.end ())
-                    {
-                        boost::shared_ptr<std::vector<std::pair<int, float> > > vec (new std::vector<std::pair<int, float> > ());
-                        vec->push_back (pair);
-                        model_explains_scene_points[nn_indices[k]] = vec;
-                    }
-                    else
-                    {
-                        it->second->push_back (pair);
-                    }
-
-                    if(!is_planar_model && !param_.ignore_color_even_if_exists_)
-                    {
-                        //std::pair<int, float> pair_color = std::make_pair (i, weights_not_sorted[k]);
-                        std::pair<int, float> pair_color = std::make_pair (i, weights[0]);
-                        it = model_explains_scene_points_color_weight.find (nn_indices[k]);
-                        if (it == model_explains_scene_points_color_weight.end ())
-                        {
-                            boost::shared_ptr<std::vector<std::pair<int, float> > > vec (new std::vector<std::pair<int, float> > ());
-                            vec->push_back (pair_color);
-                            model_explains_scene_points_color_weight[nn_indices[k]] = vec;
-                        }
-                        else
-                        {
-                            it->second->push_back (pair_color);
-                        }
-                    }
-                }
+                if(!is_planar_model && !param_.ignore_color_even_if_exists_)
+                    model_point_color_weight[i] = weights[0];
             }
             else
             {
@@ -2905,49 +2936,23 @@ GHV<ModelT, SceneT>::addModel (size_t model_id, boost::shared_ptr<GHVRecognition
         }
     }
 
+    // sorting by scene point, distance and model point puts the closest model point (lowest index on ties) first
+    std::sort (model_explains_scene_points.begin (), model_explains_scene_points.end ());
+
     //float inliers_gaussian = 2 * std::pow(inliers_threshold_ + resolution_, 2);
-    for (it = model_explains_scene_points.begin (); it != model_explains_scene_points.end (); ++it)
+    for (size_t e = 0; e < model_explains_scene_points.size (); e++)
     {
         //ATTENTION, TODO => use normal information to select closest!
+        const int scene_pt = model_explains_scene_points[e].first;
+        if (e > 0 && model_explains_scene_points[e-1].first == scene_pt)
+            continue;
 
-        Eigen::Vector3f scene_p_normal = scene_normals_->points[it->first].getNormalVector3fMap ();
-        scene_p_normal.normalize();
-
-        bool use_normal_info_for_closest = false;
-        size_t closest = 0;
-        float min_d = std::numeric_limits<float>::infinity ();
-        for (size_t i = 0; i < it->second->size (); i++)
-        {
-            if(use_normal_info_for_closest)
-            {
-                Eigen::Vector3f model_p_normal;
-                if(param_.use_normals_from_visible_ && (visible_normal_models_.size() == complete_models_.size()))
-                {
-                    model_p_normal = recog_model->normals_from_visible_->points[it->second->at (i).first].getNormalVector3fMap ();
-                }
-                else
-                {
-                    model_p_normal = recog_model->normals_->points[it->second->at (i).first].getNormalVector3fMap ();
-                }
-                model_p_normal.normalize();
-
-//                float d = it->second->at (i).second;
-                //float d_weight = std::exp( -(d / inliers_gaussian));
-                //float dotp = scene_p_normal.dot (model_p_normal); //[-1,1] from antiparallel trough perpendicular to parallel
-                //float w = d_weight * dotp;
+        const int closest_model_pt = model_explains_scene_points[e].second.second;
 
-            }
-            else
-            {
-                if (it->second->at (i).second < min_d)
-                {
-                    min_d = it->second->at (i).second;
-                    closest = i;
-                }
-            }
-        }
+        Eigen::Vector3f scene_p_normal = scene_normals_->points[scene_pt].getNormalVector3fMap ();
+        scene_p_normal.normalize();
 
-        float d = it->second->at (closest).second;
+        float d = model_explains_scene_points[e].second.first;
         float d_weight = std::exp( -(d / inliers_gaussian));
 
         //it->first is index to scene point
@@ -2956,11 +2961,11 @@ GHV<ModelT, SceneT>::addModel (size_t model_id, boost::shared_ptr<GHVRecognition
 
         if(param_.use_normals_from_visible_ && (visible_normal_models_.size() == complete_models_.size()))
         {
-            model_p_normal = recog_model->normals_from_visible_->points[it->second->at (closest).first].getNormalVector3fMap ();
+            model_p_normal = recog_model->normals_from_visible_->points[closest_model_pt].getNormalVector3fMap ();
         }
         else
         {
-            model_p_normal = recog_model->normals_->points[it->second->at (closest).first].getNormalVector3fMap ();
+            model_p_normal = recog_model->normals_->points[closest_model_pt].getNormalVector3fMap ();
         }
         model_p_normal.normalize();
 
@@ -3000,12 +3005,7 @@ GHV<ModelT, SceneT>::addModel (size_t model_id, boost::shared_ptr<GHVRecognition
 
         if (!is_planar_model && !param_.ignore_color_even_if_exists_)
         {
-            std::map<int, boost::shared_ptr<std::vector<std::pair<int, float> > > >::iterator it_color;
-            it_color = model_explains_scene_points_color_weight.find(it->first);
-            if(it != model_explains_scene_points_color_weight.end())
-            {
-                d_weight *= it_color->second->at(closest).second;
-            }
+            d_weight *= model_point_color_weight[closest_model_pt];
 
 
             /*float rgb_s;
@@ -3015,7 +3015,7 @@ GHV<ModelT, SceneT>::addModel (size_t model_id, boost::shared_ptr<GHVRecognition
             typedef typename pcl::traits::fieldList<typename CloudS::PointType>::type FieldListS;
 
             pcl::for_each_type<FieldListS> (
-                        pcl::CopyIfFieldExists<typename CloudS::PointType, float> (scene_cloud_downsampled_->points[it->first],
+                        pcl::CopyIfFieldExists<typename CloudS::PointType, float> (scene_cloud_downsampled_->points[scene_pt],
                                                                                    "rgb", exists_s, rgb_s));
 
             if(exists_s)
@@ -3039,9 +3039,9 @@ GHV<ModelT, SceneT>::addModel (size_t model_id, boost::shared_ptr<GHVRecognition
         }
 
         assert((d_weight * dotp * extra_weight) <= 1.0001f);
-        explained_indices.push_back (it->first);
+        explained_indices.push_back (scene_pt);
         explained_indices_distances.push_back (d_weight * dotp * extra_weight);
-        recog_model->scene_point_explained_by_hypothesis_[it->first] = true; //this scene point is explained by this hypothesis
+        recog_model->scene_point_explained_by_hypothesis_[scene_pt] = true; //this scene point is explained by this hypothesis
     }
 
 //    recog_model->bad_information_ =  static_cast<int> (recog_model->outlier_indices_.size ());
@@ -3108,9 +3108,14 @@ GHV<ModelT, SceneT>::computeClutterCueAtOnce ()
 #pragma omp parallel for schedule(dynamic, 1) num_threads(std::min(max_threads_, omp_get_num_procs()))
     for(size_t k=0; k < explained_points_vec.size(); k++)
     {
-        octree_scene_downsampled_->radiusSearch (scene_cloud_downsampled_->points[explained_points_vec[k]],
-                                                 param_.radius_neighborhood_clutter_, nn_indices_all_points[k],
-                                                 nn_distances_all_points[k], std::numeric_limits<int>::max ());
+        if (projective_association_)
+            projectiveRadiusSearch (scene_cloud_downsampled_->points[explained_points_vec[k]],
+                                    param_.radius_neighborhood_clutter_, nn_indices_all_points[k],
+                                    nn_distances_all_points[k]);
+        else
+            octree_scene_downsampled_->radiusSearch (scene_cloud_downsampled_->points[explained_points_vec[k]],
+                                                     param_.radius_neighborhood_clutter_, nn_indices_all_points[k],
+                                                     nn_distances_all_points[k], std::numeric_limits<int>::max ());
     }
 
 //    const float min_clutter_dist = std::pow(param_.inliers_threshold_ * 0.f, 2.f); // ??? why *0.0f? --> always 0 then
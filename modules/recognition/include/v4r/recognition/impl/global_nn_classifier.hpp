@@ -24,6 +24,15 @@
 
 #include <v4r/recognition/global_nn_classifier.h>
 #include <v4r/io/eigen.h>
+#include <v4r/recognition/training_scheduler.h>
+#include <algorithm>
+#include <boost/filesystem.hpp>
+#include <boost/scoped_array.hpp>
+#include <boost/thread/mutex.hpp>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 namespace v4r
 {
@@ -33,12 +42,20 @@ void
 GlobalNNClassifier<Distance, PointInT>::loadFeaturesAndCreateFLANN ()
 {
     std::vector<ModelTPtr> models = source_->getModels();
+    flann_models_.clear();
+    flann_model_class_.clear();
+    class_names_.clear();
 
     for (size_t i = 0; i < models.size (); i++)
     {
         const ModelTPtr &m = models[i];
         const std::string path = training_dir_ + "/" + m->class_ + "/" + m->id_ + "/" + descr_name_;
 
+        std::vector<std::string>::const_iterator cit = std::find(class_names_.begin(), class_names_.end(), m->class_);
+        const int class_id = cit - class_names_.begin();
+        if (cit == class_names_.end())
+            class_names_.push_back(m->class_);
+
         std::vector<std::string> descriptor_files = io::getFilesInDirectory(path, ".*descriptor.*.txt", false);
 
         for(const std::string &d:descriptor_files)
@@ -54,6 +71,7 @@ GlobalNNClassifier<Distance, PointInT>::loadFeaturesAndCreateFLANN ()
             descr_model.first = m;
             descr_model.second = descriptor;
             flann_models_.push_back (descr_model);
+            flann_model_class_.push_back (class_id);
         }
     }
 
@@ -83,85 +101,118 @@ template<template<class > class Distance, typename PointInT>
 void
 GlobalNNClassifier<Distance, PointInT>::classify ()
 {
-    categories_.clear ();
-    confidences_.clear ();
-    first_nn_category_ = std::string ("");
+    std::vector<pcl::PointIndices> clusters (1);
+    clusters[0].indices = indices_;
 
-    estimator_->setInput(input_);
-    estimator_->setIndices(indices_);
-    std::vector<float> signature = estimator_->estimate ();
-    std::vector<index_score> indices_scores;
+    std::vector<std::vector<std::string> > categories;
+    std::vector<std::vector<float> > confidences;
+    classify (input_, clusters, categories, confidences);
 
-    ModelTPtr empty;
+    categories_ = categories[0];
+    confidences_ = confidences[0];
+    first_nn_category_ = categories_.empty() ? std::string ("") : categories_[0];
+}
 
-    flann_model histogram (empty, signature);
-    flann::Matrix<int> indices;
-    flann::Matrix<float> distances;
-    nearestKSearch (flann_index_, histogram, NN_, indices, distances);
+template<template<class > class Distance, typename PointInT>
+void
+GlobalNNClassifier<Distance, PointInT>::classify (const PointInTPtr &cloud,
+                                                  const std::vector<pcl::PointIndices> &clusters,
+                                                  std::vector<std::vector<std::string> > &categories,
+                                                  std::vector<std::vector<float> > &confidences)
+{
+    const size_t num_clusters = clusters.size();
+    categories.clear();
+    confidences.clear();
+    categories.resize(num_clusters);
+    confidences.resize(num_clusters);
+
+    if (!num_clusters)
+        return;
+
+    // compute the signatures of all clusters, each thread uses an own copy of the estimator
+    // (estimators which can not be copied are shared). No more threads than clusters, i.e. a single
+    // cluster is described by the estimator itself without making any copy.
+#ifdef _OPENMP
+    const int num_threads = std::min<int>(omp_get_max_threads(), num_clusters);
+#else
+    const int num_threads = 1;
+#endif
+    std::vector<typename boost::shared_ptr<GlobalEstimator<PointInT> > > estimators =
+            makeWorkerEstimators(estimator_, training_estimators_, num_threads);
+    boost::scoped_array<boost::mutex> estimator_mtx (new boost::mutex[estimators.size()]);
+
+    const size_t dim = flann_data_.cols;
+    std::vector<std::vector<float> > signatures (num_clusters);
+
+#pragma omp parallel for schedule(dynamic) num_threads(num_threads)
+    for (int i = 0; i < (int)num_clusters; i++)
+    {
+#ifdef _OPENMP
+        const size_t e = omp_get_thread_num() % estimators.size();
+#else
+        const size_t e = 0;
+#endif
+        boost::mutex::scoped_lock lock(estimator_mtx[e]);
+        estimators[e]->setInput(cloud);
+        estimators[e]->setIndices(clusters[i].indices);
+        signatures[i] = estimators[e]->estimate ();
+    }
 
-    //gather NN-search results
-    float score = 0;
-    for (size_t i = 0; i < NN_; ++i)
+    // clusters without a valid signature (e.g. too few points) are not classified
+    std::vector<size_t> valid_clusters;
+    for (size_t i = 0; i < num_clusters; i++)
     {
-        score = distances[0][i];
-        index_score is;
-        is.idx_models_ = indices[0][i];
-        is.score_ = score;
-        indices_scores.push_back (is);
-        std::cout << i << ": " << indices[0][i] << " with score " << score << " and model id: " << flann_models_[indices_scores[i].idx_models_].first->class_ << "/" << flann_models_[indices_scores[i].idx_models_].first->id_ <<std::endl;
+        if (signatures[i].size() == dim)
+            valid_clusters.push_back(i);
+        else
+            LOG(ERROR) << "Signature of cluster " << i << " has size " << signatures[i].size() << " instead of " << dim << ". Skipping this cluster.";
     }
 
-    std::sort (indices_scores.begin (), indices_scores.end (), sortIndexScoresOp);
-    flann_model &fm = flann_models_[indices_scores[0].idx_models_];
-    first_nn_category_ = fm.first->class_;
+    if (valid_clusters.empty())
+        return;
 
-    std::cout << "first id: " << fm.first->id_ << std::endl;
+    flann::Matrix<float> queries (new float[valid_clusters.size() * dim], valid_clusters.size(), dim);
+    for (size_t q = 0; q < valid_clusters.size(); q++)
+        memcpy (queries[q], &signatures[ valid_clusters[q] ][0], dim * sizeof(float));
 
-    std::map<std::string, float> category_map;
-    size_t num_n = std::min (NN_, indices_scores.size ());    // why?
+    // one knn search for all clusters
+    const size_t k = std::min (NN_, flann_models_.size ());
+    flann::Matrix<int> indices (new int[valid_clusters.size() * k], valid_clusters.size(), k);
+    flann::Matrix<float> distances (new float[valid_clusters.size() * k], valid_clusters.size(), k);
+    flann_index_->knnSearch (queries, indices, distances, k, flann::SearchParams (512));
 
-    std::map<std::string, float>::iterator it;
-    float normalization_term = 0;
+    // vote for the class of each neighbour, confidence is the fraction of neighbours of a class
+    std::vector<int> votes (class_names_.size(), 0);
+    std::vector<int> voted_classes;
 
-    for (size_t i = 0; i < num_n; ++i)
+    for (size_t q = 0; q < valid_clusters.size(); q++)
     {
-        std::string cat = fm.first->class_;
-        it = category_map.find (cat);
-        if (it == category_map.end ())
+        const size_t i = valid_clusters[q];
+        voted_classes.clear();
+
+        for (size_t j = 0; j < k; j++)
         {
-            category_map[cat] = 1;
-            //category_map[cat] = indices_scores[i].score_;   // is the confidence better if score is higher or lower?
+            const int c = flann_model_class_[ indices[q][j] ];
+            if (votes[c]++ == 0)
+                voted_classes.push_back(c);
         }
-        else
+
+        std::sort (voted_classes.begin(), voted_classes.end(), [&votes](int a, int b)
         {
-            it->second++;
-            //it->second += indices_scores[i].score_;
-        }
-        normalization_term += indices_scores[i].score_;
-    }
+            return votes[a] > votes[b] || (votes[a] == votes[b] && a < b);
+        });
 
-    //------ sort classification result by the confidence value---------
-    std::vector<index_score> final_indices_scores;
-    for (it = category_map.begin (); it != category_map.end (); it++)
-    {
-        float prob = it->second / static_cast<float> (num_n);
-        //float prob = static_cast<float> (it->second) / static_cast<float> (normalization_term);
-        //categories_.push_back (it->first);
-        //confidences_.push_back (prob);
-        index_score is;
-        is.model_name_ = it->first;
-        //is.idx_input_ = static_cast<int> (idx);
-        is.score_ = prob;
-        final_indices_scores.push_back (is);
+        for (int c : voted_classes)
+        {
+            categories[i].push_back (class_names_[c]);
+            confidences[i].push_back (votes[c] / static_cast<float> (k));
+            votes[c] = 0;
+        }
     }
 
-    std::sort (final_indices_scores.begin (), final_indices_scores.end (), sortIndexScoresOpDesc);
-
-    for (size_t i=0; i < final_indices_scores.size(); i++)
-    {
-        categories_.push_back (final_indices_scores[i].model_name_);
-        confidences_.push_back (final_indices_scores[i].score_);
-    }
+    delete[] queries.ptr ();
+    delete[] indices.ptr ();
+    delete[] distances.ptr ();
 }
 
 template<template<class > class Distance, typename PointInT>
@@ -179,6 +230,11 @@ GlobalNNClassifier<Distance, PointInT>::initialize (bool force_retrain)
             source_->removeDescDirectory (*models[i], training_dir_, descr_name_);
     }
 
+    // (model, view) pairs to be trained, the signatures of a model are written to a temporary directory
+    // which replaces the training directory once all its views are trained
+    std::vector<size_t> untrained_models;
+    std::vector<std::pair<size_t, size_t> > jobs;
+
     for (size_t i = 0; i < models.size (); i++)
     {
         const ModelTPtr &m = models[i];
@@ -194,42 +250,74 @@ GlobalNNClassifier<Distance, PointInT>::initialize (bool force_retrain)
 
         if ( !view_is_already_trained )
         {
-            io::createDirIfNotExist(out_dir);
+            const std::string tmp_dir = out_dir + ".tmp";
+            if ( v4r::io::existsFolder(tmp_dir) )
+                boost::filesystem::remove_all(tmp_dir);
+            io::createDirIfNotExist(tmp_dir);
             LOG(INFO) << "Computing signatures for " << m->class_ << " for id " <<  m->id_ << " with " << m->views_.size() << " views.";
 
+            untrained_models.push_back(i);
             for (size_t v = 0; v < m->views_.size (); v++)
-            {
-                std::vector<float> signature;
-                estimator_->setInput(m->views_[v]);
-                signature = estimator_->estimate ();
-
-                std::stringstream path_entropy;
-                path_entropy << out_dir << "/entropy_" << v << ".txt";
-                io::writeFloatToFile (path_entropy.str (), m->self_occlusions_[v]);
-
-                Eigen::Vector4f centroid;
-                pcl::compute3DCentroid(*m->views_[v], centroid);
-                std::vector<float> centroid_v(3);
-                centroid_v[0] = centroid[0];
-                centroid_v[1] = centroid[1];
-                centroid_v[2] = centroid[2];
-
-                std::stringstream centroid_file;
-                centroid_file << out_dir << "/centroid_" << v << ".txt";
-                io::writeVectorToFile (centroid_file.str (), centroid_v);
-
-                std::stringstream descriptor_file;
-                descriptor_file << out_dir << "/descriptor_" << v << ".txt";
-                std::ofstream f (descriptor_file.str().c_str());
-                for(size_t j=0; j<signature.size(); j++)
-                    f << signature[j] << " ";
-                f.close();
-            }
+                jobs.push_back( std::make_pair(i, v) );
         }
         else
             LOG(INFO) << "Model " << m->class_ << " with id " <<  m->id_ << " (" << m->views_.size() << " views) has already been trained.";
     }
 
+    // each worker thread uses an own copy of the estimator (estimators which can not be copied are shared)
+    TrainingScheduler scheduler ( TrainingScheduler::Parameter(num_training_threads_) );
+
+    std::vector<typename boost::shared_ptr<GlobalEstimator<PointInT> > > estimators =
+            makeWorkerEstimators(estimator_, training_estimators_, scheduler.getNumWorkers());
+    boost::scoped_array<boost::mutex> estimator_mtx (new boost::mutex[estimators.size()]);
+
+    scheduler.run(jobs.size(), [&](size_t j, int worker)
+    {
+        const ModelTPtr &m = models[ jobs[j].first ];
+        const size_t v = jobs[j].second;
+        const std::string tmp_dir = training_dir_ + "/" + m->class_ + "/" + m->id_ + "/" + descr_name_ + ".tmp";
+
+        std::vector<float> signature;
+        {
+            const size_t e = worker % estimators.size();
+            boost::mutex::scoped_lock lock(estimator_mtx[e]);
+            estimators[e]->setInput(m->views_[v]);
+            signature = estimators[e]->estimate ();
+        }
+
+        std::stringstream path_entropy;
+        path_entropy << tmp_dir << "/entropy_" << v << ".txt";
+        io::writeFloatToFile (path_entropy.str (), m->self_occlusions_[v]);
+
+        Eigen::Vector4f centroid;
+        pcl::compute3DCentroid(*m->views_[v], centroid);
+        std::vector<float> centroid_v(3);
+        centroid_v[0] = centroid[0];
+        centroid_v[1] = centroid[1];
+        centroid_v[2] = centroid[2];
+
+        std::stringstream centroid_file;
+        centroid_file << tmp_dir << "/centroid_" << v << ".txt";
+        io::writeVectorToFile (centroid_file.str (), centroid_v);
+
+        std::stringstream descriptor_file;
+        descriptor_file << tmp_dir << "/descriptor_" << v << ".txt";
+        std::ofstream f (descriptor_file.str().c_str());
+        for(size_t k=0; k<signature.size(); k++)
+            f << signature[k] << " ";
+        f.close();
+    }, "GlobalNNClassifier::initialize (" + descr_name_ + ")");
+
+    for (size_t i = 0; i < untrained_models.size (); i++)
+    {
+        const ModelTPtr &m = models[ untrained_models[i] ];
+        const std::string out_dir = training_dir_ + "/" + m->class_ + "/" + m->id_ + "/" + descr_name_;
+
+        if ( v4r::io::existsFolder(out_dir) )
+            boost::filesystem::remove_all(out_dir);
+        boost::filesystem::rename(out_dir + ".tmp", out_dir);
+    }
+
     loadFeaturesAndCreateFLANN ();
 }
 
@@ -2,11 +2,16 @@
 #include <v4r/common/normals.h>
 #include <v4r/io/eigen.h>
 #include <v4r/recognition/local_recognizer.h>
+#include <v4r/recognition/training_scheduler.h>
 
 #include <pcl/registration/transformation_estimation_svd.h>
 #include <pcl/visualization/pcl_visualizer.h>
 
+#include <boost/filesystem.hpp>
+#include <boost/scoped_array.hpp>
+#include <boost/thread/mutex.hpp>
 #include <glog/logging.h>
+#include <algorithm>
 #include <sstream>
 
 namespace v4r
@@ -152,6 +157,23 @@ LocalRecognitionPipeline<Distance, PointT, FeatureT>::initialize (bool force_ret
             source_->removeDescDirectory (*models[i], models_dir_, descr_name_);
     }
 
+    // the views are trained on a pool of worker threads, each worker uses an own copy of the feature estimator
+    // (estimators which can not be copied are shared, the workers then compute their features one after the other)
+    TrainingScheduler scheduler ( TrainingScheduler::Parameter(param_.num_training_threads_) );
+
+    std::vector<typename boost::shared_ptr<LocalEstimator<PointT, FeatureT> > > estimators =
+            makeWorkerEstimators(estimator_, training_estimators_, scheduler.getNumWorkers());
+    boost::scoped_array<boost::mutex> estimator_mtx (new boost::mutex[estimators.size()]);
+
+    size_t num_training_views = 0;
+    for (size_t i = 0; i < models.size (); i++)
+    {
+        const std::string dir = models_dir_ + "/" + models[i]->class_ + "/" + models[i]->id_ + "/" + descr_name_;
+        if (!io::existsFolder(dir))
+            num_training_views += models[i]->view_filenames_.size();
+    }
+    scheduler.start(num_training_views);
+
     for (size_t i = 0; i < models.size (); i++)
     {
         ModelTPtr &m = models[i];
@@ -161,21 +183,43 @@ LocalRecognitionPipeline<Distance, PointT, FeatureT>::initialize (bool force_ret
         if (!io::existsFolder(dir))
         {
             std::cout << "Model not trained..." << m->views_.size () << std::endl;
+
+            // the views are loaded by the job training them
+            std::vector<unsigned char> load_failed (m->view_filenames_.size(), 0);
             if(!source_->getLoadIntoMemory())
             {
-                try{
-                    source_->loadInMemorySpecificModel(*m);
-                }
-                catch (std::runtime_error &e)
-                {
-                    std::cerr << "Load In Memory Specific Model failed. If this within a multi-pipeline recognizer, I will re-initialize now." << std::endl;
-                    return false;
-                }
+                m->views_.resize( m->view_filenames_.size() );
+                m->indices_.resize( m->view_filenames_.size() );
+                m->poses_.resize( m->view_filenames_.size() );
+                m->self_occlusions_.resize( m->view_filenames_.size() );
             }
 
+            // the training data is written to a temporary directory which is renamed once all views are trained,
+            // so an interrupted training does not leave a partially trained model behind
+            const std::string tmp_dir = dir + ".tmp";
+            if (io::existsFolder(tmp_dir))
+                boost::filesystem::remove_all(tmp_dir);
+            io::createDirIfNotExist(tmp_dir);
 
-            for (size_t v = 0; v < m->view_filenames_.size(); v++)
+            scheduler.run(m->view_filenames_.size(), [&](size_t v, int worker)
             {
+                if(!source_->getLoadIntoMemory())
+                {
+                    try{
+                        source_->loadInMemorySpecificModelAndView(*m, v);
+                    }
+                    catch (const std::runtime_error &)
+                    {
+                        m->views_[v].reset();
+                    }
+
+                    if(!m->views_[v])
+                    {
+                        load_failed[v] = 1;
+                        return;
+                    }
+                }
+
                 typename pcl::PointCloud<FeatureT>::Ptr all_signatures (new pcl::PointCloud<FeatureT> ());
                 typename pcl::PointCloud<FeatureT>::Ptr object_signatures (new pcl::PointCloud<FeatureT> ());
                 typename pcl::PointCloud<PointT>::Ptr all_keypoints;
@@ -186,10 +230,14 @@ LocalRecognitionPipeline<Distance, PointT, FeatureT>::initialize (bool force_ret
                 computeNormals<PointT>(m->views_[v], normals, param_.normal_computation_method_);
 
                 pcl::PointIndices all_kp_indices, obj_kp_indices;
-                estimator_->setNormals(normals);
-                bool success = estimator_->estimate (m->views_[v], foo, all_keypoints, all_signatures);
-                (void) success;
-                estimator_->getKeypointIndices(all_kp_indices);
+                {
+                    const size_t e = worker % estimators.size();
+                    boost::mutex::scoped_lock lock(estimator_mtx[e]);
+                    estimators[e]->setNormals(normals);
+                    bool success = estimators[e]->estimate (m->views_[v], foo, all_keypoints, all_signatures);
+                    (void) success;
+                    estimators[e]->getKeypointIndices(all_kp_indices);
+                }
 
                 // remove signatures and keypoints which do not belong to object
                 std::vector<bool> obj_mask = createMaskFromIndices(m->indices_[v].indices, m->views_[v]->points.size());
@@ -213,23 +261,39 @@ LocalRecognitionPipeline<Distance, PointT, FeatureT>::initialize (bool force_ret
 
                 if (object_keypoints->points.size()) //save descriptors and keypoints to disk
                 {
-                    io::createDirIfNotExist(dir);
                     std::string descriptor_basename (m->view_filenames_[v]);
                     boost::replace_last(descriptor_basename, source_->getViewPrefix(), "/descriptors_");
-                    pcl::io::savePCDFileBinary (dir + descriptor_basename, *object_signatures);
+                    pcl::io::savePCDFileBinary (tmp_dir + descriptor_basename, *object_signatures);
 
                     std::string keypoint_basename (m->view_filenames_[v]);
                     boost::replace_last(keypoint_basename, source_->getViewPrefix(), "/keypoints_");
-                    pcl::io::savePCDFileBinary (dir + keypoint_basename, *object_keypoints);
+                    pcl::io::savePCDFileBinary (tmp_dir + keypoint_basename, *object_keypoints);
 
                     std::string kp_normals_basename (m->view_filenames_[v]);
                     boost::replace_last(kp_normals_basename, source_->getViewPrefix(), "/keypoint_normals_");
                     pcl::PointCloud<pcl::Normal>::Ptr normals_keypoints(new pcl::PointCloud<pcl::Normal>);
                     pcl::copyPointCloud(*normals, obj_kp_indices, *normals_keypoints);
-                    pcl::io::savePCDFileBinary (dir + kp_normals_basename, *normals_keypoints);
+                    pcl::io::savePCDFileBinary (tmp_dir + kp_normals_basename, *normals_keypoints);
                 }
+
+                // views loaded for training only are released as soon as they are processed
+                if(!source_->getLoadIntoMemory())
+                    m->views_[v].reset();
+            }, "LocalRecognitionPipeline::initialize (" + descr_name_ + ")");
+
+            if (std::find(load_failed.begin(), load_failed.end(), 1) != load_failed.end())
+            {
+                std::cerr << "Load In Memory Specific Model failed. If this within a multi-pipeline recognizer, I will re-initialize now." << std::endl;
+                boost::filesystem::remove_all(tmp_dir);
+                m->views_.clear();
+                return false;
             }
 
+            if (boost::filesystem::is_empty(tmp_dir))
+                boost::filesystem::remove_all(tmp_dir);
+            else
+                boost::filesystem::rename(tmp_dir, dir);
+
             if(!source_->getLoadIntoMemory())
                 m->views_.clear();
         }
@@ -1,21 +1,341 @@
 #include <v4r/recognition/mesh_source.h>
 #include <v4r/recognition/vtk_model_sampling.h>
 
+#include <cmath>
+#include <deque>
+#include <boost/thread.hpp>
+
 namespace v4r
 {
 
-template<>
-pcl::PointCloud<pcl::PointXYZRGB>
-MeshSource<pcl::PointXYZRGB>::renderCloud (const DepthmapRenderer &renderer, float &visible)
+namespace
+{
+/**
+ * @brief Rendered view passed from the renderer to the writer threads
+ */
+struct RenderedView
+{
+    int pose_idx;   // index of the rendering pose
+    int view_idx;   // index of the stored view
+    cv::Mat depth;
+    cv::Mat color;
+};
+
+/**
+ * @brief Queue of rendered views with a fixed pool of buffers. The writers give the buffers back after
+ * saving a view, so the images are reused and rendering never runs ahead more than the pool size.
+ * After close() the writers drain the remaining views and getFull() returns 0.
+ */
+class RenderedViewQueue
+{
+private:
+    boost::mutex mtx_;
+    boost::condition_variable cond_full_, cond_free_;
+    std::deque<RenderedView*> full_, free_;
+    std::vector<RenderedView> pool_;
+    bool closed_;
+
+public:
+    explicit RenderedViewQueue(size_t size) : pool_(size), closed_(false)
+    {
+        for(size_t i=0; i<pool_.size(); i++)
+            free_.push_back(&pool_[i]);
+    }
+
+    RenderedView *getFree(bool block=true)
+    {
+        boost::unique_lock<boost::mutex> lock(mtx_);
+        while(free_.empty())
+        {
+            if(!block)
+                return 0;
+            cond_free_.wait(lock);
+        }
+        RenderedView *v = free_.front();
+        free_.pop_front();
+        return v;
+    }
+
+    void pushFree(RenderedView *v)
+    {
+        {
+            boost::unique_lock<boost::mutex> lock(mtx_);
+            free_.push_back(v);
+        }
+        cond_free_.notify_one();
+    }
+
+    RenderedView *getFull()
+    {
+        boost::unique_lock<boost::mutex> lock(mtx_);
+        while(full_.empty())
+        {
+            if(closed_)
+                return 0;
+            cond_full_.wait(lock);
+        }
+        RenderedView *v = full_.front();
+        full_.pop_front();
+        return v;
+    }
+
+    void pushFull(RenderedView *v)
+    {
+        {
+            boost::unique_lock<boost::mutex> lock(mtx_);
+            full_.push_back(v);
+        }
+        cond_full_.notify_one();
+    }
+
+    void close()
+    {
+        {
+            boost::unique_lock<boost::mutex> lock(mtx_);
+            closed_ = true;
+        }
+        cond_full_.notify_all();
+    }
+};
+
+/**
+ * @brief Closes the queue and joins the writer threads when leaving the scope, i.e. also if rendering throws
+ */
+class WriterThreadsGuard
+{
+private:
+    RenderedViewQueue &queue_;
+    boost::thread_group &threads_;
+    bool stopped_;
+
+public:
+    WriterThreadsGuard(RenderedViewQueue &queue, boost::thread_group &threads) : queue_(queue), threads_(threads), stopped_(false) { }
+
+    ~WriterThreadsGuard()
+    {
+        stop();
+    }
+
+    void stop()
+    {
+        if(stopped_)
+            return;
+        stopped_ = true;
+        queue_.close();
+        threads_.join_all();
+    }
+};
+
+/**
+ * @brief subsampled depth map to detect nearly identical views
+ */
+void
+depthSignature(const cv::Mat &depth, std::vector<float> &sig, int size=32)
+{
+    sig.resize(size*size);
+    for(int v=0; v<size; v++)
+    {
+        const float *d = depth.ptr<float>( (int)((v+.5f)*depth.rows/size) );
+        for(int u=0; u<size; u++)
+            sig[v*size+u] = d[ (int)((u+.5f)*depth.cols/size) ];
+    }
+}
+
+/**
+ * @return ratio of differing pixels (valid in only one of the views or depth difference above tolerance)
+ */
+float
+signatureDistance(const std::vector<float> &sig1, const std::vector<float> &sig2, float tol = 0.01f)
+{
+    size_t diff=0, valid=0;
+    for(size_t i=0; i<sig1.size(); i++)
+    {
+        const bool v1 = sig1[i] != 0, v2 = sig2[i] != 0;
+        if(!v1 && !v2)
+            continue;
+        valid++;
+        if( v1 != v2 || std::abs(sig1[i]-sig2[i]) > tol )
+            diff++;
+    }
+    return valid ? (float)diff/valid : 0.f;
+}
+
+template<typename RendererT>
+inline void
+renderedViewToCloud(const RendererT &renderer, const RenderedView &view, const Eigen::Matrix4f &pose, pcl::PointCloud<pcl::PointXYZ> &cloud)
+{
+    renderer.depthmapToPointcloud(view.depth, pose, cloud);
+}
+
+template<typename RendererT>
+inline void
+renderedViewToCloud(const RendererT &renderer, const RenderedView &view, const Eigen::Matrix4f &pose, pcl::PointCloud<pcl::PointXYZRGB> &cloud)
 {
-    return renderer.renderPointcloudColor(visible);
+    renderer.depthmapToPointcloud(view.depth, view.color, pose, cloud);
+}
 }
 
 template<typename PointT>
-pcl::PointCloud<PointT>
-MeshSource<PointT>::renderCloud (const DepthmapRenderer &renderer, float &visible)
+template<typename RendererT>
+void
+MeshSource<PointT>::generateViews (const RendererT &renderer, ModelT & model)
 {
-    return renderer.renderPointcloud(visible);
+    const std::vector<Eigen::Vector3f> sphere = RendererT::createSphere(radius_sphere_, tes_level_);
+
+    std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f> > render_poses(sphere.size());
+    for(size_t i=0; i<sphere.size(); i++)
+        render_poses[i] = RendererT::getPoseLookingToCenterFrom(sphere[i]); //get a camera pose looking at the center
+
+    const std::string direc = path_ + "/" + model.class_ + "/" + model.id_ + "/views/";
+    v4r::io::createDirIfNotExist(direc);
+
+    // views are written to their final index, so the containers must not be resized while the writers run
+    model.views_.resize( render_poses.size() );
+    model.poses_.resize( render_poses.size() );
+    model.self_occlusions_.resize( render_poses.size(), 0 ); // NOT IMPLEMENTED
+
+    const size_t nb_threads = std::max(1u, boost::thread::hardware_concurrency());
+    RenderedViewQueue queue( 2*nb_threads + num_writer_threads_ );
+
+    boost::mutex error_mtx;
+    std::string error_msg;
+
+    // writer threads: convert to point cloud, remove nan points and save the views
+    boost::thread_group writers;
+    WriterThreadsGuard writers_guard(queue, writers);
+    for(int t=0; t<num_writer_threads_; t++)
+    {
+        writers.create_thread( [&]()
+        {
+            for(;;)
+            {
+                RenderedView *view = queue.getFull();
+
+                if(!view)
+                    break;
+
+                try
+                {
+                    typename pcl::PointCloud<PointT>::Ptr cloud (new pcl::PointCloud<PointT>);
+                    renderedViewToCloud(renderer, *view, render_poses[view->pose_idx], *cloud);
+                    const Eigen::Matrix4f tf = v4r::RotTrans2Mat4f(cloud->sensor_orientation_, cloud->sensor_origin_);
+
+                    // reset view point otherwise pcl visualization is potentially messed up
+                    Eigen::Vector4f zero_origin; zero_origin[0] = zero_origin[1] = zero_origin[2] = zero_origin[3] = 0.f;
+                    cloud->sensor_orientation_ = Eigen::Quaternionf::Identity();
+                    cloud->sensor_origin_ = zero_origin;
+
+                    if(!gen_organized_)   // remove nan points from cloud
+                    {
+                        size_t kept=0;
+                        for(size_t idx=0; idx<cloud->points.size(); idx++)
+                        {
+                            const PointT &pt = cloud->points[idx];
+                            if ( pcl::isFinite(pt) )
+                                cloud->points[kept++] = pt;
+                        }
+                        cloud->points.resize(kept);
+                        cloud->width = kept;
+                        cloud->height = 1;
+                    }
+
+                    const int i = view->view_idx;
+                    model.views_[i] = cloud;
+                    model.poses_[i] = tf;
+
+                    //save generated model for future use
+                    std::stringstream path_view;
+                    path_view << direc << "/" << view_prefix_ << i << ".pcd";
+                    pcl::io::savePCDFileBinary (path_view.str (), *cloud);
+
+                    std::stringstream path_pose;
+                    path_pose << direc << "/" << pose_prefix_ << i << ".txt";
+                    v4r::io::writeMatrixToFile( path_pose.str (), tf);
+
+                    std::stringstream path_entropy;
+                    path_entropy << direc << "/" << entropy_prefix_ << i << ".txt";
+                    v4r::io::writeFloatToFile (path_entropy.str (), model.self_occlusions_[i]);
+                }
+                catch(const std::exception &e)
+                {
+                    boost::unique_lock<boost::mutex> lock(error_mtx);
+                    if(error_msg.empty())
+                        error_msg = e.what();
+                }
+
+                queue.pushFree(view);
+            }
+        });
+    }
+
+    // render all free buffers as one batch (in parallel for the software renderer)
+    std::vector<std::vector<float> > kept_signatures;
+    std::vector<float> signature;
+    int nb_views = 0;
+    size_t next = 0;
+
+    std::vector<RenderedView*> batch;
+    std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f> > batch_poses;
+    std::vector<cv::Mat> depths, colors;
+    std::vector<float> visible;
+
+    while(next < render_poses.size())
+    {
+        batch.assign(1, queue.getFree());
+        RenderedView *view;
+        while( batch.size() < render_poses.size()-next && (view = queue.getFree(false)) )
+            batch.push_back(view);
+
+        batch_poses.resize(batch.size());
+        depths.resize(batch.size());
+        colors.resize(batch.size());
+        for(size_t i=0; i<batch.size(); i++)
+        {
+            batch_poses[i] = render_poses[next+i];
+            depths[i] = batch[i]->depth;    // shares the buffer of the view
+            colors[i] = batch[i]->color;
+        }
+
+        renderer.renderDepthmaps(batch_poses, depths, colors, visible);
+
+        for(size_t i=0; i<batch.size(); i++)
+        {
+            view = batch[i];
+            view->depth = depths[i];
+            view->color = colors[i];
+            view->pose_idx = next+i;
+
+            if(view_dedup_thr_ > 0.f)
+            {
+                depthSignature(view->depth, signature);
+                bool duplicate = false;
+                for(size_t j=0; j<kept_signatures.size() && !duplicate; j++)
+                    duplicate = signatureDistance(signature, kept_signatures[j]) < view_dedup_thr_;
+
+                if(duplicate)
+                {
+                    queue.pushFree(view);
+                    continue;
+                }
+                kept_signatures.push_back(signature);
+            }
+
+            view->view_idx = nb_views++;
+            queue.pushFull(view);
+        }
+
+        next += batch.size();
+    }
+
+    // the writers store the remaining views and stop
+    writers_guard.stop();
+
+    model.views_.resize(nb_views);
+    model.poses_.resize(nb_views);
+    model.self_occlusions_.resize(nb_views);
+
+    if(!error_msg.empty())
+        throw std::runtime_error("[MeshSource::generateViews] Failed to store views: " + error_msg);
 }
 
 template<typename PointT>
@@ -45,67 +365,29 @@ MeshSource<PointT>::loadOrGenerate (const std::string & model_path, ModelT & mod
         int img_width = resolution_;
         int img_height = resolution_;
 
-        if(!renderer_)
-            renderer_.reset( new DepthmapRenderer(img_width, img_height) );
-
         // To preserve Kinect camera parameters (640x480 / f=525)
         const float f = 150.f;
         const float cx = img_width / 2.f;
         const float cy = img_height / 2.f;
-        renderer_->setIntrinsics(f, f, cx, cy);
         DepthmapRendererModel rmodel(model_path);
-        renderer_->setModel(&rmodel);
-
-        std::vector<Eigen::Vector3f> sphere = renderer_->createSphere(radius_sphere_, tes_level_);
 
-        for(const Eigen::Vector3f &point : sphere) {
-            Eigen::Matrix4f orientation = renderer_->getPoseLookingToCenterFrom(point); //get a camera pose looking at the center:
-            renderer_->setCamPose(orientation);
-            float visible;
-            typename pcl::PointCloud<PointT>::Ptr cloud (new pcl::PointCloud<PointT>(renderCloud(*renderer_, visible)));
-            const Eigen::Matrix4f tf = v4r::RotTrans2Mat4f(cloud->sensor_orientation_, cloud->sensor_origin_);
-
-            // reset view point otherwise pcl visualization is potentially messed up
-            Eigen::Vector4f zero_origin; zero_origin[0] = zero_origin[1] = zero_origin[2] = zero_origin[3] = 0.f;
-            cloud->sensor_orientation_ = Eigen::Quaternionf::Identity();
-            cloud->sensor_origin_ = zero_origin;
-
-            if(!gen_organized_)   // remove nan points from cloud
-            {
-                size_t kept=0;
-                for(size_t idx=0; idx<cloud->points.size(); idx++)
-                {
-                    const PointT &pt = cloud->points[idx];
-                    if ( pcl::isFinite(pt) )
-                        cloud->points[kept++] = pt;
-                }
-                cloud->points.resize(kept);
-                cloud->width = kept;
-                cloud->height = 1;
-            }
+        if(use_cpu_renderer_)
+        {
+            if(!renderer_cpu_)
+                renderer_cpu_.reset( new DepthmapRendererCPU(img_width, img_height) );
 
-            model.views_.push_back (cloud);
-            model.poses_.push_back (tf);
-            model.self_occlusions_.push_back (0); // NOT IMPLEMENTED
+            renderer_cpu_->setIntrinsics(f, f, cx, cy);
+            renderer_cpu_->setModel(&rmodel);
+            generateViews(*renderer_cpu_, model);
         }
-
-        const std::string direc = path_ + "/" + model.class_ + "/" + model.id_ + "/views/";
-        v4r::io::createDirIfNotExist(direc);
-
-        for (size_t i = 0; i < model.views_.size (); i++)
+        else
         {
-            //save generated model for future use
-            std::stringstream path_view;
-            path_view << direc << "/" << view_prefix_ << i << ".pcd";
-            pcl::io::savePCDFileBinary (path_view.str (), *(model.views_[i]));
-
-            std::stringstream path_pose;
-            path_pose << direc << "/" << pose_prefix_ << i << ".txt";
-            v4r::io::writeMatrixToFile( path_pose.str (), model.poses_[i]);
-
-            std::stringstream path_entropy;
-            path_entropy << direc << "/" << entropy_prefix_ << i << ".txt";
-            v4r::io::writeFloatToFile (path_entropy.str (), model.self_occlusions_[i]);
+            if(!renderer_)
+                renderer_.reset( new DepthmapRenderer(img_width, img_height) );
+
+            renderer_->setIntrinsics(f, f, cx, cy);
+            renderer_->setModel(&rmodel);
+            generateViews(*renderer_, model);
         }
 
         loadOrGenerate ( model_path, model);
@@ -123,21 +405,37 @@ MeshSource<PointT>::loadInMemorySpecificModel(ModelT & model)
     model.self_occlusions_.resize( model.view_filenames_.size(), 0);
 
     for (size_t i = 0; i < model.view_filenames_.size (); i++)
-    {
-        const std::string view_file = pathmodel + "/" + model.view_filenames_[i];
-        model.views_[i].reset(new pcl::PointCloud<PointT> ());
-        pcl::io::loadPCDFile (view_file, *model.views_[i]);
+        loadInMemorySpecificModelAndView(model, i);
+}
 
-        std::string pose_fn (view_file);
-        boost::replace_last (pose_fn, view_prefix_, pose_prefix_);
-        boost::replace_last (pose_fn, ".pcd", ".txt");
-        model.poses_[i] = v4r::io::readMatrixFromFile(pose_fn);
+template<typename PointT>
+void
+MeshSource<PointT>::loadInMemorySpecificModelAndView(ModelT & model, int view_id)
+{
+    const std::string pathmodel = path_ + "/" + model.class_ + "/" + model.id_ + "/views";
+    const size_t i = view_id;
 
-        std::string entropy_fn (view_file);
-        boost::replace_last (entropy_fn, view_prefix_, entropy_prefix_);
-        boost::replace_last (entropy_fn, ".pcd", ".txt");
-        v4r::io::readFloatFromFile (entropy_fn, model.self_occlusions_[i]);
+    // concurrent calls for different views require the view data of the model to be sized beforehand
+    if (model.views_.size() <= i)
+    {
+        model.poses_.resize( model.view_filenames_.size() );
+        model.views_.resize( model.view_filenames_.size() );
+        model.self_occlusions_.resize( model.view_filenames_.size(), 0);
     }
+
+    const std::string view_file = pathmodel + "/" + model.view_filenames_[i];
+    model.views_[i].reset(new pcl::PointCloud<PointT> ());
+    pcl::io::loadPCDFile (view_file, *model.views_[i]);
+
+    std::string pose_fn (view_file);
+    boost::replace_last (pose_fn, view_prefix_, pose_prefix_);
+    boost::replace_last (pose_fn, ".pcd", ".txt");
+    model.poses_[i] = v4r::io::readMatrixFromFile(pose_fn);
+
+    std::string entropy_fn (view_file);
+    boost::replace_last (entropy_fn, view_prefix_, entropy_prefix_);
+    boost::replace_last (entropy_fn, ".pcd", ".txt");
+    v4r::io::readFloatFromFile (entropy_fn, model.self_occlusions_[i]);
 }
 
 template<typename PointT>
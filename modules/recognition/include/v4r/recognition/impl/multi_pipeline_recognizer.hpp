@@ -11,6 +11,8 @@
 #include <v4r/recognition/multi_pipeline_recognizer.h>
 #include <pcl/registration/transformation_estimation_svd.h>
 #include <v4r/common/normals.h>
+#include <pcl/common/time.h>
+#include <sstream>
 
 namespace v4r
 {
@@ -96,6 +98,7 @@ MultiRecognitionPipeline<PointT>::recognize()
 {
     models_.clear();
     transforms_.clear();
+    elapsed_time_.clear();
 
     //first version... just call each recognizer independently...
     //more advanced version should compute normals and preprocess the input cloud so that
@@ -111,6 +114,7 @@ MultiRecognitionPipeline<PointT>::recognize()
 
     for(size_t i=0; i < recognizers_.size(); i++)
     {
+        pcl::StopWatch t;
         recognizers_[i]->setInputCloud(scene_);
 
         if(recognizers_[i]->requiresSegmentation()) // this might not work in the current state!!
@@ -180,23 +184,36 @@ MultiRecognitionPipeline<PointT>::recognize()
                 }
             }
         }
+
+        std::stringstream stage_name; stage_name << "recognizer_" << i;
+        elapsed_time_.push_back( std::make_pair(stage_name.str(), t.getTime()) );
     }
 
     if( !param_.save_hypotheses_ && cg_algorithm_)
     {
+        pcl::StopWatch t;
         correspondenceGrouping();
+        elapsed_time_.push_back( std::make_pair("correspondence_grouping", t.getTime()) );
 
         if (param_.icp_iterations_ > 0 || hv_algorithm_)
         {
             //Prepare scene and model clouds for the pose refinement step
+            t.reset();
             getDataSource()->voxelizeAllModels (param_.voxel_size_icp_);
+            elapsed_time_.push_back( std::make_pair("model_voxelization", t.getTime()) );
         }
 
-        if ( param_.icp_iterations_ > 0 )
+        if ( param_.icp_iterations_ > 0 ) {
+            t.reset();
             poseRefinement();
+            elapsed_time_.push_back( std::make_pair("pose_refinement", t.getTime()) );
+        }
 
-        if ( hv_algorithm_ && models_.size() )
+        if ( hv_algorithm_ && models_.size() ) {
+            t.reset();
             hypothesisVerification();
+            elapsed_time_.push_back( std::make_pair("hypothesis_verification", t.getTime()) );
+        }
     }
 
     scene_normals_.reset();
@@ -31,6 +31,7 @@
 */
 
 #include <math.h>       // atan2
+#include <pcl/common/time.h>
 #include <pcl/keypoints/sift_keypoint.h>
 #include <pcl/recognition/cg/geometric_consistency.h>
 #include <pcl/registration/correspondence_rejection_sample_consensus.h>
@@ -157,52 +158,89 @@ MultiviewRecognizer<PointT>::estimateViewTransformationBySIFT(const pcl::PointCl
     }
 }
 
+template<typename PointT>
+typename FastICPCloudCache<PointT>::Ptr
+MultiviewRecognizer<PointT>::getICPCache (View<PointT> &view)
+{
+    if ( !view.icp_cache_ ) {
+        typename pcl::PointCloud<PointT>::Ptr cloud_wo_nan ( new pcl::PointCloud<PointT>());
+
+        pcl::PassThrough<PointT> pass;
+        pass.setFilterLimits (0.f, 5.f);
+        pass.setFilterFieldName ("z");
+        pass.setInputCloud (view.scene_);
+        pass.setKeepOrganized (true);
+        pass.filter (*cloud_wo_nan);
+
+        view.icp_cache_.reset( new FastICPCloudCache<PointT>(cloud_wo_nan) );
+    }
+
+    return view.icp_cache_;
+}
+
 template<typename PointT>
 float
-MultiviewRecognizer<PointT>::calcEdgeWeightAndRefineTf (const typename pcl::PointCloud<PointT>::ConstPtr &cloud_src,
-                                                        const typename pcl::PointCloud<PointT>::ConstPtr &cloud_dst,
+MultiviewRecognizer<PointT>::calcEdgeWeightAndRefineTf (View<PointT> &view_src,
+                                                        View<PointT> &view_dst,
                                                         Eigen::Matrix4f &refined_transform,
-                                                        const Eigen::Matrix4f &transform)
+                                                        const Eigen::Matrix4f &transform,
+                                                        float best_weight)
 {
-    typename pcl::PointCloud<PointT>::Ptr cloud_src_wo_nan ( new pcl::PointCloud<PointT>());
-    typename pcl::PointCloud<PointT>::Ptr cloud_dst_wo_nan ( new pcl::PointCloud<PointT>());
-
-    pcl::PassThrough<PointT> pass;
-    pass.setFilterLimits (0.f, 5.f);
-    pass.setFilterFieldName ("z");
-    pass.setInputCloud (cloud_src);
-    pass.setKeepOrganized (true);
-    pass.filter (*cloud_src_wo_nan);
-
-    pcl::PassThrough<PointT> pass2;
-    pass2.setFilterLimits (0.f, 5.f);
-    pass2.setFilterFieldName ("z");
-    pass2.setInputCloud (cloud_dst);
-    pass2.setKeepOrganized (true);
-    pass2.filter (*cloud_dst_wo_nan);
+    // filtered clouds, normals, edges and the KD-trees of the target keypoints are computed once per view
+    const typename FastICPCloudCache<PointT>::Ptr src_cache = getICPCache(view_src);
+    const typename FastICPCloudCache<PointT>::Ptr dst_cache = getICPCache(view_dst);
 
     float w_after_icp_ = std::numeric_limits<float>::max ();
     const float best_overlap_ = 0.75f;
+    const int num_levels = std::max(1, param_.icp_pyramid_levels_);
+
+    std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f> > initial_poses (1, transform);
+
+    // coarse-to-fine, each level starts from the hypotheses surviving the coarser one
+    for (int level = num_levels - 1; level >= 0; level--) {
+        const float scale = static_cast<float>(1 << level);
+
+        FastIterativeClosestPointWithGC<PointT> icp;
+        icp.setMaxCorrespondenceDistance ( 0.02f * scale );
+        icp.setUniformSamplingRadius ( 0.01f * scale );
+        icp.setInputSource ( src_cache->cloud_ );
+        icp.setInputTarget ( dst_cache->cloud_ );
+        icp.setInputCache ( src_cache );
+        icp.setTargetCache ( dst_cache );
+        icp.setUseNormals (true);
+        icp.useStandardCG (true);
+        icp.setNoCG(true);
+        icp.setOverlapPercentage (best_overlap_);
+        icp.setKeepMaxHypotheses (5);
+        icp.setMaximumIterations ( num_levels == 1 ? 10 : (level ? 3 : 5) );
+        icp.setInitialPoses (initial_poses);
+        icp.align ();
+
+        if (level == 0) {
+            w_after_icp_ = icp.getFinalTransformation ( refined_transform );
+            break;
+        }
 
-    FastIterativeClosestPointWithGC<pcl::PointXYZRGB> icp;
-    icp.setMaxCorrespondenceDistance ( 0.02f );
-    icp.setInputSource ( cloud_src_wo_nan );
-    icp.setInputTarget ( cloud_dst_wo_nan );
-    icp.setUseNormals (true);
-    icp.useStandardCG (true);
-    icp.setNoCG(true);
-    icp.setOverlapPercentage (best_overlap_);
-    icp.setKeepMaxHypotheses (5);
-    icp.setMaximumIterations (10);
-    icp.align (transform);
-    w_after_icp_ = icp.getFinalTransformation ( refined_transform );
+        const std::vector<std::pair<float, Eigen::Matrix4f> > &results = icp.getResults();
+        if ( results.empty() )  // too few keypoints at this resolution, try the next finer one
+            continue;
+
+        const float w_coarse = best_overlap_ - results[0].first;
+        if ( results[0].first >= 0 && pcl_isfinite(w_coarse) && w_coarse > best_weight + param_.icp_coarse_rejection_margin_ ) {
+            refined_transform = results[0].second;
+            return std::numeric_limits<float>::max ();
+        }
+
+        initial_poses.clear();
+        for (size_t i = 0; i < results.size(); i++)
+            initial_poses.push_back( results[i].second );
+    }
 
     if ( w_after_icp_ < 0 || !pcl_isfinite ( w_after_icp_ ) )
         w_after_icp_ = std::numeric_limits<float>::max ();
     else
         w_after_icp_ = best_overlap_ - w_after_icp_;
 
-    //    transform = icp_trans; // refined transformation
     return w_after_icp_;
 }
 
@@ -281,6 +319,9 @@ MultiviewRecognizer<PointT>::recognize ()
                  "Started recognition for view " << id_ << " in scene " << scene_name_ <<
                  "=========================================================" << std::endl << std::endl;
 
+    elapsed_time_.clear();
+    pcl::StopWatch t;
+
     boost::shared_ptr< pcl::PointCloud<pcl::Normal> > scene_normals_f (new pcl::PointCloud<pcl::Normal> );
 
     if (!scene_ || scene_->width != 640 || scene_->height != 480)
@@ -310,9 +351,11 @@ MultiviewRecognizer<PointT>::recognize ()
         v.scene_f_ = v.scene_;
         scene_normals_f = v.scene_normals_;
     }
+    elapsed_time_.push_back( std::make_pair("preprocessing", t.getTime()) );
 
 
     if (param_.compute_mst_) {
+        t.reset();
         if( param_.scene_to_scene_) {   // compute SIFT keypoints for the scene (since neighborhood of keypoint
                                         // matters for their SIFT descriptors, the descriptors are computed on the
                                         // original rather than on the filtered point cloud. Keypoints at infinity
@@ -352,7 +395,7 @@ MultiviewRecognizer<PointT>::recognize ()
         //=====================Pose Estimation=======================
         typename std::map<size_t, View<PointT> >::iterator v_it;
         for (v_it = views_.begin(); v_it != views_.end(); ++v_it) {
-            const View<PointT> &w = v_it->second;
+            View<PointT> &w = v_it->second;
             if( w.id_ ==  v.id_ )
                 continue;
 
@@ -393,7 +436,7 @@ MultiviewRecognizer<PointT>::recognize ()
 
                     try {
                         Eigen::Matrix4f icp_refined_trans;
-                        e_tmp.edge_weight_ = calcEdgeWeightAndRefineTf( w.scene_, v.scene_, icp_refined_trans, e_tmp.transformation_);
+                        e_tmp.edge_weight_ = calcEdgeWeightAndRefineTf( w, v, icp_refined_trans, e_tmp.transformation_, lowest_edge_weight);
                         e_tmp.transformation_ = icp_refined_trans,
                         std::cout << "Edge weight is " << e_tmp.edge_weight_ << " for edge connecting vertex " <<
                                      e_tmp.source_id_ << " and " << e_tmp.target_id_ << " by " <<  e_tmp.model_name_ ;
@@ -459,6 +502,7 @@ MultiviewRecognizer<PointT>::recognize ()
                     loose_edges.erase(loose_edges.begin() + i);
             }
         }
+        elapsed_time_.push_back( std::make_pair("view_registration", t.getTime()) );
     }
 
 //    if(views_.size()>1) {
@@ -475,10 +519,17 @@ MultiviewRecognizer<PointT>::recognize ()
 //        registration_vis.spin();
 //    }
 
+    t.reset();
     rr_->setInputCloud(v.scene_);
     rr_->setSceneNormals(v.scene_normals_);
     rr_->recognize();
+    elapsed_time_.push_back( std::make_pair("single_view_recognition", t.getTime()) );
 
+    const std::vector<std::pair<std::string, double> > &sv_elapsed_time = rr_->getElapsedTimes();
+    for(size_t i=0; i<sv_elapsed_time.size(); i++)
+        elapsed_time_.push_back( std::make_pair("single_view_recognition/" + sv_elapsed_time[i].first, sv_elapsed_time[i].second) );
+
+    t.reset();
     if(rr_->getSaveHypothesesParam()) {  // we have to do the correspondence grouping ourselve [Faeulhammer et al 2015, ICRA paper]
         rr_->getSavedHypotheses(v.hypotheses_);
 
@@ -608,6 +659,7 @@ MultiviewRecognizer<PointT>::recognize ()
         models_ = v.models_;
         transforms_ = v.transforms_;
     }
+    elapsed_time_.push_back( std::make_pair("hypotheses_merging", t.getTime()) );
 
     boost::shared_ptr<GO3D<PointT, PointT> > hv_algorithm_3d;
 
@@ -615,6 +667,7 @@ MultiviewRecognizer<PointT>::recognize ()
        hv_algorithm_3d = boost::dynamic_pointer_cast<GO3D<PointT, PointT>> (hv_algorithm_);
 
     if ( hv_algorithm_3d ) {
+        t.reset();
 
         NguyenNoiseModel<PointT> nm (nm_param_);
         nm.setInputCloud(v.scene_);
@@ -669,10 +722,14 @@ MultiviewRecognizer<PointT>::recognize ()
             scene_ = v.scene_;
             scene_normals_ = v.scene_normals_;
         }
+        elapsed_time_.push_back( std::make_pair("noise_model_integration", t.getTime()) );
     }
 
-    if ( param_.icp_iterations_ > 0 )
+    if ( param_.icp_iterations_ > 0 ) {
+        t.reset();
         poseRefinement();
+        elapsed_time_.push_back( std::make_pair("pose_refinement", t.getTime()) );
+    }
 
     if ( hv_algorithm_ && !models_.empty() ) {
         if( !hv_algorithm_3d ) {
@@ -680,7 +737,9 @@ MultiviewRecognizer<PointT>::recognize ()
             scene_normals_ = v.scene_normals_;
         }
 
+        t.reset();
         hypothesisVerification();
+        elapsed_time_.push_back( std::make_pair("hypothesis_verification", t.getTime()) );
         v.model_or_plane_is_verified_ = model_or_plane_is_verified_;
 
         if( hv_algorithm_3d && hv_algorithm_3d->param_.visualize_cues_)
@@ -790,45 +790,60 @@ v4r::PartialPCDSource<Full3DPointT, PointInT, OutModelPointT>::loadInMemorySpeci
 {
   std::cout << "Loading into memory " << model.view_filenames_.size () << " views." << std::endl;
 
-  const std::string path_views = path_ + "/" + model.class_ + "/" + model.id_ + "/views/";
-
   model.views_.resize( model.view_filenames_.size() );
   model.indices_.resize( model.view_filenames_.size() );
   model.poses_.resize( model.view_filenames_.size() );
   model.self_occlusions_.resize( model.view_filenames_.size() );
 
   for (size_t i = 0; i < model.view_filenames_.size (); i++)
+    loadInMemorySpecificModelAndView(model, i);
+}
+
+template<typename Full3DPointT, typename PointInT, typename OutModelPointT>
+void
+v4r::PartialPCDSource<Full3DPointT, PointInT, OutModelPointT>::loadInMemorySpecificModelAndView(ModelT & model, int view_id)
+{
+  const std::string path_views = path_ + "/" + model.class_ + "/" + model.id_ + "/views/";
+  const size_t i = view_id;
+
+  // concurrent calls for different views require the view data of the model to be sized beforehand
+  if (model.views_.size() <= i)
   {
-    const std::string view_file = path_views + "/" + model.view_filenames_[i];
-    typename pcl::PointCloud<PointInT>::Ptr cloud (new pcl::PointCloud<PointInT> ());
-    pcl::io::loadPCDFile (view_file, *cloud);
-    model.views_[i] = cloud;
-
-    std::string pose_fn (view_file);
-    boost::replace_last (pose_fn, "view", "pose");
-    boost::replace_last (pose_fn, ".pcd", ".txt");
-    model.poses_[i] = v4r::io::readMatrixFromFile( pose_fn);
-
-    std::string entropy_fn (view_file);
-    boost::replace_last (entropy_fn, "view", "entropy");
-    boost::replace_last (entropy_fn, ".pcd", ".txt");
-    if(v4r::io::existsFile(entropy_fn))
-        v4r::io::readFloatFromFile (entropy_fn, model.self_occlusions_[i]);
-    else
-        model.self_occlusions_[i] = 0;
+    model.views_.resize( model.view_filenames_.size() );
+    model.indices_.resize( model.view_filenames_.size() );
+    model.poses_.resize( model.view_filenames_.size() );
+    model.self_occlusions_.resize( model.view_filenames_.size() );
+  }
 
-    if(gen_organized_)
-    {
-      model.indices_[i].indices.clear();
-      std::string obj_indices_fn (view_file);
-      boost::replace_last (obj_indices_fn, "view", "object_indices");
-      boost::replace_last (obj_indices_fn, ".pcd", ".txt");
-      std::ifstream f (obj_indices_fn);
-      int idx;
-      while (f >> idx)
-          model.indices_[i].indices.push_back(idx);
-      f.close();
-    }
+  const std::string view_file = path_views + "/" + model.view_filenames_[i];
+  typename pcl::PointCloud<PointInT>::Ptr cloud (new pcl::PointCloud<PointInT> ());
+  pcl::io::loadPCDFile (view_file, *cloud);
+  model.views_[i] = cloud;
+
+  std::string pose_fn (view_file);
+  boost::replace_last (pose_fn, "view", "pose");
+  boost::replace_last (pose_fn, ".pcd", ".txt");
+  model.poses_[i] = v4r::io::readMatrixFromFile( pose_fn);
+
+  std::string entropy_fn (view_file);
+  boost::replace_last (entropy_fn, "view", "entropy");
+  boost::replace_last (entropy_fn, ".pcd", ".txt");
+  if(v4r::io::existsFile(entropy_fn))
+      v4r::io::readFloatFromFile (entropy_fn, model.self_occlusions_[i]);
+  else
+      model.self_occlusions_[i] = 0;
+
+  if(gen_organized_)
+  {
+    model.indices_[i].indices.clear();
+    std::string obj_indices_fn (view_file);
+    boost::replace_last (obj_indices_fn, "view", "object_indices");
+    boost::replace_last (obj_indices_fn, ".pcd", ".txt");
+    std::ifstream f (obj_indices_fn);
+    int idx;
+    while (f >> idx)
+        model.indices_[i].indices.push_back(idx);
+    f.close();
   }
 }
 
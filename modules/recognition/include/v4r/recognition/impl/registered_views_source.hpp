@@ -135,32 +135,50 @@ RegisteredViewsSource<Full3DPointT, PointInT, OutModelPointT>::loadInMemorySpeci
     model.self_occlusions_.resize( model.view_filenames_.size() );
 
     for (size_t i=0; i<model.view_filenames_.size(); i++)
+        loadInMemorySpecificModelAndView(model, i);
+}
+
+
+template<typename Full3DPointT, typename PointInT, typename OutModelPointT>
+void
+RegisteredViewsSource<Full3DPointT, PointInT, OutModelPointT>::loadInMemorySpecificModelAndView(ModelT &model, int view_id)
+{
+    const std::string training_view_path = path_ + "/" + model.class_ + "/" + model.id_ + "/views/";
+    const size_t i = view_id;
+
+    // concurrent calls for different views require the view data of the model to be sized beforehand
+    if (model.views_.size() <= i)
     {
-        // load training view
-        const std::string view_file = training_view_path + "/" + model.view_filenames_[i];
-        model.views_[i].reset( new pcl::PointCloud<PointInT> () );
-        pcl::io::loadPCDFile (view_file, *model.views_[i]);
-
-        // read pose
-        std::string pose_fn (view_file);
-        boost::replace_last (pose_fn, view_prefix_, pose_prefix_);
-        boost::replace_last (pose_fn, ".pcd", ".txt");
-        Eigen::Matrix4f pose = io::readMatrixFromFile( pose_fn );
-        model.poses_[i] = pose.inverse(); //the recognizer assumes transformation from M to CC - i think!
-
-        // read object mask
-        model.indices_[i].indices.clear();
-        std::string obj_indices_fn (view_file);
-        boost::replace_last (obj_indices_fn, view_prefix_, indices_prefix_);
-        boost::replace_last (obj_indices_fn, ".pcd", ".txt");
-        std::ifstream f ( obj_indices_fn.c_str() );
-        int idx;
-        while (f >> idx)
-            model.indices_[i].indices.push_back(idx);
-        f.close();
-
-        model.self_occlusions_[i] = -1.f;
+        model.views_.resize( model.view_filenames_.size() );
+        model.indices_.resize( model.view_filenames_.size() );
+        model.poses_.resize( model.view_filenames_.size() );
+        model.self_occlusions_.resize( model.view_filenames_.size() );
     }
+
+    // load training view
+    const std::string view_file = training_view_path + "/" + model.view_filenames_[i];
+    model.views_[i].reset( new pcl::PointCloud<PointInT> () );
+    pcl::io::loadPCDFile (view_file, *model.views_[i]);
+
+    // read pose
+    std::string pose_fn (view_file);
+    boost::replace_last (pose_fn, view_prefix_, pose_prefix_);
+    boost::replace_last (pose_fn, ".pcd", ".txt");
+    Eigen::Matrix4f pose = io::readMatrixFromFile( pose_fn );
+    model.poses_[i] = pose.inverse(); //the recognizer assumes transformation from M to CC - i think!
+
+    // read object mask
+    model.indices_[i].indices.clear();
+    std::string obj_indices_fn (view_file);
+    boost::replace_last (obj_indices_fn, view_prefix_, indices_prefix_);
+    boost::replace_last (obj_indices_fn, ".pcd", ".txt");
+    std::ifstream f ( obj_indices_fn.c_str() );
+    int idx;
+    while (f >> idx)
+        model.indices_[i].indices.push_back(idx);
+    f.close();
+
+    model.self_occlusions_[i] = -1.f;
 }
 
 }
@@ -75,6 +75,7 @@ namespace v4r
               float max_descriptor_distance_;
               float correspondence_distance_constant_weight_;
               bool save_hypotheses_;
+              int num_training_threads_;    /// @brief number of threads used for training the models (0 ... number of available cores)
 
               Parameter(
                       bool use_cache = false,
@@ -83,7 +84,8 @@ namespace v4r
                       float distance_same_keypoint = 0.001f * 0.001f,
                       float max_descriptor_distance = std::numeric_limits<float>::infinity(),
                       float correspondence_distance_constant_weight = 1.f,
-                      bool save_hypotheses = false
+                      bool save_hypotheses = false,
+                      int num_training_threads = 0
                       )
                   : Recognizer<PointT>::Parameter(),
                     use_cache_(use_cache),
@@ -92,7 +94,8 @@ namespace v4r
                     distance_same_keypoint_ ( distance_same_keypoint ),
                     max_descriptor_distance_ ( max_descriptor_distance ),
                     correspondence_distance_constant_weight_ ( correspondence_distance_constant_weight ),
-                    save_hypotheses_ ( save_hypotheses )
+                    save_hypotheses_ ( save_hypotheses ),
+                    num_training_threads_ ( num_training_threads )
               {}
           }param_;
 
@@ -129,6 +132,9 @@ namespace v4r
           /** \brief Computes a feature */
           typename boost::shared_ptr<LocalEstimator<PointT, FeatureT> > estimator_;
 
+          /** \brief Additional feature estimators for the threads of the offline training */
+          std::vector<typename boost::shared_ptr<LocalEstimator<PointT, FeatureT> > > training_estimators_;
+
           /** \brief Point-to-point correspondence grouping algorithm */
           typename boost::shared_ptr<v4r::CorrespondenceGrouping<PointT, PointT> > cg_algorithm_;
 
@@ -322,6 +328,24 @@ namespace v4r
           estimator_ = feat;
         }
 
+        /**
+         * \brief Sets additional local feature estimators (configured like the feature estimator) for training the models.
+         * Each training thread uses one of the estimators, further threads use copies of the feature estimator (see
+         * LocalEstimator::makeCopy). Only needed for estimators which can not be copied, threads sharing an estimator
+         * compute their features one after the other.
+         */
+        void
+        setTrainingFeatureEstimators (const std::vector<typename boost::shared_ptr<LocalEstimator<PointT, FeatureT> > > & feats)
+        {
+          training_estimators_ = feats;
+        }
+
+        void
+        setNumTrainingThreads (int n)
+        {
+          param_.num_training_threads_ = n;
+        }
+
         /**
          * \brief Sets the CG algorithm
          */
@@ -35,6 +35,7 @@
 #include <v4r/io/filesystem.h>
 #include <v4r/recognition/source.h>
 #include <v4r/rendering/depthmapRenderer.h>
+#include <v4r/rendering/depthmapRendererCPU.h>
 
 namespace bf = boost::filesystem;
 
@@ -71,9 +72,20 @@ namespace v4r
 
         std::string mesh_dir_;
 
+        bool use_cpu_renderer_;
+        int num_writer_threads_;
+        float view_dedup_thr_;
+
         boost::shared_ptr<DepthmapRenderer> renderer_;
+        boost::shared_ptr<DepthmapRendererCPU> renderer_cpu_;
 
-        pcl::PointCloud<PointT> V4R_EXPORTS renderCloud (const DepthmapRenderer &renderer_, float & visible);
+        /**
+         * @brief renders the views from the sphere around the model and stores them. Rendering runs in the calling
+         * thread (the GL context is bound to it), conversion to point clouds, filtering and writing the files
+         * run in parallel in writer threads.
+         */
+        template<typename RendererT>
+        void generateViews (const RendererT &renderer, ModelT & model);
 
       public:
 
@@ -82,6 +94,9 @@ namespace v4r
         {
           gen_organized_ = false;
           load_into_memory_ = true;
+          use_cpu_renderer_ = false;
+          num_writer_threads_ = 2;
+          view_dedup_thr_ = 0.f;
         }
 
         ~MeshSource(){}
@@ -110,6 +125,34 @@ namespace v4r
             mesh_dir_ = dir;
         }
 
+        /**
+         * @brief use the software renderer (no OpenGL context needed, e.g. on headless machines)
+         */
+        void
+        setUseCPURenderer(bool use)
+        {
+            use_cpu_renderer_ = use;
+        }
+
+        /**
+         * @brief number of threads which convert, filter and save the rendered views
+         */
+        void
+        setNumWriterThreads(int n)
+        {
+            num_writer_threads_ = std::max(1, n);
+        }
+
+        /**
+         * @brief skip views which are nearly identical to an already generated view (e.g. for symmetric objects)
+         * @param thr maximum ratio of differing depth pixels of a duplicate (0 ... keep all views)
+         */
+        void
+        setViewDeduplicationThreshold(float thr)
+        {
+            view_dedup_thr_ = thr;
+        }
+
         void
         loadOrGenerate (const std::string & model_path, ModelT & model);
 
@@ -127,6 +170,9 @@ namespace v4r
         void
         loadInMemorySpecificModel(ModelT & model);
 
+        void
+        loadInMemorySpecificModelAndView(ModelT & model, int view_id);
+
         void
         generate();
 
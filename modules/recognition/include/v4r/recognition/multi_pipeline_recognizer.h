@@ -66,6 +66,7 @@ namespace v4r
         using Recognizer<PointT>::models_;
         using Recognizer<PointT>::transforms_;
         using Recognizer<PointT>::hv_algorithm_;
+        using Recognizer<PointT>::elapsed_time_;
 
         using Recognizer<PointT>::poseRefinement;
         using Recognizer<PointT>::hypothesisVerification;
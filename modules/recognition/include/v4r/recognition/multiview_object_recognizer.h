@@ -78,6 +78,7 @@ protected:
     using Recognizer<PointT>::transforms_;
     using Recognizer<PointT>::planes_;
     using Recognizer<PointT>::hv_algorithm_;
+    using Recognizer<PointT>::elapsed_time_;
 
     using Recognizer<PointT>::poseRefinement;
     using Recognizer<PointT>::hypothesisVerification;
@@ -119,10 +120,19 @@ protected:
 
     void correspondenceGrouping();
 
-    float calcEdgeWeightAndRefineTf (const typename pcl::PointCloud<PointT>::ConstPtr &cloud_src,
-                                    const typename pcl::PointCloud<PointT>::ConstPtr &cloud_dst,
+    /**
+     * @brief registers two views (coarse-to-fine if icp_pyramid_levels_ > 1) and computes the weight of their edge
+     * @param best_weight weight of the best edge found so far, candidates which are already worse at a coarse level are rejected
+     * @return edge weight (std::numeric_limits<float>::max() if registration failed or the candidate was rejected)
+     */
+    float calcEdgeWeightAndRefineTf (View<PointT> &view_src,
+                                    View<PointT> &view_dst,
                                     Eigen::Matrix4f &refined_transform,
-                                    const Eigen::Matrix4f &transform = Eigen::Matrix4f::Identity());
+                                    const Eigen::Matrix4f &transform = Eigen::Matrix4f::Identity(),
+                                    float best_weight = std::numeric_limits<float>::max());
+
+    /** @brief returns the registration data of the view (computed on first use) */
+    typename FastICPCloudCache<PointT>::Ptr getICPCache (View<PointT> &view);
 
     bool calcSiftFeatures (const typename pcl::PointCloud<PointT>::Ptr &cloud_src,
                            typename pcl::PointCloud<PointT>::Ptr &sift_keypoints,
@@ -164,6 +174,8 @@ public:
         int max_vertices_in_graph_; /// @brief maximum number of views taken into account (views selected in order of latest recognition calls)
         double chop_z_;  /// @brief points with z-component higher than chop_z_ will be ignored (low chop_z reduces computation time and false positives (noise increase with z)
         bool compute_mst_; /// @brief if true, does point cloud registration by SIFT background matching (given scene_to_scene_ == true), by using given pose (if use_robot_pose_ == true) and by common object hypotheses (if hyp_to_hyp_ == true) from all the possible connection a Mimimum Spanning Tree is computed. If false, it only uses the given pose for each point cloud
+        int icp_pyramid_levels_; /// @brief number of resolution levels for registering two views (coarse-to-fine, sampling radius doubles with each level; 1 = single resolution)
+        float icp_coarse_rejection_margin_; /// @brief candidate view transforms whose edge weight at a coarse level exceeds the best weight found so far by this margin are rejected
 
         Parameter (
                 bool scene_to_scene = true,
@@ -175,7 +187,9 @@ public:
                 int extension_mode = 0,
                 int max_vertices_in_graph = 3,
                 double chop_z = std::numeric_limits<double>::max(),
-                bool compute_mst = true
+                bool compute_mst = true,
+                int icp_pyramid_levels = 1,
+                float icp_coarse_rejection_margin = 0.1f
                 ) :
 
             Recognizer<PointT>::Parameter(),
@@ -188,7 +202,9 @@ public:
             extension_mode_ (extension_mode),
             max_vertices_in_graph_ (max_vertices_in_graph),
             chop_z_ (chop_z),
-            compute_mst_ (compute_mst)
+            compute_mst_ (compute_mst),
+            icp_pyramid_levels_ (icp_pyramid_levels),
+            icp_coarse_rejection_margin_ (icp_coarse_rejection_margin)
         {}
     }param_;
 
@@ -8,6 +8,7 @@
 #include <v4r/common/common_data_structures.h>
 #include <v4r/recognition/model.h>
 #include <v4r/recognition/local_rec_object_hypotheses.h>
+#include <v4r/registration/fast_icp_with_gc.h>
 
 typedef pcl::Histogram<128> FeatureT;
 
@@ -53,6 +54,9 @@ public:
 
     //GO3D
     std::vector<std::vector<float> >  pt_properties_; /// @brief noise properties for each point
+
+    /** @brief filtered scene, normals, edges and keypoint KD-trees used for registering the view (shared by all its edges) */
+    typename FastICPCloudCache<PointT>::Ptr icp_cache_;
 //    std::vector<int> nguyens_kept_indices_;
 };
 
@@ -81,6 +81,9 @@ namespace v4r
         void
         loadInMemorySpecificModel(ModelT & model);
 
+        void
+        loadInMemorySpecificModelAndView(ModelT & model, int view_id);
+
         void
         loadOrGenerate (const std::string &model_path, ModelT & model);
 
@@ -113,6 +113,9 @@ namespace v4r
         /** \brief Hypotheses verification algorithm */
         typename boost::shared_ptr<HypothesisVerification<PointT, PointT> > hv_algorithm_;
 
+        /** @brief wall time in milliseconds of each processing stage of the last recognize() call (in order of execution) */
+        std::vector<std::pair<std::string, double> > elapsed_time_;
+
         void poseRefinement();
         void hypothesisVerification ();
 
@@ -151,6 +154,15 @@ namespace v4r
             PCL_WARN("getSavedHypotheses is not implemented for this class.");
         }
 
+        /**
+         * @brief returns the wall time in milliseconds of each processing stage of the last recognize() call
+         */
+        const std::vector<std::pair<std::string, double> > &
+        getElapsedTimes() const
+        {
+            return elapsed_time_;
+        }
+
         virtual
         bool
         getSaveHypothesesParam() const
@@ -94,6 +94,9 @@ public:
     void
     loadInMemorySpecificModel(ModelT &model);
 
+    void
+    loadInMemorySpecificModelAndView(ModelT &model, int view_id);
+
     void
     loadModel (ModelT & model);
 
@@ -118,6 +118,11 @@ public:
         return load_into_memory_;
     }
 
+    /**
+     * @brief loads the training view view_id of the model (and the data belonging to it) into memory.
+     * Concurrent calls for different views of a model require the view data of the model to have the size
+     * of model.view_filenames_.
+     */
     virtual void
     loadInMemorySpecificModelAndView(ModelT & model, int view_id)
     {
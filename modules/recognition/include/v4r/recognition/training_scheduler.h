@@ -0,0 +1,119 @@
+/******************************************************************************
+ * Copyright (c) 2015 Thomas Faeulhammer
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ ******************************************************************************/
+
+#ifndef V4R_TRAINING_SCHEDULER_H__
+#define V4R_TRAINING_SCHEDULER_H__
+
+#include <string>
+#include <vector>
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+#include <pcl/common/time.h>
+#include <v4r/core/macros.h>
+
+namespace v4r
+{
+
+/**
+ *      @brief Runs the jobs of the offline training (typically one job per training view) on a pool of
+ *      worker threads, reports the progress together with an estimate of the remaining time and
+ *      collects the errors of the jobs.
+ *      Progress is accumulated over several calls of run() if the total number of jobs is announced by start().
+ *      @date Dec., 2015
+ *      @author Thomas Faeulhammer
+ */
+class V4R_EXPORTS TrainingScheduler
+{
+public:
+    class V4R_EXPORTS Parameter
+    {
+    public:
+        int num_threads_;   /// @brief number of worker threads (0 ... number of available cores)
+        double report_interval_;    /// @brief minimum time between two progress reports in seconds
+
+        Parameter(int num_threads = 0, double report_interval = 5.)
+            : num_threads_ (num_threads),
+              report_interval_ (report_interval)
+        {}
+    }param_;
+
+    /** @brief a job is called with the job index and the index of the worker thread (0 ... getNumWorkers()-1) */
+    typedef boost::function<void (size_t, int)> Job;
+
+private:
+    size_t total_jobs_;
+    size_t done_jobs_;
+    double last_report_;
+    pcl::StopWatch time_;
+
+    void report(const std::string &name);
+
+public:
+    TrainingScheduler(const Parameter &p = Parameter())
+        : param_(p), total_jobs_(0), done_jobs_(0), last_report_(0.)
+    {}
+
+    /** @brief number of worker threads used by run() */
+    int getNumWorkers() const;
+
+    /** @brief resets the progress and announces the total number of jobs of the following calls of run() */
+    void start(size_t total_jobs);
+
+    /**
+     * @brief runs the jobs 0 ... num_jobs-1 (started in increasing order) and returns when all of them are finished
+     * @param num_jobs number of jobs
+     * @param job function called for each job
+     * @param name shown in the progress report
+     * @throws std::runtime_error with the message of the first failed job (the remaining jobs are processed anyway)
+     */
+    void run(size_t num_jobs, const Job &job, const std::string &name = "Training");
+
+    typedef boost::shared_ptr< TrainingScheduler > Ptr;
+    typedef boost::shared_ptr< TrainingScheduler const> ConstPtr;
+};
+
+/**
+ * @brief feature estimators for the workers of a TrainingScheduler: the estimator, the additional estimators and
+ * copies of the estimator (see makeCopy) until there is one for each of the num_workers workers.
+ * If the estimator can not be copied, fewer estimators are returned and the workers have to share them.
+ */
+template<typename EstimatorPtr>
+std::vector<EstimatorPtr>
+makeWorkerEstimators(const EstimatorPtr &estimator, const std::vector<EstimatorPtr> &additional, int num_workers)
+{
+    std::vector<EstimatorPtr> estimators (1, estimator);
+    estimators.insert(estimators.end(), additional.begin(), additional.end());
+
+    while( static_cast<int>(estimators.size()) < num_workers )
+    {
+        EstimatorPtr e = estimator->makeCopy();
+        if(!e)
+            break;
+        estimators.push_back(e);
+    }
+    return estimators;
+}
+
+}
+
+#endif
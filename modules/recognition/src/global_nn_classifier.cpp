@@ -10,4 +10,5 @@
 
 //Instantiation
 template class V4R_EXPORTS v4r::GlobalNNClassifier<flann::L1, pcl::PointXYZ>;
+template class V4R_EXPORTS v4r::GlobalNNClassifier<flann::L1, pcl::PointXYZRGB>;
 template class V4R_EXPORTS v4r::GlobalNNClassifier<v4r::Metrics::HistIntersectionUnionDistance, pcl::PointXYZ>;
@@ -100,24 +100,31 @@ GO3D<ModelT, SceneT>::addModels (std::vector<typename pcl::PointCloud<ModelT>::C
 
         //a point is occluded if it is occluded in all views
 
-        //scene-occlusions
+        //depth buffer of each view is built once and shared by all models
+        std::vector<DepthBuffer> view_depth (occ_clouds_.size());
+        std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f> > trans (occ_clouds_.size());
         for(size_t k=0; k < occ_clouds_.size(); k++)
         {
-            const Eigen::Matrix4f trans =  absolute_camera_poses_[k].inverse();
-
-            for(size_t m=0; m<models.size(); m++)
-            {
-                //transform model to camera coordinate
-                typename pcl::PointCloud<ModelT> model_in_view_coordinates;
-                pcl::transformPointCloud(*models[m], model_in_view_coordinates, trans);
+            view_depth[k].setInputCloud(*occ_clouds_[k], param_.focal_length_);
+            trans[k] = absolute_camera_poses_[k].inverse();
+        }
 
-                std::vector<bool> pt_is_occluded = computeOccludedPoints(*occ_clouds_[k], model_in_view_coordinates, param_.focal_length_, param_.occlusion_thres_, true);
-                std::vector<bool> model_point_is_visible_in_occ_k(models[m]->points.size(), false);
+        //scene-occlusions
+#pragma omp parallel
+        {
+            std::vector<bool> pt_is_occluded;   // reused for all models and views of this thread
 
-                for(size_t idx=0; idx<model_point_is_visible_[m].size(); idx++) {
-                    if ( !pt_is_occluded[idx] ) {
-                        model_point_is_visible_[m][idx] = true;
-                        model_point_is_visible_in_occ_k[idx] = true;
+#pragma omp for schedule(dynamic)
+            for(int m=0; m<static_cast<int>(models.size()); m++)
+            {
+                for(size_t k=0; k < occ_clouds_.size(); k++)
+                {
+                    //model points are transformed to camera coordinate on the fly
+                    view_depth[k].computeOccludedPoints(*models[m], trans[k], pt_is_occluded, param_.occlusion_thres_, true);
+
+                    for(size_t idx=0; idx<model_point_is_visible_[m].size(); idx++) {
+                        if ( !pt_is_occluded[idx] )
+                            model_point_is_visible_[m][idx] = true;
                     }
                 }
             }
@@ -0,0 +1,121 @@
+/******************************************************************************
+ * Copyright (c) 2015 Thomas Faeulhammer
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ ******************************************************************************/
+
+#include <v4r/recognition/training_scheduler.h>
+#include <boost/thread.hpp>
+#include <glog/logging.h>
+#include <algorithm>
+#include <stdexcept>
+
+namespace v4r
+{
+
+int
+TrainingScheduler::getNumWorkers() const
+{
+    if(param_.num_threads_ > 0)
+        return param_.num_threads_;
+
+    return std::max(1u, boost::thread::hardware_concurrency());
+}
+
+void
+TrainingScheduler::start(size_t total_jobs)
+{
+    total_jobs_ = total_jobs;
+    done_jobs_ = 0;
+    last_report_ = 0.;
+    time_.reset();
+}
+
+void
+TrainingScheduler::report(const std::string &name)
+{
+    const double elapsed = time_.getTimeSeconds();
+
+    if( done_jobs_ < total_jobs_ && elapsed - last_report_ < param_.report_interval_ )
+        return;
+
+    last_report_ = elapsed;
+    const double remaining = elapsed / done_jobs_ * (total_jobs_ - done_jobs_);
+
+    LOG(INFO) << name << ": " << done_jobs_ << "/" << total_jobs_ << " jobs done after " << elapsed <<
+                 " s, approx. " << remaining << " s remaining.";
+}
+
+void
+TrainingScheduler::run(size_t num_jobs, const Job &job, const std::string &name)
+{
+    if(num_jobs == 0)
+        return;
+
+    if(done_jobs_ >= total_jobs_)
+        start(num_jobs);
+    else
+        total_jobs_ = std::max(total_jobs_, done_jobs_ + num_jobs);
+
+    const int num_workers = static_cast<int>( std::min<size_t>(getNumWorkers(), num_jobs) );
+
+    boost::mutex mtx;
+    size_t next_job = 0;
+    std::string error_msg;
+
+    boost::thread_group workers;
+    for(int w=0; w<num_workers; w++)
+    {
+        workers.create_thread( [&, w]()
+        {
+            for(;;)
+            {
+                size_t j;
+                {
+                    boost::unique_lock<boost::mutex> lock(mtx);
+                    if(next_job >= num_jobs)
+                        break;
+                    j = next_job++;
+                }
+
+                try
+                {
+                    job(j, w);
+                }
+                catch(const std::exception &e)
+                {
+                    boost::unique_lock<boost::mutex> lock(mtx);
+                    if(error_msg.empty())
+                        error_msg = e.what();
+                }
+
+                boost::unique_lock<boost::mutex> lock(mtx);
+                done_jobs_++;
+                report(name);
+            }
+        });
+    }
+    workers.join_all();
+
+    if(!error_msg.empty())
+        throw std::runtime_error("[TrainingScheduler::run] " + name + " failed: " + error_msg);
+}
+
+}
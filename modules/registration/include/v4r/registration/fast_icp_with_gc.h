@@ -19,6 +19,7 @@
 #include <pcl/common/time.h>
 #include <pcl/keypoints/uniform_sampling.h>
 #include <pcl/registration/correspondence_estimation.h>
+#include <pcl/search/kdtree.h>
 #include <pcl/visualization/pcl_visualizer.h>
 
 namespace v4r
@@ -68,6 +69,63 @@ namespace v4r
         pcl::PointCloud<pcl::Normal>::Ptr normal_src_keypoints_;
     };
 
+    /**
+     * @brief data FastIterativeClosestPointWithGC computes from a single cloud (normals, color edges and
+     * uniformly sampled keypoints with their KD-tree for each sampling radius). A cache can be shared by all
+     * alignments of the same cloud, e.g. all edges pointing to a view. It is reset if it is used with another cloud.
+     */
+    template <typename PointT>
+    class V4R_EXPORTS FastICPCloudCache
+    {
+      public:
+        class KeypointLevel
+        {
+          public:
+            float sampling_radius_;
+            typename pcl::PointCloud<PointT>::Ptr keypoints_;
+            pcl::PointCloud<pcl::Normal>::Ptr normals_;
+            typename pcl::search::KdTree<PointT>::Ptr tree_;
+            Eigen::Vector4f min_b_, max_b_;   /// @brief voxel grid bounds of the uniform sampling
+
+            EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+            typedef boost::shared_ptr<KeypointLevel> Ptr;
+        };
+
+        typename pcl::PointCloud<PointT>::Ptr cloud_;   /// @brief cloud the data belongs to
+        pcl::PointCloud<pcl::Normal>::Ptr normals_;
+        std::vector<int> edge_indices_;
+        bool has_edges_;
+        std::vector<typename KeypointLevel::Ptr> levels_;
+
+        FastICPCloudCache(const typename pcl::PointCloud<PointT>::Ptr &cloud = typename pcl::PointCloud<PointT>::Ptr())
+        {
+          reset(cloud);
+        }
+
+        void
+        reset(const typename pcl::PointCloud<PointT>::Ptr &cloud)
+        {
+          cloud_ = cloud;
+          normals_.reset();
+          edge_indices_.clear();
+          has_edges_ = false;
+          levels_.clear();
+        }
+
+        typename KeypointLevel::Ptr
+        getLevel(float sampling_radius) const
+        {
+          for(size_t i=0; i < levels_.size(); i++)
+          {
+            if(levels_[i]->sampling_radius_ == sampling_radius)
+              return levels_[i];
+          }
+          return typename KeypointLevel::Ptr();
+        }
+
+        typedef boost::shared_ptr<FastICPCloudCache<PointT> > Ptr;
+    };
+
     template <typename PointT>
     class V4R_EXPORTS FastIterativeClosestPointWithGC
     {
@@ -109,6 +167,11 @@ namespace v4r
       bool standard_cg_;
       std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f> > initial_poses_;
       bool no_cg_;
+      typename FastICPCloudCache<PointT>::Ptr input_cache_, target_cache_;
+
+      void
+      prepareCloud (PointTPtr & cloud, const typename FastICPCloudCache<PointT>::Ptr & cache,
+                    pcl::PointCloud<pcl::Normal>::Ptr & normals, std::vector<int> & edge_indices);
 
       inline void
       transformNormals (pcl::PointCloud<pcl::Normal>::Ptr & normals_cloud, Eigen::Matrix4f & transform)
@@ -257,6 +320,13 @@ namespace v4r
           standard_cg_ = b;
         }
 
+        /** @brief all hypotheses which survived the last iteration as (registration score, transform), best first */
+        const std::vector<std::pair<float, Eigen::Matrix4f> > &
+        getResults() const
+        {
+          return result_;
+        }
+
         float getFinalTransformation(Eigen::Matrix4f & matrix) const
         {
           if(result_.size() == 0)
@@ -295,6 +365,23 @@ namespace v4r
           max_iterations_ = it;
         }
 
+        void setUniformSamplingRadius(float r)
+        {
+          uniform_sampling_radius_ = r;
+        }
+
+        /** @brief reuses normals and color edges of the source cloud */
+        void setInputCache(const typename FastICPCloudCache<PointT>::Ptr & cache)
+        {
+          input_cache_ = cache;
+        }
+
+        /** @brief reuses normals, color edges, keypoints and their KD-tree of the target cloud (not used if target indices are set) */
+        void setTargetCache(const typename FastICPCloudCache<PointT>::Ptr & cache)
+        {
+          target_cache_ = cache;
+        }
+
         void setInputSource(PointTPtr cloud)
         {
           input_ = cloud;
@@ -215,6 +215,50 @@ namespace v4r
       return ret_values;
     }
 
+    template<typename PointT>
+      void
+      FastIterativeClosestPointWithGC<PointT>::prepareCloud (PointTPtr & cloud,
+                                                             const typename FastICPCloudCache<PointT>::Ptr & cache,
+                                                             pcl::PointCloud<pcl::Normal>::Ptr & normals,
+                                                             std::vector<int> & edge_indices)
+      {
+        if (cache && cache->cloud_ != cloud)
+          cache->reset (cloud);
+
+        if (use_normals_)
+        {
+          if (cache && cache->normals_)
+            normals = cache->normals_;
+          else
+          {
+            normals.reset (new pcl::PointCloud<pcl::Normal>);
+            pcl::IntegralImageNormalEstimation<PointT, pcl::Normal> normal_estimation;
+            normal_estimation.setNormalEstimationMethod (pcl::IntegralImageNormalEstimation<PointT, pcl::Normal>::AVERAGE_3D_GRADIENT);
+            normal_estimation.setNormalSmoothingSize (10.0);
+            normal_estimation.setBorderPolicy (pcl::IntegralImageNormalEstimation<PointT, pcl::Normal>::BORDER_POLICY_MIRROR);
+            normal_estimation.setInputCloud (cloud);
+            normal_estimation.compute (*normals);
+
+            if (cache)
+              cache->normals_ = normals;
+          }
+        }
+
+        if (cache && cache->has_edges_)
+          edge_indices = cache->edge_indices_;
+        else
+        {
+          edge_indices.clear ();
+          computeRGBEdges (cloud, edge_indices);
+
+          if (cache)
+          {
+            cache->edge_indices_ = edge_indices;
+            cache->has_edges_ = true;
+          }
+        }
+      }
+
     template<typename PointT>
       void
       FastIterativeClosestPointWithGC<PointT>::align (Eigen::Matrix4f initial_guess)
@@ -224,28 +268,10 @@ namespace v4r
         pcl::visualization::PCLVisualizer survived_vis ("survived VIS...");
 #endif
 
-        //compute normals
-        if (use_normals_)
-        {
-          input_normals_.reset (new pcl::PointCloud<pcl::Normal>);
-          target_normals_.reset (new pcl::PointCloud<pcl::Normal>);
-          pcl::IntegralImageNormalEstimation<PointT, pcl::Normal> normal_estimation;
-          normal_estimation.setNormalEstimationMethod (pcl::IntegralImageNormalEstimation<PointT, pcl::Normal>::AVERAGE_3D_GRADIENT);
-          normal_estimation.setNormalSmoothingSize (10.0);
-          normal_estimation.setBorderPolicy (pcl::IntegralImageNormalEstimation<PointT, pcl::Normal>::BORDER_POLICY_MIRROR);
-
-          normal_estimation.setInputCloud (input_);
-          normal_estimation.compute (*input_normals_);
-
-          normal_estimation.setInputCloud (target_);
-          normal_estimation.compute (*target_normals_);
-        }
-
-        //compute keypoints (uniform sampling, color edges)
+        //compute normals and keypoints (color edges), or take them from the caches
         std::vector<int> ind_src_cedges, ind_tgt_cedges;
-
-        computeRGBEdges(input_, ind_src_cedges);
-        computeRGBEdges (target_, ind_tgt_cedges);
+        prepareCloud (input_, input_cache_, input_normals_, ind_src_cedges);
+        prepareCloud (target_, target_cache_, target_normals_, ind_tgt_cedges);
 
         if(input_indices_.indices.size() > 0 && target_indices_.indices.size() > 0)
         {
@@ -258,33 +284,63 @@ namespace v4r
           ind_tgt_cedges = indices_tgt_roi;
         }
 
-        PointTPtr src_keypoints  (new pcl::PointCloud<PointT>);
-        PointTPtr tgt_keypoints (new pcl::PointCloud<PointT>);
+        //uniformly sampled target keypoints and their KD-tree, shared by all hypotheses (and alignments if cached)
+        const bool use_target_cache = target_cache_ && target_indices_.indices.empty();
+        typename FastICPCloudCache<PointT>::KeypointLevel::Ptr tgt_level;
+        if (use_target_cache)
+          tgt_level = target_cache_->getLevel (uniform_sampling_radius_);
+
+        if (!tgt_level)
+        {
+          tgt_level.reset (new typename FastICPCloudCache<PointT>::KeypointLevel);
+          tgt_level->sampling_radius_ = uniform_sampling_radius_;
+          tgt_level->keypoints_.reset (new pcl::PointCloud<PointT>);
+          tgt_level->normals_.reset (new pcl::PointCloud<pcl::Normal>);
+
+          PointTPtr tgt_edge_points (new pcl::PointCloud<PointT>);
+          pcl::copyPointCloud (*target_, ind_tgt_cedges, *tgt_edge_points);
+
+          std::vector<int> ind_tgt;
+          UniformSamplingSharedVoxelGrid<PointT> keypoint_extractor;
+          keypoint_extractor.setRadiusSearch (uniform_sampling_radius_);
+          uniformSamplingOfKeypoints (tgt_edge_points, ind_tgt_cedges, ind_tgt, keypoint_extractor);
+          pcl::copyPointCloud (*target_, ind_tgt, *tgt_level->keypoints_);
+          if(use_normals_)
+            pcl::copyPointCloud (*target_normals_, ind_tgt, *tgt_level->normals_);
 
-        pcl::PointCloud<pcl::Normal>::Ptr normal_tgt_keypoints(new pcl::PointCloud<pcl::Normal>);
-        pcl::PointCloud<pcl::Normal>::Ptr normal_src_keypoints(new pcl::PointCloud<pcl::Normal>);
+          keypoint_extractor.getVoxelGridValues (tgt_level->min_b_, tgt_level->max_b_);
 
-        pcl::copyPointCloud (*input_, ind_src_cedges, *src_keypoints);
-        pcl::copyPointCloud (*target_, ind_tgt_cedges, *tgt_keypoints);
+          if (!tgt_level->keypoints_->points.empty ())
+          {
+            tgt_level->tree_.reset (new pcl::search::KdTree<PointT>);
+            tgt_level->tree_->setInputCloud (tgt_level->keypoints_);
+          }
 
-        if(use_normals_)
+          if (use_target_cache)
+            target_cache_->levels_.push_back (tgt_level);
+        }
+
+        result_.clear ();
+        if (!tgt_level->tree_)
         {
-          pcl::copyPointCloud (*target_normals_, ind_tgt_cedges, *normal_tgt_keypoints);
-          pcl::copyPointCloud (*input_normals_, ind_src_cedges, *normal_src_keypoints);
+          PCL_WARN("There are no target keypoints to align to\n");
+          return;
         }
 
-        boost::shared_ptr<std::vector<int> > ind_tgt;
-        ind_tgt.reset (new std::vector<int>);
+        const PointTPtr tgt_keypoints = tgt_level->keypoints_;
+        const pcl::PointCloud<pcl::Normal>::Ptr normal_tgt_keypoints = tgt_level->normals_;
 
-        UniformSamplingSharedVoxelGrid<PointT> keypoint_extractor;
-        keypoint_extractor.setRadiusSearch (uniform_sampling_radius_);
-        uniformSamplingOfKeypoints (tgt_keypoints, ind_tgt_cedges, *ind_tgt, keypoint_extractor);
-        pcl::copyPointCloud (*target_, *ind_tgt, *tgt_keypoints);
-        if(use_normals_)
-          pcl::copyPointCloud (*target_normals_, *ind_tgt, *normal_tgt_keypoints);
+        //source keypoints are sampled with the voxel grid of the target (the same for all hypotheses)
+        std::vector<int> ind_src;
+        {
+          PointTPtr src_edge_points (new pcl::PointCloud<PointT>);
+          pcl::copyPointCloud (*input_, ind_src_cedges, *src_edge_points);
 
-        Eigen::Vector4f min_b, max_b;
-        keypoint_extractor.getVoxelGridValues (min_b, max_b);
+          UniformSamplingSharedVoxelGrid<PointT> keypoint_extractor;
+          keypoint_extractor.setRadiusSearch (uniform_sampling_radius_);
+          keypoint_extractor.setVoxelGridValues (tgt_level->min_b_, tgt_level->max_b_);
+          uniformSamplingOfKeypoints (src_edge_points, ind_src_cedges, ind_src, keypoint_extractor);
+        }
 
         typename std::vector<boost::shared_ptr<ICPNode<PointT> > > alive_nodes_; //contains nodes that need to be processed at a certain ICP iteration
 
@@ -322,27 +378,19 @@ namespace v4r
           //survived_vis.removeAllShapes ();
           //visualizeICPNodes (alive_nodes_, survived_vis, "in the loop");
 
-//#pragma omp parallel for num_threads(8)
-          for (size_t an = 0; an < alive_nodes_.size (); an++)
+#pragma omp parallel for schedule(dynamic)
+          for (int an = 0; an < (int)alive_nodes_.size (); an++)
           {
             //transform input cloud
             typename boost::shared_ptr<ICPNode<PointT> > cur_node = alive_nodes_[an];
 
             PointTPtr src_keypoints_local (new pcl::PointCloud<PointT>);
-
-            boost::shared_ptr<std::vector<int> > ind_src;
-            ind_src.reset (new std::vector<int>);
-            UniformSamplingSharedVoxelGrid<PointT> keypoint_extractor;
-            keypoint_extractor.setRadiusSearch (uniform_sampling_radius_);
-            keypoint_extractor.setVoxelGridValues (min_b, max_b);
-            uniformSamplingOfKeypoints (src_keypoints, ind_src_cedges, *ind_src, keypoint_extractor);
-
             pcl::PointCloud<pcl::Normal>::Ptr normal_src_keypoints_local(new pcl::PointCloud<pcl::Normal>);
 
-            pcl::copyPointCloud (*input_, *ind_src, *src_keypoints_local);
+            pcl::copyPointCloud (*input_, ind_src, *src_keypoints_local);
             if(use_normals_)
             {
-              pcl::copyPointCloud (*input_normals_, *ind_src, *normal_src_keypoints_local);
+              pcl::copyPointCloud (*input_normals_, ind_src, *normal_src_keypoints_local);
               transformNormals(normal_src_keypoints_local, cur_node->accum_transform_);
             }
 
@@ -360,6 +408,7 @@ namespace v4r
 
               corresp_est->setInputSource (src_keypoints_local);
               corresp_est->setInputTarget (tgt_keypoints);
+              corresp_est->setSearchMethodTarget (tgt_level->tree_, true);
               corresp_est->determineCorrespondences (*correspondences_alive_node, corr_dist_threshold_);
 
 //              corresp_est->setInputSource (tgt_keypoints);
@@ -479,8 +528,8 @@ namespace v4r
             //pcl::ScopeTime t ("Evaluate hypotheses...");
 //            float osv_cutoff = 0.1f;
             float fsv_cutoff = 0.02f;
-//#pragma omp parallel for num_threads(8)
-            for (size_t k = 0; k < next_level_nodes_.size (); k++)
+#pragma omp parallel for schedule(dynamic)
+            for (int k = 0; k < (int)next_level_nodes_.size (); k++)
             {
 
               int max_points = std::min (static_cast<int> (next_level_nodes_[k]->src_keypoints_->points.size ()), static_cast<int> (tgt_keypoints->points.size ()));
@@ -517,8 +566,8 @@ namespace v4r
             }
 
             //another pass to evaluate normals and maybe color
-//#pragma omp parallel for num_threads(8)
-            for (size_t k = 0; k < next_level_nodes_.size (); k++)
+#pragma omp parallel for schedule(dynamic)
+            for (int k = 0; k < (int)next_level_nodes_.size (); k++)
             {
               std::vector<float> values_ij = evaluateHypotheses(target_, next_level_nodes_[k]->src_keypoints_,
                                                               target_normals_, next_level_nodes_[k]->normal_src_keypoints_);
@@ -114,6 +114,8 @@ private:
     std::vector<std::vector<size_t> > indices_; /// @brief Indices of the object in each cloud (remaining points will be ignored)
     std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f> > transformations_to_global_; /// @brief transform aligning the input point clouds when multiplied
     std::vector<std::vector<std::vector<float> > > pt_properties_; /// @brief for each cloud, for each pixel represent lateral [idx=0] and axial [idx=1] as well as distance to closest depth discontinuity [idx=2]
+    std::vector<PointInfo> added_info_; /// @brief points of the views added by addView (in the coordinate system of their view)
+    std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f> > added_transformations_; /// @brief transforms aligning the added views to the global coordinate system
     PointNormalTPtr output_normals_;
 
     void cleanUp()
@@ -127,6 +129,7 @@ private:
     }
 
     void collectInfo();
+    void collectAddedInfo();
     void reasonAboutPts();
 
 public:
@@ -185,6 +188,52 @@ public:
             indices_[i] = convertVecInt2VecSizet(indices[i]);
     }
 
+    /**
+     * @brief adds a single view to the integration (streaming mode). Only the points given by the indices are stored
+     * together with their noise properties, i.e. the cloud and normals of the view can be released afterwards. The points
+     * are kept in the coordinate system of the view until compute() is called, so its transform can still be updated.
+     * Added views are kept over several calls of compute() until clearAddedViews() is called.
+     * @param cloud organized input cloud
+     * @param normals normals corresponding to the input cloud
+     * @param pt_properties for each pixel lateral [idx=0] and axial [idx=1] noise as well as distance to closest depth discontinuity [idx=2]
+     * @param indices points of the cloud to be integrated (e.g. object mask)
+     * @param transform transform aligning the cloud to the global coordinate system
+     * @return id of the added view
+     */
+    size_t
+    addView (const pcl::PointCloud<PointT> &cloud,
+             const pcl::PointCloud<pcl::Normal> &normals,
+             const std::vector<std::vector<float> > &pt_properties,
+             const std::vector<size_t> &indices,
+             const Eigen::Matrix4f &transform = Eigen::Matrix4f::Identity());
+
+    /**
+     * @brief updates the transform of a view added by addView (e.g. after a pose graph optimization)
+     * @param view_id id returned by addView
+     * @param transform transform aligning the view to the global coordinate system
+     */
+    void
+    setViewTransformation (size_t view_id, const Eigen::Matrix4f &transform);
+
+    /**
+     * @brief number of views added by addView
+     */
+    size_t
+    getNumAddedViews () const
+    {
+        return added_transformations_.size();
+    }
+
+    /**
+     * @brief removes all views added by addView
+     */
+    void
+    clearAddedViews ()
+    {
+        added_info_.clear();
+        added_transformations_.clear();
+    }
+
     /**
      * @brief compute the registered point cloud taking into account the noise model of the cameras
      * @param registered cloud
@@ -107,6 +107,68 @@ NMBasedCloudIntegration<PointT>::collectInfo ()
     }
 }
 
+template<typename PointT>
+size_t
+NMBasedCloudIntegration<PointT>::addView (const pcl::PointCloud<PointT> &cloud,
+                                          const pcl::PointCloud<pcl::Normal> &normals,
+                                          const std::vector<std::vector<float> > &pt_properties,
+                                          const std::vector<size_t> &indices,
+                                          const Eigen::Matrix4f &transform)
+{
+    CHECK (normals.points.size() == cloud.points.size() && pt_properties.size() == cloud.points.size());
+
+    const size_t view_id = added_transformations_.size();
+    added_transformations_.push_back(transform);
+    added_info_.reserve( added_info_.size() + indices.size() );
+
+    for(const auto idx : indices)
+    {
+        if(!pcl::isFinite(cloud.points[idx]))
+            continue;
+
+        PointInfo pt;
+        pt.pt = cloud.points[idx];
+        pt.normal = normals.points[idx];
+        pt.sigma_lateral = pt_properties[idx][0];
+        pt.sigma_axial = pt_properties[idx][1];
+        pt.distance_to_depth_discontinuity = pt_properties[idx][2];
+        pt.origin = view_id;
+
+        // the determinant of the covariance does not change by rotating it into the global coordinate system
+        pt.probability = 1/ sqrt(2 * M_PI * pt.sigma_lateral * pt.sigma_lateral * pt.sigma_axial);
+        added_info_.push_back(pt);
+    }
+    return view_id;
+}
+
+template<typename PointT>
+void
+NMBasedCloudIntegration<PointT>::setViewTransformation (size_t view_id, const Eigen::Matrix4f &transform)
+{
+    CHECK (view_id < added_transformations_.size());
+    added_transformations_[view_id] = transform;
+}
+
+template<typename PointT>
+void
+NMBasedCloudIntegration<PointT>::collectAddedInfo ()
+{
+    const size_t existing_pts = big_cloud_info_.size();
+    const size_t origin_offset = input_clouds_.size();
+    big_cloud_info_.resize( existing_pts + added_info_.size() );
+
+    #pragma omp parallel for schedule(static)
+    for(size_t i=0; i < added_info_.size(); i++)
+    {
+        PointInfo pt = added_info_[i];
+        const Eigen::Matrix4f &tf = added_transformations_[ pt.origin ];
+        pt.pt.getVector3fMap() = tf.block<3,3>(0,0) * pt.pt.getVector3fMap() + tf.block<3,1>(0,3);
+        pt.normal.getNormalVector3fMap() = tf.block<3,3>(0,0) * pt.normal.getNormalVector3fMap();
+        pt.origin += origin_offset;
+        big_cloud_info_[ existing_pts + i ] = pt;
+    }
+}
+
 template<typename PointT>
 void
 NMBasedCloudIntegration<PointT>::reasonAboutPts ()
@@ -177,7 +239,7 @@ template<typename PointT>
 void
 NMBasedCloudIntegration<PointT>::compute (PointTPtr & output)
 {
-    if(input_clouds_.empty()) {
+    if(input_clouds_.empty() && added_info_.empty()) {
         std::cerr << "No input clouds set for cloud integration!" << std::endl;
         return;
     }
@@ -185,9 +247,15 @@ NMBasedCloudIntegration<PointT>::compute (PointTPtr & output)
     big_cloud_info_.clear();
 
     collectInfo();
+    collectAddedInfo();
 
     if(param_.reason_about_points_)
-        reasonAboutPts();
+    {
+        if(added_transformations_.empty())
+            reasonAboutPts();
+        else    // the organized clouds of the added views are not available anymore
+            LOG(WARNING) << "Reasoning about points is not possible for views added by addView. Skipping it.";
+    }
 
     pcl::octree::OctreePointCloudPointVector<PointT> octree( param_.octree_resolution_ );
     PointTPtr big_cloud ( new pcl::PointCloud<PointT>());
@@ -39,6 +39,7 @@
 #include <pcl/io/pcd_io.h>
 #include <pcl/point_types.h>
 #include <eigen3/Eigen/Eigen>
+#include <eigen3/Eigen/StdVector>
 #include <v4r/core/macros.h>
 #include "dmRenderObject.h"
 
@@ -103,11 +104,15 @@ private:
 
     //this here is to create points as part of a sphere
     //The next two i stole from thomas mörwald
-    int search_midpoint(int &index_start, int &index_end, size_t &n_vertices, int &edge_walk,
+    static int search_midpoint(int &index_start, int &index_end, size_t &n_vertices, int &edge_walk,
                        std::vector<int> &midpoint, std::vector<int> &start, std::vector<int> &end, std::vector<float> &vertices);
-    void subdivide(size_t &n_vertices, size_t &n_edges, size_t &n_faces, std::vector<float> &vertices,
+    static void subdivide(size_t &n_vertices, size_t &n_edges, size_t &n_faces, std::vector<float> &vertices,
                    std::vector<int> &faces);
 
+    //renders the model from _pose, the output and the buffers are reused if they have the right size
+    void render(const Eigen::Matrix4f &_pose, cv::Mat &depthmap, cv::Mat &color, cv::Mat &indexMap,
+                std::vector<float> &faceSurfaceArea, std::vector<int> &facePixelCount, float &visible) const;
+
 public:
     /**
      * @brief DepthmapRenderer
@@ -124,8 +129,9 @@ public:
      * @param r radius
      * @param subdivisions there are 12 points by subdividing you add a lot more to them
      * @return vector of poses around a sphere
+     * Note: does not need a rendering context (also used by DepthmapRendererCPU)
      */
-    std::vector<Eigen::Vector3f> createSphere(float r, size_t subdivisions);
+    static std::vector<Eigen::Vector3f> createSphere(float r, size_t subdivisions);
 
     /**
      * @brief setIntrinsics
@@ -147,7 +153,7 @@ public:
      * @param position
      * @return
      */
-    Eigen::Matrix4f getPoseLookingToCenterFrom(Eigen::Vector3f position);
+    static Eigen::Matrix4f getPoseLookingToCenterFrom(Eigen::Vector3f position);
 
     /**
      * @brief setCamPose
@@ -182,6 +188,32 @@ public:
      * @return
      */
     pcl::PointCloud<pcl::PointXYZRGB> renderPointcloudColor(float &visibleSurfaceArea) const;
+
+    /**
+     * @brief renderDepthmaps renders a list of poses back to back (e.g. the poses of createSphere)
+     *        The images are only reallocated if the given ones do not have the right size.
+     * @param poses camera poses (see setCamPose)
+     * @param depthmaps one depth map per pose
+     * @param colors one color image per pose
+     * @param visibleSurfaceAreas one estimate of the visible surface area per pose
+     */
+    void renderDepthmaps(const std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f> > &poses,
+                         std::vector<cv::Mat> &depthmaps, std::vector<cv::Mat> &colors,
+                         std::vector<float> &visibleSurfaceAreas) const;
+
+    /**
+     * @brief depthmapToPointcloud converts a rendered depth map to an organized point cloud
+     * @param depth depth map (see renderDepthmap)
+     * @param _pose pose the depth map was rendered from
+     * @param cloud
+     */
+    void depthmapToPointcloud(const cv::Mat &depth, const Eigen::Matrix4f &_pose, pcl::PointCloud<pcl::PointXYZ> &cloud) const;
+
+    /**
+     * @brief depthmapToPointcloud converts a rendered depth and color map to an organized point cloud
+     */
+    void depthmapToPointcloud(const cv::Mat &depth, const cv::Mat &color, const Eigen::Matrix4f &_pose,
+                              pcl::PointCloud<pcl::PointXYZRGB> &cloud) const;
 };
 }
 
@@ -0,0 +1,184 @@
+/******************************************************************************
+ * Copyright (c) 2015 Simon Schreiberhuber
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ ******************************************************************************/
+
+/**
+*
+*      @author Simon Schreiberhuber (schreiberhuber@acin.tuwien.ac.at)
+*      @date November, 2015
+*/
+
+
+#ifndef __V4R_DEPTHMAP_RENDERER_CPU__
+#define __V4R_DEPTHMAP_RENDERER_CPU__
+
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+#include <pcl/point_types.h>
+#include <pcl/point_cloud.h>
+#include <eigen3/Eigen/Eigen>
+#include <eigen3/Eigen/StdVector>
+#include <v4r/core/macros.h>
+#include "dmRenderObject.h"
+
+
+namespace v4r{
+
+/**
+ * @brief The DepthmapRendererCPU class
+ * Software implementation of the DepthmapRenderer. It does not need an OpenGL context
+ * (e.g. for headless machines) and gives the same output as the GPU renderer:
+ * depth map, color map and the estimate of the visible surface area.
+ * The image is split into tiles. Triangles are binned to the tiles and the tiles
+ * are rasterized in parallel with a z-buffer. Alternatively renderDepthmaps renders
+ * several views in parallel (one thread per view).
+ */
+class V4R_EXPORTS DepthmapRendererCPU{
+private:
+
+    //hide the default constructor
+    DepthmapRendererCPU();
+
+    class Workspace;
+
+    //geometry of the current model (fitted into the unit sphere)
+    std::vector<Eigen::Vector3f> positions;
+    std::vector<unsigned int> colors;
+    std::vector<unsigned int> indices;
+
+    //surface area of each triangle (twice the area, as in the GPU renderer) and the sum of them
+    std::vector<float> faceArea;
+    float fullArea;
+
+    //camera intrinsics:
+    Eigen::Vector4f fxycxy;
+    Eigen::Vector2i res;
+
+    //Stores the camera pose:
+    Eigen::Matrix4f pose;
+
+    int tileSize;
+
+    void render(const Eigen::Matrix4f &_pose, Workspace &ws, cv::Mat &depthmap, cv::Mat &color, float &visible) const;
+
+public:
+    /**
+     * @brief DepthmapRendererCPU
+     * @param resx resolution of the rendered images
+     * @param resy
+     * @param _tileSize size of the tiles (in pixel) which are rasterized in parallel
+     */
+    DepthmapRendererCPU(int resx, int resy, int _tileSize=32);
+
+    ~DepthmapRendererCPU();
+
+    /**
+     * @brief createSphere (see DepthmapRenderer::createSphere)
+     */
+    static std::vector<Eigen::Vector3f> createSphere(float r, size_t subdivisions);
+
+    /**
+     * @brief setIntrinsics
+     * @param fx focal length
+     * @param fy
+     * @param cx center of projection
+     * @param cy
+     */
+    void setIntrinsics(float fx,float fy,float cx,float cy);
+
+    /**
+     * @brief setModel copies the geometry of the model, the model can be deleted afterwards
+     * @param model
+     */
+    void setModel(DepthmapRendererModel* _model);
+
+    /**
+     * @brief getPoseLookingToCenterFrom (see DepthmapRenderer::getPoseLookingToCenterFrom)
+     */
+    static Eigen::Matrix4f getPoseLookingToCenterFrom(Eigen::Vector3f position);
+
+    /**
+     * @brief setCamPose
+     * @param pose
+     * A 4x4 Matrix giving the pose
+     */
+    void setCamPose(Eigen::Matrix4f _pose);
+
+    /**
+     * @brief renderDepthmap
+     * @param visibleSurfaceArea: Returns an estimate of how much of the models surface area
+     *        is visible.
+     * @param color: CV_8UC4 color image (plain black if the geometry has no color)
+     * @return a depthmap
+     */
+    cv::Mat renderDepthmap(float &visibleSurfaceArea, cv::Mat &color) const;
+
+    /**
+     * @brief renderPointcloud
+     * @param visibleSurfaceArea: Returns an estimate of how much of the models surface area
+     *        is visible.
+     * @return
+     */
+    pcl::PointCloud<pcl::PointXYZ> renderPointcloud(float &visibleSurfaceArea) const;
+
+    /**
+     * @brief renderPointcloudColor
+     * @param visibleSurfaceArea: Returns an estimate of how much of the models surface area
+     *        is visible.
+     * @return
+     */
+    pcl::PointCloud<pcl::PointXYZRGB> renderPointcloudColor(float &visibleSurfaceArea) const;
+
+    /**
+     * @brief renderDepthmaps renders several views in parallel (e.g. the poses of createSphere)
+     *        The images are only reallocated if the given ones do not have the right size.
+     * @param poses camera poses (see setCamPose)
+     * @param depthmaps one depth map per pose
+     * @param colors one color image per pose
+     * @param visibleSurfaceAreas one estimate of the visible surface area per pose
+     */
+    void renderDepthmaps(const std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f> > &poses,
+                         std::vector<cv::Mat> &depthmaps, std::vector<cv::Mat> &colors,
+                         std::vector<float> &visibleSurfaceAreas) const;
+
+    /**
+     * @brief depthmapToPointcloud converts a rendered depth map to an organized point cloud
+     * @param depth depth map (see renderDepthmap)
+     * @param _pose pose the depth map was rendered from
+     * @param cloud
+     */
+    void depthmapToPointcloud(const cv::Mat &depth, const Eigen::Matrix4f &_pose, pcl::PointCloud<pcl::PointXYZ> &cloud) const;
+
+    /**
+     * @brief depthmapToPointcloud converts a rendered depth and color map to an organized point cloud
+     */
+    void depthmapToPointcloud(const cv::Mat &depth, const cv::Mat &color, const Eigen::Matrix4f &_pose,
+                              pcl::PointCloud<pcl::PointXYZRGB> &cloud) const;
+
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+}
+
+
+#endif /* defined(__V4R_DEPTHMAP_RENDERER_CPU__) */
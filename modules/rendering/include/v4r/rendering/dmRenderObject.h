@@ -36,6 +36,7 @@
 #include <GL/gl.h>
 
 
+#include <vector>
 #include <eigen3/Eigen/Eigen>
 #include <v4r/core/macros.h>
 
@@ -48,6 +49,7 @@ namespace v4r{
 class V4R_EXPORTS DepthmapRendererModel{
 private:
     friend class DepthmapRenderer;
+    friend class DepthmapRendererCPU;
 
     struct Vertex;
 
@@ -77,6 +79,16 @@ private:
      */
     unsigned int getIndexCount();
 
+    /**
+     * @brief copyGeometry
+     *        Copies the geometry to host side buffers (used by the software renderer)
+     * @param positions vertex positions (scaled to the unit sphere)
+     * @param colors vertex colors, packed in memory order r,g,b,a
+     * @param _indices three indices per triangle
+     */
+    void copyGeometry(std::vector<Eigen::Vector3f> &positions, std::vector<unsigned int> &colors,
+                      std::vector<unsigned int> &_indices) const;
+
 
 
 public:
@@ -536,7 +536,8 @@ void DepthmapRenderer::setCamPose(Eigen::Matrix4f _pose)
 
 
 
-cv::Mat DepthmapRenderer::renderDepthmap(float &visible,cv::Mat &color) const
+void DepthmapRenderer::render(const Eigen::Matrix4f &_pose, cv::Mat &depthmap, cv::Mat &color, cv::Mat &indexMap,
+                              std::vector<float> &faceSurfaceArea, std::vector<int> &facePixelCount, float &visible) const
 {
     //load shader:
     glUseProgram(shaderProgram);
@@ -545,7 +546,7 @@ cv::Mat DepthmapRenderer::renderDepthmap(float &visible,cv::Mat &color) const
     glm::mat4 gPose; //Keep this conversion code... might be useful
     for(int i=0;i<4;i++){
         for(int j=0;j<4;j++){
-            gPose[i][j]=pose(i,j);
+            gPose[i][j]=_pose(i,j);
         }
     }
 
@@ -603,7 +604,7 @@ cv::Mat DepthmapRenderer::renderDepthmap(float &visible,cv::Mat &color) const
     //download fbo
 
     //GET DEPTH TEXTURE
-    cv::Mat depthmap(res[1],res[0],CV_32FC1);//FC1
+    depthmap.create(res[1],res[0],CV_32FC1);//FC1
     glBindTexture(GL_TEXTURE_2D,depthTex);
     glGetTexImage(GL_TEXTURE_2D,0,GL_RED,GL_FLOAT,depthmap.data);
     //glGetTexImage(GL_TEXTURE_2D,0,GL_RED,GL_FLOAT,depthmap.data);
@@ -611,25 +612,25 @@ cv::Mat DepthmapRenderer::renderDepthmap(float &visible,cv::Mat &color) const
 
 
     //GET INDEX TEXTURE
-    cv::Mat indexMap(res[1],res[0],CV_32SC1);
+    indexMap.create(res[1],res[0],CV_32SC1);
     glBindTexture(GL_TEXTURE_2D,indexTex);
     glGetTexImage(GL_TEXTURE_2D,0,GL_RED_INTEGER,GL_UNSIGNED_INT,indexMap.data);
 
 
     //GET SSBO DATA
-    glm::vec2* faceSurfaceArea=new glm::vec2[faceCount];
+    //two floats per face: surface area and pixel area
+    faceSurfaceArea.resize(2*faceCount);
     glBindBuffer(GL_ARRAY_BUFFER,SSBO);//GL_SHADER_STORAGE_BUFFER
-    glGetBufferSubData(GL_ARRAY_BUFFER,0,sizeof(glm::vec2)*faceCount,faceSurfaceArea);
+    if(faceCount)
+        glGetBufferSubData(GL_ARRAY_BUFFER,0,sizeof(glm::vec2)*faceCount,&faceSurfaceArea[0]);
 
     //GET COLOR TEXTURE
-    cv::Mat colorMat(res[1],res[0],CV_8UC4);
+    color.create(res[1],res[0],CV_8UC4);
     glBindTexture(GL_TEXTURE_2D,colorTex);
-    glGetTexImage(GL_TEXTURE_2D,0,GL_RGBA,GL_UNSIGNED_BYTE,colorMat.data);
-    //imshow("colorMat",colorMat);
-    color=colorMat;
+    glGetTexImage(GL_TEXTURE_2D,0,GL_RGBA,GL_UNSIGNED_BYTE,color.data);
 
     //get pixel count for every triangle
-    int* facePixelCount=new int[faceCount]();//hopefully initzialized with zero
+    facePixelCount.assign(faceCount,0);
     for(int u=0;u<depthmap.rows;u++){
         for(int v=0;v<depthmap.cols;v++){
             if(indexMap.at<int>(u,v)!=0){
@@ -644,10 +645,10 @@ cv::Mat DepthmapRenderer::renderDepthmap(float &visible,cv::Mat &color) const
     for(size_t i=0;i<faceCount;i++){
         //std::cout << "pixel count face " << i << ": " << facePixelCount[i]<< std::endl;
         fullPixelCount+=facePixelCount[i];
-        fullArea+=faceSurfaceArea[i].x;
-        float pixelForFace=faceSurfaceArea[i].y;
+        fullArea+=faceSurfaceArea[2*i];
+        float pixelForFace=faceSurfaceArea[2*i+1];
         if(pixelForFace!=0){
-            visibleArea+=faceSurfaceArea[i].x*float(facePixelCount[i])/pixelForFace;
+            visibleArea+=faceSurfaceArea[2*i]*float(facePixelCount[i])/pixelForFace;
         }
     }
     //calc
@@ -658,33 +659,48 @@ cv::Mat DepthmapRenderer::renderDepthmap(float &visible,cv::Mat &color) const
     if( (err = glGetError()) != GL_NO_ERROR)
         std::cerr << "A terrible OpenGL error occured during rendering (" << err << ")" << std::endl;
 
-    delete[] facePixelCount;
-    delete[] faceSurfaceArea;
+}
+
+cv::Mat DepthmapRenderer::renderDepthmap(float &visible,cv::Mat &color) const
+{
+    cv::Mat depthmap, indexMap;
+    std::vector<float> faceSurfaceArea;
+    std::vector<int> facePixelCount;
+    render(pose,depthmap,color,indexMap,faceSurfaceArea,facePixelCount,visible);
     return depthmap;
 }
 
-pcl::PointCloud<pcl::PointXYZ> DepthmapRenderer::renderPointcloud(float &visibleSurfaceArea) const
+void DepthmapRenderer::renderDepthmaps(const std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f> > &poses,
+                                       std::vector<cv::Mat> &depthmaps, std::vector<cv::Mat> &colors,
+                                       std::vector<float> &visibleSurfaceAreas) const
+{
+    //the GL context is bound to this thread, so the views are rendered back to back
+    cv::Mat indexMap;
+    std::vector<float> faceSurfaceArea;
+    std::vector<int> facePixelCount;
+
+    depthmaps.resize(poses.size());
+    colors.resize(poses.size());
+    visibleSurfaceAreas.resize(poses.size());
+
+    for(size_t i=0;i<poses.size();i++){
+        render(poses[i],depthmaps[i],colors[i],indexMap,faceSurfaceArea,facePixelCount,visibleSurfaceAreas[i]);
+    }
+}
+
+void DepthmapRenderer::depthmapToPointcloud(const cv::Mat &depth, const Eigen::Matrix4f &_pose, pcl::PointCloud<pcl::PointXYZ> &cloud) const
 {
     const float bad_point = std::numeric_limits<float>::quiet_NaN();
-    pcl::PointCloud<pcl::PointXYZ> cloud;
     cloud.width    = res[0];
     cloud.height   = res[1];
     cloud.is_dense = false;
     cloud.points.resize (cloud.width * cloud.height);
 
     //set pose inside pcl structure
-    /*Eigen::Matrix4f ePose;
-    for(int i=0;i<4;i++){
-        for(int j=0;j<4;j++){
-            ePose(i,j)=pose[i][j];
-        }
-    }*/
-    cloud.sensor_orientation_ = Eigen::Quaternionf(Eigen::Matrix3f(pose.block(0,0,3,3)));
-    Eigen::Vector3f trans = Eigen::Matrix3f(pose.block(0,0,3,3))*Eigen::Vector3f(pose(3,0),pose(3,1),pose(3,2));
+    cloud.sensor_orientation_ = Eigen::Quaternionf(Eigen::Matrix3f(_pose.block(0,0,3,3)));
+    Eigen::Vector3f trans = Eigen::Matrix3f(_pose.block(0,0,3,3))*Eigen::Vector3f(_pose(3,0),_pose(3,1),_pose(3,2));
     cloud.sensor_origin_ = Eigen::Vector4f(trans(0), trans(1), trans(2), 1.0f);
 
-    cv::Mat color;
-    cv::Mat depth=renderDepthmap(visibleSurfaceArea,color);
     for(size_t k=0;k<cloud.height;k++){
         for(size_t j=0;j<cloud.width;j++){
             float d=depth.at<float>(k,j);
@@ -701,33 +717,22 @@ pcl::PointCloud<pcl::PointXYZ> DepthmapRenderer::renderPointcloud(float &visible
             }
         }
     }
-
-
-    return cloud;
 }
 
-pcl::PointCloud<pcl::PointXYZRGB> DepthmapRenderer::renderPointcloudColor(float &visibleSurfaceArea) const
+void DepthmapRenderer::depthmapToPointcloud(const cv::Mat &depth, const cv::Mat &color, const Eigen::Matrix4f &_pose,
+                                            pcl::PointCloud<pcl::PointXYZRGB> &cloud) const
 {
     const float bad_point = std::numeric_limits<float>::quiet_NaN();
-    pcl::PointCloud<pcl::PointXYZRGB> cloud;
     cloud.width    = res[0];
     cloud.height   = res[1];
     cloud.is_dense = false;
     cloud.points.resize (cloud.width * cloud.height);
 
     //set pose inside pcl structure
-    /*Eigen::Matrix4f ePose;
-    for(size_t i=0; i<4; i++){
-        for(size_t j=0; j<4; j++){
-            ePose(i,j)=pose[i][j];
-        }
-    }*/
-    cloud.sensor_orientation_ = Eigen::Quaternionf(Eigen::Matrix3f(pose.block(0,0,3,3)));
-    Eigen::Vector3f trans = Eigen::Matrix3f(pose.block(0,0,3,3))*Eigen::Vector3f(pose(3,0),pose(3,1),pose(3,2));
+    cloud.sensor_orientation_ = Eigen::Quaternionf(Eigen::Matrix3f(_pose.block(0,0,3,3)));
+    Eigen::Vector3f trans = Eigen::Matrix3f(_pose.block(0,0,3,3))*Eigen::Vector3f(_pose(3,0),_pose(3,1),_pose(3,2));
     cloud.sensor_origin_ = Eigen::Vector4f(trans(0),trans(1),trans(2),1.0f);
 
-    cv::Mat color;
-    const cv::Mat depth = renderDepthmap(visibleSurfaceArea,color);
     cv::vector<cv::Mat> color_channels(3);
     cv::split(color, color_channels);
     cv::Mat b, g, r;
@@ -756,7 +761,23 @@ pcl::PointCloud<pcl::PointXYZRGB> DepthmapRenderer::renderPointcloudColor(float
 
         }
     }
+}
 
+pcl::PointCloud<pcl::PointXYZ> DepthmapRenderer::renderPointcloud(float &visibleSurfaceArea) const
+{
+    pcl::PointCloud<pcl::PointXYZ> cloud;
+    cv::Mat color;
+    cv::Mat depth=renderDepthmap(visibleSurfaceArea,color);
+    depthmapToPointcloud(depth,pose,cloud);
+    return cloud;
+}
+
+pcl::PointCloud<pcl::PointXYZRGB> DepthmapRenderer::renderPointcloudColor(float &visibleSurfaceArea) const
+{
+    pcl::PointCloud<pcl::PointXYZRGB> cloud;
+    cv::Mat color;
+    const cv::Mat depth = renderDepthmap(visibleSurfaceArea,color);
+    depthmapToPointcloud(depth,color,pose,cloud);
     return cloud;
 }
 
@@ -0,0 +1,439 @@
+#include <v4r/rendering/depthmapRendererCPU.h>
+#include <v4r/rendering/depthmapRenderer.h>
+
+#include <cstring>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace v4r
+{
+
+namespace
+{
+//the GPU renderer clips everything closer than 0.1 (max draw distance is 10 m)
+const float zNear=0.1f;
+
+//packed rgba of the cleared color attachment of the GPU renderer (0,0,0,1)
+inline unsigned int clearColor()
+{
+    unsigned int c;
+    const unsigned char rgba[4]={0,0,0,255};
+    std::memcpy(&c,rgba,sizeof(unsigned int));
+    return c;
+}
+}
+
+/**
+ * @brief The DepthmapRendererCPU::Workspace class
+ * Buffers of one render call. They are kept between the views of renderDepthmaps
+ */
+class DepthmapRendererCPU::Workspace
+{
+public:
+    struct Face{
+        Eigen::Vector2f v[3];   //pixel coordinates (counter clockwise)
+        float iz[3];            //1/z of the vertices (z is negative in front of the camera)
+        int vi[3];              //vertex indices (same order as v)
+        float area2;            //twice the signed pixel area
+        float weight;           //surface area per pixel
+        int x0,y0,x1,y1;        //bounding box (inclusive)
+    };
+
+    std::vector<Eigen::Vector3f> camPoints;
+    std::vector<Eigen::Vector2f> pixPoints;
+    std::vector<Face> faces;
+    std::vector<int> valid;
+    std::vector< std::vector< std::vector<int> > > bins;   //thread -> tile -> faces
+    std::vector<int> indexMap;
+};
+
+DepthmapRendererCPU::DepthmapRendererCPU(int resx, int resy, int _tileSize)
+ : fullArea(0), fxycxy(Eigen::Vector4f::Zero()), res(resx,resy), pose(Eigen::Matrix4f::Identity()), tileSize(_tileSize)
+{
+    if(resx<=0 || resy<=0 || tileSize<=0)
+        throw std::runtime_error("[DepthmapRendererCPU::DepthmapRendererCPU] Invalid resolution or tile size!");
+}
+
+DepthmapRendererCPU::~DepthmapRendererCPU()
+{
+}
+
+std::vector<Eigen::Vector3f> DepthmapRendererCPU::createSphere(float r, size_t subdivisions)
+{
+    return DepthmapRenderer::createSphere(r,subdivisions);
+}
+
+Eigen::Matrix4f DepthmapRendererCPU::getPoseLookingToCenterFrom(Eigen::Vector3f position)
+{
+    return DepthmapRenderer::getPoseLookingToCenterFrom(position);
+}
+
+void DepthmapRendererCPU::setIntrinsics(float fx, float fy, float cx, float cy)
+{
+    fxycxy=Eigen::Vector4f(fx,fy,cx,cy);
+}
+
+void DepthmapRendererCPU::setModel(DepthmapRendererModel *_model)
+{
+    _model->copyGeometry(positions,colors,indices);
+
+    //drop incomplete triangles and invalid indices
+    indices.resize(indices.size()-indices.size()%3);
+    for(size_t i=0;i<indices.size();i++){
+        if(indices[i]>=positions.size())
+            throw std::runtime_error("[DepthmapRendererCPU::setModel] Invalid vertex index!");
+    }
+
+    //the surface area does not depend on the pose
+    const int faceCount=indices.size()/3;
+    faceArea.resize(faceCount);
+    double sum=0;
+
+    #pragma omp parallel for reduction(+:sum)
+    for(int i=0;i<faceCount;i++){
+        const Eigen::Vector3f &p1=positions[indices[3*i]];
+        const Eigen::Vector3f &p2=positions[indices[3*i+1]];
+        const Eigen::Vector3f &p3=positions[indices[3*i+2]];
+        faceArea[i]=(p1-p3).cross(p2-p3).norm();
+        sum+=faceArea[i];
+    }
+    fullArea=sum;
+}
+
+void DepthmapRendererCPU::setCamPose(Eigen::Matrix4f _pose)
+{
+    this->pose=_pose;
+}
+
+/**
+ * @brief DepthmapRendererCPU::render
+ * Tiled z-buffer rasterizer. Depth is interpolated like in the GPU renderer (1/z is linear
+ * in image space), colors are interpolated linearly in image space.
+ * Pixel centers are sampled and shared edges are owned by exactly one triangle.
+ * The visible surface area of a face is its surface area times the fraction of its pixels
+ * which pass the depth test.
+ */
+void DepthmapRendererCPU::render(const Eigen::Matrix4f &_pose, Workspace &ws, cv::Mat &depthmap, cv::Mat &color, float &visible) const
+{
+    const int width=res[0];
+    const int height=res[1];
+    const int tilesX=(width+tileSize-1)/tileSize;
+    const int tilesY=(height+tileSize-1)/tileSize;
+    const int vertexCount=positions.size();
+    const int faceCount=indices.size()/3;
+
+    depthmap.create(height,width,CV_32FC1);
+    color.create(height,width,CV_8UC4);
+    ws.indexMap.resize(width*height);
+
+    //the pose is stored transposed (see DepthmapRenderer::renderDepthmap)
+    const Eigen::Matrix4f T=_pose.transpose();
+    const Eigen::Matrix3f R=T.topLeftCorner<3,3>();
+    const Eigen::Vector3f t=T.block<3,1>(0,3);
+
+    ws.camPoints.resize(vertexCount);
+    ws.pixPoints.resize(vertexCount);
+    ws.faces.resize(faceCount);
+    ws.valid.resize(faceCount);
+
+    //transform and project the vertices
+    #pragma omp parallel for
+    for(int i=0;i<vertexCount;i++){
+        const Eigen::Vector3f pc=R*positions[i]+t;
+        ws.camPoints[i]=pc;
+        ws.pixPoints[i]=Eigen::Vector2f(pc[0]*fxycxy[0]/pc[2]+fxycxy[2],pc[1]*fxycxy[1]/pc[2]+fxycxy[3]);
+    }
+
+    //setup the triangles
+    #pragma omp parallel for
+    for(int i=0;i<faceCount;i++){
+        Workspace::Face &f=ws.faces[i];
+        ws.valid[i]=0;
+
+        int vi[3]={(int)indices[3*i],(int)indices[3*i+1],(int)indices[3*i+2]};
+
+        //triangles crossing the near plane are dropped (the models are far in front of the camera)
+        if(ws.camPoints[vi[0]][2]>-zNear || ws.camPoints[vi[1]][2]>-zNear || ws.camPoints[vi[2]][2]>-zNear)
+            continue;
+
+        const Eigen::Vector2f &a=ws.pixPoints[vi[0]];
+        const Eigen::Vector2f &b=ws.pixPoints[vi[1]];
+        const Eigen::Vector2f &c=ws.pixPoints[vi[2]];
+        float area2=(b[0]-a[0])*(c[1]-a[1])-(b[1]-a[1])*(c[0]-a[0]);
+        if(area2==0)
+            continue;
+
+        //no culling, back faces are flipped to counter clockwise order
+        if(area2<0){
+            std::swap(vi[1],vi[2]);
+            area2=-area2;
+        }
+
+        for(int k=0;k<3;k++){
+            f.v[k]=ws.pixPoints[vi[k]];
+            f.iz[k]=1.0f/ws.camPoints[vi[k]][2];
+            f.vi[k]=vi[k];
+        }
+        f.area2=area2;
+        f.weight=faceArea[i]/(0.5f*area2);
+
+        //bounding box of the pixel centers covered by the triangle
+        const float minx=std::min(f.v[0][0],std::min(f.v[1][0],f.v[2][0]));
+        const float maxx=std::max(f.v[0][0],std::max(f.v[1][0],f.v[2][0]));
+        const float miny=std::min(f.v[0][1],std::min(f.v[1][1],f.v[2][1]));
+        const float maxy=std::max(f.v[0][1],std::max(f.v[1][1],f.v[2][1]));
+        f.x0=std::max(0,(int)std::ceil(minx-0.5f));
+        f.y0=std::max(0,(int)std::ceil(miny-0.5f));
+        f.x1=std::min(width-1,(int)std::floor(maxx-0.5f));
+        f.y1=std::min(height-1,(int)std::floor(maxy-0.5f));
+        if(f.x0>f.x1 || f.y0>f.y1)
+            continue;
+
+        ws.valid[i]=1;
+    }
+
+    //bin the triangles to the tiles. Each thread bins a contiguous range of faces,
+    //so processing the bins in thread order keeps the drawing order of the GPU renderer
+    int nbThreads=1;
+#ifdef _OPENMP
+    nbThreads=omp_in_parallel()?1:omp_get_max_threads();
+#endif
+    ws.bins.resize(nbThreads);
+    for(int i=0;i<nbThreads;i++){
+        ws.bins[i].resize(tilesX*tilesY);
+        for(size_t j=0;j<ws.bins[i].size();j++)
+            ws.bins[i][j].clear();
+    }
+
+    #pragma omp parallel num_threads(nbThreads)
+    {
+        int id=0;
+#ifdef _OPENMP
+        id=omp_get_thread_num();
+#endif
+        std::vector< std::vector<int> > &bins=ws.bins[id];
+
+        #pragma omp for schedule(static)
+        for(int i=0;i<faceCount;i++){
+            if(!ws.valid[i])
+                continue;
+            const Workspace::Face &f=ws.faces[i];
+            for(int ty=f.y0/tileSize;ty<=f.y1/tileSize;ty++){
+                for(int tx=f.x0/tileSize;tx<=f.x1/tileSize;tx++){
+                    bins[ty*tilesX+tx].push_back(i);
+                }
+            }
+        }
+    }
+
+    //rasterize the tiles
+    double visibleArea=0;
+    const unsigned int background=clearColor();
+
+    #pragma omp parallel for schedule(dynamic) reduction(+:visibleArea) num_threads(nbThreads)
+    for(int tile=0;tile<tilesX*tilesY;tile++){
+        const int tx0=(tile%tilesX)*tileSize;
+        const int ty0=(tile/tilesX)*tileSize;
+        const int tx1=std::min(width-1,tx0+tileSize-1);
+        const int ty1=std::min(height-1,ty0+tileSize-1);
+
+        for(int v=ty0;v<=ty1;v++){
+            float *d=depthmap.ptr<float>(v);
+            unsigned int *c=color.ptr<unsigned int>(v);
+            int *idx=&ws.indexMap[v*width];
+            for(int u=tx0;u<=tx1;u++){
+                d[u]=0;
+                c[u]=background;
+                idx[u]=0;
+            }
+        }
+
+        for(int t=0;t<nbThreads;t++){
+            const std::vector<int> &bin=ws.bins[t][tile];
+
+            for(size_t j=0;j<bin.size();j++){
+                const int faceIdx=bin[j];
+                const Workspace::Face &f=ws.faces[faceIdx];
+                const int x0=std::max(f.x0,tx0), x1=std::min(f.x1,tx1);
+                const int y0=std::max(f.y0,ty0), y1=std::min(f.y1,ty1);
+                if(x0>x1 || y0>y1)
+                    continue;
+
+                //edge functions w_k (opposite to vertex k) and their steps in x and y
+                float ex[3],ey[3],w0[3];
+                bool owner[3];
+                for(int k=0;k<3;k++){
+                    const Eigen::Vector2f &a=f.v[(k+1)%3];
+                    const Eigen::Vector2f &b=f.v[(k+2)%3];
+                    ex[k]=-(b[1]-a[1]);
+                    ey[k]=b[0]-a[0];
+                    w0[k]=(b[0]-a[0])*((float)y0+0.5f-a[1])-(b[1]-a[1])*((float)x0+0.5f-a[0]);
+                    //top-left rule: a shared edge is traversed in opposite directions by the
+                    //two triangles, only one of them owns the pixels exactly on the edge
+                    owner[k]=(b[1]-a[1])>0 || ((b[1]-a[1])==0 && (b[0]-a[0])<0);
+                }
+
+                const float invArea=1.0f/f.area2;
+                const unsigned char *rgba[3];
+                for(int k=0;k<3;k++)
+                    rgba[k]=(const unsigned char*)&colors[f.vi[k]];
+
+                for(int v=y0;v<=y1;v++){
+                    float w[3];
+                    for(int k=0;k<3;k++)
+                        w[k]=w0[k]+(float)(v-y0)*ey[k];
+
+                    float *d=depthmap.ptr<float>(v);
+                    unsigned char *c=color.ptr<unsigned char>(v);
+                    int *idx=&ws.indexMap[v*width];
+
+                    for(int u=x0;u<=x1;u++,w[0]+=ex[0],w[1]+=ex[1],w[2]+=ex[2]){
+                        if(w[0]<0 || w[1]<0 || w[2]<0)
+                            continue;
+                        if((w[0]==0 && !owner[0]) || (w[1]==0 && !owner[1]) || (w[2]==0 && !owner[2]))
+                            continue;
+
+                        const float l0=w[0]*invArea, l1=w[1]*invArea, l2=w[2]*invArea;
+                        const float depth=-1.0f/(l0*f.iz[0]+l1*f.iz[1]+l2*f.iz[2]);
+
+                        if(d[u]!=0 && depth>=d[u])
+                            continue;
+
+                        d[u]=depth;
+                        idx[u]=faceIdx+1;
+                        for(int k=0;k<4;k++){
+                            const float val=l0*rgba[0][k]+l1*rgba[1][k]+l2*rgba[2][k];
+                            c[4*u+k]=(unsigned char)std::min(255.f,std::max(0.f,val+0.5f));
+                        }
+                    }
+                }
+            }
+        }
+
+        //sum up the visible surface area (surface area per pixel of the visible faces)
+        for(int v=ty0;v<=ty1;v++){
+            const int *idx=&ws.indexMap[v*width];
+            for(int u=tx0;u<=tx1;u++){
+                if(idx[u]!=0)
+                    visibleArea+=ws.faces[idx[u]-1].weight;
+            }
+        }
+    }
+
+    visible=fullArea>0?visibleArea/fullArea:0;
+}
+
+cv::Mat DepthmapRendererCPU::renderDepthmap(float &visibleSurfaceArea, cv::Mat &color) const
+{
+    Workspace ws;
+    cv::Mat depthmap;
+    render(pose,ws,depthmap,color,visibleSurfaceArea);
+    return depthmap;
+}
+
+void DepthmapRendererCPU::renderDepthmaps(const std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f> > &poses,
+                                          std::vector<cv::Mat> &depthmaps, std::vector<cv::Mat> &colors,
+                                          std::vector<float> &visibleSurfaceAreas) const
+{
+    depthmaps.resize(poses.size());
+    colors.resize(poses.size());
+    visibleSurfaceAreas.resize(poses.size());
+
+    //one view per thread, the views are rendered single threaded
+    #pragma omp parallel
+    {
+        Workspace ws;
+
+        #pragma omp for schedule(dynamic)
+        for(int i=0;i<(int)poses.size();i++){
+            render(poses[i],ws,depthmaps[i],colors[i],visibleSurfaceAreas[i]);
+        }
+    }
+}
+
+void DepthmapRendererCPU::depthmapToPointcloud(const cv::Mat &depth, const Eigen::Matrix4f &_pose, pcl::PointCloud<pcl::PointXYZ> &cloud) const
+{
+    const float bad_point = std::numeric_limits<float>::quiet_NaN();
+    cloud.width    = res[0];
+    cloud.height   = res[1];
+    cloud.is_dense = false;
+    cloud.points.resize (cloud.width * cloud.height);
+
+    cloud.sensor_orientation_ = Eigen::Quaternionf(Eigen::Matrix3f(_pose.block(0,0,3,3)));
+    Eigen::Vector3f trans = Eigen::Matrix3f(_pose.block(0,0,3,3))*Eigen::Vector3f(_pose(3,0),_pose(3,1),_pose(3,2));
+    cloud.sensor_origin_ = Eigen::Vector4f(trans(0), trans(1), trans(2), 1.0f);
+
+    for(size_t k=0;k<cloud.height;k++){
+        for(size_t j=0;j<cloud.width;j++){
+            float d=depth.at<float>(k,j);
+            pcl::PointXYZ &p=cloud.at(j,k);
+            if(d==0){
+                p.x=p.y=p.z=bad_point;
+            }
+            else{
+                p.x=((float)j-fxycxy[2])/fxycxy[0]*d;
+                p.y=((float)k-fxycxy[3])/fxycxy[1]*d;
+                p.z=d;
+            }
+        }
+    }
+}
+
+void DepthmapRendererCPU::depthmapToPointcloud(const cv::Mat &depth, const cv::Mat &color, const Eigen::Matrix4f &_pose,
+                                               pcl::PointCloud<pcl::PointXYZRGB> &cloud) const
+{
+    const float bad_point = std::numeric_limits<float>::quiet_NaN();
+    cloud.width    = res[0];
+    cloud.height   = res[1];
+    cloud.is_dense = false;
+    cloud.points.resize (cloud.width * cloud.height);
+
+    cloud.sensor_orientation_ = Eigen::Quaternionf(Eigen::Matrix3f(_pose.block(0,0,3,3)));
+    Eigen::Vector3f trans = Eigen::Matrix3f(_pose.block(0,0,3,3))*Eigen::Vector3f(_pose(3,0),_pose(3,1),_pose(3,2));
+    cloud.sensor_origin_ = Eigen::Vector4f(trans(0),trans(1),trans(2),1.0f);
+
+    //same channel order as DepthmapRenderer::renderPointcloudColor
+    for(size_t k=0;k<cloud.height;k++){
+        const cv::Vec4b *c=color.ptr<cv::Vec4b>(k);
+        for(size_t j=0;j<cloud.width;j++){
+            float d=depth.at<float>(k,j);
+            pcl::PointXYZRGB &p=cloud.at(j,k);
+            if(d==0){
+                p.x=p.y=p.z=bad_point;
+            }
+            else{
+                p.x=((float)j-fxycxy[2])/fxycxy[0]*d;
+                p.y=((float)k-fxycxy[3])/fxycxy[1]*d;
+                p.z=d;
+                p.b=c[j][0];
+                p.g=c[j][1];
+                p.r=c[j][2];
+            }
+        }
+    }
+}
+
+pcl::PointCloud<pcl::PointXYZ> DepthmapRendererCPU::renderPointcloud(float &visibleSurfaceArea) const
+{
+    pcl::PointCloud<pcl::PointXYZ> cloud;
+    cv::Mat color;
+    cv::Mat depth=renderDepthmap(visibleSurfaceArea,color);
+    depthmapToPointcloud(depth,pose,cloud);
+    return cloud;
+}
+
+pcl::PointCloud<pcl::PointXYZRGB> DepthmapRendererCPU::renderPointcloudColor(float &visibleSurfaceArea) const
+{
+    pcl::PointCloud<pcl::PointXYZRGB> cloud;
+    cv::Mat color;
+    cv::Mat depth=renderDepthmap(visibleSurfaceArea,color);
+    depthmapToPointcloud(depth,color,pose,cloud);
+    return cloud;
+}
+
+}
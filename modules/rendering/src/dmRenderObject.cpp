@@ -1,5 +1,6 @@
 #include <v4r/rendering/dmRenderObject.h>
 #include <iostream>
+#include <cstring>
 
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
@@ -144,6 +145,17 @@ void DepthmapRendererModel::loadToGPU(GLuint &VBO,GLuint &IBO)
 
 }
 
+void DepthmapRendererModel::copyGeometry(std::vector<Eigen::Vector3f> &positions, std::vector<unsigned int> &colors,
+                                         std::vector<unsigned int> &_indices) const
+{
+    positions.resize(vertexCount);
+    colors.resize(vertexCount);
+    for(int i=0;i<vertexCount;i++){
+        positions[i]=Eigen::Vector3f(vertices[i].pos.x,vertices[i].pos.y,vertices[i].pos.z);
+        std::memcpy(&colors[i],&vertices[i].rgba,sizeof(unsigned int));
+    }
+    _indices.assign(indices,indices+indexCount);
+}
 
 unsigned int DepthmapRendererModel::getIndexCount()
 {
@@ -14,6 +14,7 @@
 #include <set>
 #include <opencv2/opencv.hpp>
 #include <Eigen/Dense>
+#include <Eigen/StdVector>
 #include <v4r/common/common_data_structures.h>
 #include <v4r/core/macros.h>
 #include <pcl/point_types.h>
@@ -48,11 +49,14 @@ public:
     unsigned minPointsSmooth;
     int K_; // k in nearest neighor search when doing smooth clustering in unorganized point clouds
     int normal_computation_method_; /// @brief defines the method used for normal computation (only used when point cloud is downsampled / unorganized)
+    bool track_planes; /// @brief seed the clustering of organized clouds with the planes of the last call (see setCameraMotion), also without least_squares_refinement
     
     Parameter(double thrAngleNC=30, double _inlDist=0.01, unsigned _minPoints=9, bool _least_squares_refinement=true, bool _smooth_clustering=false,
-              double _thrAngleSmooth=30, double _inlDistSmooth=0.02, unsigned _minPointsSmooth=3, int K=5, int normal_computation_method = 2)
+              double _thrAngleSmooth=30, double _inlDistSmooth=0.02, unsigned _minPointsSmooth=3, int K=5, int normal_computation_method = 2,
+              bool _track_planes=false)
     : thrAngle(thrAngleNC), inlDist(_inlDist), minPoints(_minPoints), least_squares_refinement(_least_squares_refinement), smooth_clustering(_smooth_clustering),
-      thrAngleSmooth(_thrAngleSmooth), inlDistSmooth(_inlDistSmooth), minPointsSmooth(_minPointsSmooth), K_(K), normal_computation_method_ (normal_computation_method) {}
+      thrAngleSmooth(_thrAngleSmooth), inlDistSmooth(_inlDistSmooth), minPointsSmooth(_minPointsSmooth), K_(K), normal_computation_method_ (normal_computation_method),
+      track_planes(_track_planes) {}
   };
 
   /**
@@ -105,6 +109,9 @@ private:
 
   boost::shared_ptr< flann::Index<DistT> > flann_index; // for unorganized point clouds;
 
+  std::vector<Eigen::Vector4f, Eigen::aligned_allocator<Eigen::Vector4f> > tracked_planes_; // plane coefficients of the last call
+  Eigen::Matrix4f camera_motion_;
+
   
   // cluster normals
   void doClustering(const typename pcl::PointCloud<PointT>::Ptr &cloud, const pcl::PointCloud<pcl::Normal> &normals, std::vector<typename ClusterNormalsToPlanesPCL<PointT>::Plane::Ptr> &planes);
@@ -114,15 +121,19 @@ private:
   void clusterNormalsUnorganized(const typename pcl::PointCloud<PointT>::Ptr &cloud, const pcl::PointCloud<pcl::Normal> &normals, size_t idx, Plane &plane);
   // do a smooth clustering
   void smoothClustering(const typename pcl::PointCloud<PointT>::Ptr &cloud, const pcl::PointCloud<pcl::Normal> &normals, size_t idx, Plane &plane);
+  // grow the planes of the last call first
+  void clusterTrackedPlanes(const typename pcl::PointCloud<PointT>::Ptr &cloud, const pcl::PointCloud<pcl::Normal> &normals, std::vector<typename ClusterNormalsToPlanesPCL<PointT>::Plane::Ptr> &planes);
   // adds normals to each point of segmented patches
 
 public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
   ClusterNormalsToPlanesPCL(const Parameter &_p=Parameter())
       : param(_p)
   {
       cos_rad_thr_angle = cos(param.thrAngle*M_PI/180.);
       cos_rad_thr_angle_smooth = cos(param.thrAngleSmooth*M_PI/180.);
+      camera_motion_.setIdentity();
   }
 
   ~ClusterNormalsToPlanesPCL()
@@ -134,6 +145,12 @@ public:
   /** Compute a plane starting from a seed point **/
   void compute(const typename pcl::PointCloud<PointT>::Ptr &cloud, const pcl::PointCloud<pcl::Normal> &normals, int x, int y, PlaneModel<PointT> &pm);
 
+  /** Camera motion since the last call of compute (transforms points of the previous camera frame into the current one), only used once **/
+  inline void setCameraMotion(const Eigen::Matrix4f &T) { camera_motion_ = T; }
+
+  /** Forget the tracked planes **/
+  inline void resetTracking() { tracked_planes_.clear(); camera_motion_.setIdentity(); }
+
 
   typedef boost::shared_ptr< ::v4r::ClusterNormalsToPlanesPCL<PointT> > Ptr;
   typedef boost::shared_ptr< ::v4r::ClusterNormalsToPlanesPCL<PointT> const> ConstPtr;
@@ -0,0 +1,125 @@
+/**
+ * $Id$
+ *
+ * Copyright (c) 2015, Johann Prankl
+ * @author Johann Prankl (prankl@acin.tuwien.ac.at)
+ */
+
+#ifndef KP_ORGANIZED_EUCLIDEAN_CLUSTERING_HH
+#define KP_ORGANIZED_EUCLIDEAN_CLUSTERING_HH
+
+#include <vector>
+#include <limits>
+#include <pcl/point_types.h>
+#include <pcl/point_cloud.h>
+#include <pcl/PointIndices.h>
+#include <v4r/core/macros.h>
+#include <boost/shared_ptr.hpp>
+
+namespace v4r
+{
+
+/**
+ * OrganizedEuclideanClustering
+ * Euclidean clustering of organized point clouds by connected component labelling of the depth
+ * image (4-neighbourhood) with a union-find structure. The image is split into row strips which
+ * are labelled in parallel, the strips are merged at their borders afterwards.
+ * Two neighbouring points are connected if their distance is below the threshold, which is
+ * scaled with z^2 if depth_dependent is set (same as pcl::EuclideanClusterComparator).
+ */
+template< typename PointT >
+class V4R_EXPORTS OrganizedEuclideanClustering
+{
+public:
+
+  /**
+   * @brief The Parameter class
+   */
+  class Parameter
+  {
+  public:
+    float distance_threshold;   // maximum distance of neighbouring points (at 1m if depth_dependent)
+    bool depth_dependent;       // scale the threshold with z^2
+    int min_cluster_size;
+    int max_cluster_size;
+    int num_strips;             // number of row strips labelled in parallel (0 ... number of threads)
+    Parameter(float _distance_threshold=0.035, bool _depth_dependent=true, int _min_cluster_size=1,
+              int _max_cluster_size=std::numeric_limits<int>::max(), int _num_strips=0)
+    : distance_threshold(_distance_threshold), depth_dependent(_depth_dependent), min_cluster_size(_min_cluster_size),
+      max_cluster_size(_max_cluster_size), num_strips(_num_strips) {}
+  };
+
+private:
+  Parameter param;
+
+  std::vector<int> parent_;     // union-find forest, -1 for points which are not clustered
+  std::vector<int> labels_;     // cluster index of each point, -1 if not clustered
+
+  inline int find(int idx);
+  inline void merge(int idx1, int idx2);
+  inline bool isNeighbour(const PointT &pt1, const PointT &pt2) const;
+
+  void labelStrip(const pcl::PointCloud<PointT> &cloud, int row_start, int row_end);
+  void mergeStrips(const pcl::PointCloud<PointT> &cloud, int row);
+
+public:
+  OrganizedEuclideanClustering(const Parameter &_p=Parameter()) : param(_p) {}
+  ~OrganizedEuclideanClustering() {}
+
+  inline void setParameter(const Parameter &_p) { param = _p; }
+
+  /** Cluster all finite points of an organized cloud **/
+  void segment(const pcl::PointCloud<PointT> &cloud, std::vector<pcl::PointIndices> &clusters);
+
+  /** Cluster the finite points with mask[i]==true **/
+  void segment(const pcl::PointCloud<PointT> &cloud, const std::vector<bool> &mask, std::vector<pcl::PointIndices> &clusters);
+
+  /** Cluster index of each point of the last call (-1 if not clustered or the cluster has been rejected) **/
+  inline const std::vector<int> &getLabels() const { return labels_; }
+
+  typedef boost::shared_ptr< ::v4r::OrganizedEuclideanClustering<PointT> > Ptr;
+  typedef boost::shared_ptr< ::v4r::OrganizedEuclideanClustering<PointT> const> ConstPtr;
+};
+
+
+/*************************** INLINE METHODES **************************/
+
+/**
+ * find the root of a point and compress the path (path halving)
+ */
+template< typename PointT >
+inline int OrganizedEuclideanClustering<PointT>::find(int idx)
+{
+  while (parent_[idx] != idx)
+  {
+    parent_[idx] = parent_[parent_[idx]];
+    idx = parent_[idx];
+  }
+  return idx;
+}
+
+/**
+ * merge two trees, the smaller index becomes the root
+ */
+template< typename PointT >
+inline void OrganizedEuclideanClustering<PointT>::merge(int idx1, int idx2)
+{
+  int r1 = find(idx1);
+  int r2 = find(idx2);
+
+  if (r1 < r2) parent_[r2] = r1;
+  else if (r2 < r1) parent_[r1] = r2;
+}
+
+template< typename PointT >
+inline bool OrganizedEuclideanClustering<PointT>::isNeighbour(const PointT &pt1, const PointT &pt2) const
+{
+  float thr = param.distance_threshold;
+  if (param.depth_dependent) thr *= pt1.z * pt1.z;
+  return ((pt1.getVector3fMap()-pt2.getVector3fMap()).squaredNorm() < thr*thr);
+}
+
+}
+
+#endif
+
@@ -34,207 +34,405 @@
 #include <boost/graph/undirected_graph.hpp>
 #include <boost/graph/connected_components.hpp>
 
+#include <algorithm>
+#include <limits>
+
 template<typename PointT>
 void
-v4r::MultiPlaneSegmentation<PointT>::segment(bool force_unorganized)
+v4r::MultiPlaneSegmentation<PointT>::detectPlanes(const PointTCloudPtr &cloud, const pcl::PointCloud<pcl::Normal>::Ptr &normals,
+                                                  std::vector<pcl::ModelCoefficients> &model_coefficients,
+                                                  std::vector<pcl::PointIndices> &inlier_indices) const
 {
-  models_.clear();
+  pcl::PointCloud<pcl::Normal>::Ptr normal_cloud (new pcl::PointCloud<pcl::Normal>);
+  if(!normals)
+  {
+      pcl::IntegralImageNormalEstimation<PointT, pcl::Normal> ne;
+      ne.setNormalEstimationMethod (ne.COVARIANCE_MATRIX);
+      ne.setMaxDepthChangeFactor (0.02f);
+      ne.setNormalSmoothingSize (20.0f);
+      ne.setBorderPolicy (pcl::IntegralImageNormalEstimation<PointT, pcl::Normal>::BORDER_POLICY_IGNORE);
+      ne.setInputCloud (cloud);
+      ne.compute (*normal_cloud);
+  }
+  else
+  {
+      normal_cloud = normals;
+  }
 
-  if(input_->isOrganized() && !force_unorganized)
+  pcl::OrganizedMultiPlaneSegmentation<PointT, pcl::Normal, pcl::Label> mps;
+  mps.setMinInliers (min_plane_inliers_);
+  mps.setAngularThreshold (0.017453 * 2.f); // 2 degrees
+  mps.setDistanceThreshold (0.01); // 1cm
+  mps.setMaximumCurvature(0.002);
+  mps.setInputNormals (normal_cloud);
+  mps.setInputCloud (cloud);
+
+  std::vector<pcl::PlanarRegion<PointT>, Eigen::aligned_allocator<pcl::PlanarRegion<PointT> > > regions;
+  pcl::PointCloud<pcl::Label>::Ptr labels (new pcl::PointCloud<pcl::Label>);
+  std::vector<pcl::PointIndices> label_indices;
+  std::vector<pcl::PointIndices> boundary_indices;
+
+  typename pcl::PlaneRefinementComparator<PointT, pcl::Normal, pcl::Label>::Ptr ref_comp (
+                                                                                           new pcl::PlaneRefinementComparator<PointT,
+                                                                                               pcl::Normal, pcl::Label> ());
+  ref_comp->setDistanceThreshold (0.01f, false);
+  ref_comp->setAngularThreshold (0.017453 * 2.f);
+  mps.setRefinementComparator (ref_comp);
+  mps.segmentAndRefine (regions, model_coefficients, inlier_indices, labels, label_indices, boundary_indices);
+  //mps.segment (model_coefficients, inlier_indices);
+
+  //std::cout << model_coefficients.size() << std::endl;
+
+  if(merge_planes_)
   {
-    pcl::PointCloud<pcl::Normal>::Ptr normal_cloud (new pcl::PointCloud<pcl::Normal>);
-    if(!normals_set_)
+    //sort planes by size
+    //check if the first plane can be merged against the others, if yes, define a new plane combining both and add it to the cue
+
+    typedef boost::adjacency_matrix<boost::undirectedS, int> GraphPlane;
+    GraphPlane mergeable_planes (model_coefficients.size ());
+    for(size_t i=0; i < model_coefficients.size(); i++)
     {
-        pcl::IntegralImageNormalEstimation<PointT, pcl::Normal> ne;
-        ne.setNormalEstimationMethod (ne.COVARIANCE_MATRIX);
-        ne.setMaxDepthChangeFactor (0.02f);
-        ne.setNormalSmoothingSize (20.0f);
-        ne.setBorderPolicy (pcl::IntegralImageNormalEstimation<PointT, pcl::Normal>::BORDER_POLICY_IGNORE);
-        ne.setInputCloud (input_);
-        ne.compute (*normal_cloud);
+
+      Eigen::Vector3f plane_i = Eigen::Vector3f (model_coefficients[i].values[0], model_coefficients[i].values[1],
+                                                 model_coefficients[i].values[2]);
+
+      plane_i.normalize();
+      for(size_t j=(i+1); j < model_coefficients.size(); j++)
+      {
+        Eigen::Vector3f plane_j = Eigen::Vector3f (model_coefficients[j].values[0], model_coefficients[j].values[1],
+                                                   model_coefficients[j].values[2]);
+
+        plane_j.normalize();
+
+        //std::cout << "dot product:" << plane_i.dot(plane_j) << " diff:" << std::abs(model_coefficients[i].values[3] - model_coefficients[j].values[3]) << std::endl;
+        if(plane_i.dot(plane_j) > 0.95)
+        {
+          if(std::abs(model_coefficients[i].values[3] - model_coefficients[j].values[3]) < 0.015)
+          {
+            boost::add_edge (static_cast<int>(i), static_cast<int>(j), mergeable_planes);
+          }
+        }
+      }
     }
-    else
+
+    boost::vector_property_map<int> components (boost::num_vertices (mergeable_planes));
+    int n_cc = static_cast<int> (boost::connected_components (mergeable_planes, &components[0]));
+
+    std::vector<int> cc_sizes;
+    std::vector< std::vector<int> > cc_to_model_coeff;
+    cc_sizes.resize (n_cc, 0);
+    cc_to_model_coeff.resize(n_cc);
+
+    for (size_t i = 0; i < model_coefficients.size (); i++)
     {
-        normal_cloud = normal_cloud_;
+      cc_sizes[components[i]]++;
+      cc_to_model_coeff[components[i]].push_back(i);
     }
 
-    pcl::OrganizedMultiPlaneSegmentation<PointT, pcl::Normal, pcl::Label> mps;
-    mps.setMinInliers (min_plane_inliers_);
-    mps.setAngularThreshold (0.017453 * 2.f); // 2 degrees
-    mps.setDistanceThreshold (0.01); // 1cm
-    mps.setMaximumCurvature(0.002);
-    mps.setInputNormals (normal_cloud);
-    mps.setInputCloud (input_);
+    std::vector<pcl::ModelCoefficients> new_model_coefficients;
+    std::vector<pcl::PointIndices> new_inlier_indices;
 
-    std::vector<pcl::PlanarRegion<PointT>, Eigen::aligned_allocator<pcl::PlanarRegion<PointT> > > regions;
-    std::vector<pcl::ModelCoefficients> model_coefficients;
-    std::vector<pcl::PointIndices> inlier_indices;
-    pcl::PointCloud<pcl::Label>::Ptr labels (new pcl::PointCloud<pcl::Label>);
-    std::vector<pcl::PointIndices> label_indices;
-    std::vector<pcl::PointIndices> boundary_indices;
-
-    typename pcl::PlaneRefinementComparator<PointT, pcl::Normal, pcl::Label>::Ptr ref_comp (
-                                                                                             new pcl::PlaneRefinementComparator<PointT,
-                                                                                                 pcl::Normal, pcl::Label> ());
-    ref_comp->setDistanceThreshold (0.01f, false);
-    ref_comp->setAngularThreshold (0.017453 * 2.f);
-    mps.setRefinementComparator (ref_comp);
-    mps.segmentAndRefine (regions, model_coefficients, inlier_indices, labels, label_indices, boundary_indices);
-    //mps.segment (model_coefficients, inlier_indices);
-
-    //std::cout << model_coefficients.size() << std::endl;
-
-    if(merge_planes_)
+    for(size_t i=0; i < cc_sizes.size(); i++)
     {
-      //sort planes by size
-      //check if the first plane can be merged against the others, if yes, define a new plane combining both and add it to the cue
-
-      typedef boost::adjacency_matrix<boost::undirectedS, int> GraphPlane;
-      GraphPlane mergeable_planes (model_coefficients.size ());
-      for(size_t i=0; i < model_coefficients.size(); i++)
+      if(cc_sizes[i] < 2)
       {
+        new_model_coefficients.push_back(model_coefficients[cc_to_model_coeff[i][0]]);
+        new_inlier_indices.push_back(inlier_indices[cc_to_model_coeff[i][0]]);
+        continue;
+      }
 
-        Eigen::Vector3f plane_i = Eigen::Vector3f (model_coefficients[i].values[0], model_coefficients[i].values[1],
-                                                   model_coefficients[i].values[2]);
+      //std::cout << "going to merge CC:" << cc_sizes[i] << std::endl;
+      pcl::ModelCoefficients model_coeff;
+      model_coeff.values.resize(4);
 
-        plane_i.normalize();
-        for(size_t j=(i+1); j < model_coefficients.size(); j++)
-        {
-          Eigen::Vector3f plane_j = Eigen::Vector3f (model_coefficients[j].values[0], model_coefficients[j].values[1],
-                                                     model_coefficients[j].values[2]);
+      for(size_t k=0; k < 4; k++)
+        model_coeff.values[k] = 0.f;
 
-          plane_j.normalize();
+      pcl::PointIndices merged_indices;
+      for(size_t j=0; j < cc_to_model_coeff[i].size(); j++)
+      {
+        for(size_t k=0; k < 4; k++)
+          model_coeff.values[k] += model_coefficients[cc_to_model_coeff[i][j]].values[k];
 
-          //std::cout << "dot product:" << plane_i.dot(plane_j) << " diff:" << std::abs(model_coefficients[i].values[3] - model_coefficients[j].values[3]) << std::endl;
-          if(plane_i.dot(plane_j) > 0.95)
-          {
-            if(std::abs(model_coefficients[i].values[3] - model_coefficients[j].values[3]) < 0.015)
-            {
-              boost::add_edge (static_cast<int>(i), static_cast<int>(j), mergeable_planes);
-            }
-          }
-        }
+        merged_indices.indices.insert(merged_indices.indices.end(), inlier_indices[cc_to_model_coeff[i][j]].indices.begin(),
+                                                                    inlier_indices[cc_to_model_coeff[i][j]].indices.end());
       }
 
-      boost::vector_property_map<int> components (boost::num_vertices (mergeable_planes));
-      int n_cc = static_cast<int> (boost::connected_components (mergeable_planes, &components[0]));
+      for(size_t k=0; k < 4; k++)
+        model_coeff.values[k] /= static_cast<float>(cc_to_model_coeff[i].size());
+
+      new_model_coefficients.push_back(model_coeff);
+      new_inlier_indices.push_back(merged_indices);
+    }
+
+    model_coefficients = new_model_coefficients;
+    inlier_indices = new_inlier_indices;
+  }
+}
+
+/**
+ * @brief refits the plane to the candidate points (weighted by their distance to the camera)
+ * and keeps the candidates within 1cm of the refit plane as inliers
+ */
+template<typename PointT>
+void
+v4r::MultiPlaneSegmentation<PointT>::refinePlane(const pcl::PointIndices &candidates, PlaneModel<PointT> &pm) const
+{
+  //recompute coefficients based on distance to camera and normal?
+  Eigen::Vector4f centroid;
+  pcl::compute3DCentroid(*pm.cloud_, candidates, centroid);
+  Eigen::Vector3f c(centroid[0],centroid[1],centroid[2]);
+
+  Eigen::MatrixXf M_w(candidates.indices.size(), 3);
+
+  float sum_w = 0.f;
+  for(size_t k=0; k < candidates.indices.size(); k++)
+  {
+      const int &idx = candidates.indices[k];
+      float d_c = (pm.cloud_->points[idx].getVector3fMap()).norm();
+      float w_k = std::max(1.f - std::abs(1.f - d_c), 0.f);
+      //w_k = 1.f;
+      M_w.row(k) = w_k * (pm.cloud_->points[idx].getVector3fMap() - c);
+      sum_w += w_k;
+  }
+
+  Eigen::Matrix3f scatter;
+  scatter.setZero ();
+  scatter = M_w.transpose() * M_w;
+
+  Eigen::JacobiSVD<Eigen::MatrixXf> svd(scatter, Eigen::ComputeFullV);
+  //std::cout << svd.matrixV() << std::endl;
+
+  Eigen::Vector3f n = svd.matrixV().col(2);
+  //flip normal if required
+  if(n.dot(c*-1) < 0)
+      n = n * -1.f;
+
+  float d = n.dot(c) * -1.f;
+  //std::cout << "normal:" << n << std::endl;
+  //std::cout << "d:" << d << std::endl;
+
+  pm.coefficients_.values.resize(4);
+  pm.coefficients_.values[0] = n[0];
+  pm.coefficients_.values[1] = n[1];
+  pm.coefficients_.values[2] = n[2];
+  pm.coefficients_.values[3] = d;
+
+  pcl::PointIndices clean_inlier_indices;
+  float dist_threshold_ = 0.01f;
+
+  for(size_t k=0; k < candidates.indices.size(); k++)
+  {
+      const int &idx = candidates.indices[k];
+      Eigen::Vector3f p = pm.cloud_->points[idx].getVector3fMap();
+      float val = n.dot(p) + d;
+
+      if(std::abs(val) <= dist_threshold_)
+          clean_inlier_indices.indices.push_back( idx );
+  }
+
+  pm.inliers_ = clean_inlier_indices;
+}
+
+/**
+ * @brief validates the planes of the previous frame on the current one. Each valid point is assigned
+ * to the closest predicted plane within the inlier distance, connected regions with enough support
+ * are refit and the planes which still have enough inliers are added to models_
+ * @param explained points which are inliers of a tracked plane
+ */
+template<typename PointT>
+void
+v4r::MultiPlaneSegmentation<PointT>::trackPlanes(std::vector<bool> &explained)
+{
+  const float dist_threshold = 0.01f;
+  const float cos_threshold = 0.9f;   // only used if normals are given, rejects surfaces which cut the plane
+  const int width = input_->width;
+  const int height = input_->height;
+
+  explained.clear();
+  explained.resize(input_->points.size(), false);
+
+  // predict the planes in the current frame
+  const Eigen::Matrix3f R = camera_motion_.topLeftCorner<3,3>();
+  const Eigen::Vector3f t = camera_motion_.block<3,1>(0,3);
 
-      std::vector<int> cc_sizes;
-      std::vector< std::vector<int> > cc_to_model_coeff;
-      cc_sizes.resize (n_cc, 0);
-      cc_to_model_coeff.resize(n_cc);
+  std::vector<Eigen::Vector4f, Eigen::aligned_allocator<Eigen::Vector4f> > predicted(tracked_planes_.size());
+  for(size_t i=0; i < tracked_planes_.size(); i++)
+  {
+      Eigen::Vector3f n = R * tracked_planes_[i].head<3>();
+      predicted[i].head<3>() = n;
+      predicted[i][3] = tracked_planes_[i][3] - n.dot(t);
+  }
+
+  // assign points to the closest predicted plane
+  std::vector<int> labels(input_->points.size(), -1);
 
-      for (size_t i = 0; i < model_coefficients.size (); i++)
+  #pragma omp parallel for
+  for(int v=0; v < height; v++)
+  {
+      for(int u=0; u < width; u++)
       {
-        cc_sizes[components[i]]++;
-        cc_to_model_coeff[components[i]].push_back(i);
+          const int idx = v * width + u;
+          const PointT &pt = input_->points[idx];
+
+          if( !pcl::isFinite(pt) )
+              continue;
+
+          float min_dist = dist_threshold;
+          for(size_t i=0; i < predicted.size(); i++)
+          {
+              float dist = std::abs( predicted[i].head<3>().dot(pt.getVector3fMap()) + predicted[i][3] );
+              if( dist >= min_dist )
+                  continue;
+
+              if( normals_set_ && pcl_isfinite(normal_cloud_->points[idx].normal_x) &&
+                  std::abs(predicted[i].head<3>().dot(normal_cloud_->points[idx].getNormalVector3fMap())) < cos_threshold )
+                  continue;
+
+              min_dist = dist;
+              labels[idx] = i;
+          }
       }
+  }
 
-      std::vector<pcl::ModelCoefficients> new_model_coefficients;
-      std::vector<pcl::PointIndices> new_inlier_indices;
+  // keep connected regions with enough support
+  std::vector<pcl::PointIndices> candidates(predicted.size());
+  std::vector<bool> visited(input_->points.size(), false);
+  std::vector<int> queue;
+  queue.reserve(input_->points.size());
 
-      for(size_t i=0; i < cc_sizes.size(); i++)
-      {
-        if(cc_sizes[i] < 2)
-        {
-          new_model_coefficients.push_back(model_coefficients[cc_to_model_coeff[i][0]]);
-          new_inlier_indices.push_back(inlier_indices[cc_to_model_coeff[i][0]]);
+  for(size_t idx=0; idx < labels.size(); idx++)
+  {
+      if(labels[idx] < 0 || visited[idx])
           continue;
-        }
 
-        //std::cout << "going to merge CC:" << cc_sizes[i] << std::endl;
-        pcl::ModelCoefficients model_coeff;
-        model_coeff.values.resize(4);
+      const int label = labels[idx];
+      queue.clear();
+      queue.push_back(idx);
+      visited[idx] = true;
 
-        for(size_t k=0; k < 4; k++)
-          model_coeff.values[k] = 0.f;
+      for(size_t q=0; q < queue.size(); q++)
+      {
+          const int u = queue[q] % width;
+          const int v = queue[q] / width;
+          const int n_ind[4] = { u > 0 ? queue[q]-1 : -1, u < width-1 ? queue[q]+1 : -1,
+                                 v > 0 ? queue[q]-width : -1, v < height-1 ? queue[q]+width : -1 };
 
-        pcl::PointIndices merged_indices;
-        for(size_t j=0; j < cc_to_model_coeff[i].size(); j++)
-        {
           for(size_t k=0; k < 4; k++)
-            model_coeff.values[k] += model_coefficients[cc_to_model_coeff[i][j]].values[k];
+          {
+              if( n_ind[k] < 0 || visited[ n_ind[k] ] || labels[ n_ind[k] ] != label )
+                  continue;
 
-          merged_indices.indices.insert(merged_indices.indices.end(), inlier_indices[cc_to_model_coeff[i][j]].indices.begin(),
-                                                                      inlier_indices[cc_to_model_coeff[i][j]].indices.end());
-        }
+              visited[ n_ind[k] ] = true;
+              queue.push_back( n_ind[k] );
+          }
+      }
 
-        for(size_t k=0; k < 4; k++)
-          model_coeff.values[k] /= static_cast<float>(cc_to_model_coeff[i].size());
+      if( (int)queue.size() >= min_plane_inliers_ )
+          candidates[label].indices.insert(candidates[label].indices.end(), queue.begin(), queue.end());
+  }
 
-        new_model_coefficients.push_back(model_coeff);
-        new_inlier_indices.push_back(merged_indices);
-      }
+  // refit
+  for(size_t i=0; i < candidates.size(); i++)
+  {
+      if( (int)candidates[i].indices.size() < min_plane_inliers_ )
+          continue;
 
-      model_coefficients = new_model_coefficients;
-      inlier_indices = new_inlier_indices;
-    }
+      std::sort(candidates[i].indices.begin(), candidates[i].indices.end());
 
-    for(size_t i=0; i < model_coefficients.size(); i++)
-    {
       PlaneModel<PointT> pm;
-      pm.coefficients_ = model_coefficients[i];
       pm.cloud_ = input_;
-      pm.inliers_ = inlier_indices[i];
+      refinePlane(candidates[i], pm);
 
-      //recompute coefficients based on distance to camera and normal?
-      Eigen::Vector4f centroid;
-      pcl::compute3DCentroid(*pm.cloud_, pm.inliers_, centroid);
-      Eigen::Vector3f c(centroid[0],centroid[1],centroid[2]);
+      if( (int)pm.inliers_.indices.size() < min_plane_inliers_ )
+          continue;
 
-      Eigen::MatrixXf M_w(inlier_indices[i].indices.size(), 3);
+      for(size_t k=0; k < pm.inliers_.indices.size(); k++)
+          explained[ pm.inliers_.indices[k] ] = true;
 
-      float sum_w = 0.f;
-      for(size_t k=0; k < inlier_indices[i].indices.size(); k++)
-      {
-          const int &idx = inlier_indices[i].indices[k];
-          float d_c = (pm.cloud_->points[idx].getVector3fMap()).norm();
-          float w_k = std::max(1.f - std::abs(1.f - d_c), 0.f);
-          //w_k = 1.f;
-          M_w.row(k) = w_k * (pm.cloud_->points[idx].getVector3fMap() - c);
-          sum_w += w_k;
-      }
+      models_.push_back(pm);
+  }
+}
 
-      Eigen::Matrix3f scatter;
-      scatter.setZero ();
-      scatter = M_w.transpose() * M_w;
+template<typename PointT>
+void
+v4r::MultiPlaneSegmentation<PointT>::segment(bool force_unorganized)
+{
+  models_.clear();
 
-      Eigen::JacobiSVD<Eigen::MatrixXf> svd(scatter, Eigen::ComputeFullV);
-      //std::cout << svd.matrixV() << std::endl;
+  if(input_->isOrganized() && !force_unorganized)
+  {
+    std::vector<pcl::ModelCoefficients> model_coefficients;
+    std::vector<pcl::PointIndices> inlier_indices;
 
-      Eigen::Vector3f n = svd.matrixV().col(2);
-      //flip normal if required
-      if(n.dot(c*-1) < 0)
-          n = n * -1.f;
+    PointTCloudPtr detection_cloud = input_;
+    pcl::PointCloud<pcl::Normal>::Ptr detection_normals;
+    if(normals_set_)
+        detection_normals = normal_cloud_;
 
-      float d = n.dot(c) * -1.f;
-      //std::cout << "normal:" << n << std::endl;
-      //std::cout << "d:" << d << std::endl;
+    bool detect = true;
 
-      pm.coefficients_.values[0] = n[0];
-      pm.coefficients_.values[1] = n[1];
-      pm.coefficients_.values[2] = n[2];
-      pm.coefficients_.values[3] = d;
+    if(track_planes_ && !tracked_planes_.empty())
+    {
+        std::vector<bool> explained;
+        trackPlanes(explained);
 
-      pcl::PointIndices clean_inlier_indices;
-      float dist_threshold_ = 0.01f;
+        // run the detection only on what the tracked planes do not explain
+        int num_unexplained = 0;
+        for(size_t i=0; i < input_->points.size(); i++)
+        {
+            if(!explained[i] && pcl::isFinite(input_->points[i]))
+                num_unexplained++;
+        }
 
-      for(size_t k=0; k < inlier_indices[i].indices.size(); k++)
-      {
-          const int &idx = inlier_indices[i].indices[k];
-          Eigen::Vector3f p = pm.cloud_->points[idx].getVector3fMap();
-          float val = n.dot(p) + d;
+        if(num_unexplained < min_plane_inliers_)
+            detect = false;
+        else if(num_unexplained < (int)input_->points.size())
+        {
+            const float bad_value = std::numeric_limits<float>::quiet_NaN();
+            detection_cloud.reset(new PointTCloud(*input_));
+            if(normals_set_)
+                detection_normals.reset(new pcl::PointCloud<pcl::Normal>(*normal_cloud_));
 
-          if(std::abs(val) <= dist_threshold_)
-              clean_inlier_indices.indices.push_back( idx );
-      }
+            for(size_t i=0; i < explained.size(); i++)
+            {
+                if(!explained[i])
+                    continue;
+
+                detection_cloud->points[i].x = detection_cloud->points[i].y = detection_cloud->points[i].z = bad_value;
+                if(normals_set_)
+                    detection_normals->points[i].normal_x = detection_normals->points[i].normal_y = detection_normals->points[i].normal_z = bad_value;
+            }
+        }
+    }
 
-      pm.inliers_ = clean_inlier_indices;
+    if(detect)
+        detectPlanes(detection_cloud, detection_normals, model_coefficients, inlier_indices);
+
+    for(size_t i=0; i < model_coefficients.size(); i++)
+    {
+      PlaneModel<PointT> pm;
+      pm.coefficients_ = model_coefficients[i];
+      pm.cloud_ = input_;
+      refinePlane(inlier_indices[i], pm);
       models_.push_back(pm);
     }
+
+    if(track_planes_)
+    {
+        tracked_planes_.resize(models_.size());
+        for(size_t i=0; i < models_.size(); i++)
+        {
+            const std::vector<float> &c = models_[i].coefficients_.values;
+            tracked_planes_[i] = Eigen::Vector4f(c[0], c[1], c[2], c[3]);
+        }
+    }
+    camera_motion_.setIdentity();
   }
   else
   {
+    tracked_planes_.clear();  // tracking is only done on organized clouds
+
     // Create the filtering object: downsample the dataset using a leaf size of 1cm
     pcl::VoxelGrid<PointT> vg;
     PointTCloudPtr cloud_filtered (new PointTCloud);
@@ -1,12 +1,11 @@
 #include <v4r/common/normals.h>
 #include <v4r/segmentation/multiplane_segmentation.h>
+#include <v4r/segmentation/OrganizedEuclideanClustering.h>
 #include <v4r/segmentation/pcl_segmentation_methods.h>
 
 #include <pcl/apps/dominant_plane_segmentation.h>
 #include <pcl/filters/passthrough.h>
-#include <pcl/segmentation/euclidean_cluster_comparator.h>
 #include <pcl/segmentation/euclidean_plane_coefficient_comparator.h>
-#include <pcl/segmentation/organized_connected_component_segmentation.h>
 #include <pcl/segmentation/organized_multi_plane_segmentation.h>
 
 
@@ -148,11 +147,8 @@ PCLSegmenter<PointT>::do_segmentation(std::vector<pcl::PointIndices> & indices)
         extracted_table_plane_ = Eigen::Vector4f (model_coeff[table_plane_selected].values[0], model_coeff[table_plane_selected].values[1],
                 model_coeff[table_plane_selected].values[2], model_coeff[table_plane_selected].values[3]);
 
-        typename pcl::EuclideanClusterComparator<PointT, pcl::Normal, pcl::Label>::Ptr
-                euclidean_cluster_comparator_ (new pcl::EuclideanClusterComparator< PointT, pcl::Normal,pcl::Label> ());
-
-        //create two labels, 1 one for points belonging to or under the plane, 1 for points above the plane
-        label_indices.resize (2);
+        //cluster the points above the plane
+        std::vector<bool> above_plane (input_cloud_->points.size (), false);
 
         for (size_t j = 0; j < input_cloud_->points.size (); j++)
         {
@@ -164,42 +160,15 @@ PCLSegmenter<PointT>::do_segmentation(std::vector<pcl::PointIndices> & indices)
             float val = xyz_p[0] * extracted_table_plane_[0] + xyz_p[1] * extracted_table_plane_[1] + xyz_p[2] * extracted_table_plane_[2] + extracted_table_plane_[3];
 
             if (val >= param_.sensor_noise_max_)
-            {
-                /*plane_points->points[j].x = std::numeric_limits<float>::quiet_NaN ();
-         plane_points->points[j].y = std::numeric_limits<float>::quiet_NaN ();
-         plane_points->points[j].z = std::numeric_limits<float>::quiet_NaN ();*/
-                labels->points[j].label = 1;
-                label_indices[0].indices.push_back (j);
-            }
-            else
-            {
-                labels->points[j].label = 0;
-                label_indices[1].indices.push_back (j);
-            }
+                above_plane[j] = true;
         }
 
-        std::vector<bool> plane_labels;
-        plane_labels.resize (label_indices.size (), false);
-        plane_labels[0] = true;
-
-        euclidean_cluster_comparator_->setInputCloud (input_cloud_);
-        euclidean_cluster_comparator_->setLabels (labels);
-        euclidean_cluster_comparator_->setExcludeLabels (plane_labels);
-        euclidean_cluster_comparator_->setDistanceThreshold (0.035f, true);
-
-        pcl::PointCloud < pcl::Label > euclidean_labels;
+        typename OrganizedEuclideanClustering<PointT>::Parameter oec_param (0.035f, true, param_.min_cluster_size_);
+        OrganizedEuclideanClustering<PointT> oec (oec_param);
         std::vector < pcl::PointIndices > euclidean_label_indices;
-        pcl::OrganizedConnectedComponentSegmentation<PointT, pcl::Label> euclidean_segmentation (euclidean_cluster_comparator_);
-        euclidean_segmentation.setInputCloud (input_cloud_);
-        euclidean_segmentation.segment (euclidean_labels, euclidean_label_indices);
+        oec.segment (*input_cloud_, above_plane, euclidean_label_indices);
 
-        for (size_t i = 0; i < euclidean_label_indices.size (); i++)
-        {
-            if ( (int)euclidean_label_indices[i].indices.size () >= param_.min_cluster_size_)
-            {
-                indices.push_back (euclidean_label_indices[i]);
-            }
-        }
+        indices.insert (indices.end (), euclidean_label_indices.begin (), euclidean_label_indices.end ());
     }
     else if(param_.seg_type_ == 1)
     {
@@ -311,21 +280,8 @@ PCLSegmenter<PointT>::do_segmentation(std::vector<pcl::PointIndices> & indices)
 
         if(input_cloud_->isOrganized())
         {
-            std::vector < pcl::PointIndices > label_indices;
-            pcl::PointCloud<pcl::Label>::Ptr labels (new pcl::PointCloud<pcl::Label>);
-            labels->points.resize(input_cloud_->points.size());
-            labels->width = input_cloud_->width;
-            labels->height = input_cloud_->height;
-
-            for (size_t j = 0; j < input_cloud_->points.size (); j++)
-                labels->points[j].label = 0;
-
-            //cluster..
-            typename pcl::EuclideanClusterComparator<PointT, pcl::Normal, pcl::Label>::Ptr
-                    euclidean_cluster_comparator_ (new pcl::EuclideanClusterComparator<PointT, pcl::Normal,pcl::Label> ());
-
-            //create two labels, 1 one for points belonging to or under the plane, 1 for points above the plane
-            label_indices.resize (2);
+            //cluster the points above the plane
+            std::vector<bool> above_plane (input_cloud_->points.size (), false);
 
             for (size_t j = 0; j < input_cloud_->points.size (); j++)
             {
@@ -337,40 +293,15 @@ PCLSegmenter<PointT>::do_segmentation(std::vector<pcl::PointIndices> & indices)
                 float val = xyz_p[0] * extracted_table_plane_[0] + xyz_p[1] * extracted_table_plane_[1] + xyz_p[2] * extracted_table_plane_[2] + extracted_table_plane_[3];
 
                 if (val >= param_.sensor_noise_max_)
-                {
-                    labels->points[j].label = 1;
-                    label_indices[0].indices.push_back (j);
-                }
-                else
-                {
-                    labels->points[j].label = 0;
-                    label_indices[1].indices.push_back (j);
-                }
+                    above_plane[j] = true;
             }
 
-            std::vector<bool> plane_labels;
-            plane_labels.resize (label_indices.size (), false);
-            plane_labels[0] = true;
-
-            euclidean_cluster_comparator_->setInputCloud (input_cloud_);
-            euclidean_cluster_comparator_->setLabels (labels);
-            euclidean_cluster_comparator_->setExcludeLabels (plane_labels);
-            euclidean_cluster_comparator_->setDistanceThreshold (0.035f, true);
-
-            pcl::PointCloud < pcl::Label > euclidean_labels;
+            typename OrganizedEuclideanClustering<PointT>::Parameter oec_param (0.035f, true, param_.min_cluster_size_);
+            OrganizedEuclideanClustering<PointT> oec (oec_param);
             std::vector < pcl::PointIndices > euclidean_label_indices;
-            pcl::OrganizedConnectedComponentSegmentation<PointT, pcl::Label> euclidean_segmentation (euclidean_cluster_comparator_);
-            euclidean_segmentation.setInputCloud (input_cloud_);
-            euclidean_segmentation.segment (euclidean_labels, euclidean_label_indices);
-
-            for (size_t i = 0; i < euclidean_label_indices.size (); i++)
-            {
-                if (euclidean_label_indices[i].indices.size () >= param_.min_cluster_size_)
-                {
-                    indices.push_back (euclidean_label_indices[i]);
-                }
-            }
+            oec.segment (*input_cloud_, above_plane, euclidean_label_indices);
 
+            indices.insert (indices.end (), euclidean_label_indices.begin (), euclidean_label_indices.end ());
         }
         else
         {
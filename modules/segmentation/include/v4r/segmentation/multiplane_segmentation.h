@@ -10,6 +10,7 @@
 
 #include <v4r/common/common_data_structures.h>
 #include <v4r/core/macros.h>
+#include <Eigen/StdVector>
 
 namespace v4r
 {
@@ -28,13 +29,27 @@ namespace v4r
       pcl::PointCloud<pcl::Normal>::Ptr normal_cloud_;
       bool normals_set_;
 
+      // frame-to-frame tracking (organized clouds only)
+      bool track_planes_;
+      std::vector<Eigen::Vector4f, Eigen::aligned_allocator<Eigen::Vector4f> > tracked_planes_; // planes of the last call
+      Eigen::Matrix4f camera_motion_;
+
+      void detectPlanes(const PointTCloudPtr &cloud, const pcl::PointCloud<pcl::Normal>::Ptr &normals,
+                        std::vector<pcl::ModelCoefficients> &model_coefficients, std::vector<pcl::PointIndices> &inlier_indices) const;
+      void refinePlane(const pcl::PointIndices &candidates, PlaneModel<PointT> &pm) const;
+      void trackPlanes(std::vector<bool> &explained);
+
     public:
+      EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
       MultiPlaneSegmentation()
       {
         min_plane_inliers_ = 1000;
         resolution_ = 0.001f;
         merge_planes_ = false;
         normals_set_ = false;
+        track_planes_ = false;
+        camera_motion_.setIdentity();
       }
 
       void
@@ -70,6 +85,36 @@ namespace v4r
       {
         return models_;
       }
+
+      /**
+       * @brief enables frame-to-frame plane tracking for organized clouds. The planes of the previous
+       * call of segment() are moved by the camera motion, validated and refit on the new frame, and
+       * the full multi-plane detection only runs on the points they do not explain (or not at all
+       * if too few are left). Tracked planes come first in getModels().
+       */
+      void setTrackPlanes(bool b)
+      {
+        track_planes_ = b;
+        if(!b)
+            resetTracking();
+      }
+
+      /**
+       * @brief sets the camera motion since the last call of segment() (i.e. the transformation of
+       * points in the previous camera frame into the current one). It is only used for the next call
+       * and assumed to be identity if not set.
+       */
+      void setCameraMotion(const Eigen::Matrix4f &T)
+      {
+        camera_motion_ = T;
+      }
+
+      /** @brief forgets the tracked planes, the next call of segment() runs the full detection */
+      void resetTracking()
+      {
+        tracked_planes_.clear();
+        camera_motion_.setIdentity();
+      }
   };
 }
 
@@ -8,6 +8,7 @@
 #include <v4r/common/normals.h>
 #include <v4r/segmentation/ClusterNormalsToPlanesPCL.h>
 #include <pcl/features/normal_3d.h>
+#include <limits>
 
 namespace v4r
 {
@@ -246,6 +247,47 @@ ClusterNormalsToPlanesPCL<PointT>::smoothClustering(const typename pcl::PointClo
   }
 }
 
+/**
+ * @brief ClusterNormalsToPlanesPCL<PointT>::clusterTrackedPlanes
+ * Moves the planes of the last call by the camera motion and grows a plane from every
+ * unclustered point which fits a predicted plane, i.e. the tracked planes are clustered
+ * (and returned) first and the remaining points are clustered as usual
+ * @param cloud organized point cloud
+ * @param normals
+ * @param planes
+ */
+template<typename PointT>
+void
+ClusterNormalsToPlanesPCL<PointT>::clusterTrackedPlanes(const typename pcl::PointCloud<PointT>::Ptr &cloud, const pcl::PointCloud<pcl::Normal> &normals, std::vector<typename ClusterNormalsToPlanesPCL<PointT>::Plane::Ptr> &planes)
+{
+  const Eigen::Matrix3f R = camera_motion_.topLeftCorner<3,3>();
+  const Eigen::Vector3f t = camera_motion_.block<3,1>(0,3);
+
+  for (size_t i=0; i<tracked_planes_.size(); i++)
+  {
+    const Eigen::Vector3f n_pred = R * tracked_planes_[i].head<3>();
+    const float d_pred = tracked_planes_[i][3] - n_pred.dot(t);
+
+    for (size_t j=0; j<mask_.size(); j++)
+    {
+      if (!mask_[j])
+        continue;
+
+      const Eigen::Vector3f &n = normals.points[j].getNormalVector3fMap();
+      const Eigen::Vector3f &pt = cloud->points[j].getVector3fMap();
+
+      if ( (fabs(n_pred.dot(n)) <= cos_rad_thr_angle) || (fabs(n_pred.dot(pt) + d_pred) >= param.inlDist) )
+        continue;
+
+      typename Plane::Ptr plane(new Plane(true));
+      clusterNormals(cloud, normals, j, *plane);
+
+      if (plane->size() >= param.minPoints)
+        planes.push_back(plane);
+    }
+  }
+}
+
 /**
  * ClusterNormals
  */
@@ -266,6 +308,9 @@ ClusterNormalsToPlanesPCL<PointT>::doClustering(const typename pcl::PointCloud<P
         mask_[i] = false;
   }
 
+  if (param.track_planes && cloud->isOrganized())
+    clusterTrackedPlanes(cloud, normals, planes);
+
   // plane clustering
   for (size_t i=0; i<mask_.size(); i++)
   {
@@ -371,6 +416,40 @@ ClusterNormalsToPlanesPCL<PointT>::compute(const typename pcl::PointCloud<PointT
           _planes.push_back( pm );
       }
   }
+
+  // remember the planes for the next call
+  tracked_planes_.clear();
+  camera_motion_.setIdentity();
+
+  if (param.track_planes && _cloud->isOrganized())
+  {
+    if (param.least_squares_refinement)
+    {
+      for (size_t i=0; i<_planes.size(); i++)
+      {
+        const std::vector<float> &c = _planes[i].coefficients_.values;
+        Eigen::Vector4f coeffs(c[0], c[1], c[2], c[3]);
+        float norm = coeffs.head<3>().norm();
+        if (norm > std::numeric_limits<float>::epsilon())
+          tracked_planes_.push_back(coeffs/norm);
+      }
+    }
+    else
+    {
+      // without refinement the running average of the clustering (Plane::add) is tracked
+      for (size_t i=0; i<planes.size(); i++)
+      {
+        if( !planes[i]->is_plane )
+          continue;
+        float norm = planes[i]->normal.norm();
+        if (norm > std::numeric_limits<float>::epsilon())
+        {
+          const Eigen::Vector3f n = planes[i]->normal/norm;
+          tracked_planes_.push_back(Eigen::Vector4f(n[0], n[1], n[2], -n.dot(planes[i]->pt)));
+        }
+      }
+    }
+  }
 }
 
 /**
@@ -0,0 +1,184 @@
+/**
+ * $Id$
+ *
+ * Copyright (c) 2015, Johann Prankl
+ * @author Johann Prankl (prankl@acin.tuwien.ac.at)
+ */
+
+#include <v4r/segmentation/OrganizedEuclideanClustering.h>
+#include <stdexcept>
+#include <algorithm>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace v4r
+{
+
+using namespace std;
+
+/**
+ * @brief OrganizedEuclideanClustering<PointT>::labelStrip
+ * Raster scan of the rows [row_start, row_end), connects each point with its left and upper
+ * neighbour. Only points of the strip are touched, i.e. strips can be labelled in parallel.
+ */
+template<typename PointT>
+void
+OrganizedEuclideanClustering<PointT>::labelStrip(const pcl::PointCloud<PointT> &cloud, int row_start, int row_end)
+{
+  const int width = cloud.width;
+
+  for (int v=row_start; v<row_end; v++)
+  {
+    for (int u=0; u<width; u++)
+    {
+      const int idx = v*width+u;
+
+      if (parent_[idx] < 0)
+        continue;
+
+      const PointT &pt = cloud.points[idx];
+
+      if (u>0 && parent_[idx-1]>=0 && isNeighbour(pt, cloud.points[idx-1]))
+        merge(idx, idx-1);
+
+      if (v>row_start && parent_[idx-width]>=0 && isNeighbour(pt, cloud.points[idx-width]))
+        merge(idx, idx-width);
+    }
+  }
+}
+
+/**
+ * @brief OrganizedEuclideanClustering<PointT>::mergeStrips
+ * Connects the first row of a strip with the last row of the previous one
+ */
+template<typename PointT>
+void
+OrganizedEuclideanClustering<PointT>::mergeStrips(const pcl::PointCloud<PointT> &cloud, int row)
+{
+  const int width = cloud.width;
+
+  for (int u=0; u<width; u++)
+  {
+    const int idx = row*width+u;
+
+    if (parent_[idx]>=0 && parent_[idx-width]>=0 && isNeighbour(cloud.points[idx], cloud.points[idx-width]))
+      merge(idx, idx-width);
+  }
+}
+
+
+
+/************************** PUBLIC *************************/
+
+/**
+ * @brief OrganizedEuclideanClustering<PointT>::segment
+ * @param cloud organized point cloud
+ * @param clusters point indices of the clusters (ordered by their first point in the image)
+ */
+template<typename PointT>
+void
+OrganizedEuclideanClustering<PointT>::segment(const pcl::PointCloud<PointT> &cloud, std::vector<pcl::PointIndices> &clusters)
+{
+  segment(cloud, std::vector<bool>(cloud.points.size(), true), clusters);
+}
+
+/**
+ * @brief OrganizedEuclideanClustering<PointT>::segment
+ * @param cloud organized point cloud
+ * @param mask points to cluster (same size as the cloud)
+ * @param clusters point indices of the clusters (ordered by their first point in the image)
+ */
+template<typename PointT>
+void
+OrganizedEuclideanClustering<PointT>::segment(const pcl::PointCloud<PointT> &cloud, const std::vector<bool> &mask, std::vector<pcl::PointIndices> &clusters)
+{
+  if (!cloud.isOrganized())
+    throw std::runtime_error("[OrganizedEuclideanClustering::segment] The point cloud needs to be organized!");
+  if (mask.size()!=cloud.points.size())
+    throw std::runtime_error("[OrganizedEuclideanClustering::segment] Wrong mask size!");
+
+  const int width = cloud.width;
+  const int height = cloud.height;
+  const int size = width*height;
+
+  clusters.clear();
+  parent_.resize(size);
+  labels_.assign(size, -1);
+
+  // init the forest
+  #pragma omp parallel for
+  for (int i=0; i<size; i++)
+  {
+    const PointT &pt = cloud.points[i];
+    parent_[i] = ( mask[i] && pcl_isfinite(pt.x) && pcl_isfinite(pt.y) && pcl_isfinite(pt.z) ? i : -1 );
+  }
+
+  // label strips in parallel
+  int num_strips = param.num_strips;
+#ifdef _OPENMP
+  if (num_strips<=0) num_strips = omp_get_max_threads();
+#endif
+  num_strips = std::max(1, std::min(num_strips, height));
+
+  std::vector<int> strip_rows(num_strips+1);
+  for (int i=0; i<=num_strips; i++)
+    strip_rows[i] = (int)((long)i*height/num_strips);
+
+  #pragma omp parallel for
+  for (int i=0; i<num_strips; i++)
+    labelStrip(cloud, strip_rows[i], strip_rows[i+1]);
+
+  // merge the strips
+  for (int i=1; i<num_strips; i++)
+    mergeStrips(cloud, strip_rows[i]);
+
+  // flatten the trees, roots are the first point of a cluster in raster order
+  std::vector<int> cnt;
+  for (int i=0; i<size; i++)
+  {
+    if (parent_[i]<0)
+      continue;
+
+    const int root = find(i);
+    if (root==i)
+    {
+      labels_[i] = cnt.size();
+      cnt.push_back(0);
+    }
+    else labels_[i] = labels_[root];
+
+    cnt[labels_[i]]++;
+  }
+
+  // collect the clusters
+  std::vector<int> lut(cnt.size(), -1);
+  for (unsigned i=0; i<cnt.size(); i++)
+  {
+    if (cnt[i]>=param.min_cluster_size && cnt[i]<=param.max_cluster_size)
+    {
+      lut[i] = clusters.size();
+      clusters.push_back(pcl::PointIndices());
+      clusters.back().header = cloud.header;
+      clusters.back().indices.reserve(cnt[i]);
+    }
+  }
+
+  for (int i=0; i<size; i++)
+  {
+    if (labels_[i]<0)
+      continue;
+
+    labels_[i] = lut[labels_[i]];
+    if (labels_[i]>=0)
+      clusters[labels_[i]].indices.push_back(i);
+  }
+}
+
+
+template class V4R_EXPORTS OrganizedEuclideanClustering<pcl::PointXYZRGB>;
+template class V4R_EXPORTS OrganizedEuclideanClustering<pcl::PointXYZ>;
+
+} //-- THE END --
+
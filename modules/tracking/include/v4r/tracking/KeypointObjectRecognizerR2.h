@@ -118,8 +118,11 @@ public:
   ~KeypointObjectRecognizerR2();
 
   double detect(const cv::Mat &image, Eigen::Matrix4f &pose, int &view_idx);
+  double detect(const std::vector<cv::KeyPoint> &_keys, const std::vector< std::vector< cv::DMatch > > &_matches,
+                const std::vector< std::pair<int, int> > &view_rank, Eigen::Matrix4f &pose, int &view_idx);
 
-  void setModel(const Object::Ptr &_model);
+  /** set the model, if init_codebook is false the codebook matcher is not initialized (use detect with external matches) */
+  void setModel(const Object::Ptr &_model, bool init_codebook=true);
 
   void setCameraParameter(const cv::Mat &_intrinsic, const cv::Mat &_dist_coeffs);
 
@@ -0,0 +1,145 @@
+/**
+ * $Id$
+ *
+ * Software License Agreement (GNU General Public License)
+ *
+ *  Copyright (C) 2015:
+ *
+ *    Johann Prankl, prankl@acin.tuwien.ac.at
+ *    Aitor Aldoma, aldoma@acin.tuwien.ac.at
+ *
+ *      Automation and Control Institute
+ *      Vienna University of Technology
+ *      Gusshausstraße 25-29
+ *      1170 Vienn, Austria
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author Johann Prankl, Aitor Aldoma
+ *
+ */
+
+#ifndef KP_MULTI_OBJECT_TRACKER_MONO_HH
+#define KP_MULTI_OBJECT_TRACKER_MONO_HH
+
+#include <iostream>
+#include <vector>
+#include <Eigen/Dense>
+#include <Eigen/StdVector>
+#include <opencv2/core/core.hpp>
+#include <v4r/keypoints/impl/Object.hpp>
+#include <v4r/keypoints/CodebookMatcher.h>
+#include <v4r/common/impl/SmartPtr.hpp>
+#include <v4r/features/FeatureDetector_KD_FAST_IMGD.h>
+#include <v4r/tracking/ObjectTrackerMono.h>
+#include <v4r/tracking/KeypointObjectRecognizerR2.h>
+#include <v4r/core/macros.h>
+
+
+namespace v4r
+{
+
+/**
+ * MultiObjectTrackerMono
+ * Tracks several objects in the same image stream. The per frame work which does not depend
+ * on the object (gray conversion, keypoint detection and descriptor extraction for the
+ * re-detection) is computed once, re-detection uses one combined codebook of all object models
+ * and the frame-to-frame trackers of the objects run in parallel.
+ */
+class V4R_EXPORTS MultiObjectTrackerMono
+{
+public:
+
+  /**
+   * Parameter
+   */
+  class Parameter
+  {
+  public:
+    ObjectTrackerMono::Parameter ot_param;                // parameter of the single object trackers
+    FeatureDetector_KD_FAST_IMGD::Parameter det_param;    // shared keypoint detector for re-detection
+    KeypointObjectRecognizerR2::Parameter or_param;
+    Parameter(const ObjectTrackerMono::Parameter &_ot_param = ObjectTrackerMono::Parameter(),
+      const FeatureDetector_KD_FAST_IMGD::Parameter &_det_param = FeatureDetector_KD_FAST_IMGD::Parameter(1000, 1.44, 2, 17, 2),
+      const KeypointObjectRecognizerR2::Parameter &_or_param=KeypointObjectRecognizerR2::Parameter())
+    : ot_param(_ot_param), det_param(_det_param), or_param(_or_param) { }
+  };
+
+
+private:
+  Parameter param;
+
+  cv::Mat_<double> dist_coeffs;
+  cv::Mat_<double> intrinsic;
+
+  cv::Mat_<unsigned char> im_gray;
+
+  bool have_codebook;      // combined codebook has entries, i.e. re-detection is possible
+  bool codebook_created;   // createCodebook has been called for the current models
+
+  std::vector<Object::Ptr> models;
+  std::vector<TrackingModelFile::Ptr> model_files;       // empty pointer if the model is not mapped
+  std::vector<ObjectTrackerMono::Ptr> trackers;
+  std::vector<KeypointObjectRecognizerR2::Ptr> recognizers;
+  std::vector< std::pair<int,int> > view_to_object;      // global view index of the codebook -> <object, view>
+
+  std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f> > poses;
+  std::vector<double> confs;
+  std::vector<int> tracked;                              // int instead of bool, it is written in parallel
+
+  // shared per frame data
+  std::vector<cv::KeyPoint> keys;
+  cv::Mat descs;
+  std::vector< std::vector< cv::DMatch > > matches;
+  std::vector< std::vector< std::vector< cv::DMatch > > > obj_matches;
+  std::vector< std::vector< std::pair<int,int> > > obj_view_ranks;
+
+  CodebookMatcher::Ptr cbMatcher;
+  v4r::FeatureDetector::Ptr detector;
+
+  void createCodebook();
+  int addTracker(const Object::Ptr &_model, const ObjectTrackerMono::Ptr &tracker);
+  void redetect(const std::vector<int> &obj_indices);
+
+
+public:
+  MultiObjectTrackerMono(const MultiObjectTrackerMono::Parameter &p=MultiObjectTrackerMono::Parameter());
+  ~MultiObjectTrackerMono();
+
+  void setCameraParameter(const cv::Mat &_intrinsic, const cv::Mat &_dist_coeffs);
+  int addObjectModel(const Object::Ptr &_model);
+  int addObjectModelFile(const TrackingModelFile::Ptr &_model_file);
+  void clear();
+  void reset();
+
+  int track(const cv::Mat &image);
+
+  inline unsigned size() const { return models.size(); }
+  inline const Eigen::Matrix4f &getPose(unsigned idx) const { return poses[idx]; }
+  inline double getConfidence(unsigned idx) const { return confs[idx]; }
+  inline bool isTracked(unsigned idx) const { return tracked[idx]!=0; }
+  inline const Object::Ptr &getModelPtr(unsigned idx) { return models[idx]; }
+
+  typedef SmartPtr< ::v4r::MultiObjectTrackerMono> Ptr;
+  typedef SmartPtr< ::v4r::MultiObjectTrackerMono const> ConstPtr;
+};
+
+
+
+/*************************** INLINE METHODES **************************/
+
+} //--END--
+
+#endif
+
@@ -39,6 +39,7 @@
 #include <Eigen/Dense>
 #include <opencv2/core/core.hpp>
 #include <v4r/keypoints/impl/Object.hpp>
+#include <v4r/keypoints/TrackingModelFile.h>
 #include <v4r/reconstruction/ProjLKPoseTrackerR2.h>
 #include <v4r/reconstruction/LKPoseTracker.h>
 #include <v4r/reconstruction/KeypointPoseDetector.h>
@@ -99,11 +100,17 @@ private:
 
   ObjectView::Ptr view;
   Object::Ptr model;
+  TrackingModelFile::Ptr model_file;    // lazy loading of the views (optional)
 
   double conf;
   int conf_cnt;
   int not_conf_cnt;
 
+  bool have_ext_reinit;
+  int ext_view_idx;
+  double ext_conf;
+  Eigen::Matrix4f ext_pose;
+
   KeypointPoseDetector::Ptr kpDetector;
   ProjLKPoseTrackerR2::Ptr projTracker;
   LKPoseTracker::Ptr lkTracker;
@@ -115,6 +122,8 @@ private:
                          const Eigen::Matrix4f &inv_pose2);
   double reinit(const cv::Mat_<unsigned char> &im, Eigen::Matrix4f &pose, ObjectView::Ptr &view);
   void updateView(const Eigen::Matrix4f &pose, const Object &model, ObjectView::Ptr &view);
+  void setView(int view_idx);
+  void initModel();
 
 
 public:
@@ -127,13 +136,22 @@ public:
   void setCameraParameter(const cv::Mat &_intrinsic, const cv::Mat &_dist_coeffs);
   void setObjectCameraParameter(const cv::Mat &_intrinsic, const cv::Mat &_dist_coeffs);
   void setObjectModel(const Object::Ptr &_model);
+  /** set a mapped tracking model, the view data is loaded on demand */
+  void setObjectModelFile(const TrackingModelFile::Ptr &_model_file);
   void reset();
 
   bool track(const cv::Mat &image, Eigen::Matrix4f &pose, double &out_conf);
 
+  /** true if the next call of track will try to re-initialize the pose */
+  inline bool needReinit() const { return not_conf_cnt>=param.min_not_conf_cnt; }
+  /** set an externally computed re-initialization (e.g. MultiObjectTrackerMono), which is used instead of reinit in the next call of track */
+  void setReinitPose(const Eigen::Matrix4f &_pose, int _view_idx, double _conf);
+
   const Object::Ptr &getModelPtr() { return model; }
   inline const Object &getModel() { return *model; }
 
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
   typedef SmartPtr< ::v4r::ObjectTrackerMono> Ptr;
   typedef SmartPtr< ::v4r::ObjectTrackerMono const> ConstPtr;
 };
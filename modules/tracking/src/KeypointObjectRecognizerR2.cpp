@@ -218,31 +218,52 @@ double KeypointObjectRecognizerR2::detect(const cv::Mat &image, Eigen::Matrix4f
   if( image.type() != CV_8U ) cv::cvtColor( image, im_gray, CV_RGB2GRAY );
   else im_gray = image;
 
-  Object &m = *model;
-
   // get matches
   detector->detect(im_gray, keys);
   descEstimator->extract(im_gray, keys, descs);
 
   cbMatcher->queryMatches(descs, matches);
 
+  return detect(keys, matches, cbMatcher->getViewRank(), pose, view_idx);
+}
+
+/**
+ * @brief KeypointObjectRecognizerR2::detect
+ * Estimates the pose from already computed codebook matches (e.g. shared between several objects)
+ * @param _keys query keypoints
+ * @param _matches matches per query keypoint (DMatch::imgIdx is the view index of the model)
+ * @param view_rank <view_index, number of votes> sorted better first
+ * @param pose estimated pose
+ * @param view_idx most supported view (-1 if none)
+ * @return confidence value
+ */
+double KeypointObjectRecognizerR2::detect(const std::vector<cv::KeyPoint> &_keys, const std::vector< std::vector< cv::DMatch > > &_matches,
+                                          const std::vector< std::pair<int, int> > &view_rank, Eigen::Matrix4f &pose, int &view_idx)
+{
+  if (model.get()==0)
+    throw std::runtime_error("[KeypointObjectRecognizerR2::detect] No model available!");
+  if (intrinsic.empty())
+    throw std::runtime_error("[KeypointObjectRecognizerR2::detect] Intrinsic camera parameter not set!");
+
+  Object &m = *model;
+
   // select points
-  std::vector<bool> use_views(cbMatcher->getViewRank().size(),false);
+  std::vector<bool> use_views(view_rank.size(),false);
   std::vector<int> view_indices;
   std::vector<int> view_votes;
   int max = 0;
   view_idx= -1;
 
 
-  for (unsigned i=0; i<cbMatcher->getViewRank().size()&&i<(unsigned)param.use_n_views; i++)
-    use_views[cbMatcher->getViewRank()[i].first] = true;
+  for (unsigned i=0; i<view_rank.size()&&i<(unsigned)param.use_n_views; i++)
+    use_views[view_rank[i].first] = true;
 
   model_pts.clear();
   query_pts.clear();
 
-  for (unsigned i=0; i<matches.size(); i++)
+  for (unsigned i=0; i<_matches.size(); i++)
   {
-    const std::vector<cv::DMatch> &ms = matches[i];
+    const std::vector<cv::DMatch> &ms = _matches[i];
 
     for (unsigned j=0; j<ms.size(); j++)
     {
@@ -251,7 +272,7 @@ double KeypointObjectRecognizerR2::detect(const cv::Mat &image, Eigen::Matrix4f
         const cv::DMatch &ma0 = ms[j];
         const Eigen::Vector3d &pt = m.points[m.views[ma0.imgIdx]->points[ma0.trainIdx]].pt;
         model_pts.push_back(cv::Point3f(pt[0],pt[1],pt[2]));
-        query_pts.push_back(keys[ma0.queryIdx].pt);
+        query_pts.push_back(_keys[ma0.queryIdx].pt);
         view_indices.push_back(ma0.imgIdx);
         if (!dbg.empty()) cv::circle(dbg, query_pts.back(), 3, CV_RGB(255,255,255), -1);
       }
@@ -294,10 +315,13 @@ double KeypointObjectRecognizerR2::detect(const cv::Mat &image, Eigen::Matrix4f
 /**
  * setModel
  */
-void KeypointObjectRecognizerR2::setModel(const Object::Ptr &_model)
+void KeypointObjectRecognizerR2::setModel(const Object::Ptr &_model, bool init_codebook)
 {  
   model=_model; 
 
+  if (!init_codebook)
+    return;
+
   if (model->haveCodebook())
   {
     cbMatcher->setCodebook(model->cb_centers, model->cb_entries);
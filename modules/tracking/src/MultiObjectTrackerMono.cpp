@@ -0,0 +1,354 @@
+/**
+ * $Id$
+ *
+ * Copyright (c) 2015, Johann Prankl, All rights reserved.
+ * @author Johann Prankl (prankl@acin.tuwien.ac.at)
+ *
+ */
+
+#include <v4r/tracking/MultiObjectTrackerMono.h>
+#include <opencv2/imgproc/imgproc.hpp>
+#include <algorithm>
+
+
+
+namespace v4r
+{
+
+
+using namespace std;
+
+
+inline bool cmpObjViewRankDec(const std::pair<int,int> &i, const std::pair<int,int> &j)
+{
+  return (i.second>j.second);
+}
+
+
+/************************************************************************************
+ * Constructor/Destructor
+ */
+MultiObjectTrackerMono::MultiObjectTrackerMono(const MultiObjectTrackerMono::Parameter &p)
+ : param(p), have_codebook(false), codebook_created(false)
+{
+  // the codebook of the single trackers is replaced by the combined one
+  param.ot_param.use_codebook = false;
+  detector.reset(new FeatureDetector_KD_FAST_IMGD(param.det_param));
+  cbMatcher.reset(new CodebookMatcher(param.or_param.cb_param));
+}
+
+MultiObjectTrackerMono::~MultiObjectTrackerMono()
+{
+}
+
+/**
+ * @brief MultiObjectTrackerMono::createCodebook
+ * Concatenates the codebooks of all objects (a codebook is created for models without one)
+ * and re-indexes the codebook entries to a global view index
+ */
+void MultiObjectTrackerMono::createCodebook()
+{
+  cv::Mat cb_centers;
+  std::vector< std::vector< std::pair<int,int> > > cb_entries;
+
+  view_to_object.clear();
+  have_codebook = false;
+
+  for (unsigned i=0; i<models.size(); i++)
+  {
+    const Object &m = *models[i];
+    int offs = view_to_object.size();
+    cv::Mat centers = m.cb_centers;
+    std::vector< std::vector< std::pair<int,int> > > entries;
+
+    if (models[i]->haveCodebook())
+    {
+      entries = m.cb_entries;
+    }
+    else
+    {
+      CodebookMatcher cbm(param.or_param.cb_param);
+
+      // the descriptors are copied, i.e. mapped views not in use are released again
+      for (unsigned j=0; j<m.views.size(); j++)
+      {
+        bool release = false;
+
+        if (model_files[i].get()!=0 && !model_files[i]->isViewLoaded(j))
+        {
+          model_files[i]->loadView(j);
+          release = true;
+        }
+
+        cbm.addView(m.views[j]->descs, j);
+
+        if (release)
+          model_files[i]->releaseView(j);
+      }
+
+      cbm.createCodebook(centers, entries);
+    }
+
+    for (unsigned j=0; j<m.views.size(); j++)
+      view_to_object.push_back(std::make_pair((int)i,(int)j));
+
+    // e.g. a model without descriptors results in an empty codebook
+    if (centers.empty())
+      continue;
+
+    if (cb_centers.empty()) centers.copyTo(cb_centers);
+    else
+    {
+      if (centers.cols!=cb_centers.cols || centers.type()!=cb_centers.type())
+        throw std::runtime_error("[MultiObjectTrackerMono::createCodebook] Inconsistent descriptor size or type of the object models!");
+      cv::vconcat(cb_centers, centers, cb_centers);
+    }
+
+    for (unsigned j=0; j<entries.size(); j++)
+    {
+      for (unsigned k=0; k<entries[j].size(); k++)
+        entries[j][k].first += offs;
+      cb_entries.push_back(entries[j]);
+    }
+  }
+
+  if (cb_entries.size()>0)
+  {
+    cbMatcher->setCodebook(cb_centers, cb_entries);
+    have_codebook = true;
+  }
+
+  // an empty codebook is kept as well, i.e. it is not created again for each frame
+  codebook_created = true;
+}
+
+/**
+ * @brief MultiObjectTrackerMono::redetect
+ * Detects keypoints once, queries the combined codebook and estimates the poses of the
+ * requested objects in parallel
+ * @param obj_indices objects which need a re-initialization
+ */
+void MultiObjectTrackerMono::redetect(const std::vector<int> &obj_indices)
+{
+  if (have_codebook)
+  {
+    detector->detect(im_gray, keys);
+    detector->extract(im_gray, keys, descs);
+  }
+
+  // e.g. no model with descriptors, i.e. an empty codebook
+  if (!have_codebook || keys.size()==0)
+  {
+    for (unsigned i=0; i<obj_indices.size(); i++)
+      trackers[obj_indices[i]]->setReinitPose(poses[obj_indices[i]], -1, 0.);
+    return;
+  }
+
+  cbMatcher->queryMatches(descs, matches);
+
+  // split matches and view rank to the objects (DMatch::imgIdx -> view index of the object)
+  obj_matches.resize(models.size());
+  obj_view_ranks.resize(models.size());
+
+  for (unsigned i=0; i<models.size(); i++)
+  {
+    obj_matches[i].clear();
+    obj_matches[i].resize(matches.size());
+    obj_view_ranks[i].resize(models[i]->views.size());
+    for (unsigned j=0; j<obj_view_ranks[i].size(); j++)
+      obj_view_ranks[i][j] = std::make_pair((int)j,0);
+  }
+
+  for (unsigned i=0; i<matches.size(); i++)
+  {
+    const std::vector<cv::DMatch> &ms = matches[i];
+
+    for (unsigned j=0; j<ms.size(); j++)
+    {
+      const std::pair<int,int> &ov = view_to_object[ms[j].imgIdx];
+      obj_matches[ov.first][i].push_back(cv::DMatch(ms[j].queryIdx, ms[j].trainIdx, ov.second, ms[j].distance));
+      obj_view_ranks[ov.first][ov.second].second++;
+    }
+  }
+
+  #pragma omp parallel for
+  for (int i=0; i<(int)obj_indices.size(); i++)
+  {
+    int idx = obj_indices[i];
+    int view_idx = -1;
+    Eigen::Matrix4f pose = poses[idx];
+
+    std::sort(obj_view_ranks[idx].begin(), obj_view_ranks[idx].end(), cmpObjViewRankDec);
+    double conf = recognizers[idx]->detect(keys, obj_matches[idx], obj_view_ranks[idx], pose, view_idx);
+
+    trackers[idx]->setReinitPose(pose, view_idx, conf);
+  }
+}
+
+
+
+/***************************************************************************************/
+
+/**
+ * @brief MultiObjectTrackerMono::clear
+ */
+void MultiObjectTrackerMono::clear()
+{
+  models.clear();
+  model_files.clear();
+  trackers.clear();
+  recognizers.clear();
+  view_to_object.clear();
+  poses.clear();
+  confs.clear();
+  tracked.clear();
+  have_codebook = false;
+  codebook_created = false;
+}
+
+/**
+ * @brief MultiObjectTrackerMono::reset
+ */
+void MultiObjectTrackerMono::reset()
+{
+  for (unsigned i=0; i<trackers.size(); i++)
+  {
+    trackers[i]->reset();
+    poses[i].setIdentity();
+    confs[i] = 0.;
+    tracked[i] = 0;
+  }
+}
+
+/**
+ * @brief MultiObjectTrackerMono::track
+ * @param image input image
+ * @return number of objects with a confident pose (see getPose, getConfidence, isTracked)
+ */
+int MultiObjectTrackerMono::track(const cv::Mat &image)
+{
+  if (models.size()==0)
+    throw std::runtime_error("[MultiObjectTrackerMono::track] No model available!");
+  if (intrinsic.empty())
+    throw std::runtime_error("[MultiObjectTrackerMono::track] Intrinsic camera parameter not set!");
+
+  if (!codebook_created)
+    createCodebook();
+
+  if( image.type() != CV_8U ) cv::cvtColor( image, im_gray, CV_RGB2GRAY );
+  else im_gray = image;
+
+  // shared re-detection
+  std::vector<int> obj_indices;
+
+  for (unsigned i=0; i<trackers.size(); i++)
+    if (trackers[i]->needReinit())
+      obj_indices.push_back(i);
+
+  if (obj_indices.size()>0)
+    redetect(obj_indices);
+
+  // frame to frame tracking
+  int cnt = 0;
+
+  #pragma omp parallel for reduction(+:cnt)
+  for (int i=0; i<(int)trackers.size(); i++)
+  {
+    tracked[i] = (trackers[i]->track(im_gray, poses[i], confs[i])?1:0);
+    cnt += tracked[i];
+  }
+
+  return cnt;
+}
+
+/**
+ * @brief MultiObjectTrackerMono::addTracker
+ * @param _model
+ * @param tracker
+ * @return index of the object
+ */
+int MultiObjectTrackerMono::addTracker(const Object::Ptr &_model, const ObjectTrackerMono::Ptr &tracker)
+{
+  KeypointObjectRecognizerR2::Ptr recognizer(new KeypointObjectRecognizerR2(param.or_param, detector, detector));
+
+  if (!intrinsic.empty())
+    recognizer->setCameraParameter(intrinsic, dist_coeffs);
+
+  recognizer->setModel(_model, false);
+
+  models.push_back(_model);
+  trackers.push_back(tracker);
+  recognizers.push_back(recognizer);
+  poses.push_back(Eigen::Matrix4f::Identity());
+  confs.push_back(0.);
+  tracked.push_back(0);
+
+  have_codebook = false;
+  codebook_created = false;
+
+  return models.size()-1;
+}
+
+/**
+ * @brief MultiObjectTrackerMono::addObjectModel
+ * @param _model
+ * @return index of the object
+ */
+int MultiObjectTrackerMono::addObjectModel(const Object::Ptr &_model)
+{
+  ObjectTrackerMono::Ptr tracker(new ObjectTrackerMono(param.ot_param));
+
+  if (!intrinsic.empty())
+    tracker->setCameraParameter(intrinsic, dist_coeffs);
+
+  tracker->setObjectModel(_model);
+  model_files.push_back(TrackingModelFile::Ptr());
+
+  return addTracker(_model, tracker);
+}
+
+/**
+ * @brief MultiObjectTrackerMono::addObjectModelFile
+ * @param _model_file mapped tracking model, the view data is loaded on demand
+ * @return index of the object
+ */
+int MultiObjectTrackerMono::addObjectModelFile(const TrackingModelFile::Ptr &_model_file)
+{
+  ObjectTrackerMono::Ptr tracker(new ObjectTrackerMono(param.ot_param));
+
+  if (!intrinsic.empty())
+    tracker->setCameraParameter(intrinsic, dist_coeffs);
+
+  tracker->setObjectModelFile(_model_file);
+  model_files.push_back(_model_file);
+
+  return addTracker(_model_file->getModel(), tracker);
+}
+
+/**
+ * setCameraParameter
+ */
+void MultiObjectTrackerMono::setCameraParameter(const cv::Mat &_intrinsic, const cv::Mat &_dist_coeffs)
+{
+  dist_coeffs = cv::Mat_<double>();
+
+  if (_intrinsic.type() != CV_64F)
+    _intrinsic.convertTo(intrinsic, CV_64F);
+  else _intrinsic.copyTo(intrinsic);
+
+  if (!_dist_coeffs.empty())
+  {
+    dist_coeffs = cv::Mat_<double>::zeros(1,8);
+    for (int i=0; i<_dist_coeffs.cols*_dist_coeffs.rows; i++)
+      dist_coeffs(0,i) = _dist_coeffs.at<double>(0,i);
+  }
+
+  for (unsigned i=0; i<trackers.size(); i++)
+  {
+    trackers[i]->setCameraParameter(intrinsic, dist_coeffs);
+    recognizers[i]->setCameraParameter(intrinsic, dist_coeffs);
+  }
+}
+
+}
+
@@ -26,7 +26,7 @@ using namespace std;
  * Constructor/Destructor
  */
 ObjectTrackerMono::ObjectTrackerMono(const ObjectTrackerMono::Parameter &p)
- : param(p), conf(0.), conf_cnt(0), not_conf_cnt(1000)
+ : param(p), conf(0.), conf_cnt(0), not_conf_cnt(1000), have_ext_reinit(false), ext_view_idx(-1), ext_conf(0.)
 {
   view.reset(new ObjectView(0));
   FeatureDetector::Ptr estDesc(new FeatureDetector_KD_FAST_IMGD(param.det_param));
@@ -86,16 +86,28 @@ void ObjectTrackerMono::updateView(const Eigen::Matrix4f &pose, const Object &mo
 
   if (idx != view->idx && idx != -1)
   {
-    view = model.views[idx];
-
-    kpDetector->setModel(view);
-    projTracker->setModel(view, model.cameras[view->camera_id]);
-    lkTracker->setModel(view);
+    setView(idx);
   }
   //--
   //cout<<idx<<endl;
 }
 
+/**
+ * @brief ObjectTrackerMono::setView
+ * @param view_idx
+ */
+void ObjectTrackerMono::setView(int view_idx)
+{
+  if (model_file.get()!=0)
+    model_file->loadView(view_idx);
+
+  view = model->views[view_idx];
+
+  kpDetector->setModel(view);
+  projTracker->setModel(view, model->cameras[view->camera_id]);
+  lkTracker->setModel(view);
+}
+
 /**
  * @brief ObjectTrackerMono::reinit
  * @param im
@@ -136,23 +148,14 @@ double ObjectTrackerMono::reinit(const cv::Mat_<unsigned char> &im, Eigen::Matri
     double conf = kpRecognizer->detect(im, pose, view_idx);
 
     if (view_idx != -1)
-    {
-      view = model->views[view_idx];
-      kpDetector->setModel(view);
-      projTracker->setModel(view, model->cameras[view->camera_id]);
-      lkTracker->setModel(view);
-    }
+      setView(view_idx);
 
     return conf;
   }
   else
   {
     // random sample views and try to reinit
-    view = model->views[rand()%model->views.size()];
-
-    kpDetector->setModel(view);
-    projTracker->setModel(view, model->cameras[view->camera_id]);
-    lkTracker->setModel(view);
+    setView(rand()%model->views.size());
 
     return kpDetector->detect(im, pose);
   }
@@ -169,9 +172,24 @@ void ObjectTrackerMono::reset()
   conf = 0;
   conf_cnt = 0;
   not_conf_cnt = 1000;
+  have_ext_reinit = false;
   view.reset(new ObjectView(0));
 }
 
+/**
+ * @brief ObjectTrackerMono::setReinitPose
+ * @param _pose pose detected outside the tracker
+ * @param _view_idx index of the supporting view (-1 if none)
+ * @param _conf confidence value of the detection
+ */
+void ObjectTrackerMono::setReinitPose(const Eigen::Matrix4f &_pose, int _view_idx, double _conf)
+{
+  have_ext_reinit = true;
+  ext_pose = _pose;
+  ext_view_idx = _view_idx;
+  ext_conf = _conf;
+}
+
 
 /**
  * @brief ObjectTrackerMono::track
@@ -197,9 +215,21 @@ bool ObjectTrackerMono::track(const cv::Mat &image, Eigen::Matrix4f &pose, doubl
   // do refinement
   if (not_conf_cnt>=param.min_not_conf_cnt)
   {
-    conf = reinit(im_gray, pose, view);
+    if (have_ext_reinit)
+    {
+      conf = ext_conf;
+      if (ext_view_idx != -1)
+      {
+        pose = ext_pose;
+        setView(ext_view_idx);
+      }
+      else conf = 0.;
+    }
+    else conf = reinit(im_gray, pose, view);
   }
 
+  have_ext_reinit = false;
+
   if (conf > 0.001)
   {
     if (param.do_inc_pyr_lk && conf > param.conf_reinit)
@@ -295,7 +325,31 @@ void ObjectTrackerMono::setObjectModel(const Object::Ptr &_model)
   reset();
 
   model = _model;
+  model_file.reset();
+
+  initModel();
+}
+
+/**
+ * @brief ObjectTrackerMono::setObjectModelFile
+ * @param _model_file
+ */
+void ObjectTrackerMono::setObjectModelFile(const TrackingModelFile::Ptr &_model_file)
+{
+  reset();
+
+  model_file = _model_file;
+  model = model_file->getModel();
+
+  // views are loaded when they get selected (setView)
+  initModel();
+}
 
+/**
+ * @brief ObjectTrackerMono::initModel
+ */
+void ObjectTrackerMono::initModel()
+{
   // set camera parameter
   if (model->camera_parameter.size()==1)
   {
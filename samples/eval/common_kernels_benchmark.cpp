@@ -0,0 +1,591 @@
+/******************************************************************************
+ * Copyright (c) 2016 Thomas Faeulhammer
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ ******************************************************************************/
+
+/**
+*
+*      @author Thomas Faeulhammer (faeulhammer@acin.tuwien.ac.at)
+*      @date January, 2016
+*      @brief microbenchmark of the compute kernels of the common module (z-buffering, normals, noise model,
+*      organized edges, correspondence grouping, clustering and convolution). Each kernel is run on synthetic
+*      and/or recorded organized point clouds at several resolutions and with several numbers of threads.
+*      The median and minimum time and the throughput of each run are printed and written to a CSV file.
+*/
+
+#include <v4r/common/ClusteringRNN.h>
+#include <v4r/common/convolution.h>
+#include <v4r/common/graph_geometric_consistency.h>
+#include <v4r/common/hough_3d.h>
+#include <v4r/common/noise_models.h>
+#include <v4r/common/organized_edge_detection.h>
+#include <v4r/common/ZAdaptiveNormals.h>
+#include <v4r/common/zbuffering.h>
+
+#include <pcl/common/io.h>
+#include <pcl/common/time.h>
+#include <pcl/common/transforms.h>
+#include <pcl/io/pcd_io.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/function.hpp>
+#include <boost/program_options.hpp>
+#include <boost/regex.hpp>
+#include <glog/logging.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace po = boost::program_options;
+
+using namespace v4r;
+
+typedef pcl::PointXYZRGB PointT;
+
+namespace
+{
+
+/** @brief organized input cloud and the data derived from it which is shared by the kernels */
+struct BenchmarkInput
+{
+    std::string name_;
+    float focal_length_;
+    pcl::PointCloud<PointT>::Ptr cloud_;
+    pcl::PointCloud<pcl::Normal>::Ptr normals_;
+    DataMatrix2D<Eigen::Vector3f> points_;
+    pcl::PointCloud<pcl::PointXYZI>::Ptr intensity_;
+
+    // synthetic model-scene correspondences (scene keypoints = tf * model keypoints + outliers)
+    pcl::PointCloud<PointT>::Ptr model_kp_, scene_kp_;
+    pcl::PointCloud<pcl::Normal>::Ptr model_kp_normals_, scene_kp_normals_;
+    pcl::PointCloud<pcl::ReferenceFrame>::Ptr model_rf_, scene_rf_;
+    pcl::CorrespondencesPtr corrs_;
+
+    DataMatrix2Df features_;    // normalized position and color of sampled points
+};
+
+struct Measurement
+{
+    std::string kernel_, input_;
+    int width_, height_, threads_;
+    size_t items_;
+    double min_ms_, median_ms_, speedup_;
+};
+
+/**
+ * @brief renders an organized cloud of a table with three spheres in front of a wall as seen by a Kinect-like
+ * camera (focal length scaled with the width) and adds depth dependent noise and missing measurements
+ */
+void
+createSyntheticScene(int width, int height, unsigned int seed, pcl::PointCloud<PointT> &cloud)
+{
+    const float f = 525.f * width / 640.f;
+    const float cx = width / 2.f, cy = height / 2.f;
+    const float wall_z = 2.5f, table_y = 0.3f;
+    const Eigen::Vector4f spheres[3] = { Eigen::Vector4f(-0.2f, 0.15f, 1.0f, 0.10f),
+                                         Eigen::Vector4f( 0.15f, 0.2f, 1.2f, 0.10f),
+                                         Eigen::Vector4f( 0.0f, 0.1f, 1.6f, 0.15f) };
+
+    std::mt19937 gen(seed);
+    std::normal_distribution<float> noise(0.f, 1.f);
+    std::uniform_real_distribution<float> uniform(0.f, 1.f);
+
+    cloud.width = width;
+    cloud.height = height;
+    cloud.is_dense = false;
+    cloud.points.resize(width * height);
+
+    for (int v=0; v<height; v++) {
+        for (int u=0; u<width; u++) {
+            const Eigen::Vector3f d ( (u - cx) / f, (v - cy) / f, 1.f );
+            float t = wall_z;
+            int hit = 0;
+
+            if (d[1] > 0.f && table_y / d[1] < t) {
+                t = table_y / d[1];
+                hit = 1;
+            }
+
+            for (int s=0; s<3; s++) {
+                const Eigen::Vector3f c = spheres[s].head<3>();
+                const float r = spheres[s][3];
+                const float a = d.squaredNorm(), b = -2.f * d.dot(c), cc = c.squaredNorm() - r*r;
+                const float disc = b*b - 4.f*a*cc;
+                if (disc >= 0.f) {
+                    const float t_s = (-b - sqrt(disc)) / (2.f * a);
+                    if (t_s > 0.f && t_s < t) {
+                        t = t_s;
+                        hit = 2 + s;
+                    }
+                }
+            }
+
+            PointT &pt = cloud.at(u, v);
+            if (uniform(gen) < 0.01f) {
+                pt.x = pt.y = pt.z = std::numeric_limits<float>::quiet_NaN();
+                pt.r = pt.g = pt.b = 0;
+                continue;
+            }
+
+            const float sigma_axial = 0.0012f + 0.0019f * (t - 0.4f) * (t - 0.4f);
+            const float z = t + sigma_axial * noise(gen);
+            pt.getVector3fMap() = d * z;
+
+            const Eigen::Vector3f p = d * t;
+            const bool checker = ( (int)floor(p[0] * 20.f) + (int)floor(p[1] * 20.f) + (int)floor(p[2] * 20.f) ) & 1;
+            pt.r = 40 * hit + (checker ? 100 : 0);
+            pt.g = 200 - 30 * hit;
+            pt.b = checker ? 50 : 150;
+        }
+    }
+}
+
+/** @brief downsamples an organized cloud by taking every stride-th pixel in each direction */
+void
+downsampleOrganized(const pcl::PointCloud<PointT> &in, int stride, pcl::PointCloud<PointT> &out)
+{
+    out.width = in.width / stride;
+    out.height = in.height / stride;
+    out.is_dense = in.is_dense;
+    out.points.resize(out.width * out.height);
+    for (size_t v=0; v<out.height; v++)
+        for (size_t u=0; u<out.width; u++)
+            out.at(u, v) = in.at(u * stride, v * stride);
+}
+
+/**
+ * @brief computes the normals, intensity image, clustering features and the synthetic correspondences of an input
+ */
+void
+prepareInput(BenchmarkInput &in, unsigned int seed)
+{
+    const pcl::PointCloud<PointT> &cloud = *in.cloud_;
+    const int width = cloud.width, height = cloud.height;
+
+    in.points_.resize(height, width);
+    in.intensity_.reset(new pcl::PointCloud<pcl::PointXYZI>);
+    in.intensity_->width = width;
+    in.intensity_->height = height;
+    in.intensity_->points.resize(cloud.points.size());
+    for (size_t i=0; i<cloud.points.size(); i++) {
+        const PointT &pt = cloud.points[i];
+        in.points_.data[i] = pt.getVector3fMap();
+        pcl::PointXYZI &pi = in.intensity_->points[i];
+        pi.x = pt.x; pi.y = pt.y; pi.z = pt.z;
+        pi.intensity = (0.299f * pt.r + 0.587f * pt.g + 0.114f * pt.b) / 255.f;
+    }
+
+    ZAdaptiveNormals::Parameter n_param;
+    n_param.adaptive = true;
+    ZAdaptiveNormals nest(n_param);
+    DataMatrix2D<Eigen::Vector3f> normals;
+    nest.compute(in.points_, normals);
+
+    in.normals_.reset(new pcl::PointCloud<pcl::Normal>);
+    in.normals_->width = width;
+    in.normals_->height = height;
+    in.normals_->points.resize(cloud.points.size());
+    for (size_t i=0; i<cloud.points.size(); i++)
+        in.normals_->points[i].getNormalVector3fMap() = normals.data[i];
+
+    std::vector<int> valid;
+    for (size_t i=0; i<cloud.points.size(); i++) {
+        if ( pcl::isFinite(cloud.points[i]) && pcl_isfinite(in.normals_->points[i].normal_x) )
+            valid.push_back(i);
+    }
+
+    std::mt19937 gen(seed);
+    std::shuffle(valid.begin(), valid.end(), gen);
+
+    // keypoints and correspondences (number grows with the resolution like the number of extracted features)
+    const size_t num_kp = std::min<size_t>(valid.size(), std::max(100, width * height / 150));
+    const size_t num_outliers = num_kp * 3 / 10;
+
+    Eigen::Matrix4f tf = Eigen::Matrix4f::Identity();
+    tf.block<3,3>(0,0) = Eigen::AngleAxisf(0.3f, Eigen::Vector3f(0.2f, 1.f, 0.1f).normalized()).toRotationMatrix();
+    tf.block<3,1>(0,3) = Eigen::Vector3f(0.05f, -0.02f, 0.1f);
+    const Eigen::Matrix4f tf_inv = tf.inverse();
+
+    in.scene_kp_.reset(new pcl::PointCloud<PointT>);
+    in.scene_kp_normals_.reset(new pcl::PointCloud<pcl::Normal>);
+    for (size_t i=0; i<num_kp; i++) {
+        in.scene_kp_->points.push_back( cloud.points[ valid[i] ] );
+        in.scene_kp_normals_->points.push_back( in.normals_->points[ valid[i] ] );
+    }
+    in.scene_kp_->width = in.scene_kp_normals_->width = num_kp;
+    in.scene_kp_->height = in.scene_kp_normals_->height = 1;
+
+    in.model_kp_.reset(new pcl::PointCloud<PointT>);
+    pcl::transformPointCloud(*in.scene_kp_, *in.model_kp_, tf_inv);
+    in.model_kp_normals_.reset(new pcl::PointCloud<pcl::Normal>(*in.scene_kp_normals_));
+    for (size_t i=0; i<num_kp; i++)
+        in.model_kp_normals_->points[i].getNormalVector3fMap() = tf_inv.block<3,3>(0,0) * in.scene_kp_normals_->points[i].getNormalVector3fMap();
+
+    in.model_rf_.reset(new pcl::PointCloud<pcl::ReferenceFrame>);
+    in.scene_rf_.reset(new pcl::PointCloud<pcl::ReferenceFrame>);
+    in.model_rf_->points.resize(num_kp);
+    in.scene_rf_->points.resize(num_kp);
+    const Eigen::Matrix3f rot = tf.block<3,3>(0,0);
+    for (size_t i=0; i<num_kp; i++) {
+        pcl::ReferenceFrame &m_rf = in.model_rf_->points[i];
+        pcl::ReferenceFrame &s_rf = in.scene_rf_->points[i];
+        for (int d=0; d<3; d++) {
+            m_rf.x_axis[d] = d==0 ? 1.f : 0.f;
+            m_rf.y_axis[d] = d==1 ? 1.f : 0.f;
+            m_rf.z_axis[d] = d==2 ? 1.f : 0.f;
+            s_rf.x_axis[d] = rot(0, d);   // rows of the rotation (the frame axes are stored as rows)
+            s_rf.y_axis[d] = rot(1, d);
+            s_rf.z_axis[d] = rot(2, d);
+        }
+    }
+    in.model_rf_->width = in.scene_rf_->width = num_kp;
+    in.model_rf_->height = in.scene_rf_->height = 1;
+
+    in.corrs_.reset(new pcl::Correspondences);
+    std::uniform_int_distribution<int> random_kp(0, num_kp - 1);
+    for (size_t i=0; i<num_kp; i++)
+        in.corrs_->push_back( pcl::Correspondence(i, i, 0.f) );
+    for (size_t i=0; i<num_outliers; i++)
+        in.corrs_->push_back( pcl::Correspondence(random_kp(gen), random_kp(gen), 0.f) );
+
+    // normalized position and color of sampled points for clustering
+    const size_t num_samples = std::min<size_t>(valid.size(), std::max(200, width * height / 250));
+    in.features_.resize(num_samples, 6);
+    for (size_t i=0; i<num_samples; i++) {
+        const PointT &pt = cloud.points[ valid[i] ];
+        in.features_(i, 0) = pt.x / 2.f;
+        in.features_(i, 1) = pt.y / 2.f;
+        in.features_(i, 2) = pt.z / 3.f;
+        in.features_(i, 3) = pt.r / 255.f;
+        in.features_(i, 4) = pt.g / 255.f;
+        in.features_(i, 5) = pt.b / 255.f;
+    }
+}
+
+void
+setNumThreads(int n)
+{
+#ifdef _OPENMP
+    omp_set_num_threads(n);
+#else
+    (void)n;
+#endif
+}
+
+}
+
+class CommonKernelsBenchmark
+{
+private:
+    std::vector<BenchmarkInput> inputs_;
+    std::vector<int> threads_;
+    std::vector<Measurement> results_;
+    int repetitions_, warmup_;
+    boost::regex kernel_filter_;
+    std::string output_fn_;
+
+    /**
+     * @brief runs a kernel warmup_ + repetitions_ times for each number of threads and stores the median and
+     * minimum time of the timed repetitions. The speedup is relative to the first number of threads.
+     */
+    void
+    run(const std::string &kernel, const BenchmarkInput &in, size_t items, const boost::function<void ()> &f)
+    {
+        if ( !boost::regex_search(kernel, kernel_filter_) )
+            return;
+
+        double reference_ms = 0.;
+        for (size_t t_id=0; t_id<threads_.size(); t_id++) {
+            setNumThreads(threads_[t_id]);
+
+            for (int i=0; i<warmup_; i++)
+                f();
+
+            std::vector<double> times (repetitions_);
+            for (int i=0; i<repetitions_; i++) {
+                pcl::StopWatch t;
+                f();
+                times[i] = t.getTime();
+            }
+            std::sort(times.begin(), times.end());
+
+            Measurement m;
+            m.kernel_ = kernel;
+            m.input_ = in.name_;
+            m.width_ = in.cloud_->width;
+            m.height_ = in.cloud_->height;
+            m.threads_ = threads_[t_id];
+            m.items_ = items;
+            m.min_ms_ = times.front();
+            m.median_ms_ = repetitions_ % 2 ? times[repetitions_/2] : 0.5 * (times[repetitions_/2 - 1] + times[repetitions_/2]);
+            if (t_id == 0)
+                reference_ms = m.median_ms_;
+            m.speedup_ = m.median_ms_ > 0. ? reference_ms / m.median_ms_ : 0.;
+            results_.push_back(m);
+
+            std::cout << std::left << std::setw(28) << kernel << std::setw(24) << in.name_ << std::right
+                      << std::setw(5) << m.width_ << "x" << std::setw(4) << std::left << m.height_ << std::right
+                      << " threads: " << std::setw(2) << m.threads_
+                      << "  median: " << std::fixed << std::setprecision(3) << std::setw(10) << m.median_ms_ << " ms"
+                      << "  min: " << std::setw(10) << m.min_ms_ << " ms"
+                      << "  " << std::setw(8) << std::setprecision(2) << (m.median_ms_ > 0. ? items / m.median_ms_ / 1e3 : 0.) << " Mitems/s"
+                      << "  speedup: " << m.speedup_ << std::endl;
+        }
+    }
+
+public:
+    CommonKernelsBenchmark() : repetitions_(5), warmup_(1) {}
+
+    bool initialize(int argc, char ** argv)
+    {
+        std::vector<std::string> pcd_files;
+        std::string resolutions_str = "160x120,320x240,640x480";
+        std::string threads_str = "";
+        std::string kernel_filter = ".*";
+        bool synthetic = true;
+        int seed = 0;
+
+        po::options_description desc("Microbenchmark of the common module kernels\n======================================\n**Allowed options");
+        desc.add_options()
+                ("help,h", "produce help message")
+                ("pcd,p", po::value<std::vector<std::string> >(&pcd_files)->multitoken(), "recorded organized point clouds (.pcd) to run the kernels on (downsampled by integer strides to the requested resolutions)")
+                ("synthetic", po::value<bool>(&synthetic)->default_value(synthetic), "if true, runs the kernels on a synthetic scene rendered at each resolution")
+                ("resolutions,r", po::value<std::string>(&resolutions_str)->default_value(resolutions_str), "comma separated list of resolutions (WIDTHxHEIGHT)")
+                ("threads,t", po::value<std::string>(&threads_str)->default_value(threads_str), "comma separated list of the number of threads (default: 1 and powers of two up to the number of available threads)")
+                ("kernels,k", po::value<std::string>(&kernel_filter)->default_value(kernel_filter), "regular expression selecting the kernels to run")
+                ("repetitions", po::value<int>(&repetitions_)->default_value(repetitions_), "number of timed runs per kernel, input and number of threads")
+                ("warmup", po::value<int>(&warmup_)->default_value(warmup_), "number of untimed runs before the timed ones")
+                ("seed", po::value<int>(&seed)->default_value(seed), "seed for the synthetic data")
+                ("output,o", po::value<std::string>(&output_fn_)->default_value("/tmp/common_kernels_benchmark.csv"), "CSV file the results are written to")
+       ;
+
+        po::variables_map vm;
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        if (vm.count("help"))
+        {
+            std::cout << desc << std::endl;
+            return false;
+        }
+
+        try
+        {
+            po::notify(vm);
+        }
+        catch(std::exception& e)
+        {
+            std::cerr << "Error: " << e.what() << std::endl << std::endl << desc << std::endl;
+            return false;
+        }
+
+        if (repetitions_ < 1)
+            repetitions_ = 1;
+        kernel_filter_ = boost::regex(kernel_filter);
+
+        std::vector<std::pair<int, int> > resolutions;
+        std::vector<std::string> tokens;
+        boost::split(tokens, resolutions_str, boost::is_any_of(","), boost::token_compress_on);
+        for (size_t i=0; i<tokens.size(); i++) {
+            int w, h;
+            if (sscanf(tokens[i].c_str(), "%dx%d", &w, &h) == 2 && w > 0 && h > 0)
+                resolutions.push_back(std::make_pair(w, h));
+            else
+                LOG(WARNING) << "Ignoring invalid resolution " << tokens[i];
+        }
+
+        threads_.clear();
+        if (!threads_str.empty()) {
+            boost::split(tokens, threads_str, boost::is_any_of(","), boost::token_compress_on);
+            for (size_t i=0; i<tokens.size(); i++) {
+                int n = atoi(tokens[i].c_str());
+                if (n > 0)
+                    threads_.push_back(n);
+            }
+        }
+        if (threads_.empty()) {
+            int max_threads = 1;
+#ifdef _OPENMP
+            max_threads = omp_get_max_threads();
+#endif
+            for (int n=1; n<max_threads; n*=2)
+                threads_.push_back(n);
+            threads_.push_back(max_threads);
+        }
+
+        inputs_.clear();
+        for (size_t r=0; r<resolutions.size(); r++) {
+            if (synthetic) {
+                BenchmarkInput in;
+                in.name_ = "synthetic";
+                in.cloud_.reset(new pcl::PointCloud<PointT>);
+                createSyntheticScene(resolutions[r].first, resolutions[r].second, seed, *in.cloud_);
+                in.focal_length_ = 525.f * resolutions[r].first / 640.f;
+                inputs_.push_back(in);
+            }
+
+            for (size_t i=0; i<pcd_files.size(); i++) {
+                pcl::PointCloud<PointT>::Ptr cloud (new pcl::PointCloud<PointT>);
+                if (pcl::io::loadPCDFile(pcd_files[i], *cloud) < 0 || !cloud->isOrganized()) {
+                    LOG(WARNING) << "Could not load organized point cloud " << pcd_files[i];
+                    continue;
+                }
+
+                const int stride = cloud->width / resolutions[r].first;
+                if ( stride < 1 || cloud->width != (size_t)(resolutions[r].first * stride) || cloud->height != (size_t)(resolutions[r].second * stride) )
+                    continue;   // resolution can not be obtained by subsampling
+
+                BenchmarkInput in;
+                in.name_ = boost::filesystem::path(pcd_files[i]).filename().string();
+                in.cloud_.reset(new pcl::PointCloud<PointT>);
+                downsampleOrganized(*cloud, stride, *in.cloud_);
+                in.focal_length_ = 525.f * in.cloud_->width / 640.f;
+                inputs_.push_back(in);
+            }
+        }
+
+        for (size_t i=0; i<inputs_.size(); i++)
+            prepareInput(inputs_[i], seed);
+
+        return !inputs_.empty();
+    }
+
+    void benchmark()
+    {
+        results_.clear();
+
+        for (size_t i=0; i<inputs_.size(); i++) {
+            BenchmarkInput &in = inputs_[i];
+            const int width = in.cloud_->width, height = in.cloud_->height;
+            const size_t num_pixels = width * height;
+
+            ZBuffering<PointT, PointT> zbuf (width, height, in.focal_length_);
+            run("ZBuffering::computeDepthMap", in, num_pixels, [&]() { zbuf.computeDepthMap(*in.cloud_); });
+
+            ZAdaptiveNormals::Parameter n_param;
+            n_param.adaptive = true;
+            ZAdaptiveNormals nest (n_param);
+            DataMatrix2D<Eigen::Vector3f> normals;
+            run("ZAdaptiveNormals::compute", in, num_pixels, [&]() { nest.compute(in.points_, normals); });
+
+            n_param.integral_image = true;
+            ZAdaptiveNormals nest_integral (n_param);
+            run("ZAdaptiveNormals::compute(integral)", in, num_pixels, [&]() { nest_integral.compute(in.points_, normals); });
+
+            NguyenNoiseModel<PointT>::Parameter nm_param;
+            nm_param.focal_length_ = in.focal_length_;
+            NguyenNoiseModel<PointT> nm (nm_param);
+            nm.setInputCloud(in.cloud_);
+            nm.setInputNormals(in.normals_);
+            run("NguyenNoiseModel::compute", in, num_pixels, [&]() { nm.compute(); });
+
+            OrganizedEdgeBase<PointT, pcl::Label> oed;
+            oed.setDepthDisconThreshold (0.05f);
+            oed.setMaxSearchNeighbors(100);
+            oed.setEdgeType ( OrganizedEdgeBase<PointT, pcl::Label>::EDGELABEL_OCCLUDING
+                            | OrganizedEdgeBase<PointT, pcl::Label>::EDGELABEL_OCCLUDED
+                            | OrganizedEdgeBase<PointT, pcl::Label>::EDGELABEL_NAN_BOUNDARY );
+            oed.setInputCloud (in.cloud_);
+            pcl::PointCloud<pcl::Label> labels;
+            std::vector<pcl::PointIndices> edge_indices;
+            run("OrganizedEdgeBase::compute", in, num_pixels, [&]() { oed.compute(labels, edge_indices); });
+
+            pcl::PointCloud<pcl::PointXYZ>::Ptr model_kp_xyz (new pcl::PointCloud<pcl::PointXYZ>);
+            pcl::PointCloud<pcl::PointXYZ>::Ptr scene_kp_xyz (new pcl::PointCloud<pcl::PointXYZ>);
+            pcl::copyPointCloud(*in.model_kp_, *model_kp_xyz);
+            pcl::copyPointCloud(*in.scene_kp_, *scene_kp_xyz);
+            std::vector<pcl::Correspondences> clustered_corrs;
+            run("Hough3DGrouping::cluster", in, in.corrs_->size(), [&]() {
+                Hough3DGrouping<pcl::PointXYZ, pcl::PointXYZ> hough;
+                hough.setHoughBinSize(0.02);
+                hough.setHoughThreshold(5.);
+                hough.setUseInterpolation(true);
+                hough.setInputCloud(model_kp_xyz);
+                hough.setInputRf(in.model_rf_);
+                hough.setSceneCloud(scene_kp_xyz);
+                hough.setSceneRf(in.scene_rf_);
+                hough.setModelSceneCorrespondences(in.corrs_);
+                hough.cluster(clustered_corrs);
+            });
+
+            GraphGeometricConsistencyGrouping<PointT, PointT>::Parameter gc_param;
+            gc_param.max_time_allowed_cliques_comptutation_ = 100;
+            GraphGeometricConsistencyGrouping<PointT, PointT> gcg (gc_param);
+            gcg.setInputCloud(in.model_kp_);
+            gcg.setSceneCloud(in.scene_kp_);
+            gcg.setInputAndSceneNormals(in.model_kp_normals_, in.scene_kp_normals_);
+            gcg.setModelSceneCorrespondences(in.corrs_);
+            run("GraphGeometricConsistencyGrouping::cluster", in, in.corrs_->size(), [&]() { gcg.cluster(clustered_corrs); });
+
+            ClusteringRNN rnn (ClusteringRNN::Parameter(0.1f), false);
+            run("ClusteringRNN::cluster", in, in.features_.rows, [&]() { rnn.cluster(in.features_); });
+
+            pcl::PointCloud<pcl::PointXYZI> kernel, filtered;
+            kernel.width = kernel.height = 5;
+            kernel.points.resize(25);
+            const float binomial[5] = {1.f, 4.f, 6.f, 4.f, 1.f};
+            for (int v=0; v<5; v++)
+                for (int u=0; u<5; u++)
+                    kernel.at(u, v).intensity = binomial[u] * binomial[v] / 256.f;
+            Convolution<pcl::PointXYZI> conv;
+            conv.setKernel(kernel);
+            conv.setInputCloud(in.intensity_);
+            run("Convolution::filter(5x5)", in, num_pixels, [&]() { conv.filter(filtered); });
+        }
+
+        writeCSV();
+    }
+
+    /** @brief writes one line per kernel, input, resolution and number of threads */
+    void writeCSV() const
+    {
+        std::ofstream f (output_fn_.c_str());
+        f << "kernel,input,width,height,threads,items,repetitions,min_ms,median_ms,mitems_per_s,speedup" << std::endl;
+        f << std::fixed;
+        for (size_t i=0; i<results_.size(); i++) {
+            const Measurement &m = results_[i];
+            f << m.kernel_ << "," << m.input_ << "," << m.width_ << "," << m.height_ << "," << m.threads_ << ","
+              << m.items_ << "," << repetitions_ << "," << std::setprecision(4) << m.min_ms_ << "," << m.median_ms_ << ","
+              << (m.median_ms_ > 0. ? m.items_ / m.median_ms_ / 1e3 : 0.) << "," << std::setprecision(3) << m.speedup_ << std::endl;
+        }
+        f.close();
+        std::cout << "Results written to " << output_fn_ << std::endl;
+    }
+};
+
+int
+main (int argc, char ** argv)
+{
+    google::InitGoogleLogging(argv[0]);
+    CommonKernelsBenchmark bm;
+    if(bm.initialize(argc,argv))
+        bm.benchmark();
+    return 0;
+}
@@ -0,0 +1,691 @@
+/******************************************************************************
+ * Copyright (c) 2016 Thomas Faeulhammer
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ ******************************************************************************/
+
+/**
+*
+*      @author Thomas Faeulhammer (faeulhammer@acin.tuwien.ac.at)
+*      @date January, 2016
+*      @brief recognition benchmark. Replays test sequences through the single-view (MultiRecognitionPipeline)
+*      or multi-view (MultiviewRecognizer) recognizer and writes a JSON report containing the wall time of each
+*      processing stage, peak memory, CPU utilization and the pose accuracy with respect to the annotated ground-truth.
+*      Ground-truth is expected in the same format as the output of the object_recognizer evaluation tools, i.e.
+*      gt_dir/<sequence>/<view>_<model>_<instance>.txt containing the row-major 4x4 object pose in the camera frame.
+*/
+
+#include <v4r_config.h>
+#include <v4r/common/miscellaneous.h>
+#include <v4r/features/sift_local_estimator.h>
+
+#ifndef HAVE_SIFTGPU
+#include <v4r/features/opencv_sift_local_estimator.h>
+#endif
+
+#include <v4r/features/shot_local_estimator_omp.h>
+#include <v4r/io/filesystem.h>
+#include <v4r/recognition/ghv.h>
+#include <v4r/recognition/hv_go_3D.h>
+#include <v4r/recognition/local_recognizer.h>
+#include <v4r/recognition/multi_pipeline_recognizer.h>
+#include <v4r/recognition/multiview_object_recognizer.h>
+#include <v4r/recognition/recognizer.h>
+#include <v4r/recognition/registered_views_source.h>
+
+#include <pcl/common/time.h>
+#include <pcl/filters/passthrough.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdlib.h>
+#include <sys/resource.h>
+
+#include <boost/program_options.hpp>
+#include <glog/logging.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace po = boost::program_options;
+
+using namespace v4r;
+
+namespace
+{
+
+/** @brief object pose of an annotated or recognized object instance */
+struct ObjectPose
+{
+    std::string model_id_;
+    Eigen::Matrix4f tf_;
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+
+/** @brief measurements of a single recognition call */
+struct SceneResult
+{
+    std::string name_;
+    double wall_time_;   // ms
+    double cpu_time_;    // ms (user + system of all threads)
+    double peak_rss_;    // MB
+    std::vector<std::pair<std::string, double> > stages_;
+    size_t tp_, fp_, fn_;
+    std::vector<double> trans_errors_, rot_errors_;
+};
+
+/** @brief returns the value in kB of a field (e.g. VmHWM) of /proc/self/status or -1 if not available */
+long
+readProcStatus(const std::string &field)
+{
+    std::ifstream f("/proc/self/status");
+    std::string line;
+    while (std::getline(f, line)) {
+        if (line.compare(0, field.length(), field) == 0 && line.length() > field.length() && line[field.length()] == ':')
+            return atol(line.c_str() + field.length() + 1);
+    }
+    return -1;
+}
+
+/** @brief resets the peak resident set size (VmHWM) of the process (Linux >= 4.0), returns false if not supported */
+bool
+resetPeakRSS()
+{
+    std::ofstream f("/proc/self/clear_refs");
+    if (!f.is_open())
+        return false;
+    f << "5";
+    return f.good();
+}
+
+/** @brief consumed CPU time (user + system) of all threads of the process in ms */
+double
+getCPUTime()
+{
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return ( ru.ru_utime.tv_sec + ru.ru_stime.tv_sec ) * 1e3 + ( ru.ru_utime.tv_usec + ru.ru_stime.tv_usec ) * 1e-3;
+}
+
+double
+median(std::vector<double> v)
+{
+    if (v.empty())
+        return 0.;
+    std::sort(v.begin(), v.end());
+    return v.size() % 2 ? v[v.size()/2] : 0.5 * ( v[v.size()/2 - 1] + v[v.size()/2] );
+}
+
+double
+mean(const std::vector<double> &v)
+{
+    if (v.empty())
+        return 0.;
+    double sum = 0.;
+    for (size_t i=0; i<v.size(); i++)
+        sum += v[i];
+    return sum / v.size();
+}
+
+std::string
+jsonEscape(const std::string &s)
+{
+    std::string out;
+    for (size_t i=0; i<s.length(); i++) {
+        if (s[i] == '"' || s[i] == '\\')
+            out += '\\';
+        out += s[i];
+    }
+    return out;
+}
+
+std::string
+removeExtension(const std::string &fn)
+{
+    size_t pos = fn.find_last_of('.');
+    return pos == std::string::npos ? fn : fn.substr(0, pos);
+}
+
+/**
+ * @brief loads the annotated object poses of a view (files <view>_<model>_<instance>.txt, occlusion annotations are skipped)
+ */
+void
+loadGroundTruth(const std::string &gt_path, const std::string &view_name, std::vector<ObjectPose, Eigen::aligned_allocator<ObjectPose> > &gt)
+{
+    gt.clear();
+
+    if (!io::existsFolder(gt_path))
+        return;
+
+    std::vector<std::string> files = io::getFilesInDirectory(gt_path, view_name + "_.*.txt", false);
+    std::sort(files.begin(), files.end());
+
+    for (size_t i=0; i<files.size(); i++) {
+        const std::string &fn = files[i];
+        if (fn.find("_occlusion_") != std::string::npos)
+            continue;
+
+        std::string model_and_instance = removeExtension(fn.substr(view_name.length() + 1));
+        size_t pos = model_and_instance.find_last_of('_');
+        if (pos == std::string::npos)
+            continue;
+
+        ObjectPose op;
+        op.model_id_ = model_and_instance.substr(0, pos);
+
+        std::ifstream f( (gt_path + "/" + fn).c_str() );
+        for (size_t row=0; row<4; row++)
+            for (size_t col=0; col<4; col++)
+                f >> op.tf_(row, col);
+
+        if (f.fail()) {
+            LOG(WARNING) << "Could not read ground-truth pose from " << gt_path << "/" << fn;
+            continue;
+        }
+        gt.push_back(op);
+    }
+}
+
+/**
+ * @brief greedily assigns each ground-truth object to the closest (in translation) unassigned recognized object of the same model
+ * which is within the given translation (in m) and rotation (in degree) threshold
+ */
+void
+evaluate(const std::vector<ObjectPose, Eigen::aligned_allocator<ObjectPose> > &gt,
+         const std::vector<ObjectPose, Eigen::aligned_allocator<ObjectPose> > &rec,
+         double max_trans_error, double max_rot_error, SceneResult &res)
+{
+    std::vector<bool> rec_taken (rec.size(), false);
+    res.tp_ = res.fp_ = res.fn_ = 0;
+
+    for (size_t g=0; g<gt.size(); g++) {
+        int best_r = -1;
+        double best_trans_error = std::numeric_limits<double>::max(), best_rot_error = 0.;
+
+        for (size_t r=0; r<rec.size(); r++) {
+            if (rec_taken[r] || rec[r].model_id_ != gt[g].model_id_)
+                continue;
+
+            double trans_error = (gt[g].tf_.block<3,1>(0,3) - rec[r].tf_.block<3,1>(0,3)).norm();
+            Eigen::Matrix3f rot_diff = gt[g].tf_.block<3,3>(0,0).transpose() * rec[r].tf_.block<3,3>(0,0);
+            double cos_angle = std::max(-1., std::min(1., ( rot_diff.trace() - 1. ) / 2.));
+            double rot_error = acos(cos_angle) * 180. / M_PI;
+
+            if (trans_error < max_trans_error && rot_error < max_rot_error && trans_error < best_trans_error) {
+                best_r = r;
+                best_trans_error = trans_error;
+                best_rot_error = rot_error;
+            }
+        }
+
+        if (best_r >= 0) {
+            rec_taken[best_r] = true;
+            res.tp_++;
+            res.trans_errors_.push_back(best_trans_error);
+            res.rot_errors_.push_back(best_rot_error);
+        }
+        else
+            res.fn_++;
+    }
+
+    res.fp_ = rec.size() - res.tp_;
+}
+
+}
+
+template<typename PointT>
+class Benchmark
+{
+private:
+    typedef Model<PointT> ModelT;
+    typedef boost::shared_ptr<ModelT> ModelTPtr;
+    typedef pcl::Histogram<128> FeatureT;
+
+    boost::shared_ptr<MultiRecognitionPipeline<PointT> > rr_;
+    boost::shared_ptr<MultiviewRecognizer<PointT> > mv_r_;
+
+    std::string test_dir_, gt_dir_, report_fn_;
+    bool multiview_;
+    double chop_z_;
+    double max_trans_error_, max_rot_error_;
+    int seed_;
+    int num_threads_;
+
+    cv::Ptr<SiftGPU> sift_;
+    std::vector<SceneResult> results_;
+
+public:
+    Benchmark()
+    {
+        multiview_ = false;
+        chop_z_ = std::numeric_limits<float>::max();
+        max_trans_error_ = 0.03;
+        max_rot_error_ = 30.;
+        seed_ = 0;
+        num_threads_ = 0;
+    }
+
+    bool initialize(int argc, char ** argv)
+    {
+        bool do_sift;
+        bool do_shot;
+        bool use_go3d;
+        float resolution = 0.005f;
+        std::string models_dir;
+
+        typename GO3D<PointT, PointT>::Parameter paramGO3D;
+        typename GraphGeometricConsistencyGrouping<PointT, PointT>::Parameter paramGgcg;
+        typename LocalRecognitionPipeline<flann::L1, PointT, FeatureT >::Parameter paramLocalRecSift;
+        typename LocalRecognitionPipeline<flann::L1, PointT, pcl::Histogram<352> >::Parameter paramLocalRecShot;
+        typename MultiRecognitionPipeline<PointT>::Parameter paramMultiPipeRec;
+        typename SHOTLocalEstimationOMP<PointT, pcl::Histogram<352> >::Parameter paramLocalEstimator;
+        typename MultiviewRecognizer<PointT>::Parameter paramMultiView;
+        typename NguyenNoiseModel<PointT>::Parameter nm_param;
+        typename NMBasedCloudIntegration<PointT>::Parameter nmInt_param;
+        nmInt_param.octree_resolution_ = 0.001f;
+
+        paramGgcg.max_time_allowed_cliques_comptutation_ = 100;
+        paramLocalRecSift.use_cache_ = paramLocalRecShot.use_cache_ = true;
+        paramLocalRecSift.save_hypotheses_ = paramLocalRecShot.save_hypotheses_ = true;
+        paramLocalRecShot.kdtree_splits_ = 128;
+
+        int normal_computation_method = paramLocalRecSift.normal_computation_method_;
+        int num_training_threads = paramLocalRecSift.num_training_threads_;
+
+        po::options_description desc("Recognition Benchmark\n======================================\n**Allowed options");
+        desc.add_options()
+                ("help,h", "produce help message")
+                ("models_dir,m", po::value<std::string>(&models_dir)->required(), "directory containing the object models")
+                ("test_dir,t", po::value<std::string>(&test_dir_)->required(), "Directory with test scenes stored as point clouds (.pcd). The camera pose is taken directly from the pcd header fields \"sensor_orientation_\" and \"sensor_origin_\" (if the test directory contains subdirectories, each subdirectory is considered as seperate sequence)")
+                ("gt_dir,g", po::value<std::string>(&gt_dir_)->default_value(""), "Directory with the annotated object poses (same folder structure as test_dir). If empty, only timings are reported.")
+                ("report,o", po::value<std::string>(&report_fn_)->default_value("/tmp/recognition_benchmark.json"), "File the JSON report is written to")
+                ("multiview", po::bool_switch(&multiview_), "if set, replays the sequences through the multi-view recognizer, otherwise each view is recognized independently")
+                ("seed", po::value<int>(&seed_)->default_value(seed_), "seed of the random number generator (fixed to make runs comparable)")
+                ("threads", po::value<int>(&num_threads_)->default_value(num_threads_), "number of OpenMP threads (0... use OpenMP default)")
+                ("max_trans_error", po::value<double>(&max_trans_error_)->default_value(max_trans_error_, boost::str(boost::format("%.2e") % max_trans_error_) ), "maximum translation error in meter for a recognized object to match a ground-truth object")
+                ("max_rot_error", po::value<double>(&max_rot_error_)->default_value(max_rot_error_, boost::str(boost::format("%.2e") % max_rot_error_) ), "maximum rotation error in degree for a recognized object to match a ground-truth object")
+                ("do_sift", po::value<bool>(&do_sift)->default_value(true), "if true, generates hypotheses using SIFT (visual texture information)")
+                ("do_shot", po::value<bool>(&do_shot)->default_value(false), "if true, generates hypotheses using SHOT (local geometrical properties)")
+                ("use_go3d", po::value<bool>(&use_go3d)->default_value(false), "(multiview only) if true, verifies against a reconstructed scene from multiple viewpoints. Otherwise only against the current viewpoint.")
+                ("transfer_feature_matches", po::value<bool>(&paramMultiPipeRec.save_hypotheses_)->default_value(paramMultiPipeRec.save_hypotheses_), "(multiview only) if true, transfers feature matches between views [Faeulhammer ea., ICRA 2015]. Otherwise generated hypotheses [Faeulhammer ea., MVA 2015].")
+                ("knn_sift", po::value<int>(&paramLocalRecSift.knn_)->default_value(paramLocalRecSift.knn_), "sets the number k of matches for each extracted SIFT feature to its k nearest neighbors")
+                ("knn_shot", po::value<int>(&paramLocalRecShot.knn_)->default_value(paramLocalRecShot.knn_), "sets the number k of matches for each extracted SHOT feature to its k nearest neighbors")
+                ("icp_iterations", po::value<int>(&paramMultiPipeRec.icp_iterations_)->default_value(paramMultiPipeRec.icp_iterations_), "number of icp iterations. If 0, no pose refinement will be done")
+                ("chop_z,z", po::value<double>(&chop_z_)->default_value(chop_z_, boost::str(boost::format("%.2e") % chop_z_) ), "points with z-component higher than chop_z_ will be ignored (low chop_z reduces computation time and false positives (noise increase with z)")
+                ("cg_size_thresh,c", po::value<size_t>(&paramGgcg.gc_threshold_)->default_value(paramGgcg.gc_threshold_), "Minimum cluster size. At least 3 correspondences are needed to compute the 6DOF pose ")
+                ("cg_size", po::value<double>(&paramGgcg.gc_size_)->default_value(paramGgcg.gc_size_, boost::str(boost::format("%.2e") % paramGgcg.gc_size_) ), "Resolution of the consensus set used to cluster correspondences together ")
+                ("hv_regularizer,r", po::value<double>(&paramGO3D.regularizer_)->default_value(paramGO3D.regularizer_, boost::str(boost::format("%.2e") % paramGO3D.regularizer_) ), "represents a penalty multiplier for model outliers. In particular, each model outlier associated with an active hypothesis increases the global cost function.")
+                ("hv_inlier_threshold", po::value<double>(&paramGO3D.inliers_threshold_)->default_value(paramGO3D.inliers_threshold_, boost::str(boost::format("%.2e") % paramGO3D.inliers_threshold_) ), "Represents the maximum distance between model and scene points in order to state that a scene point is explained by a model point. Valid model points that do not have any corresponding scene point within this threshold are considered model outliers")
+                ("hv_add_planes", po::value<bool>(&paramGO3D.add_planes_)->default_value(paramGO3D.add_planes_), "if true, adds planes as possible hypotheses (slower but decreases false positives especially for planes detected as flat objects like books)")
+                ("normal_method,n", po::value<int>(&normal_computation_method)->default_value(normal_computation_method), "chosen normal computation method of the V4R library")
+                ("num_training_threads", po::value<int>(&num_training_threads)->default_value(num_training_threads), "number of threads used for training the models (0... number of available cores)")
+       ;
+
+        po::variables_map vm;
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        if (vm.count("help"))
+        {
+            std::cout << desc << std::endl;
+            return false;
+        }
+
+        try
+        {
+            po::notify(vm);
+        }
+        catch(std::exception& e)
+        {
+            std::cerr << "Error: " << e.what() << std::endl << std::endl << desc << std::endl;
+            return false;
+        }
+
+        srand(seed_);
+#ifdef _OPENMP
+        if (num_threads_ > 0)
+            omp_set_num_threads(num_threads_);
+        num_threads_ = omp_get_max_threads();
+#else
+        num_threads_ = 1;
+#endif
+
+        if (!multiview_)
+            paramMultiPipeRec.save_hypotheses_ = false;
+
+        paramMultiView.icp_iterations_ = paramMultiPipeRec.icp_iterations_;
+        paramMultiView.chop_z_ = chop_z_;
+        paramLocalRecSift.normal_computation_method_ = paramLocalRecShot.normal_computation_method_ =
+                paramMultiPipeRec.normal_computation_method_ = paramLocalEstimator.normal_computation_method_ =
+                paramMultiView.normal_computation_method_ = normal_computation_method;
+        paramLocalRecSift.num_training_threads_ = paramLocalRecShot.num_training_threads_ = num_training_threads;
+
+        rr_.reset(new MultiRecognitionPipeline<PointT>(paramMultiPipeRec));
+
+        boost::shared_ptr < GraphGeometricConsistencyGrouping<PointT, PointT> > gcg_alg (
+                    new GraphGeometricConsistencyGrouping<PointT, PointT> (paramGgcg));
+
+        boost::shared_ptr <Source<PointT> > cast_source;
+        if (do_sift || do_shot ) // for local recognizers we need this source type / training data
+        {
+            boost::shared_ptr < RegisteredViewsSource<pcl::PointXYZRGBNormal, PointT, PointT> > src
+                    (new RegisteredViewsSource<pcl::PointXYZRGBNormal, PointT, PointT>(resolution));
+            src->setPath (models_dir);
+            src->generate ();
+            cast_source = boost::static_pointer_cast<RegisteredViewsSource<pcl::PointXYZRGBNormal, PointT, PointT> > (src);
+        }
+
+        if (do_sift)
+        {
+#ifdef HAVE_SIFTGPU
+            static char kw[][16] = {"-m", "-fo", "-1", "-s", "-v", "1", "-pack"};
+            char * argvv[] = {kw[0], kw[1], kw[2], kw[3],kw[4],kw[5],kw[6], NULL};
+
+            int argcc = sizeof(argvv) / sizeof(char*);
+            sift_ = new SiftGPU ();
+            sift_->ParseParam (argcc, argvv);
+
+            //create an OpenGL context for computation
+            if (sift_->CreateContextGL () != SiftGPU::SIFTGPU_FULL_SUPPORTED)
+              throw std::runtime_error ("PSiftGPU::PSiftGPU: No GL support!");
+
+            boost::shared_ptr < SIFTLocalEstimation<PointT, FeatureT > > estimator (new SIFTLocalEstimation<PointT, FeatureT >(sift_));
+            boost::shared_ptr < LocalEstimator<PointT, FeatureT > > cast_estimator = boost::dynamic_pointer_cast<SIFTLocalEstimation<PointT, FeatureT > > (estimator);
+#else
+            boost::shared_ptr < OpenCVSIFTLocalEstimation<PointT, FeatureT > > estimator (new OpenCVSIFTLocalEstimation<PointT, FeatureT >);
+            boost::shared_ptr < LocalEstimator<PointT, FeatureT > > cast_estimator = boost::dynamic_pointer_cast<OpenCVSIFTLocalEstimation<PointT, FeatureT > > (estimator);
+#endif
+
+            boost::shared_ptr<LocalRecognitionPipeline<flann::L1, PointT, FeatureT > > sift_r;
+            sift_r.reset (new LocalRecognitionPipeline<flann::L1, PointT, FeatureT > (paramLocalRecSift));
+            sift_r->setDataSource (cast_source);
+            sift_r->setModelsDir (models_dir);
+            sift_r->setFeatureEstimator (cast_estimator);
+
+            boost::shared_ptr < Recognizer<PointT> > cast_recog;
+            cast_recog = boost::static_pointer_cast<LocalRecognitionPipeline<flann::L1, PointT, FeatureT > > (sift_r);
+            rr_->addRecognizer (cast_recog);
+        }
+        if (do_shot)
+        {
+            boost::shared_ptr<UniformSamplingExtractor<PointT> > uniform_kp_extractor ( new UniformSamplingExtractor<PointT>);
+            uniform_kp_extractor->setSamplingDensity (0.01f);
+            uniform_kp_extractor->setFilterPlanar (true);
+            uniform_kp_extractor->setThresholdPlanar(0.1);
+            uniform_kp_extractor->setMaxDistance( 100.0 ); // for training we want to consider all points (except nan values)
+
+            boost::shared_ptr<KeypointExtractor<PointT> > keypoint_extractor = boost::static_pointer_cast<KeypointExtractor<PointT> > (uniform_kp_extractor);
+            boost::shared_ptr<SHOTLocalEstimationOMP<PointT, pcl::Histogram<352> > > estimator (new SHOTLocalEstimationOMP<PointT, pcl::Histogram<352> >(paramLocalEstimator));
+            estimator->addKeypointExtractor (keypoint_extractor);
+
+            boost::shared_ptr<LocalEstimator<PointT, pcl::Histogram<352> > > cast_estimator;
+            cast_estimator = boost::dynamic_pointer_cast<LocalEstimator<PointT, pcl::Histogram<352> > > (estimator);
+
+            boost::shared_ptr<LocalRecognitionPipeline<flann::L1, PointT, pcl::Histogram<352> > > shot_r;
+            shot_r.reset(new LocalRecognitionPipeline<flann::L1, PointT, pcl::Histogram<352> > (paramLocalRecShot));
+            shot_r->setDataSource (cast_source);
+            shot_r->setModelsDir(models_dir);
+            shot_r->setFeatureEstimator (cast_estimator);
+
+            uniform_kp_extractor->setMaxDistance( chop_z_ ); // for training we do not want this restriction
+
+            boost::shared_ptr<Recognizer<PointT> > cast_recog;
+            cast_recog = boost::static_pointer_cast<LocalRecognitionPipeline<flann::L1, PointT, pcl::Histogram<352> > > (shot_r);
+            rr_->addRecognizer(cast_recog);
+        }
+
+        if(!paramMultiPipeRec.save_hypotheses_)
+            rr_->setCGAlgorithm( gcg_alg );
+
+        rr_->initialize(false);
+
+        boost::shared_ptr<HypothesisVerification<PointT,PointT> > cast_hv_pointer;
+        if(multiview_ && use_go3d) {
+            boost::shared_ptr<GO3D<PointT, PointT> > hyp_verification_method (new GO3D<PointT, PointT>(paramGO3D));
+            cast_hv_pointer = boost::static_pointer_cast<GO3D<PointT, PointT> > (hyp_verification_method);
+        }
+        else {
+            typename GHV<PointT, PointT>::Parameter paramGHV = paramGO3D;
+            boost::shared_ptr<GHV<PointT, PointT> > hyp_verification_method (new GHV<PointT, PointT>(paramGHV));
+            cast_hv_pointer = boost::static_pointer_cast<GHV<PointT, PointT> > (hyp_verification_method);
+        }
+
+        if (multiview_) {
+            mv_r_.reset(new MultiviewRecognizer<PointT>(paramMultiView));
+            mv_r_->setNoiseModelIntegrationParameters(nmInt_param);
+            mv_r_->setNoiseModelParameters(nm_param);
+            mv_r_->setSingleViewRecognizer(rr_);
+            mv_r_->setCGAlgorithm( gcg_alg );
+            mv_r_->setHVAlgorithm( cast_hv_pointer );
+            mv_r_->setSift(sift_);
+        }
+        else
+            rr_->setHVAlgorithm( cast_hv_pointer );
+
+        return true;
+    }
+
+    bool test()
+    {
+        std::vector< std::string> sub_folder_names = io::getFoldersInDirectory( test_dir_);
+        if( sub_folder_names.empty() )
+            sub_folder_names.push_back("");
+
+        std::sort(sub_folder_names.begin(), sub_folder_names.end());    // fixed processing order
+        results_.clear();
+
+        for (size_t sub_folder_id=0; sub_folder_id < sub_folder_names.size(); sub_folder_id++)
+        {
+            const std::string &sequence_name = sub_folder_names[ sub_folder_id ];
+            const std::string sequence_path = test_dir_ + "/" + sequence_name;
+            const std::string gt_path = gt_dir_ + "/" + sequence_name;
+
+            std::vector< std::string > views = io::getFilesInDirectory(sequence_path, ".*.pcd", false);
+            std::sort(views.begin(), views.end());
+
+            for (size_t v_id=0; v_id<views.size(); v_id++)
+            {
+                const std::string fn = sequence_path + "/" + views[ v_id ];
+                const std::string view_name = removeExtension(views[ v_id ]);
+
+                LOG(INFO) << "Recognizing file " << fn;
+                typename pcl::PointCloud<PointT>::Ptr cloud(new pcl::PointCloud<PointT>());
+                pcl::io::loadPCDFile(fn, *cloud);
+
+                SceneResult res;
+                res.name_ = sequence_name.empty() ? view_name : sequence_name + "/" + view_name;
+
+                resetPeakRSS();
+                double cpu_time_start = getCPUTime();
+                pcl::StopWatch watch;
+
+                std::vector<ModelTPtr> verified_models;
+                std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f> > transforms_verified;
+
+                if (multiview_) {
+                    Eigen::Matrix4f tf = RotTrans2Mat4f(cloud->sensor_orientation_, cloud->sensor_origin_);
+                    Eigen::Vector4f zero_origin; zero_origin[0] = zero_origin[1] = zero_origin[2] = zero_origin[3] = 0.f;
+                    cloud->sensor_orientation_ = Eigen::Quaternionf::Identity();
+                    cloud->sensor_origin_ = zero_origin;
+
+                    mv_r_->setInputCloud (cloud);
+                    mv_r_->setCameraPose(tf);
+                    mv_r_->recognize();
+                    res.wall_time_ = watch.getTime();
+                    res.stages_ = mv_r_->getElapsedTimes();
+                    verified_models = mv_r_->getVerifiedModels();
+                    transforms_verified = mv_r_->getVerifiedTransforms();
+                }
+                else {
+                    if( chop_z_ > 0 && std::isfinite(chop_z_))
+                    {
+                        pcl::PassThrough<PointT> pass;
+                        pass.setFilterLimits ( 0.f, chop_z_ );
+                        pass.setFilterFieldName ("z");
+                        pass.setInputCloud (cloud);
+                        pass.setKeepOrganized (true);
+                        pass.filter (*cloud);
+                    }
+
+                    rr_->setInputCloud (cloud);
+                    rr_->recognize();
+                    res.wall_time_ = watch.getTime();
+                    res.stages_ = rr_->getElapsedTimes();
+                    verified_models = rr_->getVerifiedModels();
+                    transforms_verified = rr_->getVerifiedTransforms();
+                }
+
+                res.cpu_time_ = getCPUTime() - cpu_time_start;
+                res.peak_rss_ = readProcStatus("VmHWM") / 1024.;
+
+                std::vector<ObjectPose, Eigen::aligned_allocator<ObjectPose> > recognized (verified_models.size());
+                for(size_t m_id=0; m_id<verified_models.size(); m_id++) {
+                    recognized[m_id].model_id_ = removeExtension(verified_models[m_id]->id_);
+                    recognized[m_id].tf_ = transforms_verified[m_id];
+                }
+
+                std::vector<ObjectPose, Eigen::aligned_allocator<ObjectPose> > gt;
+                if (!gt_dir_.empty())
+                    loadGroundTruth(gt_path, view_name, gt);
+
+                evaluate(gt, recognized, max_trans_error_, max_rot_error_, res);
+
+                LOG(INFO) << res.name_ << ": " << res.wall_time_ << " ms, TP: " << res.tp_ << ", FP: " << res.fp_ << ", FN: " << res.fn_;
+                results_.push_back(res);
+            }
+
+            if (multiview_)
+                mv_r_->cleanUp(); // delete all stored information from last sequences
+        }
+
+        writeReport();
+        return true;
+    }
+
+    /**
+     * @brief writes the results as JSON. Scenes are sorted by name, stages are listed in the order of execution
+     * and numbers are written with fixed precision so that reports of different runs can be diffed.
+     */
+    void writeReport() const
+    {
+        std::ofstream f(report_fn_.c_str());
+        f << std::fixed << std::setprecision(3);
+
+        // stage names in the order they first appear
+        std::vector<std::string> stage_names;
+        std::map<std::string, std::vector<double> > stage_times;
+        std::vector<double> wall_times, utilizations, trans_errors, rot_errors;
+        size_t tp = 0, fp = 0, fn = 0;
+        double peak_rss = 0.;
+
+        for (size_t i=0; i<results_.size(); i++) {
+            const SceneResult &r = results_[i];
+            for (size_t s=0; s<r.stages_.size(); s++) {
+                if (stage_times.find(r.stages_[s].first) == stage_times.end())
+                    stage_names.push_back(r.stages_[s].first);
+                stage_times[r.stages_[s].first].push_back(r.stages_[s].second);
+            }
+            wall_times.push_back(r.wall_time_);
+            utilizations.push_back(r.wall_time_ > 0. ? r.cpu_time_ / r.wall_time_ / num_threads_ : 0.);
+            trans_errors.insert(trans_errors.end(), r.trans_errors_.begin(), r.trans_errors_.end());
+            rot_errors.insert(rot_errors.end(), r.rot_errors_.begin(), r.rot_errors_.end());
+            tp += r.tp_; fp += r.fp_; fn += r.fn_;
+            peak_rss = std::max(peak_rss, r.peak_rss_);
+        }
+
+        const double precision = tp + fp ? (double)tp / (tp + fp) : 0.;
+        const double recall = tp + fn ? (double)tp / (tp + fn) : 0.;
+        const double f_score = precision + recall > 0. ? 2. * precision * recall / (precision + recall) : 0.;
+
+        f << "{" << std::endl;
+        f << "  \"config\": {" << std::endl;
+        f << "    \"recognizer\": \"" << (multiview_ ? "multiview" : "single_view") << "\"," << std::endl;
+        f << "    \"test_dir\": \"" << jsonEscape(test_dir_) << "\"," << std::endl;
+        f << "    \"gt_dir\": \"" << jsonEscape(gt_dir_) << "\"," << std::endl;
+        f << "    \"threads\": " << num_threads_ << "," << std::endl;
+        f << "    \"seed\": " << seed_ << "," << std::endl;
+        f << "    \"max_trans_error_m\": " << max_trans_error_ << "," << std::endl;
+        f << "    \"max_rot_error_deg\": " << max_rot_error_ << std::endl;
+        f << "  }," << std::endl;
+
+        f << "  \"summary\": {" << std::endl;
+        f << "    \"num_scenes\": " << results_.size() << "," << std::endl;
+        f << "    \"wall_time_ms\": { \"mean\": " << mean(wall_times) << ", \"median\": " << median(wall_times) << " }," << std::endl;
+        f << "    \"thread_utilization\": { \"mean\": " << mean(utilizations) << ", \"median\": " << median(utilizations) << " }," << std::endl;
+        f << "    \"peak_rss_mb\": " << peak_rss << "," << std::endl;
+        f << "    \"stages_ms\": {";
+        for (size_t s=0; s<stage_names.size(); s++) {
+            const std::vector<double> &t = stage_times.find(stage_names[s])->second;
+            f << (s ? "," : "") << std::endl << "      \"" << jsonEscape(stage_names[s]) << "\": { \"mean\": " << mean(t) << ", \"median\": " << median(t) << " }";
+        }
+        f << std::endl << "    }," << std::endl;
+        f << "    \"tp\": " << tp << "," << std::endl;
+        f << "    \"fp\": " << fp << "," << std::endl;
+        f << "    \"fn\": " << fn << "," << std::endl;
+        f << "    \"precision\": " << precision << "," << std::endl;
+        f << "    \"recall\": " << recall << "," << std::endl;
+        f << "    \"f_score\": " << f_score << "," << std::endl;
+        f << "    \"trans_error_m\": { \"mean\": " << std::setprecision(4) << mean(trans_errors) << ", \"median\": " << median(trans_errors) << " }," << std::endl;
+        f << std::setprecision(3);
+        f << "    \"rot_error_deg\": { \"mean\": " << mean(rot_errors) << ", \"median\": " << median(rot_errors) << " }" << std::endl;
+        f << "  }," << std::endl;
+
+        std::vector<size_t> order (results_.size());
+        for (size_t i=0; i<order.size(); i++)
+            order[i] = i;
+        std::sort(order.begin(), order.end(), [this](size_t a, size_t b) { return results_[a].name_ < results_[b].name_; });
+
+        f << "  \"scenes\": [";
+        for (size_t i=0; i<order.size(); i++) {
+            const SceneResult &r = results_[ order[i] ];
+            f << (i ? "," : "") << std::endl;
+            f << "    {" << std::endl;
+            f << "      \"name\": \"" << jsonEscape(r.name_) << "\"," << std::endl;
+            f << "      \"wall_time_ms\": " << r.wall_time_ << "," << std::endl;
+            f << "      \"cpu_time_ms\": " << r.cpu_time_ << "," << std::endl;
+            f << "      \"thread_utilization\": " << (r.wall_time_ > 0. ? r.cpu_time_ / r.wall_time_ / num_threads_ : 0.) << "," << std::endl;
+            f << "      \"peak_rss_mb\": " << r.peak_rss_ << "," << std::endl;
+            f << "      \"stages_ms\": {";
+            for (size_t s=0; s<r.stages_.size(); s++)
+                f << (s ? "," : "") << std::endl << "        \"" << jsonEscape(r.stages_[s].first) << "\": " << r.stages_[s].second;
+            f << std::endl << "      }," << std::endl;
+            f << "      \"tp\": " << r.tp_ << ", \"fp\": " << r.fp_ << ", \"fn\": " << r.fn_ << std::endl;
+            f << "    }";
+        }
+        f << std::endl << "  ]" << std::endl;
+        f << "}" << std::endl;
+        f.close();
+
+        std::cout << "Benchmark report written to " << report_fn_ << " (" << results_.size() << " scenes, precision: "
+                  << precision << ", recall: " << recall << ", median time: " << median(wall_times) << " ms)" << std::endl;
+    }
+};
+
+int
+main (int argc, char ** argv)
+{
+    google::InitGoogleLogging(argv[0]);
+    Benchmark<pcl::PointXYZRGB> bm;
+    if(bm.initialize(argc,argv))
+        bm.test();
+    return 0;
+}
@@ -0,0 +1,276 @@
+/**
+ * $Id$
+ *
+ * Copyright (c) 2015, Johann Prankl
+ * @author Johann Prankl (prankl@acin.tuwien.ac.at)
+ *
+ * @brief checks of the TrackingModelFile format: the views of a mapped model are only paged in when they
+ * are used (single and multi object tracker) and truncated or corrupted files result in an error instead
+ * of an out of bounds read. Returns 0 if all checks pass.
+ */
+
+#include <v4r/keypoints/TrackingModelFile.h>
+#include <v4r/tracking/ObjectTrackerMono.h>
+#include <v4r/tracking/MultiObjectTrackerMono.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <stdint.h>
+#include <string.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+
+namespace po = boost::program_options;
+
+using namespace v4r;
+
+namespace
+{
+
+int num_failed = 0;
+
+#define CHECK_TRUE(cond, msg) \
+  if (!(cond)) { std::cerr << "FAILED: " << msg << std::endl; num_failed++; } \
+  else std::cout << "ok: " << msg << std::endl;
+
+// on disk layout (see TrackingModelFile.h)
+const size_t HEADER_INDEX_OFFSET = 32;     // magic(8) version(4) byte_order(4) core_offset(8) core_size(8)
+const size_t BLOCK_HEAD = 16;              // uint64 size | uint64 reserved
+const size_t DIMS_SIZE = 8*sizeof(int32_t);
+
+/** synthetic model with num_views views and num_keys keypoints per view (no codebook) */
+ArticulatedObject::Ptr createModel(int num_views, int num_keys)
+{
+  ArticulatedObject::Ptr model(new ArticulatedObject());
+  model->camera_parameter.push_back(std::vector<double>());
+  double cam[4] = {525., 525., 320., 240.};
+  model->camera_parameter.back().assign(cam, cam+4);
+
+  cv::RNG rng(42);
+  std::vector<float> desc(64);
+
+  for (int i=0; i<num_views; i++)
+  {
+    Eigen::Matrix4f pose = Eigen::Matrix4f::Identity();
+    pose(0,3) = 0.1f*i;
+
+    cv::Mat_<unsigned char> im(48, 64);
+    rng.fill(im, cv::RNG::UNIFORM, 0, 255);
+
+    ObjectView &view = model->addArticulatedView(pose, im);
+
+    for (int j=0; j<num_keys; j++)
+    {
+      for (unsigned k=0; k<desc.size(); k++)
+        desc[k] = rng.uniform(0.f, 1.f);
+
+      Eigen::Vector3f pt(rng.uniform(-.1f,.1f), rng.uniform(-.1f,.1f), rng.uniform(.5f,1.f));
+      view.add(cv::KeyPoint(rng.uniform(0.f,64.f), rng.uniform(0.f,48.f), 7.f), &desc[0], desc.size(),
+               pt, Eigen::Vector3f(0,0,-1), pt.normalized(), pt);
+    }
+
+    view.computeCenter();
+  }
+
+  return model;
+}
+
+std::vector<char> readFile(const std::string &file)
+{
+  std::ifstream in(file.c_str(), std::ios::in | std::ios::binary);
+  return std::vector<char>((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+}
+
+void writeFile(const std::string &file, const std::vector<char> &data, size_t size)
+{
+  std::ofstream out(file.c_str(), std::ios::out | std::ios::binary);
+  out.write(&data[0], size);
+}
+
+template<typename T> T getValue(const std::vector<char> &data, size_t offs)
+{
+  T v;
+  memcpy(&v, &data[offs], sizeof(T));
+  return v;
+}
+
+template<typename T> void setValue(std::vector<char> &data, size_t offs, const T &v)
+{
+  memcpy(&data[offs], &v, sizeof(T));
+}
+
+/** true if all views can be loaded, false if loading throws (a crash fails the test) */
+bool tryLoadAllViews(const std::string &file)
+{
+  try
+  {
+    TrackingModelFile f;
+    if (!f.open(file))
+      return false;
+    f.loadAllViews();
+  }
+  catch (const std::exception &)
+  {
+    return false;
+  }
+  return true;
+}
+
+unsigned numLoadedViews(const TrackingModelFile &f)
+{
+  unsigned cnt = 0;
+  for (unsigned i=0; i<f.getNumViews(); i++)
+    cnt += (f.isViewLoaded(i)?1:0);
+  return cnt;
+}
+
+/** views are only materialized when they are used */
+void testLazyLoading(const std::string &file, const ArticulatedObject &model)
+{
+  TrackingModelFile::Ptr f(new TrackingModelFile());
+  CHECK_TRUE(f->open(file), "open model file");
+  CHECK_TRUE(f->getNumViews()==model.views.size(), "number of views");
+  CHECK_TRUE(numLoadedViews(*f)==0, "no view loaded after open");
+  CHECK_TRUE(f->getModel()->views[0]->descs.empty(), "light weight view without descriptors");
+
+  ObjectTrackerMono::Ptr tracker(new ObjectTrackerMono());
+  tracker->setObjectModelFile(f);
+  CHECK_TRUE(numLoadedViews(*f)==0, "no view loaded by ObjectTrackerMono::setObjectModelFile");
+
+  f->loadView(2);
+  CHECK_TRUE(numLoadedViews(*f)==1 && f->isViewLoaded(2), "loadView materializes only the requested view");
+
+  const ObjectView &v0 = *model.views[2];
+  const ObjectView &v1 = *f->getModel()->views[2];
+  CHECK_TRUE(v1.keys.size()==v0.keys.size() && v1.descs.rows==v0.descs.rows &&
+             cv::countNonZero(v1.descs!=v0.descs)==0 && cv::countNonZero(v1.image!=v0.image)==0, "loaded view equals the stored one");
+
+  f->releaseView(2);
+  CHECK_TRUE(numLoadedViews(*f)==0, "releaseView");
+
+  // the combined codebook is created from the descriptors, but views which are not in use are released again
+  TrackingModelFile::Ptr f2(new TrackingModelFile());
+  f2->open(file);
+
+  MultiObjectTrackerMono multi;
+  cv::Mat_<double> intrinsic = cv::Mat_<double>::eye(3,3);
+  intrinsic(0,0) = intrinsic(1,1) = 525.;
+  intrinsic(0,2) = 320.;
+  intrinsic(1,2) = 240.;
+  multi.setCameraParameter(intrinsic, cv::Mat());
+  multi.addObjectModelFile(f2);
+  CHECK_TRUE(numLoadedViews(*f2)==0, "no view loaded by MultiObjectTrackerMono::addObjectModelFile");
+
+  multi.track(cv::Mat_<unsigned char>::zeros(480, 640));
+  CHECK_TRUE(numLoadedViews(*f2)==0, "no view kept loaded after the codebook creation");
+}
+
+/** truncated and corrupted files result in an error */
+void testCorruptedFiles(const std::string &file, const std::string &tmp_file)
+{
+  std::vector<char> data = readFile(file);
+  CHECK_TRUE(tryLoadAllViews(file), "load all views of the valid file");
+
+  const uint64_t index_offset = getValue<uint64_t>(data, HEADER_INDEX_OFFSET);
+  const uint64_t view_offset = getValue<uint64_t>(data, index_offset);   // first index entry
+
+  // truncated files: in the header, the core, the view data and the index
+  size_t sizes[] = { 16, 100, (size_t)view_offset + 40, (size_t)index_offset - 8, data.size() - 4 };
+  for (unsigned i=0; i<sizeof(sizes)/sizeof(size_t); i++)
+  {
+    writeFile(tmp_file, data, sizes[i]);
+    std::ostringstream msg;
+    msg << "truncated file (" << sizes[i] << " of " << data.size() << " bytes) is rejected";
+    CHECK_TRUE(!tryLoadAllViews(tmp_file), msg.str());
+  }
+
+  // view data truncated within a block
+  std::vector<char> corrupted = data;
+  setValue<uint64_t>(corrupted, index_offset + sizeof(uint64_t), BLOCK_HEAD + DIMS_SIZE + BLOCK_HEAD + 8);
+  writeFile(tmp_file, corrupted, corrupted.size());
+  CHECK_TRUE(!tryLoadAllViews(tmp_file), "truncated view data is rejected");
+
+  // invalid descriptor type
+  corrupted = data;
+  setValue<int32_t>(corrupted, view_offset + BLOCK_HEAD + 4*sizeof(int32_t), 0x7fff);
+  writeFile(tmp_file, corrupted, corrupted.size());
+  CHECK_TRUE(!tryLoadAllViews(tmp_file), "invalid descriptor type is rejected");
+
+  // descriptor rows do not match the payload size
+  corrupted = data;
+  setValue<int32_t>(corrupted, view_offset + BLOCK_HEAD + 2*sizeof(int32_t), 1000000);
+  writeFile(tmp_file, corrupted, corrupted.size());
+  CHECK_TRUE(!tryLoadAllViews(tmp_file), "descriptor size mismatch is rejected");
+
+  // block size of the image exceeds the view
+  corrupted = data;
+  setValue<uint64_t>(corrupted, view_offset + BLOCK_HEAD + DIMS_SIZE, uint64_t(-32));
+  writeFile(tmp_file, corrupted, corrupted.size());
+  CHECK_TRUE(!tryLoadAllViews(tmp_file), "oversized block is rejected");
+
+  // view offset wrapping around the address space
+  corrupted = data;
+  setValue<uint64_t>(corrupted, index_offset, uint64_t(-16));
+  writeFile(tmp_file, corrupted, corrupted.size());
+  CHECK_TRUE(!tryLoadAllViews(tmp_file), "view offset out of the file is rejected");
+
+  // view size wrapping around the address space
+  corrupted = data;
+  setValue<uint64_t>(corrupted, index_offset + sizeof(uint64_t), uint64_t(-1));
+  writeFile(tmp_file, corrupted, corrupted.size());
+  CHECK_TRUE(!tryLoadAllViews(tmp_file), "view size out of the file is rejected");
+
+  // index offset out of the file
+  corrupted = data;
+  setValue<uint64_t>(corrupted, HEADER_INDEX_OFFSET, uint64_t(-8));
+  writeFile(tmp_file, corrupted, corrupted.size());
+  CHECK_TRUE(!tryLoadAllViews(tmp_file), "index offset out of the file is rejected");
+}
+
+}
+
+
+int main(int argc, char *argv[])
+{
+  std::string out_dir = boost::filesystem::temp_directory_path().string();
+  int num_views = 5;
+
+  po::options_description desc("Checks of the TrackingModelFile format\n======================================\n**Allowed options");
+  desc.add_options()
+      ("help,h", "produce help message")
+      ("out_dir,o", po::value<std::string>(&out_dir)->default_value(out_dir), "directory for the temporary model files")
+      ("num_views,n", po::value<int>(&num_views)->default_value(num_views), "number of views of the synthetic model")
+      ;
+  po::variables_map vm;
+  po::store(po::parse_command_line(argc, argv, desc), vm);
+  if (vm.count("help"))
+  {
+    std::cout << desc << std::endl;
+    return 0;
+  }
+  po::notify(vm);
+
+  const std::string file = out_dir + "/tracking_model_file_test.tmf";
+  const std::string tmp_file = out_dir + "/tracking_model_file_test_corrupted.tmf";
+
+  ArticulatedObject::Ptr model = createModel(std::max(num_views,3), 50);
+
+  if (!TrackingModelFile::write(file, *model))
+  {
+    std::cerr << "Could not write " << file << std::endl;
+    return 1;
+  }
+
+  testLazyLoading(file, *model);
+  testCorruptedFiles(file, tmp_file);
+
+  boost::filesystem::remove(file);
+  boost::filesystem::remove(tmp_file);
+
+  std::cout << (num_failed==0 ? "All checks passed." : "Some checks failed!") << std::endl;
+  return (num_failed==0 ? 0 : 1);
+}
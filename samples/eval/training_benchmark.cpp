@@ -0,0 +1,229 @@
+/******************************************************************************
+ * Copyright (c) 2016 Thomas Faeulhammer
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ ******************************************************************************/
+
+/**
+*
+*      @author Thomas Faeulhammer (faeulhammer@acin.tuwien.ac.at)
+*      @date January, 2016
+*      @brief training benchmark. Trains the SHOT (LocalRecognitionPipeline) and ESF (GlobalNNClassifier) models of
+*      a model database with a varying number of training threads and reports the training time and the speed-up
+*      with respect to the first run. The training data of each run is written to an own directory and compared
+*      to the one of the first run, i.e. the program returns 1 if the multi-threaded training gives different results.
+*/
+
+#include <v4r/features/esf_estimator.h>
+#include <v4r/features/shot_local_estimator_omp.h>
+#include <v4r/io/filesystem.h>
+#include <v4r/recognition/global_nn_classifier.h>
+#include <v4r/recognition/local_recognizer.h>
+#include <v4r/recognition/registered_views_source.h>
+
+#include <pcl/common/time.h>
+
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+#include <glog/logging.h>
+
+namespace po = boost::program_options;
+
+using namespace v4r;
+
+namespace
+{
+
+typedef pcl::PointXYZRGB PointT;
+
+/** @brief true if both directories contain the same files with the same content */
+bool
+equalDirectories(const std::string &dir_a, const std::string &dir_b)
+{
+    std::vector<std::string> files_a = io::getFilesInDirectory(dir_a, ".*", true);
+    std::vector<std::string> files_b = io::getFilesInDirectory(dir_b, ".*", true);
+    std::sort(files_a.begin(), files_a.end());
+    std::sort(files_b.begin(), files_b.end());
+
+    if (files_a != files_b) {
+        std::cerr << "Different training files in " << dir_a << " and " << dir_b << std::endl;
+        return false;
+    }
+
+    for (size_t i=0; i<files_a.size(); i++) {
+        std::ifstream fa((dir_a + "/" + files_a[i]).c_str(), std::ios::binary);
+        std::ifstream fb((dir_b + "/" + files_a[i]).c_str(), std::ios::binary);
+        std::string a((std::istreambuf_iterator<char>(fa)), std::istreambuf_iterator<char>());
+        std::string b((std::istreambuf_iterator<char>(fb)), std::istreambuf_iterator<char>());
+        if (a != b) {
+            std::cerr << "Training file " << files_a[i] << " differs." << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+/** @brief trains the SHOT models into train_dir, returns the training time in seconds */
+double
+trainShot(const std::string &models_dir, const std::string &train_dir, int num_threads)
+{
+    boost::shared_ptr < RegisteredViewsSource<pcl::PointXYZRGBNormal, PointT, PointT> > src
+            (new RegisteredViewsSource<pcl::PointXYZRGBNormal, PointT, PointT>(0.005f));
+    src->setPath (models_dir);
+    src->generate ();
+    boost::shared_ptr <Source<PointT> > cast_source = boost::static_pointer_cast<RegisteredViewsSource<pcl::PointXYZRGBNormal, PointT, PointT> > (src);
+
+    boost::shared_ptr<UniformSamplingExtractor<PointT> > uniform_kp_extractor ( new UniformSamplingExtractor<PointT>);
+    uniform_kp_extractor->setSamplingDensity (0.01f);
+    uniform_kp_extractor->setFilterPlanar (true);
+    uniform_kp_extractor->setThresholdPlanar(0.1);
+    uniform_kp_extractor->setMaxDistance( 100.0 );
+    boost::shared_ptr<KeypointExtractor<PointT> > keypoint_extractor = boost::static_pointer_cast<KeypointExtractor<PointT> > (uniform_kp_extractor);
+
+    boost::shared_ptr<SHOTLocalEstimationOMP<PointT, pcl::Histogram<352> > > estimator (new SHOTLocalEstimationOMP<PointT, pcl::Histogram<352> >);
+    estimator->addKeypointExtractor (keypoint_extractor);
+    boost::shared_ptr<LocalEstimator<PointT, pcl::Histogram<352> > > cast_estimator = boost::dynamic_pointer_cast<LocalEstimator<PointT, pcl::Histogram<352> > > (estimator);
+
+    typename LocalRecognitionPipeline<flann::L1, PointT, pcl::Histogram<352> >::Parameter param;
+    param.num_training_threads_ = num_threads;
+
+    LocalRecognitionPipeline<flann::L1, PointT, pcl::Histogram<352> > local (param);
+    local.setDataSource (cast_source);
+    local.setModelsDir (train_dir);
+    local.setFeatureEstimator (cast_estimator);
+
+    pcl::StopWatch t;
+    local.initialize (true);
+    return t.getTimeSeconds();
+}
+
+/** @brief trains the ESF models into train_dir, returns the training time in seconds */
+double
+trainEsf(const std::string &models_dir, const std::string &train_dir, int num_threads)
+{
+    boost::shared_ptr < RegisteredViewsSource<pcl::PointXYZRGBNormal, PointT, PointT> > src
+            (new RegisteredViewsSource<pcl::PointXYZRGBNormal, PointT, PointT>(0.005f));
+    src->setPath (models_dir);
+    src->setLoadIntoMemory (true);
+    src->generate ();
+    boost::shared_ptr <Source<PointT> > cast_source = boost::static_pointer_cast<RegisteredViewsSource<pcl::PointXYZRGBNormal, PointT, PointT> > (src);
+
+    // single-threaded signatures, i.e. the speed-up results from the training threads only
+    boost::shared_ptr<ESFEstimation<PointT> > estimator (new ESFEstimation<PointT>( typename ESFEstimation<PointT>::Parameter(20000, 1) ));
+    boost::shared_ptr<GlobalEstimator<PointT> > cast_estimator = boost::dynamic_pointer_cast<ESFEstimation<PointT> > (estimator);
+
+    GlobalNNClassifier<flann::L1, PointT> esf_classifier;
+    esf_classifier.setDataSource (cast_source);
+    esf_classifier.setTrainingDir (train_dir);
+    esf_classifier.setDescriptorName (estimator->getFeatureDescriptorName());
+    esf_classifier.setFeatureEstimator (cast_estimator);
+    esf_classifier.setNumTrainingThreads (num_threads);
+
+    pcl::StopWatch t;
+    esf_classifier.initialize (true);
+    return t.getTimeSeconds();
+}
+
+}
+
+int
+main (int argc, char ** argv)
+{
+    google::InitGoogleLogging(argv[0]);
+
+    std::string models_dir;
+    std::string out_dir = "/tmp/training_benchmark";
+    std::vector<int> threads;
+    bool do_shot = true, do_esf = true;
+
+    po::options_description desc("Training benchmark\n======================================\n**Allowed options");
+    desc.add_options()
+            ("help,h", "produce help message")
+            ("models_dir,m", po::value<std::string>(&models_dir)->required(), "directory containing the object models (registered views)")
+            ("out_dir,o", po::value<std::string>(&out_dir)->default_value(out_dir), "directory the training data of the runs is written to")
+            ("threads", po::value<std::vector<int> >(&threads)->multitoken(), "number of training threads of the runs (0... number of available cores), default: 1 0")
+            ("do_shot", po::value<bool>(&do_shot)->default_value(do_shot), "if true, benchmarks the training of the SHOT models (LocalRecognitionPipeline)")
+            ("do_esf", po::value<bool>(&do_esf)->default_value(do_esf), "if true, benchmarks the training of the ESF models (GlobalNNClassifier)")
+            ;
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    if (vm.count("help"))
+    {
+        std::cout << desc << std::endl;
+        return 0;
+    }
+    try
+    {
+        po::notify(vm);
+    }
+    catch(std::exception& e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl << std::endl << desc << std::endl;
+        return 1;
+    }
+
+    if (threads.empty())
+    {
+        threads.push_back(1);
+        threads.push_back(0);
+    }
+
+    bool consistent = true;
+
+    for (int pipeline = 0; pipeline < 2; pipeline++)
+    {
+        if ( (pipeline == 0 && !do_shot) || (pipeline == 1 && !do_esf) )
+            continue;
+
+        const std::string name = (pipeline == 0 ? "shot" : "esf");
+        double reference_time = 0.;
+
+        for (size_t r = 0; r < threads.size(); r++)
+        {
+            std::stringstream train_dir;
+            train_dir << out_dir << "/" << name << "_" << r;
+            if (io::existsFolder(train_dir.str()))
+                boost::filesystem::remove_all(train_dir.str());
+            io::createDirIfNotExist(train_dir.str());
+
+            const double time = (pipeline == 0 ? trainShot(models_dir, train_dir.str(), threads[r]) :
+                                                 trainEsf(models_dir, train_dir.str(), threads[r]));
+            if (r == 0)
+                reference_time = time;
+
+            bool same = true;
+            if (r > 0)
+            {
+                same = equalDirectories(out_dir + "/" + name + "_0", train_dir.str());
+                consistent &= same;
+            }
+
+            std::cout << name << " training with " << threads[r] << " threads: " << time << " s (speed-up "
+                      << reference_time / time << ")" << (same ? "" : ", training data differs!") << std::endl;
+        }
+    }
+
+    return consistent ? 0 : 1;
+}
@@ -60,7 +60,7 @@ init(v4r::GlobalNNClassifier<flann::L1, PointT> &esf_classifier) {
 
     esf_classifier.setDataSource(source);
     esf_classifier.setTrainingDir(MODELS_DIR_);
-    esf_classifier.setDescriptorName("esf");
+    esf_classifier.setDescriptorName(estimator->getFeatureDescriptorName());
     esf_classifier.setFeatureEstimator (cast_estimator);
     esf_classifier.setNN(KNN_);
     esf_classifier.initialize (false);
@@ -192,23 +192,25 @@ int main(int argc, char** argv)
                 }
             }
 
+            typename pcl::PointCloud<PointT>::Ptr cloudXYZ (new pcl::PointCloud<PointT>());
+            pcl::copyPointCloud(*cloud, *cloudXYZ);
+
+            if(do_esf)  // classify all clusters at once
+                esf_classifier.classify(cloudXYZ, found_clusters, categories, confidences);
+
             std::string out_fn = out_dir_full + "/" + view;
             boost::replace_all(out_fn, ".pcd", ".anno_test");
             std::ofstream of (out_fn.c_str());
             for(size_t i=0; i < found_clusters.size(); i++) {
-                typename pcl::PointCloud<PointT>::Ptr clusterXYZ (new pcl::PointCloud<PointT>());
-                pcl::copyPointCloud(*cloud, found_clusters[i], *clusterXYZ);
-
                 Eigen::Vector4f centroid;
-                pcl::compute3DCentroid (*clusterXYZ, centroid);
+                pcl::compute3DCentroid (*cloudXYZ, found_clusters[i], centroid);
                 std::cout << centroid[2] << " " << centroid[0]*centroid[0] + centroid[1]*centroid[1] + centroid[2]*centroid[2] << std::endl;
 
-                if(do_esf) {
-                    esf_classifier.setInputCloud(clusterXYZ);
-                    esf_classifier.classify();
-                    esf_classifier.getCategory(categories[i]);
-                    esf_classifier.getConfidence(confidences[i]);
-
+                if(do_esf && categories[i].empty()) {  // no valid signature for this cluster
+                    std::cout << "Predicted Label (ESF): unknown" << std::endl;
+                    of << "unknown 0 ";
+                }
+                else if(do_esf) {
                     std::cout << "Predicted Label (ESF): " << categories[i][0] << std::endl;
                     of << categories[i][0] << " " << confidences[i][0] << " ";
                     for(size_t c_id=0; c_id<categories[i].size(); c_id++) {
@@ -48,6 +48,11 @@ main (int argc, char ** argv)
             ("normal_method", po::value<int>( &m.param_.normal_method_ )->default_value( m.param_.normal_method_ ), "")
             ("ratio_cluster_obj_supported", po::value<double>( &m.param_.ratio_cluster_obj_supported_ )->default_value( m.param_.ratio_cluster_obj_supported_ ), "")
             ("ratio_cluster_occluded", po::value<double>( &m.param_.ratio_cluster_occluded_ )->default_value( m.param_.ratio_cluster_occluded_ ), "")
+            ("streaming", po::value<bool>( &m.param_.streaming_ )->default_value( m.param_.streaming_ ), "if true, learns in a memory bounded way by compacting older views and integrating them incrementally")
+            ("num_full_res_views", po::value<size_t>( &m.param_.num_full_res_views_ )->default_value( m.param_.num_full_res_views_ ), "number of latest views kept at full resolution in streaming mode")
+            ("object_voxel_size", po::value<double>( &m.param_.object_voxel_size_ )->default_value( m.param_.object_voxel_size_ ), "voxel size for downsampling the object points kept for each view in streaming mode")
+            ("spill_dir", po::value<std::string>( &m.param_.spill_dir_ )->default_value( m.param_.spill_dir_ ), "directory where the point clouds of compacted views are written to in streaming mode (required for saving training views)")
+            ("max_icp_cached_views", po::value<size_t>( &m.param_.max_icp_cached_views_ )->default_value( m.param_.max_icp_cached_views_ ), "maximum number of views whose registration data is cached (0... unbounded)")
 
             ("stat_outlier_removal_meanK", po::value<int>( &m.sor_params_.meanK_ )->default_value( m.sor_params_.meanK_ ), "MeanK used for statistical outlier removal (see PCL documentation)")
             ("stat_outlier_removal_std_mul", po::value<double>( &m.sor_params_.std_mul_ )->default_value( m.sor_params_.std_mul_ ), "Standard Deviation multiplier used for statistical outlier removal (see PCL documentation)")
@@ -69,6 +69,7 @@ public:
         paramLocalRecShot.kdtree_splits_ = 128;
 
         int normal_computation_method = paramLocalRecSift.normal_computation_method_;
+        int num_training_threads = paramLocalRecSift.num_training_threads_;
 
         po::options_description desc("Single-View Object Instance Recognizer\n======================================\n**Allowed options");
         desc.add_options()
@@ -120,6 +121,7 @@ public:
                 ("hv_use_supervoxels", po::value<bool>(&paramGHV.use_super_voxels_)->default_value(paramGHV.use_super_voxels_), "If true, uses supervoxel clustering to detect smoothness violations")
                 ("hv_min_plane_inliers", po::value<size_t>(&paramGHV.min_plane_inliers_)->default_value(paramGHV.min_plane_inliers_), "a planar cluster is only added as plane if it has at least min_plane_inliers_ points")
                 ("normal_method,n", po::value<int>(&normal_computation_method)->default_value(normal_computation_method), "chosen normal computation method of the V4R library")
+                ("num_training_threads", po::value<int>(&num_training_threads)->default_value(num_training_threads), "number of threads used for training the models (0... number of available cores)")
 ;
 
        po::variables_map vm;
@@ -142,6 +144,7 @@ public:
 
         paramLocalRecSift.normal_computation_method_ = paramLocalRecShot.normal_computation_method_ =
                 paramMultiPipeRec.normal_computation_method_ = paramLocalEstimator.normal_computation_method_ = normal_computation_method;
+        paramLocalRecSift.num_training_threads_ = paramLocalRecShot.num_training_threads_ = num_training_threads;
 
         rr_.reset(new MultiRecognitionPipeline<PointT>(paramMultiPipeRec));
 
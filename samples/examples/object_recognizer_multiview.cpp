@@ -110,6 +110,7 @@ public:
         paramLocalRecShot.kdtree_splits_ = 128;
 
         int normal_computation_method = paramLocalRecSift.normal_computation_method_;
+        int num_training_threads = paramLocalRecSift.num_training_threads_;
 
         po::options_description desc("Multiview Object Instance Recognizer\n======================================**Reference(s): Faeulhammer et al, ICRA / MVA 2015\n **Allowed options");
         desc.add_options()
@@ -167,6 +168,7 @@ public:
                 ("visualize_go3d_cues", po::value<bool>(&paramGO3D.visualize_cues_)->default_value(paramGO3D.visualize_cues_), "If true, visualizes cues computated at the go3d verification stage such as inlier, outlier points. Mainly used for debugging.")
                 ("visualize_go_cues_", po::value<bool>(&paramGO3D.visualize_go_cues_)->default_value(paramGO3D.visualize_go_cues_), "If true, visualizes cues computated at the hypothesis verification stage such as inlier, outlier points. Mainly used for debugging.")
                 ("normal_method,n", po::value<int>(&normal_computation_method)->default_value(normal_computation_method), "chosen normal computation method of the V4R library")
+                ("num_training_threads", po::value<int>(&num_training_threads)->default_value(num_training_threads), "number of threads used for training the models (0... number of available cores)")
                 ("octree_radius", po::value<float>(&nmInt_param.octree_resolution_)->default_value(nmInt_param.octree_resolution_, boost::str(boost::format("%.2e") % nmInt_param.octree_resolution_)), "resolution of the octree in the noise model based cloud registration used for hypothesis verification")
                 ("edge_radius_px", po::value<float>(&nmInt_param.edge_radius_px_)->default_value(nmInt_param.edge_radius_px_, boost::str(boost::format("%.2e") % nmInt_param.edge_radius_px_)), "points of the input cloud within this distance (in pixel) to its closest depth discontinuity pixel will be removed in the noise model based cloud registration used for hypothesis verification")
        ;
@@ -192,6 +194,7 @@ public:
         paramLocalRecSift.normal_computation_method_ = paramLocalRecShot.normal_computation_method_ =
                 paramMultiPipeRec.normal_computation_method_ = paramLocalEstimator.normal_computation_method_ =
                 paramMultiView.normal_computation_method_ = normal_computation_method;
+        paramLocalRecSift.num_training_threads_ = paramLocalRecShot.num_training_threads_ = num_training_threads;
 
         rr_.reset(new MultiRecognitionPipeline<PointT>(paramMultiPipeRec));
 